@@ -0,0 +1,132 @@
+#include "AdcFilter.h"
+
+#include <math.h>
+#include <string.h>
+
+// ======== Caja ========
+size_t BoxDecimator::process(const uint16_t *in, size_t n, float *out) {
+  const float scale = 1.0f / factor_;
+  size_t o = 0;
+  while (n) {
+    size_t take = factor_ - count_;
+    if (take > n) take = n;
+    uint32_t acc = acc_;
+    for (size_t i = 0; i < take; ++i) acc += in[i];
+    in += take;
+    n -= take;
+    count_ += (uint16_t)take;
+    if (count_ == factor_) {
+      out[o++] = (float)acc * scale;
+      acc_ = 0;
+      count_ = 0;
+    } else {
+      acc_ = acc;
+    }
+  }
+  return o;
+}
+
+// ======== FIR ========
+FirDecimator::FirDecimator(const float *taps, uint16_t count, uint16_t factor)
+    : count_(count > FIR_MAX_TAPS ? FIR_MAX_TAPS : (count ? count : 1)), factor_(factor ? factor : 1) {
+  if (taps && count) memcpy(taps_, taps, count_ * sizeof(float));
+  else taps_[0] = 1.0f;
+  memset(hist_, 0, sizeof(hist_));
+}
+
+size_t FirDecimator::process(const float *in, size_t n, float *out) {
+  size_t o = 0;
+  for (size_t i = 0; i < n; ++i) {
+    const float x = in[i];
+    if (!primed_) {
+      // Sin esto la salida arranca en 0 y tarda count muestras en subir
+      for (uint16_t k = 0; k < 2 * count_; ++k) hist_[k] = x;
+      primed_ = true;
+    }
+    hist_[pos_] = x;
+    hist_[pos_ + count_] = x;
+    if (++pos_ == count_) pos_ = 0;
+    if (++phase_ < factor_) continue;
+    phase_ = 0;
+    // hist_[pos_ .. pos_ + count_ - 1]: de la más vieja a la recién llegada
+    const float *h = &hist_[pos_];
+    float acc = 0.0f;
+    for (uint16_t k = 0; k < count_; ++k) acc += taps_[k] * h[k];
+    out[o++] = acc;
+  }
+  return o;
+}
+
+void FirDecimator::lowpass(float *taps, uint16_t count, float cutoff) {
+  const double pi = 3.14159265358979323846;
+  const double mid = (count - 1) / 2.0;
+  double sum = 0.0;
+  for (uint16_t i = 0; i < count; ++i) {
+    double x = i - mid;
+    double sinc = x == 0.0 ? 2.0 * cutoff : sin(2.0 * pi * cutoff * x) / (pi * x);
+    double window = count > 1 ? 0.54 - 0.46 * cos(2.0 * pi * i / (count - 1)) : 1.0;
+    taps[i] = (float)(sinc * window);
+    sum += taps[i];
+  }
+  for (uint16_t i = 0; i < count; ++i) taps[i] = (float)(taps[i] / sum);
+}
+
+// ======== Estadísticas por ventana ========
+void WindowStats::push(const uint16_t *in, size_t n) {
+  uint16_t mn = min_, mx = max_;
+  while (n) {
+    size_t block = n < 256 ? n : 256;
+    uint32_t s = 0, q = 0;
+    for (size_t i = 0; i < block; ++i) {
+      uint32_t v = in[i];
+      s += v;
+      q += v * v;
+      if (v < mn) mn = (uint16_t)v;
+      if (v > mx) mx = (uint16_t)v;
+    }
+    sum_ += s;
+    sumSq_ += q;
+    count_ += (uint32_t)block;
+    in += block;
+    n -= block;
+  }
+  min_ = mn;
+  max_ = mx;
+}
+
+AdcSummary WindowStats::summary() const {
+  AdcSummary s = {count_, 0, 0, 0.0f, 0.0f, 0.0f};
+  if (!count_) return s;
+  double mean = (double)sum_ / count_;
+  double meanSq = (double)sumSq_ / count_;
+  double var = meanSq - mean * mean;
+  s.min = min_;
+  s.max = max_;
+  s.mean = (float)mean;
+  s.rms = (float)sqrt(meanSq);
+  s.acRms = (float)sqrt(var > 0.0 ? var : 0.0);
+  return s;
+}
+
+void WindowStats::reset() {
+  sum_ = sumSq_ = 0;
+  count_ = 0;
+  min_ = 0xFFFF;
+  max_ = 0;
+}
+
+void RangeStats::push(const float *in, size_t n) {
+  for (size_t i = 0; i < n; ++i) {
+    float v = in[i];
+    if (!count_ || v < min_) min_ = v;
+    if (!count_ || v > max_) max_ = v;
+    sum_ += v;
+    count_++;
+  }
+}
+
+void RangeStats::reset() {
+  sum_ = 0;
+  count_ = 0;
+  min_ = max_ = 0;
+}
@@ -0,0 +1,102 @@
+// ======== Filtros para el muestreo continuo del ADC ========
+// Cadena típica: muestras crudas de 12 bits -> BoxDecimator (promedio de a D,
+// sólo sumas enteras) -> FirDecimator (pasabajos FIR que calcula una salida
+// cada D entradas) -> nivel. WindowStats y RangeStats resumen una ventana
+// (mín/máx/media/RMS) sin guardar las muestras.
+//
+// Todo procesa bloques (una trama del DMA por llamada) y guarda el estado
+// entre llamadas: partir la entrada en tramas de cualquier largo da la misma
+// salida que procesarla de una vez. Memoria fija, sin heap.
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef FIR_MAX_TAPS
+#define FIR_MAX_TAPS 64
+#endif
+
+// Promedio de a `factor` muestras: filtro caja + decimación por `factor`
+class BoxDecimator {
+public:
+  explicit BoxDecimator(uint16_t factor) : factor_(factor ? factor : 1) {}
+
+  // Escribe en out a lo sumo n / factor + 1 salidas; devuelve cuántas
+  size_t process(const uint16_t *in, size_t n, float *out);
+  void reset() { acc_ = 0; count_ = 0; }
+  uint16_t factor() const { return factor_; }
+
+private:
+  uint16_t factor_;
+  uint16_t count_ = 0;   // muestras ya sumadas del grupo en curso
+  uint32_t acc_ = 0;     // 65535 * 4095 entra en 32 bits
+};
+
+// FIR con decimación: sólo calcula la convolución en las salidas que quedan
+class FirDecimator {
+public:
+  // Copia los coeficientes (count <= FIR_MAX_TAPS)
+  FirDecimator(const float *taps, uint16_t count, uint16_t factor);
+
+  // Escribe en out a lo sumo n / factor + 1 salidas; devuelve cuántas
+  size_t process(const float *in, size_t n, float *out);
+  void reset() { pos_ = 0; phase_ = 0; primed_ = false; }
+  uint16_t factor() const { return factor_; }
+  uint16_t taps() const { return count_; }
+
+  // Pasabajos de ventana de Hamming con corte en `cutoff` (fracción de la
+  // frecuencia de entrada, 0..0,5) y ganancia 1 en continua
+  static void lowpass(float *taps, uint16_t count, float cutoff);
+
+private:
+  float taps_[FIR_MAX_TAPS];
+  // Cada muestra se escribe dos veces (pos y pos + count): la ventana de
+  // count muestras siempre es contigua y el producto no tiene módulo
+  float hist_[2 * FIR_MAX_TAPS];
+  uint16_t count_, factor_;
+  uint16_t pos_ = 0;     // donde va la próxima muestra (= la más vieja)
+  uint16_t phase_ = 0;   // entradas desde la última salida
+  bool primed_ = false;  // la historia arranca llena con la primera muestra
+};
+
+// Resumen de una ventana de muestras crudas
+struct AdcSummary {
+  uint32_t count;
+  uint16_t min, max;
+  float mean;
+  float rms;     // raíz de la media de los cuadrados (incluye la continua)
+  float acRms;   // RMS de la parte alterna (desvío estándar)
+};
+
+// Mín/máx/suma/suma de cuadrados de muestras de 12 bits. Los cuadrados se
+// acumulan de a 256 en 32 bits (256 * 4095^2 < 2^32) y recién después en 64.
+class WindowStats {
+public:
+  void push(const uint16_t *in, size_t n);
+  AdcSummary summary() const;
+  uint32_t count() const { return count_; }
+  void reset();
+
+private:
+  uint64_t sum_ = 0;
+  uint64_t sumSq_ = 0;
+  uint32_t count_ = 0;
+  uint16_t min_ = 0xFFFF;
+  uint16_t max_ = 0;
+};
+
+// Mín/máx/media de una señal ya filtrada (float)
+class RangeStats {
+public:
+  void push(const float *in, size_t n);
+  uint32_t count() const { return count_; }
+  float min() const { return min_; }
+  float max() const { return max_; }
+  float mean() const { return count_ ? (float)(sum_ / count_) : 0.0f; }
+  void reset();
+
+private:
+  double sum_ = 0;
+  uint32_t count_ = 0;
+  float min_ = 0, max_ = 0;
+};
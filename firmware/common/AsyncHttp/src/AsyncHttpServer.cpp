@@ -0,0 +1,580 @@
+#include "AsyncHttpServer.h"
+
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/select.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+static const char *reasonPhrase(int code) {
+  switch (code) {
+    case 200: return "OK";
+    case 204: return "No Content";
+    case 304: return "Not Modified";
+    case 400: return "Bad Request";
+    case 404: return "Not Found";
+    case 413: return "Payload Too Large";
+    case 431: return "Request Header Fields Too Large";
+    case 500: return "Internal Server Error";
+    case 503: return "Service Unavailable";
+    default:  return "";
+  }
+}
+
+static void setNonBlocking(int fd) {
+  fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+}
+
+// Espera a que el socket acepte datos; false si se vence el plazo
+static bool waitWritable(int fd, uint32_t ms) {
+  fd_set wr;
+  FD_ZERO(&wr);
+  FD_SET(fd, &wr);
+  timeval tv = {(time_t)(ms / 1000), (suseconds_t)((ms % 1000) * 1000)};
+  return select(fd + 1, nullptr, &wr, nullptr, &tv) > 0;
+}
+
+// Decodifica %XX y '+' en el lugar (el resultado nunca es más largo)
+static void urlDecodeInPlace(char *s) {
+  char *out = s;
+  for (char *p = s; *p; ++p) {
+    if (*p == '+') {
+      *out++ = ' ';
+    } else if (*p == '%' && isxdigit((unsigned char)p[1]) && isxdigit((unsigned char)p[2])) {
+      char hex[3] = {p[1], p[2], 0};
+      *out++ = (char)strtol(hex, nullptr, 16);
+      p += 2;
+    } else {
+      *out++ = *p;
+    }
+  }
+  *out = '\0';
+}
+
+// ======== Ciclo de vida ========
+void AsyncHttpServer::begin(uint16_t port) {
+  if (listenFd_ >= 0) close();
+  port_ = port;
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  if (fd < 0) return;
+  int one = 1;
+  setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+  sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_ANY);
+  addr.sin_port = htons(port);
+  if (bind(fd, (sockaddr *)&addr, sizeof(addr)) != 0 || listen(fd, ASYNC_HTTP_MAX_CONN * 2) != 0) {
+    Serial.printf("AsyncHttpServer: no se pudo escuchar en el puerto %u\n", (unsigned)port);
+    ::close(fd);
+    return;
+  }
+  setNonBlocking(fd);
+  listenFd_ = fd;
+}
+
+void AsyncHttpServer::close() {
+  for (Conn &c : conns_) if (c.state != CONN_FREE) closeConn(c);
+  if (listenFd_ >= 0) ::close(listenFd_);
+  listenFd_ = -1;
+}
+
+void AsyncHttpServer::on(const String &uri, HTTPMethod method, THandlerFunction fn) {
+  if (routeCount_ >= ASYNC_HTTP_MAX_ROUTES) return;
+  routes_[routeCount_++] = Route{uri, method, fn};
+}
+
+// Los punteros tienen que seguir vivos (normalmente un array static)
+void AsyncHttpServer::collectHeaders(const char *headerKeys[], const size_t headerKeysCount) {
+  collectCount_ = 0;
+  for (size_t i = 0; i < headerKeysCount && collectCount_ < ASYNC_HTTP_MAX_HEADERS; ++i) {
+    collect_[collectCount_++] = headerKeys[i];
+  }
+}
+
+bool AsyncHttpServer::collected(const char *name) const {
+  for (uint8_t i = 0; i < collectCount_; ++i) if (strcasecmp(collect_[i], name) == 0) return true;
+  return false;
+}
+
+// ======== Bucle principal ========
+// Un select() sin espera sobre el socket de escucha y todas las conexiones:
+// cuando no pasa nada cuesta una sola llamada al stack.
+void AsyncHttpServer::handleClient() {
+  if (listenFd_ < 0) return;
+  fd_set rd, wr;
+  FD_ZERO(&rd);
+  FD_ZERO(&wr);
+  int maxFd = listenFd_;
+  FD_SET(listenFd_, &rd);
+  for (Conn &c : conns_) {
+    if (c.state == CONN_READING) FD_SET(c.fd, &rd);
+    else if (c.state == CONN_SENDING) FD_SET(c.fd, &wr);
+    else continue;
+    if (c.fd > maxFd) maxFd = c.fd;
+  }
+  timeval tv = {0, 0};
+  int ready = select(maxFd + 1, &rd, &wr, nullptr, &tv);
+  if (ready <= 0 || !FD_ISSET(listenFd_, &rd)) waiting_ = false;
+
+  if (ready > 0) {
+    for (Conn &c : conns_) {
+      if (c.state == CONN_READING && FD_ISSET(c.fd, &rd)) readConn(c);
+      else if (c.state == CONN_SENDING && FD_ISSET(c.fd, &wr)) drain(c);
+    }
+    if (FD_ISSET(listenFd_, &rd)) acceptClients();
+  }
+
+  uint32_t now = millis();
+  for (Conn &c : conns_) {
+    if (c.state == CONN_FREE) continue;
+    // Peticiones que llegaron juntas (pipelining) y quedaron en el buffer
+    if (c.state == CONN_READING && c.reqLen == 0 && c.rxLen > 0) processRx(c);
+    uint32_t limit = c.state == CONN_READING ? ASYNC_HTTP_IDLE_MS : ASYNC_HTTP_WRITE_TIMEOUT_MS;
+    if (c.state != CONN_FREE && now - c.lastActive > limit) {
+      stats_.timeouts++;
+      closeConn(c);
+    }
+  }
+}
+
+AsyncHttpServer::Conn *AsyncHttpServer::freeSlot() {
+  for (Conn &c : conns_) if (c.state == CONN_FREE) return &c;
+  return nullptr;
+}
+
+void AsyncHttpServer::acceptClients() {
+  for (;;) {
+    Conn *slot = freeSlot();
+    Conn *victim = nullptr;
+    if (!slot) {
+      // Pool lleno: se hace lugar cerrando una keep-alive ociosa hace rato;
+      // si no hay, las que están activas cierran al terminar su respuesta
+      uint32_t now = millis();
+      for (Conn &c : conns_) {
+        if (c.state == CONN_READING && c.rxLen == 0 && c.requests > 0 &&
+            now - c.lastActive >= ASYNC_HTTP_EVICT_IDLE_MS &&
+            (!victim || (int32_t)(c.lastActive - victim->lastActive) < 0)) {
+          victim = &c;
+        }
+      }
+      if (!victim) {
+        waiting_ = true;
+        return;
+      }
+    }
+    int fd = accept(listenFd_, nullptr, nullptr);
+    if (fd < 0) {
+      waiting_ = false;
+      return;
+    }
+    if (victim) {
+      closeConn(*victim);
+      stats_.evicted++;
+      slot = victim;
+    }
+    setNonBlocking(fd);
+#ifdef TCP_NODELAY
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+#endif
+#ifdef HTTP_TCP_SNDBUF
+    // Sólo en PC: buffer de envío del tamaño del de lwIP (Linux lo duplica)
+    int sndbuf = HTTP_TCP_SNDBUF / 2;
+    setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &sndbuf, sizeof(sndbuf));
+#endif
+    slot->fd = fd;
+    slot->state = CONN_READING;
+    slot->keepAlive = false;
+    slot->failed = false;
+    slot->requests = 0;
+    slot->rxLen = slot->reqLen = 0;
+    slot->txStart = slot->txLen = 0;
+    slot->lastActive = millis();
+    stats_.accepted++;
+    if (++stats_.active > stats_.peakActive) stats_.peakActive = stats_.active;
+  }
+}
+
+void AsyncHttpServer::closeConn(Conn &c) {
+  if (c.state == CONN_FREE) return;
+  ::close(c.fd);
+  c.fd = -1;
+  c.state = CONN_FREE;
+  c.src = nullptr;
+  c.srcLeft = 0;
+  c.file = File();
+  stats_.active--;
+}
+
+// ======== Recepción ========
+void AsyncHttpServer::readConn(Conn &c) {
+  int n = recv(c.fd, c.rx + c.rxLen, sizeof(c.rx) - 1 - c.rxLen, 0);
+  if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK)) {
+    closeConn(c);
+    return;
+  }
+  if (n < 0) return;
+  c.rxLen += (uint16_t)n;
+  c.lastActive = millis();
+  processRx(c);
+}
+
+// Si ya llegó la petición completa (hasta la línea vacía) la atiende
+void AsyncHttpServer::processRx(Conn &c) {
+  c.rx[c.rxLen] = '\0';
+  char *end = strstr(c.rx, "\r\n\r\n");
+  if (!end) {
+    if (c.rxLen >= sizeof(c.rx) - 1) rejectRequest(c, 431);
+    return;
+  }
+  *end = '\0';
+  c.reqLen = (uint16_t)(end + 4 - c.rx);
+  int code = parseRequest(c, c.rx);
+  if (code) rejectRequest(c, code);
+  else dispatch(c);
+}
+
+// Parsea línea de pedido y cabeceras en el lugar; 0 o el código de error
+int AsyncHttpServer::parseRequest(Conn &c, char *head) {
+  req_.argCount = req_.headerCount = 0;
+
+  char *line = head;
+  char *next = strstr(line, "\r\n");
+  if (next) { *next = '\0'; next += 2; }
+
+  char *sp1 = strchr(line, ' ');
+  char *sp2 = sp1 ? strchr(sp1 + 1, ' ') : nullptr;
+  if (!sp2) return 400;
+  *sp1 = *sp2 = '\0';
+  static const struct { const char *name; HTTPMethod method; } methods[] = {
+    {"GET", HTTP_GET}, {"HEAD", HTTP_HEAD}, {"POST", HTTP_POST}, {"PUT", HTTP_PUT},
+    {"PATCH", HTTP_PATCH}, {"DELETE", HTTP_DELETE}, {"OPTIONS", HTTP_OPTIONS},
+  };
+  bool known = false;
+  for (const auto &m : methods) {
+    if (strcmp(line, m.name) == 0) { req_.method = m.method; known = true; }
+  }
+  if (!known) return 400;
+
+  // URI y query string ("a=1&b=2")
+  char *uri = sp1 + 1;
+  char *q = strchr(uri, '?');
+  if (q) {
+    *q++ = '\0';
+    while (*q && req_.argCount < ASYNC_HTTP_MAX_ARGS) {
+      char *amp = strchr(q, '&');
+      if (amp) *amp = '\0';
+      char *eq = strchr(q, '=');
+      if (eq) *eq = '\0';
+      urlDecodeInPlace(q);
+      req_.argKeys[req_.argCount] = q;
+      if (eq) urlDecodeInPlace(eq + 1);
+      req_.argValues[req_.argCount++] = eq ? eq + 1 : "";
+      if (!amp) break;
+      q = amp + 1;
+    }
+  }
+  urlDecodeInPlace(uri);
+  req_.uri = uri;
+
+  // HTTP/1.1 es keep-alive salvo "Connection: close"; HTTP/1.0 al revés
+  bool keepAlive = strcmp(sp2 + 1, "HTTP/1.1") == 0;
+
+  while (next && *next) {
+    line = next;
+    next = strstr(line, "\r\n");
+    if (next) { *next = '\0'; next += 2; }
+    char *colon = strchr(line, ':');
+    if (!colon) return 400;
+    *colon = '\0';
+    char *value = colon + 1;
+    while (*value == ' ' || *value == '\t') ++value;
+
+    if (strcasecmp(line, "Connection") == 0) {
+      if (strcasecmp(value, "close") == 0) keepAlive = false;
+      else if (strcasecmp(value, "keep-alive") == 0) keepAlive = true;
+    } else if (strcasecmp(line, "Content-Length") == 0 && atol(value) > 0) {
+      return 413;  // las rutas son todas GET: no se aceptan cuerpos
+    }
+    if (collected(line) && req_.headerCount < ASYNC_HTTP_MAX_HEADERS) {
+      req_.headerKeys[req_.headerCount] = line;
+      req_.headerValues[req_.headerCount++] = value;
+    }
+  }
+  // Con clientes esperando lugar no se ofrece keep-alive: la conexión se
+  // libera al terminar esta respuesta
+  c.keepAlive = keepAlive && !waiting_ && c.requests + 1 < ASYNC_HTTP_MAX_REQUESTS;
+  return 0;
+}
+
+String AsyncHttpServer::arg(const String &name) const {
+  for (uint8_t i = 0; i < req_.argCount; ++i) {
+    if (strcmp(req_.argKeys[i], name.c_str()) == 0) return String(req_.argValues[i]);
+  }
+  return String();
+}
+
+bool AsyncHttpServer::hasArg(const String &name) const {
+  for (uint8_t i = 0; i < req_.argCount; ++i) if (strcmp(req_.argKeys[i], name.c_str()) == 0) return true;
+  return false;
+}
+
+String AsyncHttpServer::header(const String &name) const {
+  for (uint8_t i = 0; i < req_.headerCount; ++i) {
+    if (strcasecmp(req_.headerKeys[i], name.c_str()) == 0) return String(req_.headerValues[i]);
+  }
+  return String();
+}
+
+bool AsyncHttpServer::hasHeader(const String &name) const {
+  for (uint8_t i = 0; i < req_.headerCount; ++i) if (strcasecmp(req_.headerKeys[i], name.c_str()) == 0) return true;
+  return false;
+}
+
+// ======== Atención ========
+void AsyncHttpServer::beginResponse(Conn &c) {
+  cur_ = &c;
+  c.state = CONN_SENDING;
+  contentLength_ = CONTENT_LENGTH_NOT_SET;
+  headersSent_ = chunked_ = chunkedEnded_ = false;
+  extraLen_ = 0;
+}
+
+void AsyncHttpServer::dispatch(Conn &c) {
+  beginResponse(c);
+  stats_.requests++;
+  if (c.requests++ > 0) stats_.reused++;
+
+  bool found = false;
+  for (uint8_t i = 0; i < routeCount_ && !found; ++i) {
+    const Route &r = routes_[i];
+    if (strcmp(r.uri.c_str(), req_.uri) == 0 && (r.method == HTTP_ANY || r.method == req_.method)) {
+      r.fn();
+      found = true;
+    }
+  }
+  if (!found) {
+    if (notFound_) notFound_();
+    else send(404, "text/plain", "Not found");
+  }
+  if (c.state == CONN_FREE) {  // el handler se llevó el socket
+    cur_ = nullptr;
+    return;
+  }
+  finishResponse(c);
+}
+
+void AsyncHttpServer::rejectRequest(Conn &c, int code) {
+  stats_.badRequests++;
+  beginResponse(c);
+  c.keepAlive = false;
+  send(code, "text/plain", reasonPhrase(code));
+  finishResponse(c);
+}
+
+void AsyncHttpServer::finishResponse(Conn &c) {
+  if (!headersSent_) send(500, "text/plain", "Sin respuesta");
+  else if (chunked_ && !chunkedEnded_) sendContent("", 0);
+  cur_ = nullptr;
+  drain(c);
+}
+
+int AsyncHttpServer::detachClient() {
+  if (!cur_ || headersSent_ || cur_->txLen > 0) return -1;
+  Conn &c = *cur_;
+  int fd = c.fd;
+  c.fd = -1;
+  c.state = CONN_FREE;
+  stats_.active--;
+  stats_.detached++;
+  cur_ = nullptr;
+  return fd;
+}
+
+// ======== Envío ========
+// Manda lo que entre del buffer sin bloquear; false si el socket falló
+bool AsyncHttpServer::flushTx(Conn &c) {
+  while (c.txLen > 0) {
+    int n = ::send(c.fd, c.tx + c.txStart, c.txLen, MSG_NOSIGNAL);
+    if (n > 0) {
+      c.txStart += (uint16_t)n;
+      c.txLen -= (uint16_t)n;
+    } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+      return true;
+    } else {
+      c.failed = true;
+      return false;
+    }
+  }
+  c.txStart = 0;
+  return true;
+}
+
+// Avanza la respuesta de una conexión: buffer, después el cuerpo pendiente
+// (flash o archivo). Al terminar vuelve a esperar peticiones o cierra.
+void AsyncHttpServer::drain(Conn &c) {
+  for (;;) {
+    if (c.failed || !flushTx(c)) {
+      closeConn(c);
+      return;
+    }
+    if (c.txLen > 0) return;  // el socket está lleno: sigue en otra vuelta
+    if (c.srcLeft > 0) {
+      // En el ESP32 la flash está mapeada: se manda directo, sin copiar
+      int n = ::send(c.fd, c.src, c.srcLeft, MSG_NOSIGNAL);
+      if (n > 0) {
+        c.src += n;
+        c.srcLeft -= (size_t)n;
+        c.lastActive = millis();
+        continue;
+      }
+      if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return;
+      closeConn(c);
+      return;
+    }
+    if (c.file) {
+      size_t n = c.file.read((uint8_t *)c.tx, sizeof(c.tx));
+      if (n > 0) {
+        c.txLen = (uint16_t)n;
+        continue;
+      }
+      c.file = File();
+    }
+    break;
+  }
+
+  c.lastActive = millis();
+  if (!c.keepAlive) {
+    closeConn(c);
+    return;
+  }
+  // Lista para la próxima: se descarta la petición atendida y lo que haya
+  // llegado detrás se procesa en handleClient()
+  c.state = CONN_READING;
+  c.rxLen -= c.reqLen;
+  memmove(c.rx, c.rx + c.reqLen, c.rxLen);
+  c.reqLen = 0;
+}
+
+// Escribe en el buffer de la conexión en curso; si se llena lo vacía al
+// socket y, si hace falta, espera a que lo acepte
+void AsyncHttpServer::write(const char *data, size_t len) {
+  if (!cur_) return;
+  Conn &c = *cur_;
+  while (len > 0 && !c.failed) {
+    if (c.txStart > 0 && c.txStart + c.txLen == sizeof(c.tx)) {
+      memmove(c.tx, c.tx + c.txStart, c.txLen);
+      c.txStart = 0;
+    }
+    size_t room = sizeof(c.tx) - c.txStart - c.txLen;
+    if (room == 0) {
+      if (!flushTx(c)) return;
+      if (c.txLen == sizeof(c.tx)) {
+        stats_.writeWaits++;
+        if (!waitWritable(c.fd, ASYNC_HTTP_WRITE_TIMEOUT_MS)) c.failed = true;
+      }
+      continue;
+    }
+    size_t n = len < room ? len : room;
+    memcpy(c.tx + c.txStart + c.txLen, data, n);
+    c.txLen += (uint16_t)n;
+    data += n;
+    len -= n;
+  }
+}
+
+void AsyncHttpServer::sendHeader(const String &name, const String &value, bool first) {
+  size_t n = name.length() + 2 + value.length() + 2;
+  if (extraLen_ + n > sizeof(extraHeaders_)) return;
+  char *dst = extraHeaders_ + extraLen_;
+  if (first) {
+    memmove(extraHeaders_ + n, extraHeaders_, extraLen_);
+    dst = extraHeaders_;
+  }
+  memcpy(dst, name.c_str(), name.length());
+  memcpy(dst + name.length(), ": ", 2);
+  memcpy(dst + name.length() + 2, value.c_str(), value.length());
+  memcpy(dst + n - 2, "\r\n", 2);
+  extraLen_ += n;
+}
+
+void AsyncHttpServer::sendHeaders(int code, const char *contentType, size_t contentLength) {
+  char line[96];
+  int n = snprintf(line, sizeof(line), "HTTP/1.1 %d %s\r\n", code, reasonPhrase(code));
+  write(line, (size_t)n);
+  if (contentType && *contentType) {
+    write("Content-Type: ", 14);
+    write(contentType, strlen(contentType));
+    write("\r\n", 2);
+  }
+  if (contentLength == CONTENT_LENGTH_UNKNOWN) {
+    write("Transfer-Encoding: chunked\r\n", 28);
+    chunked_ = true;
+  } else {
+    n = snprintf(line, sizeof(line), "Content-Length: %u\r\n", (unsigned)contentLength);
+    write(line, (size_t)n);
+  }
+  write(extraHeaders_, extraLen_);
+  extraLen_ = 0;
+  if (cur_ && cur_->keepAlive) write("Connection: keep-alive\r\n\r\n", 26);
+  else write("Connection: close\r\n\r\n", 21);
+  headersSent_ = true;
+  contentLength_ = CONTENT_LENGTH_NOT_SET;
+}
+
+void AsyncHttpServer::send(int code, const char *contentType, const String &content) {
+  send(code, contentType, content.c_str());
+}
+
+void AsyncHttpServer::send(int code, const char *contentType, const char *content) {
+  size_t len = content ? strlen(content) : 0;
+  sendHeaders(code, contentType, contentLength_ == CONTENT_LENGTH_NOT_SET ? len : contentLength_);
+  if (len) sendContent(content, len);
+}
+
+void AsyncHttpServer::sendContent(const char *content, size_t contentLength) {
+  if (chunked_) {
+    if (chunkedEnded_) return;
+    char frame[12];
+    int n = snprintf(frame, sizeof(frame), "%x\r\n", (unsigned)contentLength);
+    write(frame, (size_t)n);
+    if (contentLength == 0) {
+      write("\r\n", 2);  // bloque vacío: fin de la respuesta
+      chunkedEnded_ = true;
+      return;
+    }
+    write(content, contentLength);
+    write("\r\n", 2);
+    return;
+  }
+  write(content, contentLength);
+}
+
+// El cuerpo queda pendiente y lo manda drain() desde la flash
+void AsyncHttpServer::send_P(int code, PGM_P contentType, PGM_P content, size_t contentLength) {
+  sendHeaders(code, contentType, contentLength);
+  if (!cur_) return;
+  cur_->src = content;
+  cur_->srcLeft = contentLength;
+}
+
+// Se queda con una copia del handle: el archivo se lee a medida que el
+// socket acepta datos (el llamador no tiene que cerrarlo)
+size_t AsyncHttpServer::streamFile(File &file, const String &contentType, const int code) {
+  size_t size = file.size();
+  String name(file.name());
+  if (name.endsWith(".gz") && contentType != "application/x-gzip" && contentType != "application/octet-stream") {
+    sendHeader("Content-Encoding", "gzip");
+  }
+  sendHeaders(code, contentType.c_str(), size);
+  if (cur_) cur_->file = file;
+  return size;
+}
@@ -0,0 +1,184 @@
+// ======== Servidor HTTP no bloqueante ========
+// Misma API que el WebServer del core para los handlers (on, arg, header,
+// send, sendContent, send_P, streamFile...), pero sobre sockets no
+// bloqueantes: handleClient() atiende hasta ASYNC_HTTP_MAX_CONN conexiones a
+// la vez sin quedarse esperando a ninguna. Cada conexión tiene sus buffers
+// fijos de recepción y envío y soporta keep-alive (HTTP/1.1).
+//
+// Los cuerpos que no genera el handler (send_P desde flash y streamFile) se
+// mandan de a pedazos desde handleClient() a medida que el socket acepta
+// datos, así un cliente lento bajando app.js no frena a los demás. Lo que
+// escribe el handler (send/sendContent) va al buffer de la conexión; si no
+// entra se espera a que el socket lo tome (hasta ASYNC_HTTP_WRITE_TIMEOUT_MS).
+//
+// Con el pool lleno, una conexión nueva desaloja a la keep-alive ociosa más
+// vieja; si no hay ociosas queda en el backlog del stack TCP y las
+// respuestas en curso salen con "Connection: close" para hacerle lugar.
+#pragma once
+
+#include <Arduino.h>
+#include <FS.h>
+#include <WebServer.h>  // HTTPMethod y CONTENT_LENGTH_* del core
+#include <functional>
+
+#ifndef ASYNC_HTTP_MAX_CONN
+#define ASYNC_HTTP_MAX_CONN 6      // lwIP del ESP32 trae 10 sockets en total
+#endif
+#ifndef ASYNC_HTTP_RX_BUF
+#define ASYNC_HTTP_RX_BUF 768      // petición completa (línea + cabeceras)
+#endif
+#ifndef ASYNC_HTTP_TX_BUF
+#define ASYNC_HTTP_TX_BUF 1460     // un segmento TCP
+#endif
+#ifndef ASYNC_HTTP_IDLE_MS
+#define ASYNC_HTTP_IDLE_MS 5000    // keep-alive sin peticiones
+#endif
+#ifndef ASYNC_HTTP_EVICT_IDLE_MS
+#define ASYNC_HTTP_EVICT_IDLE_MS 1000  // ociosa que se puede desalojar con el pool lleno
+#endif
+#ifndef ASYNC_HTTP_WRITE_TIMEOUT_MS
+#define ASYNC_HTTP_WRITE_TIMEOUT_MS 5000
+#endif
+#ifndef ASYNC_HTTP_MAX_REQUESTS
+#define ASYNC_HTTP_MAX_REQUESTS 100  // peticiones por conexión keep-alive
+#endif
+#define ASYNC_HTTP_MAX_ROUTES 16
+#define ASYNC_HTTP_MAX_ARGS 8
+#define ASYNC_HTTP_MAX_HEADERS 8
+#define ASYNC_HTTP_EXTRA_HEADERS 320
+
+class AsyncHttpServer {
+public:
+  typedef std::function<void(void)> THandlerFunction;
+
+  struct Stats {
+    uint32_t accepted;
+    uint32_t requests;
+    uint32_t reused;       // peticiones servidas sobre una conexión keep-alive
+    uint32_t evicted;      // keep-alive ociosas cerradas para hacer lugar
+    uint32_t timeouts;     // cerradas por inactividad o envío trabado
+    uint32_t badRequests;  // petición inválida o más grande que el buffer
+    uint32_t writeWaits;   // el handler tuvo que esperar al socket
+    uint32_t detached;     // conexiones entregadas con detachClient()
+    uint8_t  active;
+    uint8_t  peakActive;
+  };
+
+  explicit AsyncHttpServer(int port = 80) : port_(port) {}
+  ~AsyncHttpServer() { close(); }
+
+  void begin() { begin((uint16_t)port_); }
+  void begin(uint16_t port);
+  void close();
+  void stop() { close(); }
+  void handleClient();
+
+  void on(const String &uri, THandlerFunction fn) { on(uri, HTTP_ANY, fn); }
+  void on(const String &uri, HTTPMethod method, THandlerFunction fn);
+  void onNotFound(THandlerFunction fn) { notFound_ = fn; }
+
+  // ======== Petición en curso (válido dentro del handler) ========
+  String uri() const { return String(req_.uri); }
+  HTTPMethod method() const { return req_.method; }
+  String arg(const String &name) const;
+  bool hasArg(const String &name) const;
+  int args() const { return req_.argCount; }
+  String header(const String &name) const;
+  bool hasHeader(const String &name) const;
+  void collectHeaders(const char *headerKeys[], const size_t headerKeysCount);
+
+  // ======== Respuesta ========
+  void setContentLength(const size_t contentLength) { contentLength_ = contentLength; }
+  void sendHeader(const String &name, const String &value, bool first = false);
+  void send(int code, const char *contentType = nullptr, const String &content = String(""));
+  void send(int code, const String &contentType, const String &content) { send(code, contentType.c_str(), content); }
+  void send(int code, const char *contentType, const char *content);
+  void send_P(int code, PGM_P contentType, PGM_P content, size_t contentLength);
+  void sendContent(const String &content) { sendContent(content.c_str(), content.length()); }
+  void sendContent(const char *content, size_t contentLength);
+  size_t streamFile(File &file, const String &contentType, const int code = 200);
+
+  // Dentro del handler, antes de responder: saca la conexión del pool y
+  // devuelve el socket (no bloqueante) a quien llama, que pasa a ser el
+  // dueño (p.ej. EventStream). -1 si ya no se puede.
+  int detachClient();
+
+  const Stats &stats() const { return stats_; }
+
+private:
+  enum ConnState : uint8_t { CONN_FREE, CONN_READING, CONN_SENDING };
+
+  struct Conn {
+    int fd = -1;
+    ConnState state = CONN_FREE;
+    bool keepAlive = false;
+    bool failed = false;       // error de escritura: se descarta el resto
+    uint16_t requests = 0;
+    uint32_t lastActive = 0;
+    uint16_t rxLen = 0;
+    uint16_t reqLen = 0;       // bytes de rx que ocupa la petición en curso
+    uint16_t txStart = 0;
+    uint16_t txLen = 0;
+    const char *src = nullptr; // cuerpo pendiente en flash (send_P)
+    size_t srcLeft = 0;
+    File file;                 // cuerpo pendiente en el FS (streamFile)
+    char rx[ASYNC_HTTP_RX_BUF];
+    char tx[ASYNC_HTTP_TX_BUF];
+  };
+
+  // Petición parseada en el lugar sobre Conn::rx (sin heap)
+  struct Request {
+    HTTPMethod method = HTTP_GET;
+    const char *uri = "";
+    uint8_t argCount = 0;
+    uint8_t headerCount = 0;
+    const char *argKeys[ASYNC_HTTP_MAX_ARGS];
+    const char *argValues[ASYNC_HTTP_MAX_ARGS];
+    const char *headerKeys[ASYNC_HTTP_MAX_HEADERS];
+    const char *headerValues[ASYNC_HTTP_MAX_HEADERS];
+  };
+
+  struct Route {
+    String uri;
+    HTTPMethod method;
+    THandlerFunction fn;
+  };
+
+  void acceptClients();
+  Conn *freeSlot();
+  void closeConn(Conn &c);
+  void readConn(Conn &c);
+  void processRx(Conn &c);
+  int parseRequest(Conn &c, char *head);
+  void beginResponse(Conn &c);
+  void dispatch(Conn &c);
+  void rejectRequest(Conn &c, int code);
+  void finishResponse(Conn &c);
+  void drain(Conn &c);
+  bool flushTx(Conn &c);
+  void write(const char *data, size_t len);
+  void sendHeaders(int code, const char *contentType, size_t contentLength);
+  bool collected(const char *name) const;
+
+  int port_;
+  int listenFd_ = -1;
+  Conn conns_[ASYNC_HTTP_MAX_CONN];
+  Conn *cur_ = nullptr;        // conexión cuyo handler está corriendo
+  Request req_;
+  Route routes_[ASYNC_HTTP_MAX_ROUTES];
+  uint8_t routeCount_ = 0;
+  THandlerFunction notFound_;
+  const char *collect_[ASYNC_HTTP_MAX_HEADERS];
+  uint8_t collectCount_ = 0;
+  bool waiting_ = false;       // hay conexiones en el backlog sin lugar en el pool
+
+  // Estado de la respuesta en curso
+  size_t contentLength_ = CONTENT_LENGTH_NOT_SET;
+  bool headersSent_ = false;
+  bool chunked_ = false;
+  bool chunkedEnded_ = false;
+  char extraHeaders_[ASYNC_HTTP_EXTRA_HEADERS];
+  size_t extraLen_ = 0;
+
+  Stats stats_ = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+};
@@ -0,0 +1,17 @@
+// ======== Servidor que usan los firmwares web ========
+// Por defecto el WebServer del core (atiende de a un cliente y cierra la
+// conexión); con -D WEB_ASYNC=1 el AsyncHttpServer no bloqueante. Los
+// handlers, JsonResponse y StaticAssets sólo usan la API común a los dos.
+#pragma once
+
+#ifndef WEB_ASYNC
+#define WEB_ASYNC 0
+#endif
+
+#if WEB_ASYNC
+#include "AsyncHttpServer.h"
+typedef AsyncHttpServer HttpServer;
+#else
+#include <WebServer.h>
+typedef WebServer HttpServer;
+#endif
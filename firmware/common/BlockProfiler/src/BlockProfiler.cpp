@@ -0,0 +1,147 @@
+#include "BlockProfiler.h"
+
+#include <stdarg.h>
+
+static const uint32_t kMagic = 0x424c4b50;  // "BLKP"
+static const uint16_t kVersion = 1;
+
+const uint32_t BlockProfiler::kBoundsMs[BLOCK_PROFILER_BUCKETS - 1] = {1, 4, 16, 64, 256, 1024, 4096};
+
+void BlockProfiler::clear() {
+  memset(&p_, 0, sizeof(p_));
+  p_.magic = kMagic;
+  p_.version = kVersion;
+  p_.sites = count_;
+  p_.cutSite = -1;
+}
+
+void BlockProfiler::begin(bool retained) {
+  if (!retained || p_.magic != kMagic || p_.version != kVersion || p_.sites != count_) {
+    clear();
+    p_.boots = 1;
+    return;
+  }
+  // La marca "en curso" de un sitio es la llamada que cortó el reinicio
+  p_.cutSite = -1;
+  p_.cutMs = 0;
+  for (uint8_t i = 0; i < count_; ++i) {
+    BlockSite &s = p_.site[i];
+    if (!s.activeMs) continue;
+    uint32_t startMs = s.activeMs - 1;
+    uint32_t ms = p_.beatMs > startMs ? p_.beatMs - startMs : 0;
+    if (p_.cutSite < 0 || ms > p_.cutMs) {
+      p_.cutSite = (int8_t)i;
+      p_.cutMs = ms;
+    }
+    BlockCall c = {ms < UINT32_MAX / 1000 ? ms * 1000 : UINT32_MAX, startMs, p_.boots, 1, 0};
+    record(s, c);
+    s.activeMs = 0;
+  }
+  p_.boots++;
+  p_.beatMs = 0;
+}
+
+uint32_t BlockProfiler::enter(uint8_t site) {
+  if (site < count_) p_.site[site].activeMs = millis() + 1;
+  return micros();
+}
+
+void BlockProfiler::leave(uint8_t site, uint32_t startUs) {
+  uint32_t us = micros() - startUs;
+  if (site >= count_) return;
+  BlockSite &s = p_.site[site];
+  BlockCall c = {us, s.activeMs - 1, p_.boots, 0, 0};
+  s.activeMs = 0;
+  record(s, c);
+}
+
+void BlockProfiler::record(BlockSite &s, const BlockCall &c) {
+  uint32_t ms = c.us / 1000;
+  uint8_t b = 0;
+  while (b < BLOCK_PROFILER_BUCKETS - 1 && ms >= kBoundsMs[b]) ++b;
+  s.buckets[b]++;
+  s.count++;
+  s.sumUs += c.us;
+  if (c.us > s.maxUs) s.maxUs = c.us;
+
+  // Inserción en la lista de peores (ordenada, de mayor a menor)
+  int i = BLOCK_PROFILER_WORST - 1;
+  if (c.us <= s.worst[i].us) return;
+  while (i > 0 && s.worst[i - 1].us < c.us) {
+    s.worst[i] = s.worst[i - 1];
+    --i;
+  }
+  s.worst[i] = c;
+}
+
+bool BlockProfiler::interrupted(uint8_t &site, uint32_t &ms) const {
+  if (p_.cutSite < 0) return false;
+  site = (uint8_t)p_.cutSite;
+  ms = p_.cutMs;
+  return true;
+}
+
+bool BlockProfiler::worst(uint8_t &site, BlockCall &call) const {
+  bool found = false;
+  for (uint8_t i = 0; i < count_; ++i) {
+    const BlockCall &c = p_.site[i].worst[0];
+    if (c.us && (!found || c.us > call.us)) {
+      site = i;
+      call = c;
+      found = true;
+    }
+  }
+  return found;
+}
+
+// Agrega con snprintf sin pasarse de cap (el texto se trunca)
+static void append(char *buf, size_t cap, size_t &len, const char *fmt, ...) {
+  if (len + 1 >= cap) return;
+  va_list ap;
+  va_start(ap, fmt);
+  int n = vsnprintf(buf + len, cap - len, fmt, ap);
+  va_end(ap);
+  if (n > 0) len += (size_t)n < cap - len ? (size_t)n : cap - len - 1;
+}
+
+size_t BlockProfiler::report(char *buf, size_t cap) const {
+  size_t len = 0;
+  if (cap) buf[0] = '\0';
+  append(buf, cap, len, "🧭 *Llamadas bloqueantes* (%u arranques)\n", (unsigned)p_.boots);
+  uint8_t site;
+  uint32_t cutMs;
+  if (interrupted(site, cutMs)) {
+    append(buf, cap, len, "💥 Reinicio anterior durante *%s* (≥ %lu ms)\n", name(site), (unsigned long)cutMs);
+  }
+  append(buf, cap, len, "_ms: <1 <4 <16 <64 <256 <1k <4k más_\n");
+  for (uint8_t i = 0; i < count_; ++i) {
+    const BlockSite &s = p_.site[i];
+    if (!s.count) continue;
+    append(buf, cap, len, "*%s*: %lu× prom %lu ms, máx %lu ms\n ", name(i), (unsigned long)s.count,
+           (unsigned long)(s.sumUs / s.count / 1000), (unsigned long)(s.maxUs / 1000));
+    for (uint8_t b = 0; b < BLOCK_PROFILER_BUCKETS; ++b) {
+      append(buf, cap, len, b ? "·%lu" : "%lu", (unsigned long)s.buckets[b]);
+    }
+    append(buf, cap, len, "\n");
+  }
+
+  // Las peores de todos los sitios, de mayor a menor
+  append(buf, cap, len, "🐢 *Peores:*");
+  uint32_t below = UINT32_MAX;
+  for (uint8_t k = 0; k < BLOCK_PROFILER_WORST; ++k) {
+    const BlockCall *best = nullptr;
+    uint8_t bestSite = 0;
+    for (uint8_t i = 0; i < count_; ++i) {
+      for (uint8_t j = 0; j < BLOCK_PROFILER_WORST; ++j) {
+        const BlockCall &c = p_.site[i].worst[j];
+        if (c.us && c.us < below && (!best || c.us > best->us)) { best = &c; bestSite = i; }
+      }
+    }
+    if (!best) break;
+    below = best->us;
+    append(buf, cap, len, "\n %s %lu ms (arranque %u%s)", name(bestSite), (unsigned long)(best->us / 1000),
+           (unsigned)best->boot, best->interrupted ? ", cortada" : "");
+  }
+  if (below == UINT32_MAX) append(buf, cap, len, " ninguna");
+  return len;
+}
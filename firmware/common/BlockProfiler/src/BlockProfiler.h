@@ -0,0 +1,105 @@
+// ======== Perfil de llamadas bloqueantes que sobrevive a los reinicios ========
+// Cada sitio (getUpdates, sendMessage, lectura del DHT22...) se mide entre
+// enter() y leave(): cantidad, histograma de duración, suma, máximo y sus
+// peores llamadas. Todo vive en un BlockProfile que el firmware ubica en
+// memoria RTC (RTC_NOINIT_ATTR): sobrevive al watchdog, a un pánico y a
+// ESP.restart(); sólo un encendido (o un brownout) lo borra.
+//
+// La llamada que deja al watchdog sin alimentar nunca llega a leave(). Por
+// eso enter() marca el sitio "en curso" con su hora de inicio y otra tarea
+// llama a beat() periódicamente. En el arranque siguiente begin() encuentra
+// la marca y la registra como llamada interrumpida de al menos
+// (último latido - inicio).
+//
+// Cada sitio lo usa una sola tarea a la vez: sus campos tienen un único
+// escritor y se leen desde otras tareas sin lock, como JitterStats.
+#pragma once
+
+#include <Arduino.h>
+
+#ifndef BLOCK_PROFILER_SITES
+#define BLOCK_PROFILER_SITES 8
+#endif
+#define BLOCK_PROFILER_WORST 3     // peores llamadas recordadas por sitio
+#define BLOCK_PROFILER_BUCKETS 8   // <1, <4, <16, <64, <256, <1024, <4096 ms y el resto
+
+struct BlockCall {
+  uint32_t us;          // duración (interrumpida: hasta el último latido)
+  uint32_t atMs;        // millis() al empezar, en ese arranque
+  uint16_t boot;        // número de arranque desde el último clear()
+  uint8_t interrupted;  // el reinicio la cortó
+  uint8_t pad;
+};
+
+struct BlockSite {
+  uint32_t count;
+  uint32_t buckets[BLOCK_PROFILER_BUCKETS];
+  uint64_t sumUs;
+  uint32_t maxUs;
+  uint32_t activeMs;    // millis() + 1 del enter() en curso; 0 = libre
+  BlockCall worst[BLOCK_PROFILER_WORST];  // de mayor a menor
+};
+
+// Sin constructores: el firmware lo declara RTC_NOINIT_ATTR
+struct BlockProfile {
+  uint32_t magic;
+  uint16_t version;
+  uint16_t boots;
+  uint32_t beatMs;      // último latido (millis() de este arranque)
+  int8_t cutSite;       // sitio en curso al reiniciar (-1: ninguno)
+  uint8_t sites;
+  uint16_t pad;
+  uint32_t cutMs;       // cuánto llevaba como mínimo
+  BlockSite site[BLOCK_PROFILER_SITES];
+};
+
+class BlockProfiler {
+public:
+  static const uint32_t kBoundsMs[BLOCK_PROFILER_BUCKETS - 1];
+
+  // names: un nombre por sitio (count <= BLOCK_PROFILER_SITES)
+  BlockProfiler(BlockProfile &rtc, const char *const *names, uint8_t count)
+      : p_(rtc), names_(names), count_(count < BLOCK_PROFILER_SITES ? count : BLOCK_PROFILER_SITES) {}
+
+  // retained: el reinicio conservó la RAM RTC (todo salvo encendido y
+  // brownout). Con datos válidos suma un arranque y cierra la llamada que
+  // haya quedado en curso; si no, empieza de cero.
+  void begin(bool retained);
+  void clear();
+
+  uint32_t enter(uint8_t site);              // devuelve micros() de inicio
+  void leave(uint8_t site, uint32_t startUs);
+  void beat(uint32_t nowMs) { p_.beatMs = nowMs; }
+
+  // Llamada que estaba en curso en el reinicio anterior
+  bool interrupted(uint8_t &site, uint32_t &ms) const;
+  // La peor llamada registrada (de cualquier sitio y arranque)
+  bool worst(uint8_t &site, BlockCall &call) const;
+
+  const char *name(uint8_t site) const { return site < count_ ? names_[site] : "?"; }
+  uint16_t boots() const { return p_.boots; }
+  const BlockSite &site(uint8_t i) const { return p_.site[i]; }
+  uint8_t count() const { return count_; }
+
+  // Resumen en texto (Markdown de Telegram); devuelve el largo escrito
+  size_t report(char *buf, size_t cap) const;
+
+  // Mide el bloque donde vive
+  class Scope {
+  public:
+    Scope(BlockProfiler &p, uint8_t site) : p_(p), site_(site), t0_(p.enter(site)) {}
+    ~Scope() { p_.leave(site_, t0_); }
+
+  private:
+    BlockProfiler &p_;
+    uint8_t site_;
+    uint32_t t0_;
+  };
+
+private:
+  void record(BlockSite &s, const BlockCall &c);
+
+  BlockProfile &p_;
+  const char *const *names_;
+  uint8_t count_;
+};
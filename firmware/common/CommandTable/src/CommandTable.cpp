@@ -0,0 +1,92 @@
+#include "CommandTable.h"
+
+#include <stdlib.h>
+#include <strings.h>
+
+// FNV-1a con semilla
+uint32_t CommandTable::hash(const char *s, size_t len, uint32_t seed) {
+  uint32_t h = 2166136261u ^ (seed * 0x9E3779B9u);
+  for (size_t i = 0; i < len; ++i) {
+    h ^= (uint8_t)s[i];
+    h *= 16777619u;
+  }
+  return h ^ (h >> 15);
+}
+
+bool CommandTable::begin() {
+  for (uint32_t seed = 1; seed < 100000; ++seed) {
+    memset(slot_, -1, sizeof(slot_));
+    bool ok = true;
+    for (uint8_t i = 0; i < n_ && ok; ++i) {
+      uint32_t h = hash(cmds_[i].name, strlen(cmds_[i].name), seed) & (COMMAND_TABLE_SLOTS - 1);
+      if (slot_[h] >= 0) ok = false;
+      else slot_[h] = (int8_t)i;
+    }
+    if (ok) {
+      seed_ = seed;
+      return true;
+    }
+  }
+  seed_ = 0;
+  memset(slot_, -1, sizeof(slot_));
+  return false;
+}
+
+const Command *CommandTable::find(const char *name, size_t len) const {
+  if (!seed_) return nullptr;
+  int i = slot_[hash(name, len, seed_) & (COMMAND_TABLE_SLOTS - 1)];
+  if (i < 0) return nullptr;
+  const char *cand = cmds_[i].name;
+  return strncmp(cand, name, len) == 0 && cand[len] == '\0' ? &cmds_[i] : nullptr;
+}
+
+bool CommandArgs::is(const char *word) const {
+  return ok && strlen(word) == len && strncasecmp(arg, word, len) == 0;
+}
+
+CommandTable::Result CommandTable::dispatch(const char *chatId, const char *text) const {
+  if (text[0] != '/') return NOT_COMMAND;
+  size_t nameLen = strcspn(text, " @\n");
+  const Command *cmd = find(text, nameLen);
+  if (!cmd) return UNKNOWN;
+
+  const char *p = text + nameLen;
+  if (*p == '@') p += strcspn(p, " \n");  // "/status@MiBot"
+  while (*p == ' ' || *p == '\n') ++p;
+
+  CommandArgs args = {p, 0, false, 0};
+  switch (cmd->arg) {
+    case ArgType::NONE:
+      break;
+    case ArgType::INT: {
+      char *end;
+      args.num = strtol(p, &end, 10);
+      args.len = (uint8_t)(end - p);
+      args.ok = end != p && (*end == '\0' || *end == ' ' || *end == '\n');
+      break;
+    }
+    case ArgType::WORD: {
+      size_t len = strcspn(p, " \n");
+      args.len = len > 255 ? 255 : (uint8_t)len;
+      args.ok = len > 0;
+      break;
+    }
+  }
+  cmd->handler(chatId, args);
+  return HANDLED;
+}
+
+size_t CommandTable::menu(char *out, size_t cap, const char *title) const {
+  if (cap == 0) return 0;
+  size_t n = 0;
+  int w = snprintf(out, cap, "%s", title);
+  n = w < 0 ? 0 : ((size_t)w < cap ? (size_t)w : cap - 1);
+  for (uint8_t i = 0; i < n_ && n + 1 < cap; ++i) {
+    const Command &c = cmds_[i];
+    if (!c.help) continue;
+    w = snprintf(out + n, cap - n, "%s%s %s%s%s - %s", n > 0 && out[n - 1] != '\n' ? "\n" : "", c.icon, c.name,
+                 c.usage[0] ? " " : "", c.usage, c.help);
+    n += w < 0 ? 0 : ((size_t)w < cap - n ? (size_t)w : cap - n - 1);
+  }
+  return n;
+}
@@ -0,0 +1,79 @@
+// ======== Tabla de comandos del bot ========
+// Cada comando es una fila constante (nombre, ícono, uso, ayuda, tipo de
+// argumento, handler); el sketch la declara como arreglo y de la misma tabla
+// salen el despacho y el texto de /menu.
+//
+// Búsqueda: hash perfecto sobre los nombres. begin() busca una semilla con
+// la que ningún par de comandos cae en el mismo slot (el env del ESP32
+// compila en gnu++11, sin loops constexpr, por eso se hace al arrancar: son
+// microsegundos) y después cada mensaje cuesta un hash + una comparación.
+//
+// Argumentos sin copias: el handler recibe punteros dentro del texto
+// original ("/setInterval 30" -> arg = "30", num = 30). Acepta también la
+// forma "/comando@NombreDelBot" que Telegram usa en grupos.
+#pragma once
+
+#include <Arduino.h>
+
+#ifndef COMMAND_TABLE_SLOTS
+#define COMMAND_TABLE_SLOTS 32   // potencia de 2, al menos el doble de comandos
+#endif
+
+enum class ArgType : uint8_t {
+  NONE,   // se ignora lo que venga después
+  INT,    // entero en base 10
+  WORD,   // una palabra (hasta el primer espacio)
+};
+
+struct CommandArgs {
+  const char *arg;   // inicio del argumento dentro del mensaje (no termina en '\0')
+  uint8_t len;
+  bool ok;           // había argumento y se pudo interpretar según ArgType
+  long num;          // ArgType::INT
+
+  // Compara el argumento sin distinguir mayúsculas
+  bool is(const char *word) const;
+};
+
+typedef void (*CommandHandler)(const char *chatId, const CommandArgs &args);
+
+struct Command {
+  const char *name;      // con la barra: "/status"
+  const char *icon;      // para /menu
+  const char *usage;     // "[seg]" o "" si no lleva argumento
+  const char *help;      // nullptr = no aparece en /menu
+  ArgType arg;
+  CommandHandler handler;
+};
+
+class CommandTable {
+public:
+  enum Result : uint8_t { HANDLED, NOT_COMMAND, UNKNOWN };
+
+  template <size_t N>
+  explicit CommandTable(const Command (&cmds)[N]) : cmds_(cmds), n_((uint8_t)N) {
+    static_assert(N * 2 <= COMMAND_TABLE_SLOTS, "agrandar COMMAND_TABLE_SLOTS");
+  }
+
+  // Arma el índice; false si no encontró semilla (nombres repetidos)
+  bool begin();
+
+  Result dispatch(const char *chatId, const char *text) const;
+
+  // name sin argumentos ni "@bot"; nullptr si no existe
+  const Command *find(const char *name, size_t len) const;
+
+  // Escribe title y una línea por comando con ayuda. Devuelve la longitud
+  // (cortada a cap - 1, siempre termina en '\0').
+  size_t menu(char *out, size_t cap, const char *title) const;
+
+  uint32_t seed() const { return seed_; }
+
+private:
+  static uint32_t hash(const char *s, size_t len, uint32_t seed);
+
+  const Command *cmds_;
+  uint8_t n_;
+  uint32_t seed_ = 0;
+  int8_t slot_[COMMAND_TABLE_SLOTS];
+};
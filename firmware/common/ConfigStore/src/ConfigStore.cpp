@@ -0,0 +1,75 @@
+#include "ConfigStore.h"
+
+static const char *const kKey = "cfg";
+
+bool ConfigStoreBase::begin() {
+  uint32_t t0 = micros();
+  Preferences prefs;
+  bool ok = false;
+  if (prefs.begin(ns_, true)) {
+    uint8_t buf[sizeof(Header) + CONFIG_MAX_SIZE];
+    size_t len = prefs.getBytesLength(kKey);
+    Header h;
+    if (len >= sizeof(Header) && len <= sizeof(buf) && prefs.getBytes(kKey, buf, sizeof(buf)) == len) {
+      memcpy(&h, buf, sizeof(h));
+      // Registro de una versión igual o anterior: se toma el prefijo común
+      if (h.version >= 1 && h.version <= version_ && h.size == len - sizeof(Header) && h.size <= size_) {
+        memcpy(value_, buf + sizeof(Header), h.size);
+        stats_.lifetime = h.writes;
+        stats_.loadedVersion = h.version;
+        ok = true;
+      }
+    }
+    prefs.end();
+  }
+  // Lo "guardado" es lo que se leyó; si el registro es de otra versión el
+  // próximo flush() lo reescribe entero aunque los valores no cambien
+  memcpy(saved_, value_, size_);
+  migrate_ = ok && stats_.loadedVersion != version_;
+  stats_.loadUs = micros() - t0;
+  return ok;
+}
+
+void ConfigStoreBase::touch(uint32_t nowMs) {
+  dirty_ = true;
+  dirtySince_ = nowMs;
+}
+
+uint32_t ConfigStoreBase::dueInMs(uint32_t nowMs) const {
+  if (!dirty_) return UINT32_MAX;
+  uint32_t elapsed = nowMs - dirtySince_;
+  return elapsed >= CONFIG_FLUSH_MS ? 0 : CONFIG_FLUSH_MS - elapsed;
+}
+
+bool ConfigStoreBase::tick(uint32_t nowMs) {
+  return dirty_ && dueInMs(nowMs) == 0 && flush();
+}
+
+bool ConfigStoreBase::flush() {
+  dirty_ = false;
+  if (!migrate_ && memcmp(value_, saved_, size_) == 0) {
+    stats_.skipped++;
+    return false;
+  }
+  uint8_t buf[sizeof(Header) + CONFIG_MAX_SIZE];
+  Header h = {version_, size_, stats_.lifetime + 1};
+  memcpy(buf, &h, sizeof(h));
+  memcpy(buf + sizeof(h), value_, size_);
+
+  uint32_t t0 = micros();
+  Preferences prefs;
+  bool ok = prefs.begin(ns_, false) && prefs.putBytes(kKey, buf, sizeof(h) + size_) == sizeof(h) + size_;
+  prefs.end();
+  stats_.lastWriteUs = micros() - t0;
+  if (stats_.lastWriteUs > stats_.maxWriteUs) stats_.maxWriteUs = stats_.lastWriteUs;
+  if (!ok) {
+    stats_.failed++;
+    dirty_ = true;  // se reintenta en el próximo tick()
+    return false;
+  }
+  stats_.writes++;
+  stats_.lifetime = h.writes;
+  memcpy(saved_, value_, size_);
+  migrate_ = false;
+  return true;
+}
@@ -0,0 +1,97 @@
+// ======== Configuración persistente en NVS ========
+// Un struct por firmware guardado como un solo blob en NVS (Preferences).
+// NVS ya reparte el desgaste y verifica cada entrada con CRC; acá se suma:
+//
+//  - Versión: el registro lleva versión y tamaño. Campos nuevos se agregan
+//    al final del struct y se sube la versión: un registro viejo (más corto)
+//    se carga en el prefijo y los campos nuevos quedan con su valor inicial.
+//  - Escritura diferida: touch() marca el cambio y tick() escribe recién
+//    cuando pasan CONFIG_FLUSH_MS sin cambios nuevos (varios comandos
+//    seguidos = una escritura). flush() escribe ya (antes de reiniciar).
+//  - Sin escrituras inútiles: sólo se escribe si los bytes difieren de lo
+//    último guardado (setear el mismo valor no gasta flash).
+//  - Contador: escrituras de este arranque y de toda la vida del equipo
+//    (va en el propio registro, no cuesta una escritura aparte).
+//
+// No es thread-safe: value()/touch()/tick() desde una sola tarea.
+#pragma once
+
+#include <Arduino.h>
+#include <Preferences.h>
+
+#ifndef CONFIG_FLUSH_MS
+#define CONFIG_FLUSH_MS 5000
+#endif
+
+// Tamaño máximo del struct (el registro se arma en la pila)
+#define CONFIG_MAX_SIZE 256
+
+class ConfigStoreBase {
+public:
+  struct Stats {
+    uint32_t writes;        // escrituras a NVS en este arranque
+    uint32_t lifetime;      // escrituras desde que se creó el registro
+    uint32_t skipped;       // flush sin cambios reales (no se escribió)
+    uint32_t failed;
+    uint32_t lastWriteUs;
+    uint32_t maxWriteUs;
+    uint32_t loadUs;
+    uint16_t loadedVersion; // 0 = no había registro
+  };
+
+  // Lee el registro; false si no había (o no sirve) y quedan los valores iniciales
+  bool begin();
+
+  // Hubo un cambio en value(): se escribe en CONFIG_FLUSH_MS si no hay otro
+  void touch(uint32_t nowMs);
+
+  // Llamar seguido; true si escribió
+  bool tick(uint32_t nowMs);
+
+  // Escribe ya si hay diferencias con lo guardado
+  bool flush();
+
+  // Cuánto falta para la escritura pendiente (UINT32_MAX si no hay)
+  uint32_t dueInMs(uint32_t nowMs) const;
+
+  bool dirty() const { return dirty_; }
+  const Stats &stats() const { return stats_; }
+
+protected:
+  ConfigStoreBase(const char *ns, void *value, void *saved, uint16_t size, uint16_t version)
+    : ns_(ns), value_((uint8_t *)value), saved_((uint8_t *)saved), size_(size), version_(version) {}
+
+private:
+  struct Header {
+    uint16_t version;
+    uint16_t size;
+    uint32_t writes;        // contador de vida, incluida esta escritura
+  };
+
+  const char *ns_;
+  uint8_t *value_;
+  uint8_t *saved_;
+  uint16_t size_;
+  uint16_t version_;
+  bool dirty_ = false;
+  bool migrate_ = false;
+  uint32_t dirtySince_ = 0;
+  Stats stats_ = {0, 0, 0, 0, 0, 0, 0, 0};
+};
+
+template <typename T, uint16_t Version>
+class ConfigStore : public ConfigStoreBase {
+public:
+  // defaults: valores iniciales si no hay registro (o para campos nuevos)
+  ConfigStore(const char *ns, const T &defaults)
+    : ConfigStoreBase(ns, &value_, &saved_, sizeof(T), Version), value_(defaults), saved_(defaults) {}
+
+  static_assert(sizeof(T) <= CONFIG_MAX_SIZE, "config demasiado grande para un registro");
+
+  T &value() { return value_; }
+  const T &value() const { return value_; }
+
+private:
+  T value_;
+  T saved_;
+};
@@ -0,0 +1,54 @@
+#include "Dht22Async.h"
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+void Dht22Async::begin() {
+  // Entrada y salida open-drain a la vez: con la salida en HIGH la línea
+  // queda libre y el pin sigue leyendo (e interrumpiendo) lo que haga el sensor
+  pinMode(pin_, OUTPUT_OPEN_DRAIN | PULLUP);
+  digitalWrite(pin_, HIGH);
+  attachInterruptArg(digitalPinToInterrupt(pin_), onEdge, this, CHANGE);
+}
+
+void IRAM_ATTR Dht22Async::onEdge(void *arg) {
+  Dht22Async *d = (Dht22Async *)arg;
+  uint8_t i = d->edges_;
+  if (!d->capturing_ || i >= DHT22_MAX_EDGES) return;
+  d->edgeUs_[i] = micros();
+  d->edgeLevel_[i] = (uint8_t)digitalRead(d->pin_);
+  d->edges_ = i + 1;
+}
+
+DhtFrame Dht22Async::read() {
+  stats_.frames++;
+
+  // Arranque: LOW al menos 1 ms (2 ticks de FreeRTOS = entre 1 y 2 ms)
+  capturing_ = false;
+  digitalWrite(pin_, LOW);
+  vTaskDelay(pdMS_TO_TICKS(2));
+  edges_ = 0;
+  capturing_ = true;
+  digitalWrite(pin_, HIGH);
+  vTaskDelay(pdMS_TO_TICKS(DHT22_CAPTURE_MS));
+  capturing_ = false;
+
+  // Flancos -> pulsos; lo que sigue al último flanco no tiene duración
+  uint8_t n = edges_;
+  if (n > stats_.maxEdges) stats_.maxEdges = n;
+  DhtPulse pulses[DHT22_MAX_EDGES];
+  size_t np = 0;
+  for (uint8_t i = 0; i + 1 < n; ++i) {
+    uint32_t us = edgeUs_[i + 1] - edgeUs_[i];
+    pulses[np++] = DhtPulse{(uint16_t)(us > 0xFFFF ? 0xFFFF : us), edgeLevel_[i]};
+  }
+
+  DhtFrame f = decodeDht22(pulses, np);
+  if (f.err == DhtError::OK) {
+    stats_.ok++;
+  } else {
+    stats_.errors[(uint8_t)f.err]++;
+    stats_.lastErr = f.err;
+  }
+  return f;
+}
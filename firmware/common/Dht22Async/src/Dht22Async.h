@@ -0,0 +1,55 @@
+// ======== DHT22 por interrupciones ========
+// La librería de Adafruit lee los 40 bits contando ciclos con las
+// interrupciones apagadas ~5 ms por lectura: en ese tiempo no corren ni la
+// pila WiFi ni los timers. Acá la línea genera una interrupción por flanco
+// que sólo anota micros() y el nivel; la tarea que lee duerme mientras
+// tanto y después decodifica la trama con decodeDht22().
+//
+// La línea queda en open-drain con pull-up: la placa la baja para el pulso
+// de arranque y la suelta, y el sensor contesta por el mismo pin.
+// read() bloquea sólo a la tarea que llama (~8 ms durmiendo): pensado
+// para la tarea de muestreo, no para loop() ni para un handler HTTP.
+#pragma once
+
+#include <Arduino.h>
+
+#include "Dht22Decoder.h"
+
+// Respuesta + 40 bits + fin = 84 flancos; margen para ruido en la línea
+#define DHT22_MAX_EDGES 100
+
+// Tiempo que se deja capturar después de soltar la línea (trama: ~5 ms)
+#ifndef DHT22_CAPTURE_MS
+#define DHT22_CAPTURE_MS 6
+#endif
+
+class Dht22Async {
+public:
+  struct Stats {
+    uint32_t frames;      // lecturas pedidas
+    uint32_t ok;
+    uint32_t errors[6];   // por DhtError (errors[0] queda en 0)
+    uint8_t maxEdges;     // flancos en la trama más larga (ruido si pasa de 84)
+    DhtError lastErr;     // último error (OK si nunca hubo)
+  };
+
+  explicit Dht22Async(uint8_t pin) : pin_(pin) {}
+
+  void begin();
+
+  // Pulso de arranque, captura y decodificación. Con el sensor recién
+  // alimentado o leído hace menos de 2 s devuelve lo que conteste (o error).
+  DhtFrame read();
+
+  const Stats &stats() const { return stats_; }
+
+private:
+  static void onEdge(void *arg);
+
+  uint8_t pin_;
+  volatile bool capturing_ = false;
+  volatile uint8_t edges_ = 0;
+  uint32_t edgeUs_[DHT22_MAX_EDGES];
+  uint8_t edgeLevel_[DHT22_MAX_EDGES];
+  Stats stats_ = {0, 0, {0, 0, 0, 0, 0, 0}, 0, DhtError::OK};
+};
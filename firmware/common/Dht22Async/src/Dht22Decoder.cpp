@@ -0,0 +1,95 @@
+#include "Dht22Decoder.h"
+
+#include <math.h>
+
+namespace {
+
+// Ventanas de tiempo (µs). Anchas a propósito: la latencia de la
+// interrupción con WiFi activo corre cada flanco unos µs.
+const uint16_t kRespMin = 40, kRespMax = 120;
+const uint16_t kLowMin = 30, kLowMax = 90;
+const uint16_t kHighMin = 10, kOneMin = 48, kHighMax = 110;
+
+// Recorre los pulsos fundiendo el ruido: un pulso corto y el que le sigue
+// se suman al anterior, y dos pulsos seguidos del mismo nivel son uno solo
+class PulseReader {
+public:
+  PulseReader(const DhtPulse *p, size_t n) : p_(p), n_(n) {}
+
+  bool next(DhtPulse &out) {
+    if (i_ >= n_) return false;
+    out = p_[i_++];
+    while (i_ < n_) {
+      const DhtPulse &q = p_[i_];
+      if (q.level == out.level) {
+        out.us += q.us;
+        i_++;
+      } else if (q.us < DHT22_GLITCH_US && i_ + 1 < n_ && p_[i_ + 1].level == out.level) {
+        out.us += q.us + p_[i_ + 1].us;
+        i_ += 2;
+      } else {
+        break;
+      }
+    }
+    return true;
+  }
+
+private:
+  const DhtPulse *p_;
+  size_t n_;
+  size_t i_ = 0;
+};
+
+DhtFrame fail(DhtFrame f, DhtError err) {
+  f.err = err;
+  f.t = f.h = NAN;
+  return f;
+}
+
+} // namespace
+
+DhtFrame decodeDht22(const DhtPulse *pulses, size_t n) {
+  DhtFrame f = {DhtError::OK, 0, {0, 0, 0, 0, 0}, NAN, NAN};
+  PulseReader rd(pulses, n);
+  DhtPulse a, b;
+
+  // Respuesta: puede venir precedida por el HIGH de cuando se soltó la línea
+  bool found = false;
+  if (!rd.next(a)) return fail(f, DhtError::NO_RESPONSE);
+  for (int skip = 0; skip < 3 && !found; ++skip) {
+    if (!rd.next(b)) return fail(f, DhtError::NO_RESPONSE);
+    found = a.level == 0 && a.us >= kRespMin && a.us <= kRespMax && b.us >= kRespMin && b.us <= kRespMax;
+    a = b;
+  }
+  if (!found) return fail(f, DhtError::NO_RESPONSE);
+
+  for (; f.bits < 40; ++f.bits) {
+    if (!rd.next(a) || !rd.next(b)) return fail(f, DhtError::TRUNCATED);
+    if (a.us < kLowMin || a.us > kLowMax || b.us < kHighMin || b.us > kHighMax) {
+      return fail(f, DhtError::BAD_PULSE);
+    }
+    f.raw[f.bits / 8] = (uint8_t)(f.raw[f.bits / 8] << 1 | (b.us >= kOneMin ? 1 : 0));
+  }
+
+  if ((uint8_t)(f.raw[0] + f.raw[1] + f.raw[2] + f.raw[3]) != f.raw[4]) return fail(f, DhtError::CHECKSUM);
+
+  float h = ((f.raw[0] << 8) | f.raw[1]) * 0.1f;
+  float t = (((f.raw[2] & 0x7F) << 8) | f.raw[3]) * 0.1f;
+  if (f.raw[2] & 0x80) t = -t;
+  if (h > 100.0f || t < -40.0f || t > 80.0f) return fail(f, DhtError::RANGE);
+  f.t = t;
+  f.h = h;
+  return f;
+}
+
+const char *dhtErrorName(DhtError err) {
+  switch (err) {
+    case DhtError::OK:          return "ok";
+    case DhtError::NO_RESPONSE: return "sin respuesta";
+    case DhtError::TRUNCATED:   return "trama cortada";
+    case DhtError::BAD_PULSE:   return "pulso inválido";
+    case DhtError::CHECKSUM:    return "checksum";
+    case DhtError::RANGE:       return "fuera de rango";
+  }
+  return "?";
+}
@@ -0,0 +1,44 @@
+// ======== Decodificador de tramas del DHT22 ========
+// Recibe la trama como pulsos (nivel + duración en µs), tal como la
+// capturan las interrupciones o un analizador lógico, y devuelve
+// temperatura y humedad o por qué la trama no sirve. No depende del
+// hardware: se prueba en PC con trazas grabadas (BotBench).
+//
+// Trama: respuesta (LOW ~80 µs, HIGH ~80 µs) y 40 bits, cada uno un LOW de
+// ~50 µs seguido de un HIGH de ~27 µs (0) o ~70 µs (1). Los bytes son
+// humedad (x10), temperatura (x10, bit 15 = signo) y checksum.
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Pulsos más cortos que esto son ruido en la línea y se funden con sus vecinos
+#ifndef DHT22_GLITCH_US
+#define DHT22_GLITCH_US 10
+#endif
+
+struct DhtPulse {
+  uint16_t us;
+  uint8_t level;  // 0 = LOW, 1 = HIGH
+};
+
+enum class DhtError : uint8_t {
+  OK,
+  NO_RESPONSE,  // no apareció el LOW/HIGH de respuesta
+  TRUNCATED,    // la trama se cortó antes de los 40 bits
+  BAD_PULSE,    // un pulso fuera de tiempo (flanco perdido, ruido)
+  CHECKSUM,
+  RANGE,        // checksum bien pero valores imposibles
+};
+
+struct DhtFrame {
+  DhtError err;
+  uint8_t bits;     // bits leídos (40 si la trama llegó entera)
+  uint8_t raw[5];
+  float t;          // °C (NAN si err != OK)
+  float h;          // %  (NAN si err != OK)
+};
+
+DhtFrame decodeDht22(const DhtPulse *pulses, size_t n);
+
+const char *dhtErrorName(DhtError err);
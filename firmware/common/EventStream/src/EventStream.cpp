@@ -0,0 +1,153 @@
+#include "EventStream.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/socket.h>
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+static const char kHead[] =
+  "HTTP/1.1 200 OK\r\n"
+  "Content-Type: text/event-stream\r\n"
+  "Cache-Control: no-cache\r\n"
+  "Connection: keep-alive\r\n"
+  "\r\n"
+  "retry: 3000\n\n";
+
+static int formatEvent(char *out, size_t cap, const char *event, const char *data, size_t len) {
+  int n = snprintf(out, cap, "event: %s\ndata: ", event);
+  if (n < 0 || (size_t)n + len + 2 > cap) return -1;
+  memcpy(out + n, data, len);
+  memcpy(out + n + len, "\n\n", 2);
+  return n + (int)len + 2;
+}
+
+bool EventStream::subscribe(HttpServer &server, const char *firstEvent, const char *firstData) {
+  Sub *s = nullptr;
+  for (Sub &sub : subs_) {
+    if (sub.fd < 0) { s = &sub; break; }
+  }
+  if (!s) {
+    stats_.rejected++;
+    return false;
+  }
+#if WEB_ASYNC
+  int fd = server.detachClient();
+#else
+  WiFiClient client = server.client();
+  int fd = client.fd();
+#endif
+  if (fd < 0) return false;
+  fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+  // Socket recién abierto: la cabecera entra entera en el buffer de envío
+  if (send(fd, kHead, sizeof(kHead) - 1, MSG_NOSIGNAL) != (int)(sizeof(kHead) - 1)) {
+#if WEB_ASYNC
+    ::close(fd);
+#endif
+    return false;
+  }
+  s->fd = fd;
+#if !WEB_ASYNC
+  s->client = client;
+#endif
+  s->len = s->sent = 0;
+  s->lastProgress = millis();
+  count_++;
+  stats_.subscribed++;
+
+  if (firstEvent && firstData) {
+    int n = formatEvent(s->buf, sizeof(s->buf), firstEvent, firstData, strlen(firstData));
+    if (n > 0) {
+      s->len = (uint16_t)n;
+      if (!flush(*s, millis())) drop(*s);
+    }
+  }
+  return true;
+}
+
+void EventStream::publish(const char *event, const char *data, size_t len) {
+  lastEventMs_ = millis();
+  if (!count_) return;
+  char frame[EVENT_STREAM_FRAME];
+  int n = formatEvent(frame, sizeof(frame), event, data, len);
+  if (n < 0) return;
+  stats_.events++;
+  for (Sub &s : subs_) {
+    if (s.fd < 0) continue;
+    queue(s, frame, (size_t)n);
+    if (!flush(s, lastEventMs_)) drop(s);
+  }
+}
+
+void EventStream::tick(uint32_t nowMs) {
+  if (!count_) return;
+  bool ping = nowMs - lastEventMs_ >= EVENT_STREAM_PING_MS;
+  bool check = nowMs - lastCheckMs_ >= 1000;
+  if (ping) lastEventMs_ = nowMs;
+  if (check) lastCheckMs_ = nowMs;
+
+  for (Sub &s : subs_) {
+    if (s.fd < 0) continue;
+    if (check) {
+      // El navegador no manda nada por este socket: 0 es que cerró
+      char tmp[32];
+      int r = recv(s.fd, tmp, sizeof(tmp), MSG_DONTWAIT);
+      if (r == 0 || (r < 0 && errno != EAGAIN && errno != EWOULDBLOCK)) {
+        drop(s);
+        continue;
+      }
+    }
+    if (ping && s.len == 0) queue(s, ": ping\n\n", 8);
+    if (s.len == 0) continue;
+    if (!flush(s, nowMs) || (s.len > 0 && nowMs - s.lastProgress > EVENT_STREAM_STALL_MS)) drop(s);
+  }
+}
+
+void EventStream::queue(Sub &s, const char *frame, size_t len) {
+  if (s.len > 0) {
+    if (s.sent > 0) {
+      stats_.skipped++;
+      return;
+    }
+    stats_.coalesced++;
+  } else {
+    s.lastProgress = millis();
+  }
+  memcpy(s.buf, frame, len);
+  s.len = (uint16_t)len;
+  s.sent = 0;
+}
+
+// Manda lo que el socket acepte; false si se cortó
+bool EventStream::flush(Sub &s, uint32_t nowMs) {
+  while (s.sent < s.len) {
+    int n = send(s.fd, s.buf + s.sent, s.len - s.sent, MSG_NOSIGNAL | MSG_DONTWAIT);
+    if (n > 0) {
+      s.sent += (uint16_t)n;
+      s.lastProgress = nowMs;
+      stats_.bytes += (uint32_t)n;
+    } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+      return true;
+    } else {
+      return false;
+    }
+  }
+  if (s.len > 0) stats_.sent++;
+  s.len = s.sent = 0;
+  return true;
+}
+
+void EventStream::drop(Sub &s) {
+#if WEB_ASYNC
+  ::close(s.fd);
+#else
+  s.client = WiFiClient();  // el core cierra al soltar la última copia
+#endif
+  s.fd = -1;
+  s.len = s.sent = 0;
+  count_--;
+  stats_.dropped++;
+}
@@ -0,0 +1,87 @@
+// ======== Server-Sent Events (/api/stream) ========
+// Cada evento se arma una sola vez y se manda a todos los suscriptores, así
+// el costo por lectura no depende de cuántos dashboards estén abiertos.
+//
+// Los sockets son no bloqueantes y cada suscriptor tiene un buffer fijo de
+// un evento. Backpressure: si un cliente todavía no tomó nada del evento
+// anterior, el nuevo lo reemplaza (una lectura vieja no sirve); si lo tomó a
+// medias, se termina ése y el nuevo se saltea. Un cliente que no avanza en
+// EVENT_STREAM_STALL_MS se desconecta. Nunca se bloquea el loop().
+//
+// Con el WebServer del core el socket se toma con server.client(); con
+// AsyncHttpServer con detachClient(), fuera del pool de conexiones.
+#pragma once
+
+#include <Arduino.h>
+#include <HttpServer.h>
+#if !WEB_ASYNC
+#include <WiFiClient.h>
+#endif
+
+#ifndef EVENT_STREAM_MAX_SUBS
+#define EVENT_STREAM_MAX_SUBS 3
+#endif
+#ifndef EVENT_STREAM_FRAME
+#define EVENT_STREAM_FRAME 192    // "event: ...\ndata: {...}\n\n" más largo
+#endif
+#ifndef EVENT_STREAM_PING_MS
+#define EVENT_STREAM_PING_MS 15000  // comentario ": ping" si no hubo eventos
+#endif
+#ifndef EVENT_STREAM_STALL_MS
+#define EVENT_STREAM_STALL_MS 20000
+#endif
+
+// Pool + suscriptores + socket de escucha tienen que entrar en los sockets de lwIP
+#if WEB_ASYNC && defined(CONFIG_LWIP_MAX_SOCKETS)
+static_assert(ASYNC_HTTP_MAX_CONN + EVENT_STREAM_MAX_SUBS + 1 <= CONFIG_LWIP_MAX_SOCKETS,
+              "ASYNC_HTTP_MAX_CONN + EVENT_STREAM_MAX_SUBS no entra en CONFIG_LWIP_MAX_SOCKETS");
+#endif
+
+class EventStream {
+public:
+  struct Stats {
+    uint32_t subscribed;
+    uint32_t rejected;    // lista llena
+    uint32_t events;      // publish()
+    uint32_t sent;        // eventos completos entregados (sumando suscriptores)
+    uint32_t coalesced;   // reemplazados por uno más nuevo antes de salir
+    uint32_t skipped;     // salteados porque el anterior iba a medias
+    uint32_t dropped;     // suscriptores cortados (error o trabados)
+    uint32_t bytes;       // bytes de eventos enviados
+  };
+
+  // Desde el handler de /api/stream. false si no hay lugar (el llamador
+  // contesta 503 y el navegador sigue con polling).
+  bool subscribe(HttpServer &server, const char *firstEvent = nullptr, const char *firstData = nullptr);
+
+  // data no puede tener '\n' (JSON de JsonWriter)
+  void publish(const char *event, const char *data, size_t len);
+
+  // Llamar en cada loop(): avanza envíos pendientes, pings y cortes
+  void tick(uint32_t nowMs);
+
+  uint8_t count() const { return count_; }
+  const Stats &stats() const { return stats_; }
+
+private:
+  struct Sub {
+    int fd = -1;
+#if !WEB_ASYNC
+    WiFiClient client;       // la copia mantiene abierto el socket del core
+#endif
+    uint16_t len = 0;        // bytes del evento pendiente
+    uint16_t sent = 0;       // cuántos ya salieron
+    uint32_t lastProgress = 0;
+    char buf[EVENT_STREAM_FRAME];
+  };
+
+  void queue(Sub &s, const char *frame, size_t len);
+  bool flush(Sub &s, uint32_t nowMs);
+  void drop(Sub &s);
+
+  Sub subs_[EVENT_STREAM_MAX_SUBS];
+  uint8_t count_ = 0;
+  uint32_t lastEventMs_ = 0;
+  uint32_t lastCheckMs_ = 0;
+  Stats stats_ = {0, 0, 0, 0, 0, 0, 0, 0};
+};
@@ -0,0 +1,114 @@
+#include "HistoryCache.h"
+
+static_assert(HISTORY_CACHE_BYTES <= 65535, "offsets de 16 bits");
+static_assert(HISTORY_CACHE_MAX_ENTRY <= HISTORY_CACHE_BYTES, "una entrada tiene que entrar en el arena");
+
+int HistoryCache::find(const char *key) const {
+  for (int i = 0; i < count_; ++i) {
+    if (strncmp(entries_[i].key, key, HISTORY_CACHE_KEY_LEN) == 0) return i;
+  }
+  return -1;
+}
+
+const char *HistoryCache::get(const char *key, size_t &len) {
+  int i = find(key);
+  if (i < 0) { stats_.misses++; return nullptr; }
+  stats_.hits++;
+  entries_[i].lastUse = ++tick_;
+  len = entries_[i].len;
+  return arena_ + entries_[i].offset;
+}
+
+// Quita la entrada y compacta el arena para que el espacio libre quede al final
+void HistoryCache::removeAt(int idx) {
+  Entry gone = entries_[idx];
+  size_t tail = used_ + pending_ - (gone.offset + gone.len);   // con la inserción en curso
+  memmove(arena_ + gone.offset, arena_ + gone.offset + gone.len, tail);
+  used_ -= gone.len;
+  for (int i = idx; i < count_ - 1; ++i) entries_[i] = entries_[i + 1];
+  count_--;
+  for (int i = 0; i < count_; ++i) {
+    if (entries_[i].offset > gone.offset) entries_[i].offset -= gone.len;
+  }
+}
+
+void HistoryCache::evictLru() {
+  int lru = 0;
+  for (int i = 1; i < count_; ++i) {
+    if (entries_[i].lastUse < entries_[lru].lastUse) lru = i;
+  }
+  removeAt(lru);
+  stats_.evictions++;
+}
+
+bool HistoryCache::put(const char *key, const char *data, size_t len) {
+  beginPut(key);
+  append(data, len);
+  return commitPut();
+}
+
+void HistoryCache::beginPut(const char *key) {
+  pending_ = 0;
+  streaming_ = strlen(key) < HISTORY_CACHE_KEY_LEN;
+  if (!streaming_) {
+    stats_.rejected++;
+    return;
+  }
+  memcpy(pendingKey_, key, strlen(key) + 1);
+  int old = find(key);
+  if (old >= 0) removeAt(old);
+}
+
+// Se desaloja a medida que hace falta lugar; removeAt corre también los
+// bytes de la inserción en curso
+void HistoryCache::append(const char *data, size_t len) {
+  if (!streaming_) return;
+  if (pending_ + len > HISTORY_CACHE_MAX_ENTRY) {
+    streaming_ = false;
+    pending_ = 0;
+    stats_.rejected++;
+    return;
+  }
+  while (count_ > 0 && used_ + pending_ + len > sizeof(arena_)) evictLru();
+  memcpy(arena_ + used_ + pending_, data, len);
+  pending_ += len;
+}
+
+bool HistoryCache::commitPut() {
+  if (!streaming_) return false;
+  streaming_ = false;
+  if (count_ == HISTORY_CACHE_ENTRIES) evictLru();
+  Entry &e = entries_[count_++];
+  memcpy(e.key, pendingKey_, sizeof(e.key));
+  e.offset = (uint16_t)used_;
+  e.len = (uint16_t)pending_;
+  e.lastUse = ++tick_;
+  used_ += pending_;
+  pending_ = 0;
+  stats_.inserts++;
+  return true;
+}
+
+void HistoryCache::invalidate(const char *key) {
+  int i = find(key);
+  if (i < 0) return;
+  removeAt(i);
+  stats_.invalidations++;
+}
+
+void HistoryCache::invalidatePrefix(const char *prefix) {
+  size_t n = strlen(prefix);
+  for (int i = count_ - 1; i >= 0; --i) {
+    if (strncmp(entries_[i].key, prefix, n) == 0) {
+      removeAt(i);
+      stats_.invalidations++;
+    }
+  }
+}
+
+void HistoryCache::clear() {
+  count_ = 0;
+  used_ = 0;
+  pending_ = 0;
+  streaming_ = false;
+}
@@ -0,0 +1,78 @@
+// ======== Cache LRU de respuestas de /api/history ========
+// Guarda el JSON ya serializado por fecha ("YYYY-MM-DD") en un arena estático
+// de HISTORY_CACHE_BYTES. Al llenarse desaloja la entrada usada hace más
+// tiempo. Sin heap: todo vive en arrays de tamaño fijo.
+//
+// Una respuesta se puede guardar de una vez (put) o copiarla a medida que
+// sale al cliente (beginPut, append por tramos, commitPut): así entra
+// cualquier respuesta que quepa en el arena, no sólo las que entraron en
+// el buffer de JsonResponse.
+#pragma once
+
+#include <Arduino.h>
+
+#ifndef HISTORY_CACHE_BYTES
+#define HISTORY_CACHE_BYTES 16384  // presupuesto total de bytes de respuestas
+#endif
+#ifndef HISTORY_CACHE_MAX_ENTRY
+// Más grande no se guarda. Como el largo se conoce recién al final, una
+// respuesta que se pasa pudo haber desalojado hasta este tanto.
+#define HISTORY_CACHE_MAX_ENTRY (HISTORY_CACHE_BYTES / 2)
+#endif
+#ifndef HISTORY_CACHE_ENTRIES
+#define HISTORY_CACHE_ENTRIES 8
+#endif
+#define HISTORY_CACHE_KEY_LEN 24
+
+class HistoryCache {
+public:
+  struct Stats {
+    uint32_t hits;
+    uint32_t misses;
+    uint32_t inserts;
+    uint32_t evictions;
+    uint32_t rejected;       // respuestas más grandes que el presupuesto
+    uint32_t invalidations;
+  };
+
+  // Devuelve el cuerpo cacheado (válido hasta el próximo put) o nullptr
+  const char *get(const char *key, size_t &len);
+  bool put(const char *key, const char *data, size_t len);
+  // Inserción en streaming: si la respuesta pasa de HISTORY_CACHE_MAX_ENTRY
+  // se descarta sola (rejected) y commitPut devuelve false
+  void beginPut(const char *key);
+  void append(const char *data, size_t len);
+  bool commitPut();
+  // Con la firma de JsonWriter::SinkFn, para JsonResponse::tee
+  static void sink(void *ctx, const char *data, size_t len) { ((HistoryCache *)ctx)->append(data, len); }
+  void invalidate(const char *key);
+  void invalidatePrefix(const char *prefix);  // p.ej. todas las resoluciones de una fecha
+  void clear();
+
+  const Stats &stats() const { return stats_; }
+  size_t bytesUsed() const { return used_; }
+  size_t capacity() const { return sizeof(arena_); }
+  uint8_t count() const { return count_; }
+
+private:
+  struct Entry {
+    char key[HISTORY_CACHE_KEY_LEN];
+    uint16_t offset;
+    uint16_t len;
+    uint32_t lastUse;
+  };
+
+  int find(const char *key) const;
+  void removeAt(int idx);
+  void evictLru();
+
+  char arena_[HISTORY_CACHE_BYTES];
+  Entry entries_[HISTORY_CACHE_ENTRIES];
+  uint8_t count_ = 0;
+  size_t used_ = 0;      // las entradas ocupan [0, used_) del arena, compactadas
+  size_t pending_ = 0;   // la inserción en curso sigue en [used_, used_ + pending_)
+  bool streaming_ = false;
+  char pendingKey_[HISTORY_CACHE_KEY_LEN];
+  uint32_t tick_ = 0;
+  Stats stats_ = {0, 0, 0, 0, 0, 0};
+};
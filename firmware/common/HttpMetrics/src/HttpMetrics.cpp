@@ -0,0 +1,100 @@
+#include "HttpMetrics.h"
+
+#include <WiFi.h>
+
+const uint32_t LatencyHistogram::kBoundsUs[HTTP_METRICS_BUCKETS] = {
+  100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000, 100000, 250000, 500000, 1000000,
+};
+
+void LatencyHistogram::add(uint32_t us) {
+  uint8_t i = 0;
+  while (i < HTTP_METRICS_BUCKETS && us > kBoundsUs[i]) ++i;
+  buckets_[i]++;
+  count_++;
+  sumUs_ += us;
+}
+
+void LatencyHistogram::write(JsonWriter &w, const char *name, const char *labels) const {
+  char line[128];
+  const char *sep = labels[0] ? "," : "";
+  uint32_t acc = 0;
+  for (uint8_t i = 0; i <= HTTP_METRICS_BUCKETS; ++i) {
+    acc += buckets_[i];
+    int n;
+    if (i < HTTP_METRICS_BUCKETS) {
+      n = snprintf(line, sizeof(line), "%s_bucket{%s%sle=\"%g\"} %u\n", name, labels, sep, kBoundsUs[i] / 1e6,
+                   (unsigned)acc);
+    } else {
+      n = snprintf(line, sizeof(line), "%s_bucket{%s%sle=\"+Inf\"} %u\n", name, labels, sep, (unsigned)acc);
+    }
+    if (n > 0) w.raw(line, (size_t)n < sizeof(line) ? (size_t)n : sizeof(line) - 1);
+  }
+  const char *open = labels[0] ? "{" : "";
+  const char *close = labels[0] ? "}" : "";
+  int n = snprintf(line, sizeof(line), "%s_sum%s%s%s %.6f\n%s_count%s%s%s %u\n", name, open, labels, close,
+                   sumUs_ / 1e6, name, open, labels, close, (unsigned)count_);
+  if (n > 0) w.raw(line, (size_t)n < sizeof(line) ? (size_t)n : sizeof(line) - 1);
+}
+
+HttpServer::THandlerFunction HttpMetrics::timed(const char *name, HttpServer::THandlerFunction fn) {
+  if (count_ >= HTTP_METRICS_ROUTES) return fn;  // sin lugar: la ruta anda, sin medir
+  Route *r = &routes_[count_++];
+  r->name = name;
+  r->bytes = 0;
+  ByteCounter bytes = bytesSent_;
+  return [r, bytes, fn]() {
+    uint32_t b0 = bytes();
+    uint32_t t0 = micros();
+    fn();
+    r->latency.add(micros() - t0);
+    r->bytes += bytes() - b0;
+  };
+}
+
+void HttpMetrics::loopTick() {
+  uint32_t now = micros();
+  if (lastLoopUs_) {
+    uint32_t us = now - lastLoopUs_;
+    loop_.add(us);
+    if (us > loopMaxUs_) loopMaxUs_ = us;
+  }
+  lastLoopUs_ = now;
+}
+
+void HttpMetrics::type(JsonWriter &w, const char *name, const char *kind) {
+  char line[96];
+  int n = snprintf(line, sizeof(line), "# TYPE %s %s\n", name, kind);
+  if (n > 0) w.raw(line, (size_t)n < sizeof(line) ? (size_t)n : sizeof(line) - 1);
+}
+
+void HttpMetrics::sample(JsonWriter &w, const char *name, const char *labels, double value) {
+  char line[128];
+  int n = labels[0] ? snprintf(line, sizeof(line), "%s{%s} %.10g\n", name, labels, value)
+                    : snprintf(line, sizeof(line), "%s %.10g\n", name, value);
+  if (n > 0) w.raw(line, (size_t)n < sizeof(line) ? (size_t)n : sizeof(line) - 1);
+}
+
+void HttpMetrics::write(JsonWriter &w) {
+  char labels[48];
+  type(w, "http_request_duration_seconds", "histogram");
+  for (uint8_t i = 0; i < count_; ++i) {
+    snprintf(labels, sizeof(labels), "route=\"%s\"", routes_[i].name);
+    routes_[i].latency.write(w, "http_request_duration_seconds", labels);
+  }
+  type(w, "http_response_bytes_total", "counter");
+  for (uint8_t i = 0; i < count_; ++i) {
+    snprintf(labels, sizeof(labels), "route=\"%s\"", routes_[i].name);
+    sample(w, "http_response_bytes_total", labels, routes_[i].bytes);
+  }
+
+  type(w, "loop_duration_seconds", "histogram");
+  loop_.write(w, "loop_duration_seconds", "");
+  gauge(w, "loop_duration_max_seconds", loopMaxUs_ / 1e6);
+  loopMaxUs_ = 0;
+
+  gauge(w, "esp_heap_free_bytes", ESP.getFreeHeap());
+  gauge(w, "esp_heap_min_free_bytes", ESP.getMinFreeHeap());
+  gauge(w, "esp_heap_largest_free_block_bytes", ESP.getMaxAllocHeap());
+  gauge(w, "wifi_rssi_dbm", WiFi.RSSI());
+  gauge(w, "uptime_seconds", millis() / 1000.0);
+}
@@ -0,0 +1,78 @@
+// ======== Métricas en formato Prometheus ========
+// Cada ruta se registra envuelta con timed(): el envoltorio toma micros()
+// antes y después del handler y suma la latencia a un histograma de
+// buckets fijos (memoria fija, sin heap por petición) y los bytes de
+// cuerpo que salieron a un contador. Los bytes los cuenta quien responde
+// (JsonResponse, StaticAssets): el firmware pasa una función que devuelve
+// el total y acá se toma la diferencia.
+//
+// La latencia es el tiempo dentro del handler: con el WebServer del core
+// incluye el envío; con AsyncHttpServer el envío sigue después en segundo
+// plano y no se cuenta.
+//
+// write() vuelca todo como texto de Prometheus (text/plain 0.0.4) por un
+// JsonWriter, así la respuesta sale en chunks con el buffer de siempre.
+#pragma once
+
+#include <Arduino.h>
+#include <HttpServer.h>
+#include <JsonStream.h>
+
+#ifndef HTTP_METRICS_ROUTES
+#define HTTP_METRICS_ROUTES 12
+#endif
+
+// Límites de los buckets en µs (el último bucket es +Inf)
+#define HTTP_METRICS_BUCKETS 13
+
+class LatencyHistogram {
+public:
+  static const uint32_t kBoundsUs[HTTP_METRICS_BUCKETS];
+
+  void add(uint32_t us);
+  uint32_t count() const { return count_; }
+  // name{labels,le="..."} para cada bucket (acumulado), _sum y _count
+  void write(JsonWriter &w, const char *name, const char *labels) const;
+
+private:
+  uint32_t buckets_[HTTP_METRICS_BUCKETS + 1] = {0};
+  uint32_t count_ = 0;
+  uint64_t sumUs_ = 0;
+};
+
+class HttpMetrics {
+public:
+  typedef uint32_t (*ByteCounter)();
+
+  explicit HttpMetrics(ByteCounter bytesSent) : bytesSent_(bytesSent) {}
+
+  // Handler medido bajo route="name" (name debe vivir para siempre)
+  HttpServer::THandlerFunction timed(const char *name, HttpServer::THandlerFunction fn);
+
+  // Llamar al principio de cada loop(): mide el tiempo de la vuelta anterior
+  void loopTick();
+
+  // Rutas, loop(), heap y WiFi. El firmware puede seguir escribiendo sus
+  // propias métricas con counter()/gauge() antes de cerrar la respuesta.
+  void write(JsonWriter &w);
+
+  // Una línea "# TYPE" y una muestra; labels sin llaves ("" = sin labels)
+  static void type(JsonWriter &w, const char *name, const char *kind);
+  static void sample(JsonWriter &w, const char *name, const char *labels, double value);
+  static void counter(JsonWriter &w, const char *name, double value) { type(w, name, "counter"); sample(w, name, "", value); }
+  static void gauge(JsonWriter &w, const char *name, double value) { type(w, name, "gauge"); sample(w, name, "", value); }
+
+private:
+  struct Route {
+    const char *name;
+    LatencyHistogram latency;
+    uint32_t bytes;
+  };
+
+  ByteCounter bytesSent_;
+  Route routes_[HTTP_METRICS_ROUTES];
+  uint8_t count_ = 0;
+  LatencyHistogram loop_;
+  uint32_t lastLoopUs_ = 0;
+  uint32_t loopMaxUs_ = 0;   // desde el último scrape
+};
@@ -0,0 +1,17 @@
+#include "JitterStats.h"
+
+bool JitterStats::wake(uint32_t nowUs) {
+  int32_t late = (int32_t)(nowUs - nextUs_);
+  uint32_t dev = late < 0 ? (uint32_t)-late : (uint32_t)late;
+  samples++;
+  if (late >= (int32_t)periodUs_) {
+    overruns++;
+    nextUs_ = nowUs + periodUs_;
+    return true;
+  }
+  lastUs = dev;
+  if (dev > maxUs) maxUs = dev;
+  sumUs += dev;
+  nextUs_ += periodUs_;
+  return false;
+}
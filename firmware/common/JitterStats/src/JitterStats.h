@@ -0,0 +1,35 @@
+// ======== Jitter de una tarea periódica ========
+// La tarea llama a start() antes del primer vTaskDelayUntil() y a wake() en
+// cada despertar. El desvío se mide contra el horario ideal (inicio + n
+// períodos), no contra el despertar anterior, así un atraso no se "absorbe".
+// Si la tarea pierde un período completo se cuenta como overrun y se vuelve
+// a anclar el horario. Los campos son de 32 bits: se leen desde otra tarea
+// sin lock.
+#pragma once
+
+#include <Arduino.h>
+
+class JitterStats {
+public:
+  explicit JitterStats(uint32_t periodMs) : periodUs_(periodMs * 1000UL) {}
+
+  void start(uint32_t nowUs) {
+    nextUs_ = nowUs + periodUs_;
+  }
+
+  // Devuelve true si hubo overrun (el llamador debe re-anclar su xLastWakeTime)
+  bool wake(uint32_t nowUs);
+
+  uint32_t meanUs() const { return samples ? (uint32_t)(sumUs / samples) : 0; }
+  void reset() { samples = overruns = lastUs = maxUs = 0; sumUs = 0; }
+
+  uint32_t samples = 0;
+  uint32_t overruns = 0;  // períodos perdidos
+  uint32_t lastUs = 0;
+  uint32_t maxUs = 0;
+  uint64_t sumUs = 0;
+
+private:
+  uint32_t periodUs_;
+  uint32_t nextUs_ = 0;
+};
@@ -0,0 +1,161 @@
+#include "JsonStream.h"
+
+JsonWriter::JsonWriter(char *buf, size_t cap, SinkFn sink, void *ctx)
+    : buf_(buf), cap_(cap), sink_(sink), ctx_(ctx) {}
+
+void JsonWriter::put(const char *s, size_t n) {
+  while (n) {
+    if (len_ == cap_) flush();
+    size_t k = cap_ - len_;
+    if (k > n) k = n;
+    memcpy(buf_ + len_, s, k);
+    len_ += k; total_ += k; s += k; n -= k;
+  }
+}
+
+void JsonWriter::flush() {
+  if (len_ == 0) return;
+  if (sink_) sink_(ctx_, buf_, len_);
+  len_ = 0;
+  flushes_++;
+}
+
+// Coma antes de cada elemento salvo el primero del nivel (y nunca tras una clave)
+void JsonWriter::separator() {
+  if (afterKey_) { afterKey_ = false; return; }
+  if (depth_ == 0) return;
+  uint32_t bit = 1u << (depth_ - 1);
+  if (needComma_ & bit) put(',');
+  else needComma_ |= bit;
+}
+
+void JsonWriter::open(char c) {
+  separator();
+  put(c);
+  depth_++;
+  needComma_ &= ~(1u << (depth_ - 1));
+}
+
+void JsonWriter::close(char c) {
+  put(c);
+  if (depth_) depth_--;
+}
+
+JsonWriter &JsonWriter::beginObject() { open('{'); return *this; }
+JsonWriter &JsonWriter::endObject() { close('}'); return *this; }
+JsonWriter &JsonWriter::beginArray() { open('['); return *this; }
+JsonWriter &JsonWriter::endArray() { close(']'); return *this; }
+
+JsonWriter &JsonWriter::key(const char *k) {
+  value(k);
+  put(':');
+  afterKey_ = true;
+  return *this;
+}
+
+void JsonWriter::putUint(uint64_t v) {
+  char tmp[21];
+  char *p = tmp + sizeof(tmp);
+  do { *--p = (char)('0' + v % 10); v /= 10; } while (v);
+  put(p, tmp + sizeof(tmp) - p);
+}
+
+JsonWriter &JsonWriter::value(unsigned long long v) { separator(); putUint(v); return *this; }
+
+JsonWriter &JsonWriter::value(long long v) {
+  separator();
+  if (v < 0) put('-');
+  putUint(v < 0 ? 0ULL - (unsigned long long)v : (unsigned long long)v);
+  return *this;
+}
+
+JsonWriter &JsonWriter::value(bool v) {
+  separator();
+  if (v) put("true", 4); else put("false", 5);
+  return *this;
+}
+
+JsonWriter &JsonWriter::null() {
+  separator();
+  put("null", 4);
+  return *this;
+}
+
+JsonWriter &JsonWriter::value(const char *s) {
+  separator();
+  put('"');
+  for (; *s; ++s) {
+    char c = *s;
+    if (c == '"' || c == '\\') { put('\\'); put(c); }
+    else if ((uint8_t)c < 0x20) {
+      static const char hex[] = "0123456789abcdef";
+      put("\\u00", 4); put(hex[(c >> 4) & 0xF]); put(hex[c & 0xF]);
+    } else put(c);
+  }
+  put('"');
+  return *this;
+}
+
+// Punto fijo con redondeo, igual que String(v, decimals) pero sin dtostrf
+JsonWriter &JsonWriter::value(float v, uint8_t decimals) {
+  if (isnan(v) || isinf(v)) return null();
+  static const uint32_t pow10[] = {1, 10, 100, 1000, 10000, 100000, 1000000};
+  if (decimals > 6) decimals = 6;
+  separator();
+  double scaled = (double)v * pow10[decimals];
+  bool neg = scaled < 0;
+  uint64_t n = (uint64_t)((neg ? -scaled : scaled) + 0.5);
+  if (neg && n != 0) put('-');
+  putUint(n / pow10[decimals]);
+  uint32_t fp = (uint32_t)(n % pow10[decimals]);
+  if (decimals) {
+    char tmp[8];
+    for (int i = decimals - 1; i >= 0; --i) { tmp[i] = (char)('0' + fp % 10); fp /= 10; }
+    put('.');
+    put(tmp, decimals);
+  }
+  return *this;
+}
+
+JsonWriter &JsonWriter::raw(const char *s, size_t len) {
+  put(s, len);
+  return *this;
+}
+
+// ======== JsonResponse ========
+char JsonResponse::s_buf[JSON_STREAM_BUF_SIZE];
+uint32_t JsonResponse::s_bytesSent = 0;
+
+JsonResponse::JsonResponse(HttpServer &server, int code, const char *contentType)
+    : server_(server), code_(code), contentType_(contentType), w_(s_buf, sizeof(s_buf), sink, this) {}
+
+// El buffer se llenó: arrancar (una vez) la respuesta chunked y mandar el bloque
+void JsonResponse::sink(void *ctx, const char *data, size_t len) {
+  JsonResponse *self = (JsonResponse *)ctx;
+  if (!self->chunked_) {
+    self->chunked_ = true;
+    self->server_.setContentLength(CONTENT_LENGTH_UNKNOWN);
+    self->server_.send(self->code_, self->contentType_, "");
+  }
+  if (self->teeFn_) self->teeFn_(self->teeCtx_, data, len);
+  self->server_.sendContent(data, len);
+}
+
+size_t JsonResponse::end() {
+  if (chunked_) {
+    w_.flush();
+    server_.sendContent("", 0);  // bloque final
+    s_bytesSent += w_.total();
+  } else {
+    if (teeFn_) teeFn_(teeCtx_, w_.data(), w_.buffered());
+    send(server_, w_.data(), w_.buffered(), code_, contentType_);
+  }
+  return w_.total();
+}
+
+void JsonResponse::send(HttpServer &server, const char *data, size_t len, int code, const char *contentType) {
+  server.setContentLength(len);
+  server.send(code, contentType, "");
+  server.sendContent(data, len);
+  s_bytesSent += len;
+}
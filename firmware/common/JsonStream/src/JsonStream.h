@@ -0,0 +1,113 @@
+// ======== JSON en streaming sin heap ========
+// JsonWriter escribe en un buffer fijo y lo vacía en un "sink" cuando se
+// llena. JsonResponse lo conecta al WebServer: si el JSON entra en el buffer
+// se envía con Content-Length; si no, pasa a chunked (sendContent) en bloques
+// del tamaño del buffer. Nunca se arma el JSON en un String.
+#pragma once
+
+#include <Arduino.h>
+#include <HttpServer.h>
+
+#ifndef JSON_STREAM_BUF_SIZE
+#define JSON_STREAM_BUF_SIZE 512
+#endif
+
+class JsonWriter {
+public:
+  typedef void (*SinkFn)(void *ctx, const char *data, size_t len);
+
+  JsonWriter(char *buf, size_t cap, SinkFn sink, void *ctx);
+
+  JsonWriter &beginObject();
+  JsonWriter &endObject();
+  JsonWriter &beginArray();
+  JsonWriter &endArray();
+  JsonWriter &key(const char *k);
+
+  JsonWriter &value(long long v);
+  JsonWriter &value(unsigned long long v);
+  JsonWriter &value(int v) { return value((long long)v); }
+  JsonWriter &value(unsigned int v) { return value((unsigned long long)v); }
+  JsonWriter &value(long v) { return value((long long)v); }
+  JsonWriter &value(unsigned long v) { return value((unsigned long long)v); }
+  JsonWriter &value(bool v);
+  JsonWriter &value(const char *s);  // con escape
+  JsonWriter &value(float v, uint8_t decimals);
+  JsonWriter &null();
+  JsonWriter &raw(const char *s, size_t len);  // sin separadores ni escape
+
+  // Atajos key + value
+  template <class T> JsonWriter &field(const char *k, T v) { return key(k).value(v); }
+  JsonWriter &field(const char *k, float v, uint8_t decimals) { return key(k).value(v, decimals); }
+
+  void flush();
+  size_t total() const { return total_; }     // bytes producidos en total
+  size_t buffered() const { return len_; }    // bytes aún en el buffer
+  const char *data() const { return buf_; }
+  bool flushed() const { return flushes_ > 0; }
+
+private:
+  void put(char c) { if (len_ == cap_) flush(); buf_[len_++] = c; total_++; }
+  void put(const char *s, size_t n);
+  void putUint(uint64_t v);
+  void separator();
+  void open(char c);
+  void close(char c);
+
+  char *buf_;
+  size_t cap_;
+  size_t len_ = 0;
+  size_t total_ = 0;
+  uint32_t flushes_ = 0;
+  SinkFn sink_;
+  void *ctx_;
+  uint32_t needComma_ = 0;  // un bit por nivel de anidamiento
+  uint8_t depth_ = 0;
+  bool afterKey_ = false;
+};
+
+// ======== Respuestas binarias ========
+// Mismo buffer y mismo envío que el JSON (JsonWriter::raw), con enteros
+// varint (LEB128: 7 bits por byte) y zigzag para deltas con signo.
+inline void writeVarint(JsonWriter &w, uint32_t v) {
+  char tmp[5];
+  size_t n = 0;
+  while (v >= 0x80) { tmp[n++] = (char)(v | 0x80); v >>= 7; }
+  tmp[n++] = (char)v;
+  w.raw(tmp, n);
+}
+inline void writeZigzag(JsonWriter &w, int32_t v) {
+  writeVarint(w, ((uint32_t)v << 1) ^ (uint32_t)(v >> 31));
+}
+
+// Respuesta JSON sobre el WebServer con buffer estático compartido
+// (los handlers corren de a uno, así que alcanza con uno).
+class JsonResponse {
+public:
+  explicit JsonResponse(HttpServer &server, int code = 200,
+                        const char *contentType = "application/json; charset=utf-8");
+  JsonWriter &json() { return w_; }
+  size_t end();  // devuelve los bytes de cuerpo enviados
+  // Copia de todo el cuerpo, tramo a tramo, a medida que sale (p.ej. a un cache)
+  void tee(JsonWriter::SinkFn fn, void *ctx) { teeFn_ = fn; teeCtx_ = ctx; }
+
+  // Bytes de cuerpo enviados por todas las respuestas desde el arranque
+  static uint32_t bytesSent() { return s_bytesSent; }
+
+  // Envía un cuerpo ya serializado (p.ej. desde un cache) con Content-Length
+  static void send(HttpServer &server, const char *data, size_t len, int code = 200,
+                   const char *contentType = "application/json; charset=utf-8");
+
+private:
+  static void sink(void *ctx, const char *data, size_t len);
+
+  static char s_buf[JSON_STREAM_BUF_SIZE];
+  static uint32_t s_bytesSent;
+  HttpServer &server_;
+  int code_;
+  const char *contentType_;
+  bool chunked_ = false;
+  JsonWriter::SinkFn teeFn_ = nullptr;
+  void *teeCtx_ = nullptr;
+  JsonWriter w_;
+};
@@ -0,0 +1,133 @@
+#include "Lttb.h"
+
+Lttb::Lttb(uint32_t n, uint32_t points, uint16_t rowSize, EmitFn emit, void *ctx)
+    : n_(n), middle_(n > 2 ? n - 2 : 0), buckets_(points > 2 ? points - 2 : 0),
+      rowSize_(rowSize < LTTB_ROW_MAX ? rowSize : LTTB_ROW_MAX), passthrough_(points < 3 || points >= n),
+      fn_(emit), ctx_(ctx) {
+  for (uint8_t s = 0; s < LTTB_SERIES; ++s) {
+    min_[s] = INFINITY;
+    max_[s] = -INFINITY;
+  }
+}
+
+void Lttb::emit(const Point &p) {
+  fn_(ctx_, p.row);
+  emitted_++;
+}
+
+void Lttb::open(Bucket &b, uint32_t id) {
+  memset(b.used, 0, sizeof(b.used));
+  b.id = id;
+  b.len = bucketStart(id + 1) - bucketStart(id);
+  b.count = 0;
+  b.sx = 0;
+  for (uint8_t s = 0; s < LTTB_SERIES; ++s) b.sy[s] = 0;
+}
+
+// Tramo corto: cada fila en su lugar. Largo: en cada parte, un lugar para
+// el mínimo y otro para el máximo de cada serie.
+void Lttb::add(Bucket &b, const Point &p) {
+  uint32_t j = b.count++;
+  b.sx += p.x;
+  for (uint8_t s = 0; s < LTTB_SERIES; ++s) b.sy[s] += p.y[s];
+  if (b.len <= LTTB_CANDIDATES) {
+    b.cand[j] = p;
+    b.used[j] = true;
+    return;
+  }
+  uint32_t base = (uint32_t)((uint64_t)j * LTTB_SUBBUCKETS / b.len) * 2 * LTTB_SERIES;
+  for (uint8_t s = 0; s < LTTB_SERIES; ++s) {
+    uint32_t lo = base + 2 * s, hi = lo + 1;
+    if (!b.used[lo] || p.y[s] < b.cand[lo].y[s]) { b.cand[lo] = p; b.used[lo] = true; }
+    if (!b.used[hi] || p.y[s] > b.cand[hi].y[s]) { b.cand[hi] = p; b.used[hi] = true; }
+  }
+}
+
+void Lttb::select(const Bucket &b, double cx, const double *cy) {
+  double w[LTTB_SERIES];
+  for (uint8_t s = 0; s < LTTB_SERIES; ++s) {
+    double span = (double)max_[s] - min_[s];
+    w[s] = span > 0 ? 1.0 / span : 0.0;
+  }
+  // Coordenadas relativas a A: los epoch en segundos no pierden precisión
+  double ax = a_.x, dcx = cx - ax;
+  int best = -1;
+  double bestArea = -1;
+  for (uint8_t k = 0; k < LTTB_CANDIDATES; ++k) {
+    if (!b.used[k]) continue;
+    const Point &p = b.cand[k];
+    double dpx = (double)p.x - ax;
+    double area = 0;
+    for (uint8_t s = 0; s < LTTB_SERIES; ++s) {
+      area += w[s] * fabs(dpx * (cy[s] - a_.y[s]) - dcx * ((double)p.y[s] - a_.y[s]));
+    }
+    if (area > bestArea) { bestArea = area; best = k; }
+  }
+  if (best < 0) return;
+  a_ = b.cand[best];
+  emit(a_);
+}
+
+void Lttb::push(uint32_t x, float y0, float y1, const void *row) {
+  if (seen_ >= n_) return;  // más filas que las anunciadas: se ignoran
+  uint32_t i = seen_++;
+  Point &p = last_;
+  p.x = x;
+  p.y[0] = y0;
+  p.y[1] = y1;
+  memcpy(p.row, row, rowSize_);
+  if (passthrough_) { emit(p); return; }
+  for (uint8_t s = 0; s < LTTB_SERIES; ++s) {
+    if (p.y[s] < min_[s]) min_[s] = p.y[s];
+    if (p.y[s] > max_[s]) max_[s] = p.y[s];
+  }
+
+  if (i == 0) {
+    a_ = p;
+    emit(p);
+    open(b_[cur_], 0);
+    return;
+  }
+
+  Bucket &cur = b_[cur_];
+  if (i == n_ - 1) {
+    // Última fila: cierra el pendiente contra el promedio del actual y el
+    // actual contra ella
+    if (pending_) {
+      double cy[LTTB_SERIES];
+      for (uint8_t s = 0; s < LTTB_SERIES; ++s) cy[s] = cur.sy[s] / cur.count;
+      select(b_[cur_ ^ 1], cur.sx / cur.count, cy);
+    }
+    double cy[LTTB_SERIES] = {p.y[0], p.y[1]};
+    select(cur, p.x, cy);
+    pending_ = false;
+    emit(p);
+    return;
+  }
+
+  uint32_t id = bucketOf(i);
+  if (id != cur.id) {
+    // El tramo actual está completo: ya se puede elegir del pendiente
+    if (pending_) {
+      double cy[LTTB_SERIES];
+      for (uint8_t s = 0; s < LTTB_SERIES; ++s) cy[s] = cur.sy[s] / cur.count;
+      select(b_[cur_ ^ 1], cur.sx / cur.count, cy);
+    }
+    pending_ = true;
+    cur_ ^= 1;
+    open(b_[cur_], id);
+  }
+  add(b_[cur_], p);
+}
+
+void Lttb::finish() {
+  if (passthrough_ || seen_ == 0 || seen_ >= n_) return;
+  Bucket &cur = b_[cur_];
+  double cy[LTTB_SERIES];
+  if (cur.count == 0) return;
+  for (uint8_t s = 0; s < LTTB_SERIES; ++s) cy[s] = cur.sy[s] / cur.count;
+  if (pending_) select(b_[cur_ ^ 1], cur.sx / cur.count, cy);
+  pending_ = false;
+  select(cur, cur.sx / cur.count, cy);
+  seen_ = n_;
+}
@@ -0,0 +1,87 @@
+// ======== LTTB (Largest-Triangle-Three-Buckets) en streaming ========
+// Reduce n filas a `points` conservando la forma del gráfico: la primera y
+// la última siempre salen, y el medio se parte en points-2 tramos de los
+// que sale una fila por tramo, la que forma el triángulo más grande con la
+// elegida del tramo anterior y el promedio del tramo siguiente.
+//
+// Las filas llegan de a una con push() (en orden de x) y salen por el
+// callback a medida que se eligen, con un tramo de atraso: sólo se guardan
+// el tramo pendiente y el que se está leyendo. Para que la memoria no
+// dependa del largo del tramo, en tramos de más de LTTB_CANDIDATES filas se
+// preseleccionan el mínimo y el máximo de cada serie en LTTB_SUBBUCKETS
+// partes (MinMaxLTTB); en tramos cortos se consideran todas.
+//
+// Cada fila lleva dos series (temperatura y humedad): el área de cada una
+// se normaliza por el rango visto hasta ese momento y se suman, así ninguna
+// domina por sus unidades. n tiene que ser exacto: los tramos se calculan
+// con él antes de empezar.
+#pragma once
+
+#include <Arduino.h>
+
+#define LTTB_SERIES 2
+#ifndef LTTB_SUBBUCKETS
+#define LTTB_SUBBUCKETS 2
+#endif
+#define LTTB_CANDIDATES (2 * LTTB_SERIES * LTTB_SUBBUCKETS)
+#ifndef LTTB_ROW_MAX
+#define LTTB_ROW_MAX 32   // bytes de la fila que se copia y se devuelve (Rollup)
+#endif
+
+class Lttb {
+public:
+  typedef void (*EmitFn)(void *ctx, const void *row);
+
+  // n: filas que van a llegar; points < 3 o >= n: salen todas tal cual
+  Lttb(uint32_t n, uint32_t points, uint16_t rowSize, EmitFn emit, void *ctx);
+
+  void push(uint32_t x, float y0, float y1, const void *row);
+  // Cierra los tramos abiertos si llegaron menos filas que n
+  void finish();
+
+  uint32_t emitted() const { return emitted_; }
+  static uint32_t outputSize(uint32_t n, uint32_t points) { return points >= 3 && points < n ? points : n; }
+
+private:
+  struct Point {
+    uint32_t x;
+    float y[LTTB_SERIES];
+    uint8_t row[LTTB_ROW_MAX];
+  };
+  struct Bucket {
+    Point cand[LTTB_CANDIDATES];
+    bool used[LTTB_CANDIDATES];
+    uint32_t id;
+    uint32_t len;      // filas que le tocan al tramo
+    uint32_t count;    // filas que ya llegaron
+    double sx;
+    double sy[LTTB_SERIES];
+  };
+
+  uint32_t bucketOf(uint32_t i) const { return (uint32_t)((uint64_t)(i - 1) * buckets_ / middle_); }
+  uint32_t bucketStart(uint32_t b) const {
+    return (uint32_t)(((uint64_t)b * middle_ + buckets_ - 1) / buckets_) + 1;
+  }
+  void open(Bucket &b, uint32_t id);
+  void add(Bucket &b, const Point &p);
+  // Elige la fila de b contra el anterior (a_) y el punto c; la emite y pasa a ser a_
+  void select(const Bucket &b, double cx, const double *cy);
+  void emit(const Point &p);
+
+  uint32_t n_;
+  uint32_t middle_;    // n - 2
+  uint32_t buckets_;   // points - 2
+  uint16_t rowSize_;
+  bool passthrough_;
+  EmitFn fn_;
+  void *ctx_;
+  uint32_t seen_ = 0;
+  uint32_t emitted_ = 0;
+  Point a_;            // última elegida
+  Point last_;         // última recibida
+  float min_[LTTB_SERIES];
+  float max_[LTTB_SERIES];
+  Bucket b_[2];        // pendiente y en lectura (se alternan)
+  uint8_t cur_ = 0;
+  bool pending_ = false;
+};
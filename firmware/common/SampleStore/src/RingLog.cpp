@@ -0,0 +1,257 @@
+#include "RingLog.h"
+
+static const uint32_t kMagic = 0x53544D31;  // "STM1"
+static const uint16_t kVersion = 2;   // 2: índice de largo variable
+
+uint32_t RingLog::oldestSeq() const {
+  uint32_t total = totalSeq();
+  uint32_t oldest = total > capacity_ ? total - capacity_ : 0;
+  return oldest > floor_ ? oldest : floor_;
+}
+
+// ======== Apertura ========
+bool RingLog::create() {
+  memset(&hdr_, 0, sizeof(hdr_));
+  hdr_.magic = kMagic;
+  hdr_.version = kVersion;
+  hdr_.recordSize = recSize_;
+  hdr_.capacity = capacity_;
+  hdr_.maxDays = maxDays_;
+  fs::File f = fs_.open(path_, FILE_WRITE);
+  if (!f) return false;
+  bool ok = writeHeader(f);
+  // El lugar del índice se reserva entero: el registro 0 va justo después
+  // y SPIFFS no deja hacer seek más allá del final del archivo
+  uint8_t zero[64];
+  memset(zero, 0, sizeof(zero));
+  for (uint32_t left = offsetOf(0) - sizeof(hdr_); ok && left > 0;) {
+    size_t n = left < sizeof(zero) ? left : sizeof(zero);
+    ok = f.write(zero, n) == n;
+    left -= n;
+  }
+  f.close();
+  return ok;
+}
+
+bool RingLog::begin(DayFn dayOf, void *ctx) {
+  pending_ = 0;
+  floor_ = 0;
+  fs::File f = fs_.open(path_, FILE_READ);
+  bool valid = false;
+  if (f) {
+    valid = f.read((uint8_t *)&hdr_, sizeof(hdr_)) == sizeof(hdr_) && hdr_.magic == kMagic &&
+            hdr_.version == kVersion && hdr_.recordSize == recSize_ && hdr_.capacity == capacity_ &&
+            hdr_.maxDays == maxDays_ && hdr_.dayCount <= maxDays_;
+    size_t idx = (size_t)hdr_.dayCount * sizeof(DayEntry);
+    valid = valid && f.read((uint8_t *)days_, idx) == idx;
+    f.close();
+  }
+  // Archivo ausente, de otra versión o con otro formato: se empieza de cero
+  ready_ = valid || create();
+  if (valid && dayOf) checkOverwritten(dayOf, ctx);
+  return ready_;
+}
+
+// Un flush cortado entre los registros y la cabecera pudo pisar los lugares
+// que siguen a nextSeq: con el anillo lleno son los batchLen_ registros más
+// viejos, que la cabecera todavía indexa. Se leen (usando el lote, vacío
+// al abrir, de buffer) y los que no son del día que dice el índice quedan
+// afuera; como el lote se escribe en orden, los pisados son un prefijo.
+// Si el anillo entero cabe en un día, un registro pisado puede ser del
+// mismo día y pasar: queda una muestra nueva entre las viejas del día.
+void RingLog::checkOverwritten(DayFn dayOf, void *ctx) {
+  uint32_t oldest = oldestSeq();
+  if (hdr_.nextSeq + batchLen_ <= capacity_) return;   // el lote no alcanza a dar la vuelta
+  uint32_t end = hdr_.nextSeq + batchLen_ - capacity_;
+  if (end > hdr_.nextSeq) end = hdr_.nextSeq;
+  fs::File f = fs_.open(path_, FILE_READ);
+  if (!f) return;
+  uint32_t valid = oldest;
+  for (uint32_t seq = oldest; seq < end; ++seq) {
+    if (!f.seek(offsetOf(seq % capacity_)) || f.read(batch_, recSize_) != recSize_) break;
+    stats_.fsReads++;
+    stats_.bytesRead += recSize_;
+    int32_t indexed = -1;
+    for (uint32_t i = 0; i < hdr_.dayCount; ++i) {
+      if (seq >= days_[i].firstSeq && seq < days_[i].endSeq) { indexed = days_[i].day; break; }
+    }
+    if (dayOf(ctx, batch_) != indexed) valid = seq + 1;
+  }
+  f.close();
+  floor_ = valid;
+}
+
+// ======== Escritura ========
+void RingLog::indexAppend(int32_t day, uint32_t seq) {
+  if (hdr_.dayCount > 0) {
+    DayEntry &last = days_[hdr_.dayCount - 1];
+    if (last.day == day && last.endSeq == seq) { last.endSeq = seq + 1; return; }
+  }
+  // Día nuevo (o el reloj volvió atrás): entrada nueva; si no hay lugar se pierde la más vieja
+  if (hdr_.dayCount == maxDays_) {
+    if (evictFn_) evictFn_(evictCtx_, days_[0].day);
+    memmove(&days_[0], &days_[1], sizeof(DayEntry) * (maxDays_ - 1));
+    hdr_.dayCount--;
+  }
+  days_[hdr_.dayCount++] = DayEntry{day, seq, seq + 1};
+}
+
+bool RingLog::append(int32_t day, const void *rec) {
+  if (!ready_) return false;
+  if (pending_ == batchLen_ && !flush()) return false;
+  if (pending_ == 0) batchSinceMs_ = millis();
+  indexAppend(day, totalSeq());
+  memcpy(batch_ + pending_ * recSize_, rec, recSize_);
+  pending_++;
+  // Con el anillo lleno cada registro nuevo pisa el más viejo: avisar de qué día era
+  if (evictFn_ && totalSeq() > capacity_) {
+    uint32_t gone = oldestSeq() - 1;
+    for (uint32_t i = 0; i < hdr_.dayCount && days_[i].firstSeq <= gone; ++i) {
+      if (gone < days_[i].endSeq) { evictFn_(evictCtx_, days_[i].day); break; }
+    }
+  }
+  if (pending_ == batchLen_) return flush();
+  return true;
+}
+
+bool RingLog::writeHeader(fs::File &f) {
+  // Se descartan del índice los días que el anillo ya pisó
+  uint32_t oldest = oldestSeq();
+  uint32_t keep = 0;
+  for (uint32_t i = 0; i < hdr_.dayCount; ++i) {
+    if (days_[i].endSeq > oldest) days_[keep++] = days_[i];
+  }
+  hdr_.dayCount = (uint16_t)keep;
+  if (!f.seek(0)) return false;
+  // Sólo las entradas en uso: el resto del lugar reservado no se lee
+  size_t idx = (size_t)hdr_.dayCount * sizeof(DayEntry);
+  size_t n = f.write((const uint8_t *)&hdr_, sizeof(hdr_));
+  if (n == sizeof(hdr_) && idx) n += f.write((const uint8_t *)days_, idx);
+  stats_.bytesWritten += n;
+  return n == sizeof(hdr_) + idx;
+}
+
+// Primero los registros y después la cabecera: si se corta la energía en el
+// medio se pierde el lote y la cabecera vieja sigue describiendo el anillo.
+// Mientras el anillo no dio la vuelta eso alcanza; después, el lote pisa los
+// registros más viejos que esa cabecera todavía indexa, y es begin() (con
+// dayOf) quien los encuentra y los deja afuera al abrir.
+bool RingLog::flush() {
+  if (!ready_ || pending_ == 0) return true;
+  fs::File f = fs_.open(path_, "r+");
+  if (!f) { stats_.writeErrors++; return false; }
+
+  bool ok = true;
+  uint16_t done = 0;
+  while (ok && done < pending_) {
+    uint32_t slot = (hdr_.nextSeq + done) % capacity_;
+    // Tramo contiguo hasta el final del anillo
+    uint16_t n = pending_ - done;
+    if (slot + n > capacity_) n = (uint16_t)(capacity_ - slot);
+    size_t bytes = (size_t)n * recSize_;
+    ok = f.seek(offsetOf(slot)) && f.write(batch_ + done * recSize_, bytes) == bytes;
+    if (ok) {
+      stats_.bytesWritten += bytes;
+      done += n;
+    }
+  }
+  if (ok) {
+    hdr_.nextSeq += pending_;
+    uint16_t written = pending_;
+    pending_ = 0;
+    ok = writeHeader(f);
+    if (ok) {
+      stats_.flushes++;
+      stats_.recordsWritten += written;
+    }
+  }
+  f.close();
+  if (!ok) stats_.writeErrors++;
+  return ok;
+}
+
+void RingLog::tick(unsigned long nowMs) {
+  if (pending_ > 0 && nowMs - batchSinceMs_ >= SAMPLE_STORE_FLUSH_MS) flush();
+}
+
+// ======== Lectura ========
+size_t RingLog::readRange(fs::File &f, uint32_t from, uint32_t to, RecordFn fn, void *ctx, bool &stop) {
+  size_t n = 0;
+  uint8_t buf[256];
+  const uint32_t perRead = sizeof(buf) / recSize_;
+  // Parte en flash
+  uint32_t flashEnd = to < hdr_.nextSeq ? to : hdr_.nextSeq;
+  uint32_t seq = from;
+  while (seq < flashEnd && f) {
+    uint32_t slot = seq % capacity_;
+    uint32_t k = flashEnd - seq;
+    if (k > perRead) k = perRead;
+    if (slot + k > capacity_) k = capacity_ - slot;
+    uint32_t t0 = micros();
+    if (!f.seek(offsetOf(slot))) break;
+    size_t bytes = f.read(buf, k * recSize_);
+    stats_.fsReads++;
+    stats_.bytesRead += bytes;
+    stats_.readUs += micros() - t0;
+    size_t got = bytes / recSize_;
+    for (size_t i = 0; i < got; ++i) {
+      n++;
+      if (!fn(ctx, buf + i * recSize_)) { stop = true; return n; }
+    }
+    if (got < k) break;
+    seq += k;
+  }
+  // Parte que sigue en RAM
+  for (seq = from > hdr_.nextSeq ? from : hdr_.nextSeq; seq < to; ++seq) {
+    n++;
+    if (!fn(ctx, batch_ + (seq - hdr_.nextSeq) * recSize_)) { stop = true; break; }
+  }
+  return n;
+}
+
+size_t RingLog::forEachInDays(int32_t fromDay, int32_t toDay, RecordFn fn, void *ctx) {
+  if (!ready_) return 0;
+  uint32_t oldest = oldestSeq();
+  fs::File f;
+  size_t n = 0;
+  bool stop = false;
+  for (uint32_t i = 0; i < hdr_.dayCount && !stop; ++i) {
+    const DayEntry &e = days_[i];
+    if (e.day < fromDay || e.day > toDay || e.endSeq <= oldest) continue;
+    uint32_t from = e.firstSeq > oldest ? e.firstSeq : oldest;
+    if (!f && from < hdr_.nextSeq) {
+      uint32_t t0 = micros();
+      f = fs_.open(path_, FILE_READ);
+      stats_.readUs += micros() - t0;
+    }
+    n += readRange(f, from, e.endSeq, fn, ctx, stop);
+  }
+  return n;
+}
+
+size_t RingLog::countInDay(int32_t day) const {
+  uint32_t oldest = oldestSeq();
+  size_t n = 0;
+  for (uint32_t i = 0; i < hdr_.dayCount; ++i) {
+    const DayEntry &e = days_[i];
+    if (e.day != day || e.endSeq <= oldest) continue;
+    n += e.endSeq - (e.firstSeq > oldest ? e.firstSeq : oldest);
+  }
+  return n;
+}
+
+bool RingLog::last(void *out) {
+  if (!ready_ || size() == 0) return false;
+  if (pending_ > 0) {
+    memcpy(out, batch_ + (pending_ - 1) * recSize_, recSize_);
+    return true;
+  }
+  uint32_t t0 = micros();
+  fs::File f = fs_.open(path_, FILE_READ);
+  uint32_t slot = (hdr_.nextSeq - 1) % capacity_;
+  bool ok = f && f.seek(offsetOf(slot)) && f.read((uint8_t *)out, recSize_) == recSize_;
+  stats_.fsReads++;
+  stats_.bytesRead += ok ? recSize_ : 0;
+  stats_.readUs += micros() - t0;
+  return ok;
+}
@@ -0,0 +1,107 @@
+// ======== Archivo circular de registros de tamaño fijo ========
+// Base de SampleStore: append-only, escritura por lotes desde un buffer en
+// RAM e índice por día en la cabecera. El registro con número de secuencia s
+// vive en la posición s % capacidad. El índice tiene tantas entradas como
+// días quiera responder cada anillo (las provee quien lo usa, como el lote):
+// si se llena, el día más viejo deja de poder consultarse aunque sus
+// registros sigan en el archivo.
+//
+// Layout del archivo: [Header][maxDays × DayEntry][registro 0]...[registro N-1]
+#pragma once
+
+#include <Arduino.h>
+#include <FS.h>
+
+#ifndef SAMPLE_STORE_FLUSH_MS
+#define SAMPLE_STORE_FLUSH_MS 600000  // escribir igual si el lote tiene más de 10 min
+#endif
+
+class RingLog {
+public:
+  struct Stats {
+    uint32_t flushes;
+    uint32_t recordsWritten;
+    uint32_t bytesWritten;
+    uint32_t writeErrors;
+    uint32_t fsReads;     // aperturas + lecturas del archivo para consultas
+    uint32_t bytesRead;
+    uint32_t readUs;      // tiempo dentro de open/seek/read (sin los callbacks)
+  };
+
+  // Devuelve false para cortar el recorrido
+  typedef bool (*RecordFn)(void *ctx, const void *rec);
+  // Día al que pertenece un registro (para revisarlo contra el índice)
+  typedef int32_t (*DayFn)(void *ctx, const void *rec);
+  // Un registro nuevo pisó (o el índice dejó afuera) registros de ese día
+  typedef void (*EvictFn)(void *ctx, int32_t day);
+
+  struct DayEntry {
+    int32_t day;
+    uint32_t firstSeq;
+    uint32_t endSeq;  // exclusivo
+  };
+
+  // batch: buffer de RAM para batchLen registros; days: índice de maxDays
+  // entradas (los dos los provee quien lo usa)
+  RingLog(fs::FS &fs, const char *path, uint16_t recordSize, uint32_t capacity, uint8_t *batch,
+          uint16_t batchLen, DayEntry *days, uint16_t maxDays)
+      : fs_(fs), path_(path), recSize_(recordSize), capacity_(capacity), batch_(batch), batchLen_(batchLen),
+        days_(days), maxDays_(maxDays) {}
+
+  // dayOf: si se pasa, revisa los registros que un flush cortado pudo pisar
+  // (ver flush()) y deja afuera los que ya no son del día indexado
+  bool begin(DayFn dayOf = nullptr, void *ctx = nullptr);
+  bool append(int32_t day, const void *rec);
+  void onEvict(EvictFn fn, void *ctx) { evictFn_ = fn; evictCtx_ = ctx; }
+  bool flush();
+  void tick(unsigned long nowMs);
+
+  // Recorre en orden los registros del día (incluye los que siguen en RAM)
+  size_t forEachInDay(int32_t day, RecordFn fn, void *ctx) { return forEachInDays(day, day, fn, ctx); }
+  // Lo mismo para los días fromDay..toDay (inclusive), en orden de escritura
+  size_t forEachInDays(int32_t fromDay, int32_t toDay, RecordFn fn, void *ctx);
+  size_t countInDay(int32_t day) const;
+  bool last(void *out);
+
+  uint32_t size() const { return totalSeq() - oldestSeq(); }
+  const Stats &stats() const { return stats_; }
+
+private:
+  struct Header {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t recordSize;
+    uint32_t capacity;
+    uint32_t nextSeq;   // registros ya escritos en flash
+    uint16_t dayCount;
+    uint16_t maxDays;   // entradas reservadas para el índice después de la cabecera
+  };
+
+  uint32_t oldestSeq() const;
+  uint32_t totalSeq() const { return hdr_.nextSeq + pending_; }
+  uint32_t offsetOf(uint32_t slot) const {
+    return sizeof(Header) + (uint32_t)maxDays_ * sizeof(DayEntry) + slot * recSize_;
+  }
+  void indexAppend(int32_t day, uint32_t seq);
+  void checkOverwritten(DayFn dayOf, void *ctx);
+  size_t readRange(fs::File &f, uint32_t from, uint32_t to, RecordFn fn, void *ctx, bool &stop);
+  bool writeHeader(fs::File &f);
+  bool create();
+
+  fs::FS &fs_;
+  const char *path_;
+  uint16_t recSize_;
+  uint32_t capacity_;
+  uint8_t *batch_;
+  uint16_t batchLen_;
+  DayEntry *days_;
+  uint16_t maxDays_;
+  Header hdr_;
+  uint16_t pending_ = 0;
+  EvictFn evictFn_ = nullptr;
+  void *evictCtx_ = nullptr;
+  uint32_t floor_ = 0;   // secuencias menores no son válidas aunque estén en el anillo
+  unsigned long batchSinceMs_ = 0;
+  bool ready_ = false;
+  Stats stats_ = {0, 0, 0, 0, 0, 0, 0};
+};
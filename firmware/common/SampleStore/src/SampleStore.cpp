@@ -0,0 +1,326 @@
+#include "SampleStore.h"
+
+// ======== Fechas (algoritmo civil de días desde 1970-01-01) ========
+static int32_t daysFromCivil(int y, unsigned m, unsigned d) {
+  y -= m <= 2;
+  const int era = (y >= 0 ? y : y - 399) / 400;
+  const unsigned yoe = (unsigned)(y - era * 400);
+  const unsigned doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+  const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+  return era * 146097 + (int32_t)doe - 719468;
+}
+
+int32_t SampleStore::dayFromDate(const char *s) {
+  if (!s || strlen(s) != 10 || s[4] != '-' || s[7] != '-') return -1;
+  for (int i = 0; i < 10; ++i) {
+    if (i == 4 || i == 7) continue;
+    if (s[i] < '0' || s[i] > '9') return -1;
+  }
+  int y = (s[0] - '0') * 1000 + (s[1] - '0') * 100 + (s[2] - '0') * 10 + (s[3] - '0');
+  unsigned m = (unsigned)((s[5] - '0') * 10 + (s[6] - '0'));
+  unsigned d = (unsigned)((s[8] - '0') * 10 + (s[9] - '0'));
+  if (y < 1970 || m < 1 || m > 12 || d < 1) return -1;
+  // Sin esto 2024-02-31 caería en el 2 de marzo
+  static const uint8_t kMonthDays[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+  bool leap = (y % 4 == 0 && y % 100 != 0) || y % 400 == 0;
+  if (d > kMonthDays[m - 1] + (m == 2 && leap ? 1u : 0u)) return -1;
+  return daysFromCivil(y, m, d);
+}
+
+void SampleStore::formatDay(int32_t z, char out[11]) {
+  z += 719468;
+  const int32_t era = (z >= 0 ? z : z - 146096) / 146097;
+  const unsigned doe = (unsigned)(z - era * 146097);
+  const unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+  const unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+  const unsigned mp = (5 * doy + 2) / 153;
+  const unsigned d = doy - (153 * mp + 2) / 5 + 1;
+  const unsigned m = mp < 10 ? mp + 3 : mp - 9;
+  const int y = (int)yoe + era * 400 + (m <= 2);
+  unsigned yy = (unsigned)y % 10000;
+  out[0] = (char)('0' + yy / 1000); out[1] = (char)('0' + yy / 100 % 10);
+  out[2] = (char)('0' + yy / 10 % 10); out[3] = (char)('0' + yy % 10);
+  out[4] = '-'; out[5] = (char)('0' + m / 10); out[6] = (char)('0' + m % 10);
+  out[7] = '-'; out[8] = (char)('0' + d / 10); out[9] = (char)('0' + d % 10);
+  out[10] = '\0';
+}
+
+// ======== Registros ========
+SampleStore::Record SampleStore::pack(uint32_t ts, float t, float h) {
+  Record r;
+  r.ts = ts;
+  r.t = (int16_t)lroundf(constrain(t, -300.0f, 300.0f) * 100.0f);
+  r.h = (uint16_t)lroundf(constrain(h, 0.0f, 100.0f) * 100.0f);
+  return r;
+}
+
+Sample SampleStore::unpack(const Record &r) {
+  Sample s;
+  s.ts = r.ts;
+  s.temperature = r.t / 100.0f;
+  s.humidity = r.h / 100.0f;
+  return s;
+}
+
+Rollup SampleStore::unpack(const Bucket &b) {
+  Rollup r;
+  r.start = b.start;
+  r.count = b.count;
+  r.tMin = b.tMin / 100.0f;
+  r.tMax = b.tMax / 100.0f;
+  r.tMean = b.count ? (float)((double)b.tSum / b.count / 100.0) : NAN;
+  r.hMin = b.hMin / 100.0f;
+  r.hMax = b.hMax / 100.0f;
+  r.hMean = b.count ? (float)((double)b.hSum / b.count / 100.0) : NAN;
+  return r;
+}
+
+SampleStore::SampleStore(fs::FS &fs, const char *path)
+    : raw_(fs, path, sizeof(Record), SAMPLE_STORE_CAPACITY, (uint8_t *)batch_, SAMPLE_STORE_BATCH, rawDays_,
+           SAMPLE_STORE_DAYS),
+      levels_{
+          RingLog(fs, "/roll_m.bin", sizeof(Bucket), SAMPLE_STORE_MINUTE_CAPACITY, (uint8_t *)minuteBatch_,
+                  SAMPLE_STORE_BATCH, minuteDays_, SAMPLE_STORE_MINUTE_DAYS),
+          RingLog(fs, "/roll_h.bin", sizeof(Bucket), SAMPLE_STORE_HOUR_CAPACITY, (uint8_t *)hourBatch_, 4, hourDays_,
+                  SAMPLE_STORE_HOUR_DAYS),
+          RingLog(fs, "/roll_d.bin", sizeof(Bucket), SAMPLE_STORE_DAY_CAPACITY, (uint8_t *)dayBatch_, 1, dayDays_,
+                  SAMPLE_STORE_DAY_DAYS),
+      } {
+  memset(open_, 0, sizeof(open_));
+}
+
+bool SampleStore::begin(long tzOffsetSec) {
+  tzOffset_ = tzOffsetSec;
+  // Registros y buckets empiezan con su ts (o inicio): de ahí sale el día
+  RingLog::DayFn dayOfRec = [](void *p, const void *rec) {
+    uint32_t ts;
+    memcpy(&ts, rec, sizeof(ts));
+    return ((SampleStore *)p)->dayOf(ts);
+  };
+  bool ok = raw_.begin(dayOfRec, this);
+  for (uint8_t i = 0; i < kLevels; ++i) ok = levels_[i].begin(dayOfRec, this) && ok;
+  restoreOpenBuckets();
+  return ok;
+}
+
+// Los buckets en curso viven en RAM y se escriben recién al cerrarse; tras
+// un reinicio se rearman con las muestras crudas del día de la última, que
+// siguen en el anillo. Un nivel cuyo log ya tiene ese bucket (o uno
+// posterior: el lote crudo se perdió y el del nivel no) queda vacío para
+// no escribirlo dos veces.
+void SampleStore::restoreOpenBuckets() {
+  memset(open_, 0, sizeof(open_));
+  Record last;
+  if (!raw_.last(&last)) return;
+  struct Ctx {
+    SampleStore *store;
+    uint32_t start[kLevels];
+    bool want[kLevels];
+  } c;
+  c.store = this;
+  for (uint8_t i = 0; i < kLevels; ++i) {
+    Bucket prev;
+    c.start[i] = bucketStart(i, last.ts);
+    c.want[i] = !(levels_[i].last(&prev) && prev.start >= c.start[i]);
+  }
+  raw_.forEachInDay(dayOf(last.ts), [](void *p, const void *rec) {
+    Ctx *c = (Ctx *)p;
+    const Record &r = *(const Record *)rec;
+    for (uint8_t i = 0; i < kLevels; ++i) {
+      if (c->want[i] && c->store->bucketStart(i, r.ts) == c->start[i]) accumulate(c->store->open_[i], c->start[i], r);
+    }
+    return true;
+  }, &c);
+}
+
+void SampleStore::onEvict(EvictFn fn, void *ctx) {
+  evictFn_ = fn;
+  evictUser_ = ctx;
+  RingLog::EvictFn relay = [](void *p, int32_t day) {
+    EvictCtx *c = (EvictCtx *)p;
+    c->store->evictFn_(c->store->evictUser_, c->res, day);
+  };
+  RingLog *logs[] = {&raw_, &levels_[0], &levels_[1], &levels_[2]};
+  for (uint8_t i = 0; i <= kLevels; ++i) {
+    evictCtx_[i] = EvictCtx{this, (Resolution)i};
+    logs[i]->onEvict(fn ? relay : nullptr, &evictCtx_[i]);
+  }
+}
+
+// ======== Escritura ========
+uint32_t SampleStore::bucketStart(uint8_t level, uint32_t ts) const {
+  switch (level) {
+    case 0:  return ts - ts % 60;
+    case 1:  return ts - ts % 3600;
+    default: return dayStart(dayOf(ts));
+  }
+}
+
+void SampleStore::addToBucket(uint8_t level, const Record &r) {
+  Bucket &b = open_[level];
+  uint32_t start = bucketStart(level, r.ts);
+  if (b.count > 0 && b.start != start) {
+    levels_[level].append(dayOf(b.start), &b);
+    b.count = 0;
+  }
+  accumulate(b, start, r);
+}
+
+void SampleStore::accumulate(Bucket &b, uint32_t start, const Record &r) {
+  if (b.count == 0) {
+    b.start = start;
+    b.tMin = b.tMax = r.t;
+    b.hMin = b.hMax = r.h;
+    b.tSum = 0;
+    b.hSum = 0;
+  }
+  if (r.t < b.tMin) b.tMin = r.t;
+  if (r.t > b.tMax) b.tMax = r.t;
+  if (r.h < b.hMin) b.hMin = r.h;
+  if (r.h > b.hMax) b.hMax = r.h;
+  b.tSum += r.t;
+  b.hSum += r.h;
+  b.count++;
+}
+
+bool SampleStore::append(uint32_t ts, float temperature, float humidity) {
+  Record r = pack(ts, temperature, humidity);
+  if (!raw_.append(dayOf(ts), &r)) return false;
+  for (uint8_t i = 0; i < kLevels; ++i) addToBucket(i, r);
+  appended_++;
+  return true;
+}
+
+bool SampleStore::flush() {
+  bool ok = raw_.flush();
+  for (uint8_t i = 0; i < kLevels; ++i) ok = levels_[i].flush() && ok;
+  return ok;
+}
+
+void SampleStore::tick(unsigned long nowMs) {
+  raw_.tick(nowMs);
+  for (uint8_t i = 0; i < kLevels; ++i) levels_[i].tick(nowMs);
+}
+
+SampleStore::Stats SampleStore::stats() const {
+  Stats s = {appended_, 0, 0, 0, 0, 0, 0, 0};
+  const RingLog *logs[] = {&raw_, &levels_[0], &levels_[1], &levels_[2]};
+  for (const RingLog *l : logs) {
+    s.flushes += l->stats().flushes;
+    s.recordsWritten += l->stats().recordsWritten;
+    s.bytesWritten += l->stats().bytesWritten;
+    s.writeErrors += l->stats().writeErrors;
+    s.fsReads += l->stats().fsReads;
+    s.bytesRead += l->stats().bytesRead;
+    s.readUs += l->stats().readUs;
+  }
+  return s;
+}
+
+// ======== Lectura ========
+struct SampleCtx { SampleStore::SampleFn fn; void *ctx; };
+struct RollupCtx { SampleStore::RollupFn fn; void *ctx; };
+
+size_t SampleStore::forEachInDay(int32_t day, SampleFn fn, void *ctx) {
+  SampleCtx c = {fn, ctx};
+  return raw_.forEachInDay(day, [](void *p, const void *rec) {
+    SampleCtx *c = (SampleCtx *)p;
+    c->fn(c->ctx, unpack(*(const Record *)rec));
+    return true;
+  }, &c);
+}
+
+bool SampleStore::lastSample(Sample &out) {
+  Record r;
+  if (!raw_.last(&r)) return false;
+  out = unpack(r);
+  return true;
+}
+
+size_t SampleStore::forEachRollupInDay(Resolution res, int32_t day, RollupFn fn, void *ctx) {
+  if (res == RES_RAW) return 0;
+  uint8_t level = (uint8_t)res - 1;
+  RollupCtx c = {fn, ctx};
+  size_t n = levels_[level].forEachInDay(day, [](void *p, const void *rec) {
+    RollupCtx *c = (RollupCtx *)p;
+    c->fn(c->ctx, unpack(*(const Bucket *)rec));
+    return true;
+  }, &c);
+  // El bucket en curso también cuenta
+  const Bucket &b = open_[level];
+  if (b.count > 0 && dayOf(b.start) == day) {
+    fn(ctx, unpack(b));
+    n++;
+  }
+  return n;
+}
+
+size_t SampleStore::countRollupsInDay(Resolution res, int32_t day) const {
+  if (res == RES_RAW) return countInDay(day);
+  uint8_t level = (uint8_t)res - 1;
+  const Bucket &b = open_[level];
+  return levels_[level].countInDay(day) + ((b.count > 0 && dayOf(b.start) == day) ? 1 : 0);
+}
+
+// ======== Lectura por rango ========
+struct RangeCtx {
+  uint32_t from, to;
+  SampleStore::SampleVisitFn sampleFn;
+  SampleStore::RollupVisitFn rollupFn;
+  void *ctx;
+  size_t n;
+  bool stopped;
+};
+
+size_t SampleStore::forEachInRange(uint32_t fromTs, uint32_t toTs, SampleVisitFn fn, void *ctx) {
+  if (fromTs > toTs) return 0;
+  RangeCtx c = {fromTs, toTs, fn, nullptr, ctx, 0, false};
+  raw_.forEachInDays(dayOf(fromTs), dayOf(toTs), [](void *p, const void *rec) {
+    RangeCtx *c = (RangeCtx *)p;
+    const Record &r = *(const Record *)rec;
+    if (r.ts < c->from || r.ts > c->to) return true;
+    c->n++;
+    c->stopped = !c->sampleFn(c->ctx, unpack(r));
+    return !c->stopped;
+  }, &c);
+  return c.n;
+}
+
+size_t SampleStore::forEachRollupInRange(Resolution res, uint32_t fromTs, uint32_t toTs, RollupVisitFn fn,
+                                         void *ctx) {
+  if (res == RES_RAW || fromTs > toTs) return 0;
+  uint8_t level = (uint8_t)res - 1;
+  RangeCtx c = {fromTs, toTs, nullptr, fn, ctx, 0, false};
+  levels_[level].forEachInDays(dayOf(fromTs), dayOf(toTs), [](void *p, const void *rec) {
+    RangeCtx *c = (RangeCtx *)p;
+    const Bucket &b = *(const Bucket *)rec;
+    if (b.start < c->from || b.start > c->to) return true;
+    c->n++;
+    c->stopped = !c->rollupFn(c->ctx, unpack(b));
+    return !c->stopped;
+  }, &c);
+  // El bucket en curso va último
+  const Bucket &b = open_[level];
+  if (!c.stopped && b.count > 0 && b.start >= fromTs && b.start <= toTs) {
+    c.n++;
+    fn(ctx, unpack(b));
+  }
+  return c.n;
+}
+
+bool SampleStore::parseResolution(const char *s, Resolution &out) {
+  if (!s || !*s || strcmp(s, "raw") == 0) { out = RES_RAW; return true; }
+  if (strcmp(s, "minute") == 0) { out = RES_MINUTE; return true; }
+  if (strcmp(s, "hour") == 0) { out = RES_HOUR; return true; }
+  if (strcmp(s, "day") == 0) { out = RES_DAY; return true; }
+  return false;
+}
+
+const char *SampleStore::resolutionName(Resolution res) {
+  switch (res) {
+    case RES_MINUTE: return "minute";
+    case RES_HOUR:   return "hour";
+    case RES_DAY:    return "day";
+    default:         return "raw";
+  }
+}
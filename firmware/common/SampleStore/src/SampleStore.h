@@ -0,0 +1,153 @@
+// ======== Log de muestras + rollups en flash ========
+// Las muestras crudas (timestamp, temp*100, hum*100; 8 bytes) van a un
+// RingLog. Al mismo tiempo se mantienen, a medida que llegan, buckets
+// agregados (min/max/media/cantidad) por minuto, hora y día, cada nivel en
+// su propio RingLog. Así una consulta de un día lee a lo sumo 1440, 24 o 1
+// buckets sin importar cada cuánto se muestree.
+//
+// El bucket en curso de cada nivel vive en RAM y se escribe al cerrarse;
+// al arrancar se rearma con las muestras crudas que ya tiene el anillo.
+#pragma once
+
+#include <Arduino.h>
+#include <FS.h>
+#include "RingLog.h"
+
+#ifndef SAMPLE_STORE_CAPACITY
+#define SAMPLE_STORE_CAPACITY 8192         // muestras crudas en el anillo (8 B c/u)
+#endif
+#ifndef SAMPLE_STORE_BATCH
+#define SAMPLE_STORE_BATCH 16              // muestras en RAM antes de escribir
+#endif
+#ifndef SAMPLE_STORE_MINUTE_CAPACITY
+#define SAMPLE_STORE_MINUTE_CAPACITY 4320  // 3 días de buckets de 1 min (32 B c/u)
+#endif
+#ifndef SAMPLE_STORE_HOUR_CAPACITY
+#define SAMPLE_STORE_HOUR_CAPACITY 768     // 32 días de buckets de 1 h
+#endif
+#ifndef SAMPLE_STORE_DAY_CAPACITY
+#define SAMPLE_STORE_DAY_CAPACITY 366      // 1 año de buckets diarios
+#endif
+#ifndef SAMPLE_STORE_DAYS
+#define SAMPLE_STORE_DAYS 64               // días indexados del log crudo (1 muestra cada 11 min los llena)
+#endif
+// Los rollups indexan todos los días que les entran, más el primero y el
+// último a medias
+#define SAMPLE_STORE_MINUTE_DAYS (SAMPLE_STORE_MINUTE_CAPACITY / 1440 + 2)
+#define SAMPLE_STORE_HOUR_DAYS (SAMPLE_STORE_HOUR_CAPACITY / 24 + 2)
+#define SAMPLE_STORE_DAY_DAYS (SAMPLE_STORE_DAY_CAPACITY + 1)
+
+struct Sample {
+  uint32_t ts;         // epoch UTC (s)
+  float temperature;   // °C
+  float humidity;      // %
+};
+
+enum Resolution : uint8_t { RES_RAW = 0, RES_MINUTE, RES_HOUR, RES_DAY };
+
+struct Rollup {
+  uint32_t start;      // inicio del bucket, epoch UTC (s)
+  uint32_t count;      // muestras agregadas
+  float tMin, tMax, tMean;
+  float hMin, hMax, hMean;
+};
+
+class SampleStore {
+public:
+  struct Stats {
+    uint32_t appended;
+    uint32_t flushes;
+    uint32_t recordsWritten;
+    uint32_t bytesWritten;
+    uint32_t writeErrors;
+    uint32_t fsReads;
+    uint32_t bytesRead;
+    uint32_t readUs;
+  };
+
+  typedef void (*SampleFn)(void *ctx, const Sample &s);
+  typedef void (*RollupFn)(void *ctx, const Rollup &r);
+  // Para recorridos por rango: devolver false corta
+  typedef bool (*SampleVisitFn)(void *ctx, const Sample &s);
+  typedef bool (*RollupVisitFn)(void *ctx, const Rollup &r);
+
+  // El log (crudo o de un nivel) pisó registros de ese día: lo que se haya
+  // armado con ellos ya no vale (p.ej. respuestas cacheadas)
+  typedef void (*EvictFn)(void *ctx, Resolution res, int32_t day);
+
+  explicit SampleStore(fs::FS &fs, const char *path = "/samples.bin");
+  void onEvict(EvictFn fn, void *ctx);
+
+  // tzOffsetSec: desfase local para decidir a qué día pertenece cada muestra
+  bool begin(long tzOffsetSec);
+  bool append(uint32_t ts, float temperature, float humidity);
+  bool flush();
+  void tick(unsigned long nowMs);  // escribe los lotes viejos
+
+  // Recorre en orden las muestras del día (incluye las que siguen en RAM)
+  size_t forEachInDay(int32_t day, SampleFn fn, void *ctx);
+  size_t countInDay(int32_t day) const { return raw_.countInDay(day); }
+  bool lastSample(Sample &out);
+
+  // Buckets agregados del día (res = RES_MINUTE, RES_HOUR o RES_DAY)
+  size_t forEachRollupInDay(Resolution res, int32_t day, RollupFn fn, void *ctx);
+  size_t countRollupsInDay(Resolution res, int32_t day) const;
+
+  // Muestras (o buckets, por su inicio) con ts en [fromTs, toTs], en orden
+  // de escritura y hasta que fn devuelva false. Sólo se leen los días del
+  // rango; devuelve cuántos se entregaron a fn.
+  size_t forEachInRange(uint32_t fromTs, uint32_t toTs, SampleVisitFn fn, void *ctx);
+  size_t forEachRollupInRange(Resolution res, uint32_t fromTs, uint32_t toTs, RollupVisitFn fn, void *ctx);
+
+  int32_t dayOf(uint32_t ts) const { return (int32_t)(((int64_t)ts + tzOffset_) / 86400); }
+  uint32_t dayStart(int32_t day) const { return (uint32_t)((int64_t)day * 86400 - tzOffset_); }
+  static int32_t dayFromDate(const char *yyyymmdd);          // -1 si no es válida
+  static void formatDay(int32_t day, char out[11]);          // "YYYY-MM-DD"
+  static bool parseResolution(const char *s, Resolution &out);
+  static const char *resolutionName(Resolution res);
+
+  uint32_t size() const { return raw_.size(); }  // muestras crudas válidas
+  Stats stats() const;
+
+private:
+  struct Record {
+    uint32_t ts;
+    int16_t t;   // centésimas de °C
+    uint16_t h;  // centésimas de %
+  };
+  struct Bucket {
+    uint32_t start;
+    uint32_t count;
+    int16_t tMin, tMax;
+    uint16_t hMin, hMax;
+    int64_t tSum;
+    uint64_t hSum;
+  };
+  static const uint8_t kLevels = 3;  // minuto, hora, día
+
+  static Record pack(uint32_t ts, float t, float h);
+  static Sample unpack(const Record &r);
+  static Rollup unpack(const Bucket &b);
+  uint32_t bucketStart(uint8_t level, uint32_t ts) const;
+  void addToBucket(uint8_t level, const Record &r);
+  static void accumulate(Bucket &b, uint32_t start, const Record &r);
+  void restoreOpenBuckets();
+
+  long tzOffset_ = 0;
+  Record batch_[SAMPLE_STORE_BATCH];
+  Bucket minuteBatch_[SAMPLE_STORE_BATCH];
+  Bucket hourBatch_[4];
+  Bucket dayBatch_[1];
+  RingLog::DayEntry rawDays_[SAMPLE_STORE_DAYS];
+  RingLog::DayEntry minuteDays_[SAMPLE_STORE_MINUTE_DAYS];
+  RingLog::DayEntry hourDays_[SAMPLE_STORE_HOUR_DAYS];
+  RingLog::DayEntry dayDays_[SAMPLE_STORE_DAY_DAYS];
+  RingLog raw_;
+  RingLog levels_[kLevels];
+  Bucket open_[kLevels];  // bucket en curso por nivel (count == 0: vacío)
+  struct EvictCtx { SampleStore *store; Resolution res; };
+  EvictCtx evictCtx_[kLevels + 1];
+  EvictFn evictFn_ = nullptr;
+  void *evictUser_ = nullptr;
+  uint32_t appended_ = 0;
+};
@@ -0,0 +1,77 @@
+#include "SensorFilter.h"
+
+#include <math.h>
+
+const ChannelLimits DHT22_TEMP_LIMITS = {-40.0f, 80.0f, 3.0f, 0.3f};
+const ChannelLimits DHT22_HUM_LIMITS = {0.0f, 100.0f, 15.0f, 0.3f};
+
+float ChannelFilter::median() const {
+  // Inserción sobre una copia: N es chico (5)
+  float v[SENSOR_FILTER_MEDIAN];
+  for (uint8_t i = 0; i < count_; ++i) {
+    float x = win_[i];
+    uint8_t j = i;
+    for (; j > 0 && v[j - 1] > x; --j) v[j] = v[j - 1];
+    v[j] = x;
+  }
+  return v[count_ / 2];
+}
+
+ChannelFilter::Result ChannelFilter::push(float x) {
+  if (!inRange(x)) return INVALID;
+
+  Result res = ACCEPTED;
+  if (count_ > 0 && fabsf(x - median()) > lim_.maxStep) {
+    // ¿Sigue una racha de lecturas parecidas lejos de la mediana?
+    if (run_ > 0 && fabsf(x - runSum_ / run_) > lim_.maxStep) {
+      run_ = 0;
+      runSum_ = 0;
+    }
+    runSum_ += x;
+    if (++run_ < SENSOR_FILTER_STEP_RUN) return SPIKE;
+    // Cambio real: el filtro arranca de nuevo en el nivel nuevo
+    x = runSum_ / run_;
+    count_ = head_ = 0;
+    res = STEP;
+  }
+  run_ = 0;
+  runSum_ = 0;
+
+  win_[head_] = x;
+  head_ = (uint8_t)((head_ + 1) % SENSOR_FILTER_MEDIAN);
+  if (count_ < SENSOR_FILTER_MEDIAN) count_++;
+  float m = median();
+  ema_ = count_ == 1 ? m : ema_ + lim_.alpha * (m - ema_);
+  return res;
+}
+
+bool SensorFilter::push(float t, float h, uint32_t nowMs) {
+  stats_.samples++;
+  // El DHT22 manda los dos valores en la misma trama: si uno es imposible,
+  // no se confía en el otro
+  if (!t_.inRange(t) || !h_.inRange(h)) {
+    stats_.invalid++;
+    return false;
+  }
+  bool changed = false;
+  ChannelFilter::Result r[2] = {t_.push(t), h_.push(h)};
+  for (ChannelFilter::Result x : r) {
+    if (x == ChannelFilter::SPIKE) {
+      stats_.spikes++;
+    } else {
+      changed = true;
+      if (x == ChannelFilter::STEP) stats_.steps++;
+    }
+  }
+  if (changed) {
+    stats_.accepted++;
+    goodMs_ = nowMs;
+  }
+  return changed;
+}
+
+FilteredReading SensorFilter::latest() const {
+  bool valid = t_.valid() && h_.valid();
+  FilteredReading r = {valid ? t_.value() : NAN, valid ? h_.value() : NAN, goodMs_, staleMs_, valid};
+  return r;
+}
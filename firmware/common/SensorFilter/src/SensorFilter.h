@@ -0,0 +1,96 @@
+// ======== Filtro de lecturas (temperatura + humedad) ========
+// Entre el sensor y todos los que muestran o guardan datos. Por canal:
+//
+//  1. Rango: NaN o fuera de lo que el sensor puede medir -> se descarta.
+//  2. Picos: una lectura que se aleja más de maxStep de la mediana
+//     reciente se descarta. Si SENSOR_FILTER_STEP_RUN lecturas seguidas
+//     coinciden en el valor nuevo, es un cambio real y el filtro lo sigue.
+//  3. Mediana de las últimas SENSOR_FILTER_MEDIAN lecturas aceptadas.
+//  4. EMA sobre la mediana (alpha chico = más suave, más lento).
+//
+// La salida es el último valor bueno con su millis(): quien lo consume
+// decide con stale() si sigue sirviendo. Una lectura fallida no cambia la
+// salida ni dispara reintentos; la próxima llega en el período normal.
+// Memoria fija: dos ventanas de floats, sin heap.
+#pragma once
+
+#include <math.h>
+#include <stdint.h>
+
+#ifndef SENSOR_FILTER_MEDIAN
+#define SENSOR_FILTER_MEDIAN 5   // impar
+#endif
+
+#ifndef SENSOR_FILTER_STEP_RUN
+#define SENSOR_FILTER_STEP_RUN 3
+#endif
+
+struct ChannelLimits {
+  float min, max;   // rango físico del sensor
+  float maxStep;    // salto máximo contra la mediana antes de ser pico
+  float alpha;      // EMA (0..1]
+};
+
+class ChannelFilter {
+public:
+  enum Result : uint8_t { ACCEPTED, INVALID, SPIKE, STEP };
+
+  explicit ChannelFilter(const ChannelLimits &limits) : lim_(limits) {}
+
+  Result push(float x);
+  bool inRange(float x) const { return !isnan(x) && x >= lim_.min && x <= lim_.max; }
+  bool valid() const { return count_ > 0; }
+  float value() const { return ema_; }
+  float median() const;
+  void reset() { count_ = head_ = run_ = 0; }
+
+private:
+  ChannelLimits lim_;
+  float win_[SENSOR_FILTER_MEDIAN];
+  float runSum_ = 0;      // suma de la racha de picos (para ver si coinciden)
+  float ema_ = 0;
+  uint8_t count_ = 0;
+  uint8_t head_ = 0;
+  uint8_t run_ = 0;       // picos seguidos parecidos entre sí
+};
+
+// Lo que ven los consumidores (copiable por valor a una cola)
+struct FilteredReading {
+  float t, h;          // filtrados; NAN si todavía no hubo un dato bueno
+  uint32_t goodMs;     // millis() del último dato aceptado
+  uint32_t staleMs;    // a partir de esta edad el dato ya no sirve
+  bool valid;
+
+  uint32_t ageMs(uint32_t nowMs) const { return nowMs - goodMs; }
+  bool stale(uint32_t nowMs) const { return !valid || ageMs(nowMs) > staleMs; }
+};
+
+class SensorFilter {
+public:
+  struct Stats {
+    uint32_t samples;    // lecturas recibidas
+    uint32_t accepted;
+    uint32_t invalid;    // NaN / fuera de rango (en cualquiera de los dos canales)
+    uint32_t spikes;
+    uint32_t steps;      // cambios reales aceptados tras una racha de "picos"
+  };
+
+  SensorFilter(const ChannelLimits &t, const ChannelLimits &h, uint32_t staleMs)
+    : t_(t), h_(h), staleMs_(staleMs) {}
+
+  // Una lectura cruda (NaN si el sensor falló). true si cambió la salida.
+  bool push(float t, float h, uint32_t nowMs);
+
+  FilteredReading latest() const;
+  const Stats &stats() const { return stats_; }
+
+private:
+  ChannelFilter t_, h_;
+  uint32_t staleMs_;
+  uint32_t goodMs_ = 0;
+  Stats stats_ = {0, 0, 0, 0, 0};
+};
+
+// Límites para el DHT22 (±0.5 °C, ±2 %HR de precisión)
+extern const ChannelLimits DHT22_TEMP_LIMITS;
+extern const ChannelLimits DHT22_HUM_LIMITS;
@@ -0,0 +1,139 @@
+#include "SleepBatch.h"
+
+#include <stdarg.h>
+
+static const uint32_t kMagic = 0x534c4254;  // "SLBT"
+static const uint16_t kVersion = 1;
+
+// Filas del mensaje: edad de la primera y kPerLine lecturas "T/H"
+static const uint8_t kPerLine = 4;
+static const size_t kLineMax = 48;    // "`-99999m` " + 4 × "-40.0/100 "
+static const size_t kFrameMax = 320;  // cabecera y pie
+
+void SleepBatch::clear() {
+  memset(&r_, 0, sizeof(r_));
+  r_.magic = kMagic;
+  r_.version = kVersion;
+}
+
+void SleepBatch::begin(bool retained) {
+  if (!retained || r_.magic != kMagic || r_.version != kVersion) clear();
+  r_.wakes++;
+}
+
+void SleepBatch::push(float t, float h, uint32_t nowMs) {
+  BatchSample s;
+  s.ms = r_.clockMs + nowMs;
+  if (isnan(t) || isnan(h)) {
+    s.t = INT16_MIN;
+    s.h = 0;
+    r_.failed++;
+  } else {
+    s.t = (int16_t)lroundf(constrain(t, -300.0f, 300.0f) * 100.0f);
+    s.h = (uint16_t)lroundf(constrain(h, 0.0f, 100.0f) * 100.0f);
+  }
+  // Lleno: se pisa la más vieja
+  if (r_.count == SLEEP_BATCH_CAPACITY) {
+    r_.head = (r_.head + 1) % SLEEP_BATCH_CAPACITY;
+    r_.count--;
+    r_.lost++;
+  }
+  r_.ring[(r_.head + r_.count) % SLEEP_BATCH_CAPACITY] = s;
+  r_.count++;
+  r_.samples++;
+}
+
+void SleepBatch::sent(uint16_t taken) {
+  if (taken > r_.count) taken = r_.count;
+  r_.head = (r_.head + taken) % SLEEP_BATCH_CAPACITY;
+  r_.count -= taken;
+  r_.messages++;
+}
+
+void SleepBatch::radioDone(bool ok, uint16_t every, uint32_t radioMs) {
+  if (!every) every = 1;
+  r_.windows++;
+  r_.radioMs += radioMs;
+  if (ok) {
+    // Lo que no entró en la ventana sale apenas se complete otro lote
+    r_.failStreak = 0;
+    r_.nextRadio = r_.samples + (r_.count >= every ? 1 : every - r_.count);
+  } else {
+    r_.windowFails++;
+    if (r_.failStreak < SLEEP_BATCH_MAX_BACKOFF) r_.failStreak++;
+    r_.nextRadio = r_.samples + ((uint32_t)every << r_.failStreak);
+  }
+}
+
+uint32_t SleepBatch::sleepMs(uint32_t periodMs, uint32_t nowMs) {
+  uint32_t ms = nowMs + SLEEP_BATCH_MIN_SLEEP_MS <= periodMs ? periodMs - nowMs : SLEEP_BATCH_MIN_SLEEP_MS;
+  r_.awakeMs += nowMs;
+  r_.clockMs += nowMs + ms;
+  return ms;
+}
+
+// Agrega con snprintf sin pasarse de cap (el texto se trunca)
+static void append(char *buf, size_t cap, size_t &len, const char *fmt, ...) {
+  if (len + 1 >= cap) return;
+  va_list ap;
+  va_start(ap, fmt);
+  int n = vsnprintf(buf + len, cap - len, fmt, ap);
+  va_end(ap);
+  if (n > 0) len += (size_t)n < cap - len ? (size_t)n : cap - len - 1;
+}
+
+size_t SleepBatch::format(char *buf, size_t cap, uint32_t periodMs, uint32_t nowMs, uint16_t &taken) const {
+  size_t len = 0;
+  if (cap) buf[0] = '\0';
+  size_t lines = cap > kFrameMax + kLineMax ? (cap - kFrameMax) / kLineMax : 1;
+  taken = r_.count < lines * kPerLine ? r_.count : (uint16_t)(lines * kPerLine);
+
+  // Resumen de lo que va en este mensaje
+  int16_t tMin = INT16_MAX, tMax = INT16_MIN;
+  uint16_t hMin = UINT16_MAX, hMax = 0;
+  int32_t tSum = 0;
+  uint32_t hSum = 0;
+  uint16_t valid = 0;
+  for (uint16_t i = 0; i < taken; ++i) {
+    const BatchSample &s = at(i);
+    if (s.t == INT16_MIN) continue;
+    if (s.t < tMin) tMin = s.t;
+    if (s.t > tMax) tMax = s.t;
+    if (s.h < hMin) hMin = s.h;
+    if (s.h > hMax) hMax = s.h;
+    tSum += s.t;
+    hSum += s.h;
+    valid++;
+  }
+
+  append(buf, cap, len, "🌙 *Lote de %u muestra%s* (cada %lu s)\n", (unsigned)taken, taken == 1 ? "" : "s",
+         (unsigned long)(periodMs / 1000));
+  if (valid) {
+    append(buf, cap, len, "🌡️ *%.1f / %.1f / %.1f °C* _(mín/prom/máx)_\n💧 *%.0f / %.0f / %.0f %%*\n", tMin / 100.0,
+           tSum / 100.0 / valid, tMax / 100.0, hMin / 100.0, hSum / 100.0 / valid, hMax / 100.0);
+  } else {
+    append(buf, cap, len, "⚠️ Ninguna lectura válida del DHT22\n");
+  }
+  if (valid < taken || r_.lost) {
+    append(buf, cap, len, "⚠️ Fallidas: %u | perdidas sin enviar: %lu\n", (unsigned)(taken - valid),
+           (unsigned long)r_.lost);
+  }
+
+  // Las lecturas, de la más vieja a la más nueva; edad de la primera de cada fila
+  uint32_t now = r_.clockMs + nowMs;
+  for (uint16_t i = 0; i < taken; ++i) {
+    const BatchSample &s = at(i);
+    if (i % kPerLine == 0) {
+      uint32_t age = (now - s.ms) / 1000;
+      if (i) append(buf, cap, len, "\n");
+      if (age >= 600) append(buf, cap, len, "`-%lum`", (unsigned long)(age / 60));
+      else append(buf, cap, len, "`-%lus`", (unsigned long)age);
+    }
+    if (s.t == INT16_MIN) append(buf, cap, len, " --/--");
+    else append(buf, cap, len, " %.1f/%.0f", s.t / 100.0, s.h / 100.0);
+  }
+
+  append(buf, cap, len, "\n📻 Radio: %lu ms por muestra, %lu despertares\n",
+         (unsigned long)(r_.samples ? r_.radioMs / r_.samples : 0), (unsigned long)r_.wakes);
+  return len;
+}
@@ -0,0 +1,91 @@
+// ======== Muestreo por lotes con deep sleep ========
+// Para nodos a batería o solares: el ESP32 duerme entre muestras. Cada
+// despertar lee el sensor, guarda la lectura en un anillo en memoria RTC
+// (RTC_DATA_ATTR: sobrevive al deep sleep, no a un encendido) y vuelve a
+// dormir sin tocar la radio. Cada `every` muestras levanta WiFi y TLS y
+// manda las pendientes en un mensaje. Si la ventana de radio falla, las
+// muestras siguen en el anillo (lleno, pisa las más viejas y las cuenta) y
+// el próximo intento se aleja: every, 2·every, 4·every, hasta 8·every
+// muestras, para no gastar la batería contra un AP caído. En un corte largo
+// se pierden las más viejas: el anillo guarda SLEEP_BATCH_CAPACITY.
+//
+// SleepBatch sólo decide y lleva las cuentas; dormir, leer y enviar lo hace
+// el firmware, así toda la lógica corre igual en el host. Los tiempos son
+// millis() del despertar en curso: el reloj del lote (ms desde el
+// encendido, sumando lo dormido) vive en el registro RTC. El arranque
+// previo a setup() no se ve desde acá y el período real sale unos ms más
+// largo.
+#pragma once
+
+#include <Arduino.h>
+
+#ifndef SLEEP_BATCH_CAPACITY
+#define SLEEP_BATCH_CAPACITY 48    // muestras en RTC (8 bytes cada una)
+#endif
+#define SLEEP_BATCH_MAX_BACKOFF 3  // tras fallar, hasta every << 3 muestras sin radio
+#define SLEEP_BATCH_MIN_SLEEP_MS 100
+
+struct BatchSample {
+  uint32_t ms;       // reloj del lote
+  int16_t t;         // °C * 100; INT16_MIN: lectura fallida
+  uint16_t h;        // % * 100
+};
+
+// Sin constructores: el firmware lo declara RTC_DATA_ATTR
+struct SleepBatchRtc {
+  uint32_t magic;
+  uint16_t version;
+  uint16_t head;       // la más vieja pendiente
+  uint16_t count;      // pendientes
+  uint8_t failStreak;  // ventanas de radio fallidas seguidas
+  uint8_t pad;
+  uint32_t clockMs;    // reloj del lote al empezar este despertar
+  uint32_t nextRadio;  // valor de samples en el que toca la radio
+  uint32_t wakes;
+  uint32_t samples;    // lecturas guardadas (incluidas las fallidas)
+  uint32_t failed;     // lecturas fallidas
+  uint32_t lost;       // pisadas con el anillo lleno, sin enviar
+  uint32_t messages;   // mensajes enviados
+  uint32_t windows;    // ventanas de radio
+  uint32_t windowFails;
+  uint32_t awakeMs;    // total despierto (ventanas incluidas)
+  uint32_t radioMs;    // total con la radio prendida
+  BatchSample ring[SLEEP_BATCH_CAPACITY];
+};
+
+class SleepBatch {
+public:
+  explicit SleepBatch(SleepBatchRtc &rtc) : r_(rtc) {}
+
+  // retained: despertar de deep sleep. Con el registro válido suma un
+  // despertar; si no (encendido, otra versión) empieza de cero y la radio
+  // toca en este mismo despertar.
+  void begin(bool retained);
+  void clear();
+
+  // Una lectura (NaN si falló) al millis() del despertar
+  void push(float t, float h, uint32_t nowMs);
+
+  // ¿Levantar la radio en este despertar?
+  bool radioDue() const { return r_.samples >= r_.nextRadio; }
+
+  // Mensaje (Markdown de Telegram) con las pendientes más viejas que entren
+  // en cap; taken = cuántas. Devuelve el largo escrito.
+  size_t format(char *buf, size_t cap, uint32_t periodMs, uint32_t nowMs, uint16_t &taken) const;
+  // El mensaje salió: se descartan las `taken` más viejas
+  void sent(uint16_t taken);
+  // Fin de la ventana de radio (ok: salió todo lo que se intentó)
+  void radioDone(bool ok, uint16_t every, uint32_t radioMs);
+
+  // Fin del despertar: cuánto dormir para que el próximo caiga periodMs
+  // después del inicio de este. Avanza el reloj y las cuentas.
+  uint32_t sleepMs(uint32_t periodMs, uint32_t nowMs);
+
+  uint16_t pending() const { return r_.count; }
+  const SleepBatchRtc &rtc() const { return r_; }
+
+private:
+  const BatchSample &at(uint16_t i) const { return r_.ring[(r_.head + i) % SLEEP_BATCH_CAPACITY]; }
+
+  SleepBatchRtc &r_;
+};
@@ -0,0 +1,115 @@
+#include "StaticAssets.h"
+
+void StaticAssets::begin() {
+  static const char *keys[] = {"If-None-Match", "Accept-Encoding"};
+  server_.collectHeaders(keys, 2);
+}
+
+// HTML siempre se revalida (así un uploadfs nuevo se ve enseguida);
+// CSS/JS pueden quedar una hora en el navegador
+const char *StaticAssets::cacheControl(const String &path) {
+  if (path.endsWith(".html")) return "no-cache";
+  return "public, max-age=3600";
+}
+
+// Busca (o calcula y recuerda) el ETag de un archivo del FS
+StaticAssets::Meta *StaticAssets::lookup(const char *path) {
+  for (uint8_t i = 0; i < count_; ++i) {
+    if (strcmp(metas_[i].path, path) == 0) return &metas_[i];
+  }
+  if (strlen(path) >= STATIC_ASSETS_PATH_LEN) return nullptr;
+
+  uint32_t t0 = micros();
+  File f = fs_.open(path, "r");
+  stats_.fsOpens++;
+  if (!f) {  // los inexistentes no se recuerdan
+    stats_.fsUs += micros() - t0;
+    return nullptr;
+  }
+  uint32_t h = 2166136261u;
+  uint8_t buf[256];
+  size_t n, size = 0;
+  while ((n = f.read(buf, sizeof(buf))) > 0) {
+    for (size_t i = 0; i < n; ++i) { h ^= buf[i]; h *= 16777619u; }
+    size += n;
+  }
+  f.close();
+  stats_.hashed++;
+  stats_.fsUs += micros() - t0;
+
+  Meta *m;
+  if (count_ < STATIC_ASSETS_MAX) m = &metas_[count_++];
+  else { m = &metas_[next_]; next_ = (next_ + 1) % STATIC_ASSETS_MAX; }
+  memcpy(m->path, path, strlen(path) + 1);
+  snprintf(m->etag, sizeof(m->etag), "\"%x-%08x\"", (unsigned)size, (unsigned)h);
+  return m;
+}
+
+// Cabeceras de cache comunes; true si ya se contestó 304
+bool StaticAssets::notModified(const String &path, const char *etag) {
+  server_.sendHeader("ETag", etag);
+  server_.sendHeader("Cache-Control", cacheControl(path));
+  server_.sendHeader("Vary", "Accept-Encoding");
+  if (server_.header("If-None-Match") != etag) return false;
+  stats_.notModified++;
+  server_.send(304);
+  return true;
+}
+
+const EmbeddedAsset *StaticAssets::findEmbedded(const char *path, bool gzipOk) const {
+  const EmbeddedAsset *plain = nullptr;
+  for (size_t i = 0; i < embeddedCount_; ++i) {
+    const EmbeddedAsset &e = embedded_[i];
+    if (strcmp(e.path, path) != 0) continue;
+    if (e.gzip == gzipOk) return &e;
+    if (!e.gzip) plain = &e;
+  }
+  return plain;
+}
+
+bool StaticAssets::serveEmbedded(const EmbeddedAsset &e, const String &path) {
+  if (notModified(path, e.etag)) return true;
+  if (e.gzip) server_.sendHeader("Content-Encoding", "gzip");
+  server_.send_P(200, e.contentType, (PGM_P)e.data, e.length);
+  stats_.served++;
+  stats_.servedEmbedded++;
+  stats_.bytes += e.length;
+  if (e.gzip) stats_.servedGzip++;
+  return true;
+}
+
+bool StaticAssets::serveFromFs(const String &path, const String &contentType, bool gzipOk) {
+  char gzPath[STATIC_ASSETS_PATH_LEN];
+  snprintf(gzPath, sizeof(gzPath), "%s.gz", path.c_str());
+  Meta *m = gzipOk ? lookup(gzPath) : nullptr;
+  bool gz = m != nullptr;
+  if (!m) m = lookup(path.c_str());
+  if (!m) return false;
+  if (notModified(path, m->etag)) return true;
+
+  uint32_t t0 = micros();
+  File file = fs_.open(m->path, "r");
+  stats_.fsOpens++;
+  stats_.fsUs += micros() - t0;
+  if (!file) return false;
+  stats_.bytes += file.size();
+  // streamFile agrega Content-Encoding: gzip porque el nombre termina en .gz.
+  // Sin close(): AsyncHttpServer se queda con el handle y lo lee después;
+  // el archivo se cierra cuando se suelta la última copia.
+  server_.streamFile(file, contentType);
+  stats_.served++;
+  if (gz) stats_.servedGzip++;
+  return true;
+}
+
+bool StaticAssets::serve(const String &path, const String &contentType) {
+  bool gzipOk = server_.header("Accept-Encoding").indexOf("gzip") >= 0;
+  const EmbeddedAsset *e = findEmbedded(path.c_str(), gzipOk);
+#if STATIC_ASSETS_PREFER_FS
+  if (serveFromFs(path, contentType, gzipOk)) return true;
+  return e && serveEmbedded(*e, path);
+#else
+  if (e) return serveEmbedded(*e, path);
+  return serveFromFs(path, contentType, gzipOk);
+#endif
+}
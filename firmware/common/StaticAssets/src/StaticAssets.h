@@ -0,0 +1,81 @@
+// ======== Archivos estáticos con cache HTTP ========
+// Sirve /x desde el FS eligiendo /x.gz si existe y el navegador acepta gzip.
+// Cada variante lleva un ETag fuerte (tamaño + FNV-1a del contenido) que se
+// calcula la primera vez y queda en RAM: un If-None-Match que coincide se
+// contesta 304 sin abrir ningún archivo.
+//
+// Con setEmbedded() los archivos generados por tools/embed_data.py se
+// sirven directo desde la flash (send_P), sin ninguna llamada al FS. El FS
+// queda para lo que no está embebido, o primero si se compila con
+// -D STATIC_ASSETS_PREFER_FS=1 (para probar cambios con uploadfs).
+#pragma once
+
+#include <Arduino.h>
+#include <FS.h>
+#include <HttpServer.h>
+
+#ifndef STATIC_ASSETS_MAX
+#define STATIC_ASSETS_MAX 12   // variantes (plana/.gz) recordadas
+#endif
+#define STATIC_ASSETS_PATH_LEN 32
+#ifndef STATIC_ASSETS_PREFER_FS
+#define STATIC_ASSETS_PREFER_FS 0
+#endif
+
+// Archivo embebido en flash (lo genera tools/embed_data.py)
+struct EmbeddedAsset {
+  const char *path;         // "/app.js"
+  const char *contentType;
+  const uint8_t *data;      // PROGMEM
+  uint32_t length;
+  const char *etag;
+  bool gzip;                // data está comprimido con gzip
+};
+
+class StaticAssets {
+public:
+  struct Stats {
+    uint32_t served;
+    uint32_t servedGzip;
+    uint32_t servedEmbedded;
+    uint32_t notModified;
+    uint32_t hashed;      // archivos leídos enteros para calcular el ETag
+    uint32_t bytes;       // cuerpos enviados (embebidos y del FS; 304 = 0)
+    uint32_t fsOpens;
+    uint32_t fsUs;        // tiempo en abrir y hashear archivos del FS
+  };
+
+  StaticAssets(HttpServer &server, fs::FS &fs) : server_(server), fs_(fs) {}
+
+  // Llamar en setup() antes de server.begin(): pide al servidor las
+  // cabeceras If-None-Match y Accept-Encoding
+  void begin();
+  void setEmbedded(const EmbeddedAsset *assets, size_t count) { embedded_ = assets; embeddedCount_ = count; }
+
+  // false si el archivo no existe (el llamador contesta 404/500)
+  bool serve(const String &path, const String &contentType);
+
+  const Stats &stats() const { return stats_; }
+
+private:
+  struct Meta {
+    char path[STATIC_ASSETS_PATH_LEN];
+    char etag[20];
+  };
+
+  Meta *lookup(const char *path);
+  const EmbeddedAsset *findEmbedded(const char *path, bool gzipOk) const;
+  bool serveEmbedded(const EmbeddedAsset &e, const String &path);
+  bool serveFromFs(const String &path, const String &contentType, bool gzipOk);
+  bool notModified(const String &path, const char *etag);
+  static const char *cacheControl(const String &path);
+
+  HttpServer &server_;
+  fs::FS &fs_;
+  Meta metas_[STATIC_ASSETS_MAX];
+  uint8_t count_ = 0;
+  uint8_t next_ = 0;   // reemplazo circular cuando la tabla se llena
+  const EmbeddedAsset *embedded_ = nullptr;
+  size_t embeddedCount_ = 0;
+  Stats stats_ = {0, 0, 0, 0, 0, 0, 0, 0};
+};
@@ -0,0 +1,402 @@
+#include "TelegramClient.h"
+
+#include <strings.h>
+
+// ---- JSON ----
+
+static size_t jsonEscapedLen(const char *s) {
+  size_t n = 0;
+  for (; *s; ++s) {
+    unsigned char c = (unsigned char)*s;
+    if (c == '"' || c == '\\' || c == '\n' || c == '\r' || c == '\t') n += 2;
+    else if (c < 0x20) n += 6;
+    else n += 1;
+  }
+  return n;
+}
+
+void TelegramClient::putJsonString(const char *s) {
+  put("\"", 1);
+  for (; *s; ++s) {
+    unsigned char c = (unsigned char)*s;
+    switch (c) {
+      case '"':  put("\\\"", 2); break;
+      case '\\': put("\\\\", 2); break;
+      case '\n': put("\\n", 2); break;
+      case '\r': put("\\r", 2); break;
+      case '\t': put("\\t", 2); break;
+      default:
+        if (c < 0x20) {
+          char esc[7];
+          snprintf(esc, sizeof(esc), "\\u%04x", c);
+          put(esc, 6);
+        } else {
+          put(s, 1);
+        }
+    }
+  }
+  put("\"", 1);
+}
+
+static int hex4(const char *p) {
+  int v = 0;
+  for (int i = 0; i < 4; ++i) {
+    char c = p[i];
+    v <<= 4;
+    if (c >= '0' && c <= '9') v |= c - '0';
+    else if (c >= 'a' && c <= 'f') v |= c - 'a' + 10;
+    else if (c >= 'A' && c <= 'F') v |= c - 'A' + 10;
+    else return -1;
+  }
+  return v;
+}
+
+// Copia un string JSON (p apunta después de la comilla de apertura) a UTF-8
+static void jsonUnescape(const char *p, char *out, size_t cap) {
+  size_t n = 0;
+  while (*p && *p != '"' && n + 1 < cap) {
+    if (*p != '\\') {
+      out[n++] = *p++;
+      continue;
+    }
+    ++p;
+    char c = *p++;
+    if (c == 'n') out[n++] = '\n';
+    else if (c == 't') out[n++] = '\t';
+    else if (c == 'r') out[n++] = '\r';
+    else if (c == 'b' || c == 'f') continue;
+    else if (c != 'u') out[n++] = c;  // \" \\ \/
+    else {
+      long cp = hex4(p);
+      if (cp < 0) break;
+      p += 4;
+      if (cp >= 0xD800 && cp < 0xDC00 && p[0] == '\\' && p[1] == 'u') {  // par sustituto (emojis)
+        int lo = hex4(p + 2);
+        if (lo >= 0xDC00 && lo < 0xE000) {
+          cp = 0x10000 + ((cp - 0xD800) << 10) + (lo - 0xDC00);
+          p += 6;
+        }
+      }
+      char u[4];
+      size_t k;
+      if (cp < 0x80) { u[0] = (char)cp; k = 1; }
+      else if (cp < 0x800) { u[0] = (char)(0xC0 | (cp >> 6)); u[1] = (char)(0x80 | (cp & 0x3F)); k = 2; }
+      else if (cp < 0x10000) {
+        u[0] = (char)(0xE0 | (cp >> 12)); u[1] = (char)(0x80 | ((cp >> 6) & 0x3F));
+        u[2] = (char)(0x80 | (cp & 0x3F)); k = 3;
+      } else {
+        u[0] = (char)(0xF0 | (cp >> 18)); u[1] = (char)(0x80 | ((cp >> 12) & 0x3F));
+        u[2] = (char)(0x80 | ((cp >> 6) & 0x3F)); u[3] = (char)(0x80 | (cp & 0x3F)); k = 4;
+      }
+      if (n + k >= cap) break;
+      memcpy(out + n, u, k);
+      n += k;
+    }
+  }
+  out[n] = '\0';
+}
+
+// Recorrido mínimo de JSON sobre [p, end): alcanza para ubicar claves de un
+// objeto sin confundirlas con las de objetos anidados (reply_to_message...)
+static const char *skipWs(const char *p, const char *end) {
+  while (p < end && (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t')) ++p;
+  return p;
+}
+
+// Fin del valor que empieza en p, o nullptr si el cuerpo se corta antes
+static const char *skipValue(const char *p, const char *end) {
+  int depth = 0;
+  bool str = false;
+  for (; p < end; ++p) {
+    char c = *p;
+    if (str) {
+      if (c == '\\') ++p;
+      else if (c == '"') {
+        str = false;
+        if (depth == 0) return p + 1;
+      }
+    } else if (c == '"') {
+      str = true;
+    } else if (c == '{' || c == '[') {
+      ++depth;
+    } else if (c == '}' || c == ']') {
+      if (depth == 0) return p;  // fin del escalar dentro del contenedor
+      if (--depth == 0) return p + 1;
+    } else if (depth == 0 && (c == ',' || c == ' ' || c == '\n' || c == '\r' || c == '\t')) {
+      return p;
+    }
+  }
+  return nullptr;
+}
+
+// Valor de la clave key en el objeto que empieza en obj ('{'), sólo en su
+// primer nivel; nullptr si no está o el objeto se corta antes
+static const char *findKey(const char *obj, const char *end, const char *key) {
+  size_t len = strlen(key);
+  const char *p = skipWs(obj, end);
+  if (p >= end || *p != '{') return nullptr;
+  ++p;
+  for (;;) {
+    p = skipWs(p, end);
+    if (p >= end || *p != '"') return nullptr;
+    const char *k = p + 1;
+    p = skipValue(p, end);
+    if (!p) return nullptr;
+    bool match = (size_t)(p - 1 - k) == len && memcmp(k, key, len) == 0;
+    p = skipWs(p, end);
+    if (p >= end || *p != ':') return nullptr;
+    p = skipWs(p + 1, end);
+    if (match) return p < end ? p : nullptr;
+    p = skipValue(p, end);
+    if (!p) return nullptr;
+    p = skipWs(p, end);
+    if (p >= end || *p != ',') return nullptr;
+    ++p;
+  }
+}
+
+// ---- HTTP ----
+
+// Valor de una cabecera (nombre en minúsculas) dentro del bloque de cabeceras
+static const char *findHeader(const char *headers, const char *name) {
+  size_t len = strlen(name);
+  for (const char *line = strstr(headers, "\r\n"); line; line = strstr(line + 2, "\r\n")) {
+    const char *h = line + 2;
+    size_t i = 0;
+    while (i < len && h[i] && (h[i] | 0x20) == name[i]) ++i;
+    if (i == len && h[i] == ':') {
+      h += len + 1;
+      while (*h == ' ') ++h;
+      return h;
+    }
+  }
+  return nullptr;
+}
+
+bool TelegramClient::open() {
+  stats_.requests++;
+  txLen_ = 0;
+  txError_ = false;
+  reused_ = keepAlive_ && net_.connected();
+  if (reused_) {
+    stats_.reused++;
+    return true;
+  }
+  net_.stop();
+  uint32_t t0 = millis();
+  if (!net_.connect(TELEGRAM_HOST, TELEGRAM_PORT)) {
+    stats_.netErrors++;
+    return false;
+  }
+  uint32_t ms = millis() - t0;
+  stats_.connects++;
+  stats_.connectMsSum += ms;
+  if (ms > stats_.connectMsMax) stats_.connectMsMax = ms;
+  return true;
+}
+
+// El servidor cerró (EOF o RST) una conexión reusada antes de mandar nada:
+// la había cerrado por ociosa y la petición no llegó a procesarse. Se repite
+// una vez por una conexión nueva. Un timeout no: la petición pudo haberse
+// procesado y un sendMessage repetido llega dos veces.
+bool TelegramClient::stale(const Result &r) {
+  if (r.status != 0 || !idleClosed_) return false;
+  stats_.staleRetries++;
+  return true;
+}
+
+void TelegramClient::put(const char *s, size_t len) {
+  while (len > 0) {
+    if (txLen_ == sizeof(tx_) && !flushTx()) return;
+    size_t n = sizeof(tx_) - txLen_;
+    if (n > len) n = len;
+    memcpy(tx_ + txLen_, s, n);
+    txLen_ += n;
+    s += n;
+    len -= n;
+  }
+}
+
+bool TelegramClient::flushTx() {
+  if (txError_) return false;
+  if (txLen_ > 0 && net_.write((const uint8_t *)tx_, txLen_) != txLen_) txError_ = true;
+  txLen_ = 0;
+  return !txError_;
+}
+
+int TelegramClient::readSome(char *dst, size_t cap, uint32_t deadline) {
+  for (;;) {
+    int avail = net_.available();
+    if (avail > 0) return net_.read((uint8_t *)dst, (size_t)avail < cap ? (size_t)avail : cap);
+    if (!net_.connected()) return 0;
+    if ((int32_t)(millis() - deadline) >= 0) return -1;
+    delay(1);
+  }
+}
+
+// Manda lo que quede en tx_ y lee la respuesta: cuerpo en rx_[0..bodyLen_).
+// La conexión sigue abierta sólo si la respuesta llegó entera y el servidor
+// no pidió cerrar.
+TelegramClient::Result TelegramClient::finish(uint32_t timeoutMs) {
+  Result r = {0, 0};
+  bool keep = false;
+  bodyLen_ = 0;
+  rx_[0] = '\0';
+  uint32_t deadline = millis() + timeoutMs;
+  size_t len = 0;
+  gotBytes_ = false;
+  bool closed = true;   // sin respuesta porque el servidor cerró (no por timeout)
+  char *body = nullptr;
+  if (flushTx()) {
+    while (!body && len < TELEGRAM_RX_BUF) {
+      int n = readSome(rx_ + len, TELEGRAM_RX_BUF - len, deadline);
+      if (n <= 0) {
+        closed = n == 0;
+        break;
+      }
+      len += (size_t)n;
+      rx_[len] = '\0';
+      gotBytes_ = true;
+      body = strstr(rx_, "\r\n\r\n");
+    }
+  }
+  if (body && strncmp(rx_, "HTTP/1.", 7) == 0) {
+    body[2] = '\0';  // corta las cabeceras para buscar en ellas
+    r.status = atoi(rx_ + 9);
+    const char *cl = findHeader(rx_, "content-length");
+    const char *conn = findHeader(rx_, "connection");
+    keep = keepAlive_ && cl && !(conn && strncasecmp(conn, "close", 5) == 0);
+    size_t want = cl ? strtoul(cl, nullptr, 10) : (size_t)-1;
+    bodyLen_ = len - (size_t)(body + 4 - rx_);
+    memmove(rx_, body + 4, bodyLen_);
+    size_t got = bodyLen_;   // lo que no entra en rx_ se lee y se descarta
+    while (got < want) {
+      char discard[64];
+      bool full = bodyLen_ >= TELEGRAM_RX_BUF;
+      int n = full ? readSome(discard, sizeof(discard), deadline)
+                   : readSome(rx_ + bodyLen_, TELEGRAM_RX_BUF - bodyLen_, deadline);
+      if (n <= 0) {
+        if (cl) r.status = 0;  // cuerpo incompleto
+        break;
+      }
+      got += (size_t)n;
+      if (!full) bodyLen_ += (size_t)n;
+    }
+    if (bodyLen_ > TELEGRAM_RX_BUF) bodyLen_ = TELEGRAM_RX_BUF;
+    rx_[bodyLen_] = '\0';
+  }
+  if (r.status == 0 || !keep) net_.stop();
+
+  idleClosed_ = reused_ && !gotBytes_ && closed;
+  if (r.status == 0) {
+    if (!idleClosed_) stats_.netErrors++;  // si no, stale() lo repite
+  } else if (r.status != 200) {
+    stats_.httpErrors++;
+    if (r.status == 429) {
+      stats_.tooMany++;
+      const char *ra = strstr(rx_, "\"retry_after\":");
+      r.retryAfterS = ra ? (uint16_t)atoi(ra + 14) : 1;
+    }
+  }
+  return r;
+}
+
+// ---- API ----
+
+TelegramClient::Result TelegramClient::sendMessage(const char *chatId, const char *text, const char *parseMode) {
+  uint32_t t0 = millis();
+  bool pm = parseMode && *parseMode;
+  size_t bodyLen = 11 + jsonEscapedLen(chatId) + 2 + 8 + jsonEscapedLen(text) + 2 + 1;  // {"chat_id":"…","text":"…"}
+  if (pm) bodyLen += 14 + jsonEscapedLen(parseMode) + 2;                               // ,"parse_mode":"…"
+  char line[64];
+  Result r = {0, 0};
+
+  for (int attempt = 0; attempt < 2; ++attempt) {
+    if (!open()) break;
+    put("POST /bot");
+    put(token_);
+    put("/sendMessage HTTP/1.1\r\nHost: " TELEGRAM_HOST "\r\nContent-Type: application/json\r\n");
+    if (!keepAlive_) put("Connection: close\r\n");
+    snprintf(line, sizeof(line), "Content-Length: %u\r\n\r\n", (unsigned)bodyLen);
+    put(line);
+    put("{\"chat_id\":");
+    putJsonString(chatId);
+    put(",\"text\":");
+    putJsonString(text);
+    if (pm) {
+      put(",\"parse_mode\":");
+      putJsonString(parseMode);
+    }
+    put("}");
+    r = finish(timeoutMs_);
+    if (!stale(r)) break;
+  }
+
+  uint32_t ms = millis() - t0;
+  stats_.sends++;
+  stats_.sendMsSum += ms;
+  if (ms > stats_.sendMsMax) stats_.sendMsMax = ms;
+  return r;
+}
+
+int TelegramClient::getUpdates(int pollS, Update *out, int max) {
+  char line[96];
+  snprintf(line, sizeof(line), "/getUpdates?offset=%ld&timeout=%d&limit=%d HTTP/1.1\r\n", lastUpdateId + 1, pollS,
+           max);
+  Result r = {0, 0};
+  for (int attempt = 0; attempt < 2; ++attempt) {
+    if (!open()) return -1;
+    put("GET /bot");
+    put(token_);
+    put(line);
+    put(keepAlive_ ? "Host: " TELEGRAM_HOST "\r\n\r\n" : "Host: " TELEGRAM_HOST "\r\nConnection: close\r\n\r\n");
+    r = finish((uint32_t)pollS * 1000UL + timeoutMs_);
+    if (!stale(r)) break;
+  }
+  const char *end = rx_ + bodyLen_;
+  const char *ok = findKey(rx_, end, "ok");
+  const char *result = findKey(rx_, end, "result");
+  if (r.status != 200 || !ok || strncmp(ok, "true", 4) != 0 || !result || *result != '[') return -1;
+
+  // Un update cuenta sólo si llegó entero: el resto del cuerpo pudo quedar
+  // afuera de rx_ y vuelve en el próximo poll. Si ni el primero entra, no
+  // va a entrar nunca: se saltea para no pedirlo para siempre.
+  int n = 0;
+  const char *p = result + 1;
+  while (n < max) {
+    p = skipWs(p, end);
+    if (p < end && *p == ',') p = skipWs(p + 1, end);
+    if (p >= end || *p != '{') break;
+    const char *close = skipValue(p, end);
+    const char *id = findKey(p, end, "update_id");
+    if (!close) {
+      if (n == 0 && id) {
+        long skipped = strtol(id, nullptr, 10);
+        if (skipped > lastUpdateId) lastUpdateId = skipped;
+        stats_.skippedUpdates++;
+      }
+      break;
+    }
+    Update &u = out[n];
+    u.id = id ? strtol(id, nullptr, 10) : 0;
+    u.chatId[0] = '\0';
+    u.text[0] = '\0';
+    const char *msg = findKey(p, close, "message");
+    const char *chat = msg && *msg == '{' ? findKey(msg, close, "chat") : nullptr;
+    const char *chatId = chat && *chat == '{' ? findKey(chat, close, "id") : nullptr;
+    if (chatId) {
+      size_t k = 0;
+      while (k + 1 < sizeof(u.chatId) && (chatId[k] == '-' || (chatId[k] >= '0' && chatId[k] <= '9'))) {
+        u.chatId[k] = chatId[k];
+        ++k;
+      }
+      u.chatId[k] = '\0';
+    }
+    const char *text = msg && *msg == '{' ? findKey(msg, close, "text") : nullptr;
+    if (text && *text == '"') jsonUnescape(text + 1, u.text, sizeof(u.text));
+    if (u.id > lastUpdateId) lastUpdateId = u.id;
+    ++n;
+    p = close;
+  }
+  return n;
+}
@@ -0,0 +1,103 @@
+// ======== Cliente mínimo de la Bot API de Telegram ========
+// Reemplaza a UniversalTelegramBot en el bot: devuelve el código HTTP y el
+// retry_after de un 429 (sin eso no se pueden respetar los límites de
+// Telegram), arma las peticiones en un buffer fijo sin Strings y del JSON de
+// getUpdates sólo saca lo que usa el bot (update_id, message.chat.id y
+// message.text).
+//
+// La conexión TLS queda abierta entre peticiones (keep-alive): polls y
+// envíos van por el mismo socket y el handshake (cientos de ms de CPU en el
+// ESP32) se paga sólo al reconectar. Si Telegram cerró una conexión ociosa
+// (EOF o RST antes del primer byte de la respuesta) la petición se repite
+// una vez por una conexión nueva. Un timeout no se repite: la petición pudo
+// haber llegado y un sendMessage saldría dos veces.
+#pragma once
+
+#include <Arduino.h>
+#include <Client.h>
+
+#ifndef TELEGRAM_HOST
+#define TELEGRAM_HOST "api.telegram.org"
+#endif
+#ifndef TELEGRAM_PORT
+#define TELEGRAM_PORT 443
+#endif
+#ifndef TELEGRAM_TX_BUF
+#define TELEGRAM_TX_BUF 512    // se vacía al socket cuando se llena
+#endif
+#ifndef TELEGRAM_RX_BUF
+#define TELEGRAM_RX_BUF 2048   // cuerpo de respuesta; getUpdates pide pocos updates por vez
+#endif
+
+class TelegramClient {
+public:
+  struct Result {
+    int status;             // código HTTP; 0 = sin respuesta (red, TLS o timeout)
+    uint16_t retryAfterS;   // 429: segundos que pide Telegram
+  };
+
+  struct Update {
+    long id;
+    char chatId[24];
+    char text[96];          // truncado (UTF-8 puede quedar cortado al final)
+  };
+
+  struct Stats {
+    uint32_t requests;
+    uint32_t connects;      // conexiones nuevas (= handshakes TLS)
+    uint32_t reused;        // peticiones sobre una conexión ya abierta
+    uint32_t staleRetries;  // conexión cerrada por el servidor sin contestar: se repitió
+    uint32_t netErrors;     // sin conexión, timeout o respuesta inválida
+    uint32_t httpErrors;    // respuestas != 200
+    uint32_t tooMany;       // 429
+    uint32_t connectMsSum;  // TCP + handshake
+    uint32_t connectMsMax;
+    uint32_t sends;         // sendMessage terminados (con o sin éxito)
+    uint32_t sendMsSum;     // petición completa, incluida la conexión
+    uint32_t sendMsMax;
+    uint32_t skippedUpdates; // updates que no entran en TELEGRAM_RX_BUF
+  };
+
+  TelegramClient(Client &net, const char *token) : net_(net), token_(token) {}
+
+  void setTimeout(uint32_t ms) { timeoutMs_ = ms; }
+  // false: "Connection: close" y una conexión por petición (como antes)
+  void setKeepAlive(bool on) { keepAlive_ = on; }
+  // Cierra la conexión (p. ej. si se cayó el WiFi)
+  void stop() { net_.stop(); }
+
+  Result sendMessage(const char *chatId, const char *text, const char *parseMode = "");
+
+  // Long poll de hasta pollS segundos. Devuelve cuántos updates dejó en out
+  // (como mucho max) o -1 si falló. lastUpdateId avanza solo, hasta el
+  // último update que llegó entero. chatId y text salen del "message" del
+  // update (vacíos si es otro tipo de update o no tiene texto).
+  int getUpdates(int pollS, Update *out, int max);
+
+  long lastUpdateId = 0;
+  const Stats &stats() const { return stats_; }
+
+private:
+  bool open();
+  bool stale(const Result &r);
+  void put(const char *s, size_t len);
+  void put(const char *s) { put(s, strlen(s)); }
+  void putJsonString(const char *s);
+  bool flushTx();
+  Result finish(uint32_t timeoutMs);
+  int readSome(char *dst, size_t cap, uint32_t deadline);
+
+  Client &net_;
+  const char *token_;
+  uint32_t timeoutMs_ = 12000;
+  bool keepAlive_ = true;
+  bool reused_ = false;    // la petición en curso va por una conexión vieja
+  bool gotBytes_ = false;  // y ya llegó algo de la respuesta
+  bool idleClosed_ = false; // el servidor la cerró sin contestar nada
+  char tx_[TELEGRAM_TX_BUF];
+  size_t txLen_ = 0;
+  bool txError_ = false;
+  char rx_[TELEGRAM_RX_BUF + 1];
+  size_t bodyLen_ = 0;
+  Stats stats_ = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+};
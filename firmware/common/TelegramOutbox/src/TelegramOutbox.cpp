@@ -0,0 +1,151 @@
+#include "TelegramOutbox.h"
+
+// Comparaciones de millis() seguras ante el desborde
+static bool after(uint32_t a, uint32_t b) { return (int32_t)(a - b) > 0; }
+static uint32_t later(uint32_t a, uint32_t b) { return after(a, b) ? a : b; }
+
+static bool isGroup(const char *chatId) { return chatId[0] == '@' || chatId[0] == '-'; }
+
+// Copia text cortando en un borde de carácter UTF-8; true si entró entero
+static bool copyText(char *dst, const char *text) {
+  size_t len = strlen(text);
+  bool fits = len < OUTBOX_TEXT;
+  if (!fits) {
+    len = OUTBOX_TEXT - 1;
+    while (len > 0 && ((unsigned char)text[len] & 0xC0) == 0x80) --len;
+  }
+  memcpy(dst, text, len);
+  dst[len] = '\0';
+  return fits;
+}
+
+bool TelegramOutbox::push(const char *chatId, const char *text, const char *parseMode, Kind kind, uint32_t nowMs) {
+  Slot *s = nullptr;
+  if (kind == TELEMETRY) {
+    for (Slot &c : slots_) {
+      if (c.state == PENDING && c.kind == TELEMETRY && strcmp(c.msg.chatId, chatId) == 0) {
+        s = &c;
+        stats_.coalesced++;
+        break;
+      }
+    }
+  }
+  if (!s) {
+    for (Slot &c : slots_) {
+      if (c.state == FREE) { s = &c; break; }
+    }
+    if (!s) {
+      stats_.dropped++;
+      return false;
+    }
+    s->state = PENDING;
+    s->kind = kind;
+    s->seq = seq_++;
+    s->notBefore = nowMs;
+    snprintf(s->msg.chatId, sizeof(s->msg.chatId), "%s", chatId);
+    depth_++;
+    if (depth_ > stats_.maxDepth) stats_.maxDepth = depth_;
+    stats_.queued++;
+  }
+  s->attempts = 0;
+  snprintf(s->msg.parseMode, sizeof(s->msg.parseMode), "%s", parseMode ? parseMode : "");
+  if (!copyText(s->msg.text, text)) stats_.truncated++;
+  return true;
+}
+
+uint32_t TelegramOutbox::chatNext(const char *chatId) const {
+  for (const ChatClock &c : chats_) {
+    if (c.chatId[0] && strcmp(c.chatId, chatId) == 0) return c.nextMs;
+  }
+  return globalNext_;
+}
+
+// -1 si el slot no puede salir (vacío, en vuelo o detrás de otro del mismo
+// chat); si puede, readyAt es desde cuándo
+int TelegramOutbox::eligible(int i, uint32_t nowMs, uint32_t &readyAt) const {
+  const Slot &s = slots_[i];
+  if (s.state != PENDING) return -1;
+  for (const Slot &o : slots_) {
+    if (&o == &s || o.state == FREE || strcmp(o.msg.chatId, s.msg.chatId) != 0) continue;
+    if (o.state == SENDING || (int32_t)(o.seq - s.seq) < 0) return -1;
+  }
+  readyAt = later(later(nowMs, s.notBefore), later(chatNext(s.msg.chatId), globalNext_));
+  return i;
+}
+
+const TelegramOutbox::Msg *TelegramOutbox::next(uint32_t nowMs, int &id) {
+  // Relojes vencidos -> "ahora": así nunca quedan a más de 2^31 ms de millis()
+  if (!after(globalNext_, nowMs)) globalNext_ = nowMs;
+  for (ChatClock &c : chats_) {
+    if (!after(c.nextMs, nowMs)) c.nextMs = nowMs;
+  }
+  for (Slot &s : slots_) {
+    if (s.state == PENDING && !after(s.notBefore, nowMs)) s.notBefore = nowMs;
+  }
+
+  id = -1;
+  for (int i = 0; i < OUTBOX_SLOTS; ++i) {
+    uint32_t readyAt;
+    if (eligible(i, nowMs, readyAt) < 0 || after(readyAt, nowMs)) continue;
+    if (id < 0 || (int32_t)(slots_[i].seq - slots_[id].seq) < 0) id = i;
+  }
+  if (id < 0) return nullptr;
+  slots_[id].state = SENDING;
+  slots_[id].attempts++;
+  return &slots_[id].msg;
+}
+
+void TelegramOutbox::markSent(const char *chatId, uint32_t nowMs) {
+  ChatClock *slot = nullptr;
+  for (ChatClock &c : chats_) {
+    if (c.chatId[0] && strcmp(c.chatId, chatId) == 0) { slot = &c; break; }
+    // Si no está: uno libre o, si no hay, el que venció hace más tiempo
+    if (!slot || (slot->chatId[0] && (!c.chatId[0] || after(slot->nextMs, c.nextMs)))) slot = &c;
+  }
+  snprintf(slot->chatId, sizeof(slot->chatId), "%s", chatId);
+  slot->nextMs = nowMs + (isGroup(chatId) ? OUTBOX_GROUP_GAP_MS : OUTBOX_CHAT_GAP_MS);
+  globalNext_ = later(globalNext_, nowMs + OUTBOX_GLOBAL_GAP_MS);
+}
+
+void TelegramOutbox::complete(int id, int httpStatus, uint32_t retryAfterMs, uint32_t nowMs) {
+  if (id < 0 || id >= OUTBOX_SLOTS || slots_[id].state != SENDING) return;
+  Slot &s = slots_[id];
+  bool retry = false;
+  if (httpStatus == 200) {
+    stats_.sent++;
+    markSent(s.msg.chatId, nowMs);
+  } else if (httpStatus == 429) {
+    stats_.rateLimited++;
+    globalNext_ = later(globalNext_, nowMs + retryAfterMs);
+    s.notBefore = nowMs + retryAfterMs;
+    retry = true;
+  } else if (httpStatus >= 400 && httpStatus < 500) {
+    stats_.rejected++;
+    markSent(s.msg.chatId, nowMs);
+  } else {
+    uint32_t backoff = OUTBOX_BACKOFF_BASE_MS << (s.attempts - 1 < 16 ? s.attempts - 1 : 16);
+    if (backoff > OUTBOX_BACKOFF_MAX_MS) backoff = OUTBOX_BACKOFF_MAX_MS;
+    s.notBefore = nowMs + backoff / 2 + (uint32_t)random((long)(backoff / 2 + 1));
+    retry = true;
+  }
+
+  if (retry && s.attempts < OUTBOX_MAX_ATTEMPTS) {
+    stats_.retries++;
+    s.state = PENDING;
+    return;
+  }
+  if (retry) stats_.expired++;
+  s.state = FREE;
+  depth_--;
+}
+
+uint32_t TelegramOutbox::waitMs(uint32_t nowMs) const {
+  uint32_t best = UINT32_MAX;
+  for (int i = 0; i < OUTBOX_SLOTS; ++i) {
+    uint32_t readyAt;
+    if (eligible(i, nowMs, readyAt) < 0) continue;
+    uint32_t w = after(readyAt, nowMs) ? readyAt - nowMs : 0;
+    if (w < best) best = w;
+  }
+  return best;
+}
@@ -0,0 +1,108 @@
+// ======== Cola de salida de Telegram ========
+// Slots fijos (nada de heap). Quien produce mensajes hace push() y sigue;
+// la tarea de red pide next(), envía sin tener la cola tomada y avisa el
+// resultado con complete(). No es thread-safe: el sketch la protege con un
+// mutex que nunca se tiene durante un envío.
+//
+//  - Telemetría: un mensaje nuevo para un chat que ya tiene telemetría
+//    esperando la reemplaza (coalescing); la lectura vieja no sirve.
+//  - Orden: por chat se respeta el orden de llegada.
+//  - Límites de Telegram: ~1 msg/s por chat privado, 20/min en grupos y
+//    canales (un envío cada 3 s), ~30/s en total. Un 429 frena todo lo que
+//    pida retry_after.
+//  - Errores de red o 5xx: reintento con backoff exponencial y jitter
+//    (mitad fija, mitad al azar); después de OUTBOX_MAX_ATTEMPTS se
+//    descarta. Otros 4xx no se reintentan.
+#pragma once
+
+#include <Arduino.h>
+
+#ifndef OUTBOX_SLOTS
+#define OUTBOX_SLOTS 8
+#endif
+#ifndef OUTBOX_TEXT
+#define OUTBOX_TEXT 1024         // el mensaje más largo (/status) ronda los 900 bytes
+#endif
+#ifndef OUTBOX_CHATS
+#define OUTBOX_CHATS 6           // chats con límite de envío registrado
+#endif
+#ifndef OUTBOX_MAX_ATTEMPTS
+#define OUTBOX_MAX_ATTEMPTS 6
+#endif
+#ifndef OUTBOX_BACKOFF_BASE_MS
+#define OUTBOX_BACKOFF_BASE_MS 1000
+#endif
+#ifndef OUTBOX_BACKOFF_MAX_MS
+#define OUTBOX_BACKOFF_MAX_MS 60000
+#endif
+#define OUTBOX_CHAT_GAP_MS 1000   // chat privado
+#define OUTBOX_GROUP_GAP_MS 3000  // grupo o canal (id negativo o @nombre)
+#define OUTBOX_GLOBAL_GAP_MS 34
+
+class TelegramOutbox {
+public:
+  enum Kind : uint8_t { REPLY, TELEMETRY };
+
+  struct Msg {
+    char chatId[24];
+    char parseMode[12];
+    char text[OUTBOX_TEXT];
+  };
+
+  struct Stats {
+    uint32_t queued;
+    uint32_t coalesced;     // telemetría reemplazada antes de salir
+    uint32_t sent;
+    uint32_t retries;       // reintentos programados (red, 5xx, 429)
+    uint32_t rateLimited;   // 429 recibidos
+    uint32_t dropped;       // cola llena
+    uint32_t expired;       // agotó los intentos
+    uint32_t rejected;      // 4xx: no tiene sentido reintentar
+    uint32_t truncated;
+    uint8_t maxDepth;
+  };
+
+  // false si no hay lugar: el mensaje se pierde (y se cuenta)
+  bool push(const char *chatId, const char *text, const char *parseMode, Kind kind, uint32_t nowMs);
+
+  // Próximo mensaje que puede salir ya, o nullptr. El puntero sigue válido
+  // (y el slot reservado) hasta complete(id, ...).
+  const Msg *next(uint32_t nowMs, int &id);
+
+  // httpStatus 0 = sin respuesta; retryAfterMs sólo para 429
+  void complete(int id, int httpStatus, uint32_t retryAfterMs, uint32_t nowMs);
+
+  // Cuánto falta para que algo pueda salir (0 = ya; UINT32_MAX = nada pendiente)
+  uint32_t waitMs(uint32_t nowMs) const;
+
+  uint8_t depth() const { return depth_; }
+  const Stats &stats() const { return stats_; }
+
+private:
+  enum State : uint8_t { FREE, PENDING, SENDING };
+
+  struct Slot {
+    State state = FREE;
+    Kind kind = REPLY;
+    uint8_t attempts = 0;
+    uint32_t seq = 0;
+    uint32_t notBefore = 0;  // backoff
+    Msg msg;
+  };
+
+  struct ChatClock {
+    char chatId[24];
+    uint32_t nextMs;         // no enviar a este chat antes de esto
+  };
+
+  int eligible(int i, uint32_t nowMs, uint32_t &readyAt) const;
+  uint32_t chatNext(const char *chatId) const;
+  void markSent(const char *chatId, uint32_t nowMs);
+
+  Slot slots_[OUTBOX_SLOTS];
+  ChatClock chats_[OUTBOX_CHATS] = {};
+  uint32_t seq_ = 0;
+  uint32_t globalNext_ = 0;
+  uint8_t depth_ = 0;
+  Stats stats_ = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+};
@@ -1,18 +1,277 @@
+/****************************************************
+ * ESP32 Lumus: nivel de luz con el ADC en modo continuo
+ * - LDR/fototransistor en GPIO34 (ADC1_CH6), muestreado por DMA a 20 kHz
+ * - Tramas dobles: una se llena mientras la otra se procesa
+ * - Caja 20 kHz -> 1 kHz, FIR pasabajos 1 kHz -> 100 Hz (nivel sin el
+ *   parpadeo de 100/120 Hz de la red)
+ * - Por ventana de 1 s: mín/máx/media/RMS crudos, nivel y % de parpadeo
+ * - /api/latest con la última ventana, como los otros firmwares
+ * - WiFiManager + mDNS (lumus-XXXX.local)
+ ****************************************************/
 #include <Arduino.h>
+#include <WiFi.h>
+#include <HttpServer.h>
+#include <time.h>
+#include <JsonStream.h>
+#include <AdcFilter.h>
+#include <WiFiManager.h>   // https://github.com/tzapu/WiFiManager
+#include <ESPmDNS.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/queue.h>
+#include <driver/adc.h>    // modo continuo (DMA) de ESP-IDF 4.4
 
-// put function declarations here:
-int myFunction(int, int);
+// ======== SERVIDOR ========
+HttpServer server(80);
 
+// ======== UTIL FECHA/HORA (Argentina) ========
+static const long  gmtOffset_sec = -3 * 3600; // UTC-3
+static const int   daylightOffset_sec = 0;    // sin DST
+static const char* ntpServer = "pool.ntp.org";
+
+// ======== ADC CONTINUO ========
+#define LIGHT_CHANNEL ADC1_CHANNEL_6          // GPIO34 (sólo entrada)
+const uint32_t ADC_RATE_HZ = 20000;           // mínimo del modo DMA
+const size_t FRAME_SAMPLES = 1000;            // 50 ms por trama
+const uint32_t ADC_BUFFER_FRAMES = 4;         // ringbuffer del driver
+const uint32_t WINDOW_MS = 1000;              // estadísticas por ventana
+const uint32_t WINDOW_SAMPLES = ADC_RATE_HZ / 1000 * WINDOW_MS;
+
+// ======== FILTROS ========
+const uint16_t BOX_FACTOR = 20;               // 20 kHz -> 1 kHz
+const uint16_t FIR_TAPS = 64;
+const uint16_t FIR_FACTOR = 10;               // 1 kHz -> 100 Hz
+const float FIR_CUTOFF = 0.03f;               // 30 Hz a 1 kHz: 100/120 Hz quedan en la banda de rechazo
+const size_t MID_SAMPLES = FRAME_SAMPLES / BOX_FACTOR + 1;
+const size_t LEVEL_SAMPLES = MID_SAMPLES / FIR_FACTOR + 1;
+
+// Tramas dobles: el lector llena una mientras el DSP procesa la otra. Los
+// índices circulan entre freeQ (vacías) y readyQ (llenas); sin trama libre
+// el lector descarta la que acaba de leer y lo cuenta.
+uint16_t frames[2][FRAME_SAMPLES];
+size_t frameLen[2];
+QueueHandle_t freeQ, readyQ;
+
+// Lo que publica cada ventana (copiable por valor a la cola)
+struct LightWindow {
+  AdcSummary adc;       // muestras crudas de la ventana
+  float level;          // media del nivel filtrado (cuentas)
+  float levelMin, levelMax;
+  float flicker;        // % de parpadeo: (máx - mín) / (máx + mín) a 1 kHz
+  float dspLoad;        // % del tiempo de la ventana que usó el DSP
+  uint32_t dropped;     // tramas descartadas por falta de trama libre (total)
+  uint32_t overruns;    // desbordes del ringbuffer del driver (total)
+  uint32_t ms;          // millis() al cerrar la ventana
+};
+QueueHandle_t windowQ;  // largo 1: la última ventana (xQueueOverwrite)
+
+volatile uint32_t droppedFrames = 0;
+volatile uint32_t adcOverruns = 0;
+
+// ======== TAREAS ========
+bool startAdc() {
+  adc_digi_init_config_t init = {};
+  init.max_store_buf_size = ADC_BUFFER_FRAMES * FRAME_SAMPLES * sizeof(adc_digi_output_data_t);
+  init.conv_num_each_intr = FRAME_SAMPLES * sizeof(adc_digi_output_data_t);
+  init.adc1_chan_mask = BIT(LIGHT_CHANNEL);
+  if (adc_digi_initialize(&init) != ESP_OK) return false;
+
+  adc_digi_pattern_config_t pattern = {};
+  pattern.atten = ADC_ATTEN_DB_11;            // 0..~3,1 V
+  pattern.channel = LIGHT_CHANNEL;
+  pattern.unit = 0;                           // ADC1
+  pattern.bit_width = SOC_ADC_DIGI_MAX_BITWIDTH;
+
+  adc_digi_configuration_t cfg = {};
+  cfg.conv_limit_en = true;                   // obligatorio en el ESP32
+  cfg.conv_limit_num = 250;
+  cfg.pattern_num = 1;
+  cfg.adc_pattern = &pattern;
+  cfg.sample_freq_hz = ADC_RATE_HZ;
+  cfg.conv_mode = ADC_CONV_SINGLE_UNIT_1;
+  cfg.format = ADC_DIGI_OUTPUT_FORMAT_TYPE1;
+  if (adc_digi_controller_configure(&cfg) != ESP_OK) return false;
+  return adc_digi_start() == ESP_OK;
+}
+
+// Lee tramas del DMA directo a una trama libre y la pasa al DSP
+void adcTask(void *) {
+  static uint16_t spare[FRAME_SAMPLES];  // destino cuando el DSP no soltó ninguna
+  for (;;) {
+    uint8_t idx;
+    bool haveFrame = xQueueReceive(freeQ, &idx, 0) == pdTRUE;
+    uint16_t *dst = haveFrame ? frames[idx] : spare;
+
+    uint32_t bytes = 0;
+    esp_err_t err = adc_digi_read_bytes((uint8_t *)dst, FRAME_SAMPLES * sizeof(adc_digi_output_data_t), &bytes,
+                                        ADC_MAX_DELAY);
+    if (err == ESP_ERR_INVALID_STATE) adcOverruns++;  // se perdieron muestras, las leídas sirven
+    else if (err != ESP_OK) bytes = 0;
+
+    size_t n = bytes / sizeof(adc_digi_output_data_t);
+    if (!haveFrame) {
+      if (n) droppedFrames++;
+      continue;
+    }
+    if (!n) {
+      xQueueSend(freeQ, &idx, 0);
+      continue;
+    }
+    // Tipo 1: 12 bits de dato + 4 de canal; se deja sólo el dato, en el lugar
+    const adc_digi_output_data_t *raw = (const adc_digi_output_data_t *)dst;
+    for (size_t i = 0; i < n; ++i) dst[i] = raw[i].type1.data;
+    frameLen[idx] = n;
+    xQueueSend(readyQ, &idx, 0);
+  }
+}
+
+// Filtra cada trama y cierra una ventana cada WINDOW_SAMPLES muestras
+void dspTask(void *) {
+  static float mid[MID_SAMPLES];
+  static float level[LEVEL_SAMPLES];
+  static float taps[FIR_TAPS];
+  FirDecimator::lowpass(taps, FIR_TAPS, FIR_CUTOFF);
+  static BoxDecimator box(BOX_FACTOR);
+  static FirDecimator fir(taps, FIR_TAPS, FIR_FACTOR);
+  static WindowStats raw;
+  static RangeStats midRange, levelRange;
+  uint32_t busyUs = 0;
+  uint32_t windowStartMs = millis();
+
+  for (;;) {
+    uint8_t idx;
+    xQueueReceive(readyQ, &idx, portMAX_DELAY);
+    uint32_t t0 = micros();
+    const uint16_t *s = frames[idx];
+    size_t n = frameLen[idx];
+    raw.push(s, n);
+    size_t m = box.process(s, n, mid);
+    xQueueSend(freeQ, &idx, 0);  // la trama ya no hace falta: que el lector la reuse
+    midRange.push(mid, m);
+    size_t k = fir.process(mid, m, level);
+    levelRange.push(level, k);
+    busyUs += micros() - t0;
+
+    if (raw.count() < WINDOW_SAMPLES) continue;
+    uint32_t nowMs = millis();
+    LightWindow w;
+    w.adc = raw.summary();
+    w.level = levelRange.mean();
+    w.levelMin = levelRange.min();
+    w.levelMax = levelRange.max();
+    float hi = midRange.max(), lo = midRange.min();
+    w.flicker = hi + lo > 0.0f ? 100.0f * (hi - lo) / (hi + lo) : 0.0f;
+    uint32_t spanMs = nowMs - windowStartMs;
+    w.dspLoad = spanMs ? busyUs / (10.0f * spanMs) : 0.0f;
+    w.dropped = droppedFrames;
+    w.overruns = adcOverruns;
+    w.ms = nowMs;
+    xQueueOverwrite(windowQ, &w);
+
+    raw.reset();
+    midRange.reset();
+    levelRange.reset();
+    busyUs = 0;
+    windowStartMs = nowMs;
+  }
+}
+
+// ======== HANDLERS ========
+static float percent(float counts) { return counts * 100.0f / 4095.0f; }
+
+void writeLatest(JsonWriter &w) {
+  time_t now; time(&now);
+  LightWindow win;
+  bool valid = xQueuePeek(windowQ, &win, 0) == pdTRUE;
+  uint32_t nowMs = millis();
+
+  w.beginObject();
+  if (valid) {
+    uint64_t ms = ((uint64_t)now) * 1000ULL - (nowMs - win.ms);
+    w.field("level", percent(win.level), 1)
+      .field("min", percent(win.levelMin), 1)
+      .field("max", percent(win.levelMax), 1)
+      .field("flicker", win.flicker, 1);
+    w.key("adc").beginObject()
+      .field("samples", win.adc.count)
+      .field("min", win.adc.min)
+      .field("max", win.adc.max)
+      .field("mean", win.adc.mean, 1)
+      .field("rms", win.adc.rms, 1)
+      .field("ripple", win.adc.acRms, 1)   // RMS de la parte alterna
+      .endObject();
+    w.key("dsp").beginObject()
+      .field("load", win.dspLoad, 2)
+      .field("dropped", win.dropped)
+      .field("overruns", win.overruns)
+      .endObject();
+    w.field("timestamp", ms)
+      .field("stale", nowMs - win.ms > 3 * WINDOW_MS);
+  } else {
+    w.key("level").null().field("stale", true);
+  }
+  w.field("rate", ADC_RATE_HZ).endObject();
+}
+
+// /api/latest -> última ventana de estadísticas
+void handleLatest() {
+  JsonResponse res(server);
+  writeLatest(res.json());
+  res.end();
+}
+
+// ======== SETUP / LOOP ========
 void setup() {
-  // put your setup code here, to run once:
-  int result = myFunction(2, 3);
+  Serial.begin(115200);
+  delay(200);
+
+  // Obtener últimos 4 dígitos de la MAC
+  String mac = WiFi.macAddress();
+  String macSuffix = mac.substring(mac.length() - 5);
+  macSuffix.replace(":", "");
+  macSuffix.toUpperCase();
+  String apName = "AP-LUMUS-" + macSuffix;
+  String mdnsName = "lumus-" + macSuffix;
+
+  // WIFI con WiFiManager
+  WiFiManager wm;
+  wm.setTimeout(180); // 3 min para configurar
+  if (!wm.autoConnect(apName.c_str())) {
+    Serial.println("⏳ Tiempo agotado, reiniciando...");
+    ESP.restart();
+  }
+  Serial.print("✅ Conectado a WiFi. IP: ");
+  Serial.println(WiFi.localIP());
+
+  if (MDNS.begin(mdnsName.c_str())) {
+    Serial.printf("✅ mDNS iniciado: http://%s.local/\n", mdnsName.c_str());
+  } else {
+    Serial.println("⚠️ Error iniciando mDNS");
+  }
+
+  configTime(gmtOffset_sec, daylightOffset_sec, ntpServer);
+
+  server.on("/api/latest", HTTP_GET, handleLatest);
+  server.onNotFound([]() { server.send(404, "text/plain; charset=utf-8", "Recurso no encontrado"); });
+  server.begin();
+  Serial.println("Servidor HTTP iniciado");
+
+  // Colas antes que las tareas; las dos tramas arrancan libres
+  freeQ = xQueueCreate(2, sizeof(uint8_t));
+  readyQ = xQueueCreate(2, sizeof(uint8_t));
+  windowQ = xQueueCreate(1, sizeof(LightWindow));
+  for (uint8_t i = 0; i < 2; ++i) xQueueSend(freeQ, &i, 0);
+
+  if (!startAdc()) {
+    Serial.println("¡Error iniciando el ADC continuo!");
+    return;
+  }
+  // En el núcleo 1 con el loop (la WiFi vive en el 0); el lector primero
+  xTaskCreatePinnedToCore(adcTask, "adc", 3072, nullptr, 5, nullptr, 1);
+  xTaskCreatePinnedToCore(dspTask, "dsp", 4096, nullptr, 4, nullptr, 1);
+  Serial.printf("ADC continuo: %u Hz, tramas de %u muestras\n", (unsigned)ADC_RATE_HZ, (unsigned)FRAME_SAMPLES);
 }
 
 void loop() {
-  // put your main code here, to run repeatedly:
+  server.handleClient();
 }
-
-// put function definitions here:
-int myFunction(int x, int y) {
-  return x + y;
-}
\ No newline at end of file
@@ -30,8 +30,122 @@ function formatTime(dt) {
   return `${pad(dt.getHours())}:${pad(dt.getMinutes())}:${pad(dt.getSeconds())}`;
 }
 
+// YYYY-MM-DD en hora local (la misma fecha que se elige en el popup)
+function formatDate(dt) {
+  const pad = n => String(n).padStart(2, "0");
+  return `${dt.getFullYear()}-${pad(dt.getMonth() + 1)}-${pad(dt.getDate())}`;
+}
+
 // ================================
-// Simulación DHT22
+// Histórico local en IndexedDB
+// ================================
+// Un object store por día ("d2025-09-02", clave ts). Cada lectura es un put
+// de un solo registro, sin releer ni reescribir lo ya guardado: el costo por
+// lectura no depende de cuánto tiempo lleve abierta la página. Los días más
+// viejos que LOCAL_RETENTION_DAYS se borran enteros al crear el store del
+// día nuevo. IndexedDB sólo crea stores en un cambio de versión: pasa una vez
+// por día, y las demás pestañas cierran su conexión (onversionchange) y la
+// reabren en la lectura siguiente.
+const LOCAL_DB = "dht22";
+const LOCAL_RETENTION_DAYS = 7;
+const hasIndexedDB = "indexedDB" in window;
+let localDb = null;  // promesa de la conexión abierta
+
+// Lo que dejaban las versiones anteriores (un JSON con todos los días)
+localStorage.removeItem("history");
+
+function dayStoreName(dateStr) {
+  return "d" + dateStr;
+}
+
+// Abre la base; con version (cambio de versión) crea el store de `day` y
+// borra los que quedaron fuera de la ventana de retención
+function openLocalDb(day, version) {
+  return new Promise((resolve, reject) => {
+    const req = indexedDB.open(LOCAL_DB, version);
+    req.onupgradeneeded = () => {
+      const db = req.result;
+      if (!day) return;
+      if (!db.objectStoreNames.contains(dayStoreName(day))) {
+        db.createObjectStore(dayStoreName(day), { keyPath: "ts" });
+      }
+      const first = new Date(day + "T00:00");
+      first.setDate(first.getDate() - (LOCAL_RETENTION_DAYS - 1));
+      const oldest = dayStoreName(formatDate(first));
+      for (const name of Array.from(db.objectStoreNames)) {
+        if (name < oldest) db.deleteObjectStore(name);
+      }
+    };
+    req.onsuccess = () => {
+      const db = req.result;
+      db.onversionchange = () => {
+        db.close();
+        localDb = null;
+      };
+      resolve(db);
+    };
+    req.onerror = () => reject(req.error);
+  });
+}
+
+// Conexión (con el store de `day` creado si se pide). Las llamadas se
+// encadenan: dos lecturas al cambiar el día no suben la versión dos veces.
+function useLocalDb(day) {
+  const p = (localDb || openLocalDb(day)).then(db => {
+    if (!day || db.objectStoreNames.contains(dayStoreName(day))) return db;
+    db.close();
+    return openLocalDb(day, db.version + 1);
+  });
+  localDb = p;
+  p.catch(() => { if (localDb === p) localDb = null; });
+  return p;
+}
+
+async function saveLocal(data) {
+  if (!hasIndexedDB) return;
+  const day = formatDate(new Date(data.timestamp));
+  const db = await useLocalDb(day);
+  const name = dayStoreName(day);
+  db.transaction(name, "readwrite").objectStore(name)
+    .put({ ts: data.timestamp, t: data.temperature, h: data.humidity });
+}
+
+// Un día del histórico local en arreglos tipados (el formato de los gráficos)
+async function loadLocal(dateStr) {
+  if (!hasIndexedDB) return null;
+  const db = await useLocalDb(null);
+  const name = dayStoreName(dateStr);
+  if (!db.objectStoreNames.contains(name)) return null;
+  return new Promise((resolve, reject) => {
+    const tx = db.transaction(name);
+    const store = tx.objectStore(name);
+    const count = store.count();
+    let out = null, i = 0;
+    // Los pedidos de una transacción se atienden en orden: el count ya está
+    store.openCursor().onsuccess = e => {
+      const cursor = e.target.result;
+      if (!out) {
+        out = {
+          timestamps: new Float64Array(count.result),
+          temperature: new Float32Array(count.result),
+          humidity: new Float32Array(count.result)
+        };
+      }
+      if (!cursor || i >= out.timestamps.length) return;
+      const v = cursor.value;
+      out.timestamps[i] = v.ts;
+      out.temperature[i] = v.t;
+      out.humidity[i] = v.h;
+      i++;
+      cursor.continue();
+    };
+    tx.oncomplete = () => resolve(i ? out : null);
+    tx.onerror = () => reject(tx.error);
+  });
+}
+
+// ================================
+// Simulación DHT22 (sin dispositivo, p.ej. abriendo index.html localmente)
 // ================================
 function fakeLatest() {
   const temp = 18 + Math.random() * 12; // 18°C - 30°C
@@ -43,53 +157,98 @@ function fakeLatest() {
   };
 }
 
-async function fetchLatest() {
-  try {
-    const data = fakeLatest();
-
-    // Mostrar en UI
-    if (tempEl) tempEl.textContent = data.temperature.toFixed(1);
-    if (humEl) humEl.textContent = Math.round(data.humidity);
-    if (humStateEl) {
-      humStateEl.textContent =
-        data.humidity < 30 ? "Seco" :
-        (data.humidity > 70 ? "Húmedo" : "Confortable");
-    }
-    if (lastUpdateEl) lastUpdateEl.textContent = formatTime(new Date(data.timestamp));
+function showLatest(data) {
+  // Sin lecturas válidas todavía (o el sensor dejó de contestar): el
+  // servidor manda null / stale y no se guarda nada
+  if (data.temperature == null) {
+    if (tempEl) tempEl.textContent = "--";
+    if (humEl) humEl.textContent = "--";
+    return;
+  }
+  if (data.stale) {
+    if (lastUpdateEl) lastUpdateEl.textContent = formatTime(new Date(data.timestamp)) + " (sin datos nuevos)";
+    return;
+  }
 
-    // Guardar en localStorage
-    const today = new Date().toISOString().slice(0, 10); // YYYY-MM-DD
-    const stored = JSON.parse(localStorage.getItem("history") || "{}");
-    if (!stored[today]) {
-      stored[today] = { timestamps: [], temperature: [], humidity: [] };
-    }
-    stored[today].timestamps.push(data.timestamp);
-    stored[today].temperature.push(data.temperature);
-    stored[today].humidity.push(data.humidity);
+  // Mostrar en UI
+  if (tempEl) tempEl.textContent = data.temperature.toFixed(1);
+  if (humEl) humEl.textContent = Math.round(data.humidity);
+  if (humStateEl) {
+    humStateEl.textContent =
+      data.humidity < 30 ? "Seco" :
+      (data.humidity > 70 ? "Húmedo" : "Confortable");
+  }
+  if (lastUpdateEl) lastUpdateEl.textContent = formatTime(new Date(data.timestamp));
 
-    localStorage.setItem("history", JSON.stringify(stored));
+  // Guardar en el histórico local (la misma lectura dos veces pisa el registro)
+  saveLocal(data).catch(e => console.warn("No se pudo guardar la lectura:", e));
+}
 
-    // 🔎 Log de depuración
-    console.log("Lectura guardada:", data);
-    console.log("LocalStorage ahora:", stored);
+// ================================
+// Lecturas en vivo: /api/stream (SSE) con polling de respaldo
+// ================================
+async function pollLatest() {
+  let data;
+  try {
+    const res = await fetch("/api/latest", { cache: "no-store" });
+    if (!res.ok) throw new Error(`HTTP ${res.status}`);
+    data = await res.json();
+  } catch (e) {
+    data = fakeLatest();
+  }
+  try {
+    showLatest(data);
   } catch (e) {
-    console.error("Error en fetchLatest:", e);
+    console.error("Error en pollLatest:", e);
   }
 }
 
-// Primera lectura inmediata + luego cada 3s
-fetchLatest();
-setInterval(fetchLatest, 3000);
+let pollTimer = null;
+function startPolling() {
+  if (pollTimer) return;
+  pollLatest();
+  pollTimer = setInterval(pollLatest, 3000);
+}
+function stopPolling() {
+  if (!pollTimer) return;
+  clearInterval(pollTimer);
+  pollTimer = null;
+}
+
+// El ESP32 arma cada lectura una sola vez y la empuja a todos los dashboards
+// abiertos. Mientras el stream no esté conectado se hace polling cada 3 s;
+// si el servidor lo rechaza (503: lista de suscriptores llena) se vuelve a
+// intentar en 30 s.
+function startStream() {
+  if (!("EventSource" in window)) {
+    startPolling();
+    return;
+  }
+  const es = new EventSource("/api/stream");
+  es.addEventListener("reading", ev => {
+    stopPolling();
+    try {
+      showLatest(JSON.parse(ev.data));
+    } catch (e) {
+      console.error("Error en /api/stream:", e);
+    }
+  });
+  es.onerror = () => {
+    startPolling();
+    if (es.readyState === EventSource.CLOSED) {
+      es.close();
+      setTimeout(startStream, 30000);
+    }
+  };
+}
+
+startStream();
 
 // ================================
 // Popup con SweetAlert2 y gráficas
 // ================================
 document.getElementById("openCharts").addEventListener("click", async () => {
-  const today = new Date();
-  const yyyy = today.getFullYear();
-  const mm = String(today.getMonth() + 1).padStart(2, "0");
-  const dd = String(today.getDate()).padStart(2, "0");
-  const defaultDate = `${yyyy}-${mm}-${dd}`;
+  const defaultDate = formatDate(new Date());
 
   await Swal.fire({
     title: "Histórico por fecha",
@@ -101,7 +260,7 @@ document.getElementById("openCharts").addEventListener("click", async () => {
         <div class="popup-card">
           <label for="datePick" class="muted">Seleccionar fecha</label>
           <input id="datePick" type="date" value="${defaultDate}" style="width:100%;padding:10px;border-radius:8px;border:1px solid var(--border);background:var(--bg);color:var(--fg)">
-          <p class="muted" style="margin-top:10px">Se muestran las lecturas simuladas guardadas en localStorage.</p>
+          <p class="muted" style="margin-top:10px">Sin el ESP32 se muestran las lecturas guardadas en este navegador (últimos ${LOCAL_RETENTION_DAYS} días).</p>
         </div>
         <div class="popup-row">
           <div class="popup-card"><canvas id="tempChart"></canvas></div>
@@ -124,7 +283,7 @@ async function buildCharts(dateStr) {
     return;
   }
 
-  const labels = data.timestamps.map(ts => formatTime(new Date(ts)));
+  const labels = Array.from(data.timestamps, ts => formatTime(new Date(ts)));
   const tempCtx = document.getElementById("tempChart").getContext("2d");
   const humCtx = document.getElementById("humChart").getContext("2d");
 
@@ -151,7 +310,7 @@ async function buildCharts(dateStr) {
       await Swal.fire("Sin datos", "No hay datos simulados guardados para esta fecha.", "info");
       return;
     }
-    const newLabels = nd.timestamps.map(ts => formatTime(new Date(ts)));
+    const newLabels = Array.from(nd.timestamps, ts => formatTime(new Date(ts)));
 
     tempChart.data.labels = newLabels;
     tempChart.data.datasets[0].data = nd.temperature;
@@ -164,9 +323,89 @@ async function buildCharts(dateStr) {
 }
 
 // ================================
-// Recuperar datos de localStorage
+// Histórico binario del ESP32 (/api/history.bin)
+// ================================
+// Cabecera: "HB" | versión | tipo (0 raw, 1 min, 2 hora, 3 día, 4 simulado) | escala
+//           | varint cantidad | varint t0 (s)
+// Filas: deltas zigzag-varint por columna (ts, T, H) o, en buckets,
+//        (ts, T, Tmin, Tmax, H, Hmin, Hmax) + n sin delta.
+function decodeHistoryBin(buf) {
+  const bytes = new Uint8Array(buf);
+  let pos = 0;
+  const varint = () => {
+    let v = 0, mul = 1, b;
+    do {
+      b = bytes[pos++];
+      v += (b & 0x7f) * mul;
+      mul *= 128;
+    } while (b & 0x80);
+    return v;
+  };
+  const zigzag = () => {
+    const v = varint();
+    return v % 2 ? -(v + 1) / 2 : v / 2;
+  };
+
+  if (bytes[0] !== 0x48 || bytes[1] !== 0x42 || bytes[2] !== 1) throw new Error("Formato binario desconocido");
+  const kind = bytes[3];
+  const scale = bytes[4];
+  pos = 5;
+  const n = varint();
+  let ts = varint();
+
+  const cols = kind >= 1 && kind <= 3 ? 6 : 2;
+  const prev = new Array(cols).fill(0);
+  // Arreglos tipados: Chart.js los acepta tal cual como datos
+  const out = {
+    timestamps: new Float64Array(n),
+    temperature: new Float32Array(n),
+    humidity: new Float32Array(n)
+  };
+  if (cols === 6) {
+    out.temperatureMin = new Float32Array(n); out.temperatureMax = new Float32Array(n);
+    out.humidityMin = new Float32Array(n); out.humidityMax = new Float32Array(n);
+    out.count = new Uint32Array(n);
+  }
+
+  for (let i = 0; i < n; i++) {
+    ts += zigzag();
+    out.timestamps[i] = ts * 1000;
+    for (let c = 0; c < cols; c++) prev[c] += zigzag();
+    if (cols === 2) {
+      out.temperature[i] = prev[0] / scale;
+      out.humidity[i] = prev[1] / scale;
+    } else {
+      out.temperature[i] = prev[0] / scale;
+      out.temperatureMin[i] = prev[1] / scale;
+      out.temperatureMax[i] = prev[2] / scale;
+      out.humidity[i] = prev[3] / scale;
+      out.humidityMin[i] = prev[4] / scale;
+      out.humidityMax[i] = prev[5] / scale;
+      out.count[i] = varint();
+    }
+  }
+  return out;
+}
+
+// El gráfico no muestra más puntos que los que entran en el ancho del
+// canvas: el ESP32 decima el día (LTTB) antes de mandarlo
+const CHART_POINTS = 500;
+
+// ================================
+// Recuperar histórico: primero el ESP32, si no hay (p.ej. abierto como
+// archivo local) se usa el histórico local de IndexedDB
 // ================================
 async function fetchHistory(dateStr) {
-  const stored = JSON.parse(localStorage.getItem("history") || "{}");
-  return stored[dateStr] || null;
+  try {
+    const res = await fetch(`/api/history.bin?date=${dateStr}&resolution=minute&points=${CHART_POINTS}`);
+    if (res.ok) return decodeHistoryBin(await res.arrayBuffer());
+  } catch (e) {
+    console.warn("Histórico del dispositivo no disponible:", e);
+  }
+  try {
+    return await loadLocal(dateStr);
+  } catch (e) {
+    console.warn("Histórico local no disponible:", e);
+    return null;
+  }
 }
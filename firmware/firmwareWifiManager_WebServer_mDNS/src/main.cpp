@@ -1,19 +1,61 @@
 #include <Arduino.h>
 #include <WiFi.h>
-#include <WebServer.h>
+#include <HttpServer.h>   // WebServer o AsyncHttpServer (WEB_ASYNC)
 #include <SPIFFS.h>
 #include <time.h>
+#include <JsonStream.h>
+#include <HistoryCache.h>
+#include <SampleStore.h>
+#include <StaticAssets.h>
+#include <EventStream.h>
+#include <SensorFilter.h>
+#include <HttpMetrics.h>
+#include <Lttb.h>
+// Lo genera tools/embed_data.py al compilar; sin él todo sale de SPIFFS
+#if __has_include("web_assets.h")
+#include "web_assets.h"
+#define HAVE_WEB_ASSETS 1
+#endif
 #include <WiFiManager.h>   // https://github.com/tzapu/WiFiManager
 #include <ESPmDNS.h>
 
 // ======== SERVIDOR ========
-WebServer server(80);
+HttpServer server(80);
+HistoryCache historyCache;   // respuestas de /api/history por fecha (LRU)
+StaticAssets assets(server, SPIFFS);  // .gz + ETag + 304
+EventStream events;          // /api/stream (SSE) para los dashboards abiertos
+
+// Bytes de cuerpo enviados por todas las rutas (para http_response_bytes_total)
+uint32_t bytesOut() { return assets.stats().bytes + JsonResponse::bytesSent(); }
+HttpMetrics metrics(bytesOut);  // /api/metrics (Prometheus)
 
 // ======== UTIL FECHA/HORA (Argentina) ========
 static const long  gmtOffset_sec = -3 * 3600; // UTC-3
 static const int   daylightOffset_sec = 0;    // sin DST
 static const char* ntpServer = "pool.ntp.org";
 
+// ======== mDNS ========
+// TXT de _http._tcp para el colector de la flota (tools/collector): la
+// versión de la API sube sólo si cambia algo que rompa a los clientes;
+// caps lista las rutas y parámetros que entiende esta placa
+static const char* API_VERSION = "1";
+static const char* API_CAPS = "latest,history,history.bin,range,points,stream,metrics";
+
+// ======== MUESTRAS (log en SPIFFS) ========
+SampleStore store(SPIFFS);
+const unsigned long SAMPLE_INTERVAL_MS = 60000;  // una muestra por minuto
+unsigned long lastSampleMs = 0;
+const unsigned long LIVE_INTERVAL_MS = 3000;     // lectura en vivo por /api/stream
+unsigned long lastLiveMs = 0;
+
+// ======== SENSOR (filtrado) ========
+// Se lee sólo acá, a período fijo; /api/latest, /api/stream y el log usan
+// el último valor bueno del filtro y nunca disparan una lectura
+const unsigned long SENSOR_PERIOD_MS = 2000;     // el DHT22 no admite menos
+const unsigned long SENSOR_STALE_MS = 5 * SENSOR_PERIOD_MS;
+unsigned long lastSensorMs = 0;
+SensorFilter sensor(DHT22_TEMP_LIMITS, DHT22_HUM_LIMITS, SENSOR_STALE_MS);
+
 // ======== HELPERS ========
 String contentType(const String &path) {
   if (path.endsWith(".html")) return "text/html; charset=utf-8";
@@ -25,11 +67,7 @@ String contentType(const String &path) {
 }
 
 bool serveFile(const String &path) {
-  File file = SPIFFS.open(path, "r");
-  if (!file) return false;
-  server.streamFile(file, contentType(path));
-  file.close();
-  return true;
+  return assets.serve(path, contentType(path));
 }
 
 // Pseudo-rand determinístico simple a partir de string (fecha)
@@ -69,61 +107,522 @@ void handleStatic() {
   if (!serveFile(path)) server.send(404, "text/plain; charset=utf-8", "Archivo no encontrado");
 }
 
-// /api/latest -> devuelve lectura "actual"
-void handleLatest() {
-  time_t now; time(&now);
+// ======== SENSOR ========
+// Lectura "actual" (simulada hasta conectar el DHT22)
+void readSensor(time_t now, float &t, float &h) {
   struct tm timeinfo;
   localtime_r(&now, &timeinfo);
 
   float hour = timeinfo.tm_hour + (timeinfo.tm_min/60.0f);
-  uint32_t seed = (uint32_t)now;
+  uint32_t seed = (uint32_t)now;  // cambia con el tiempo
+
+  t = simTemp(hour, seed);
+  h = simHum(hour, seed);
+}
+
+void sampleSensor() {
+  time_t now; time(&now);
+  float t, h;
+  readSensor(now, t, h);
+  sensor.push(t, h, millis());
+}
+
+// El log pisó registros de un día: sus respuestas cacheadas en esa
+// resolución ("YYYY-MM-DD/h...") ya no coinciden con lo guardado
+void onStoreEvict(void *, Resolution res, int32_t day) {
+  char prefix[13];
+  SampleStore::formatDay(day, prefix);
+  prefix[10] = '/';
+  prefix[11] = SampleStore::resolutionName(res)[0];
+  prefix[12] = '\0';
+  historyCache.invalidatePrefix(prefix);
+}
+
+// Guarda una muestra en el log y descarta del cache el día que cambió
+void recordSample() {
+  time_t now; time(&now);
+  if (now < 1600000000) return;  // sin hora NTP todavía
+
+  FilteredReading r = sensor.latest();
+  if (r.stale(millis())) return;  // mejor un hueco que un dato viejo repetido
+  if (!store.append((uint32_t)now, r.t, r.h)) return;
+
+  char date[11];
+  SampleStore::formatDay(store.dayOf((uint32_t)now), date);
+  historyCache.invalidatePrefix(date);
+}
+
+// Lectura "actual": {"temperature":..,"humidity":..,"timestamp":ms,"stale":bool}
+// timestamp es el del último dato bueno; sin ninguno todavía, valores null
+void writeLatest(JsonWriter &w) {
+  time_t now; time(&now);
+  FilteredReading r = sensor.latest();
+  uint32_t nowMs = millis();
+  uint64_t ms = ((uint64_t)now) * 1000ULL - r.ageMs(nowMs);
+
+  w.beginObject();
+  if (r.valid) w.field("temperature", r.t, 1).field("humidity", r.h, 0);
+  else w.key("temperature").null().key("humidity").null();
+  w.field("timestamp", ms)
+    .field("stale", r.stale(nowMs))
+    .endObject();
+}
+
+// La misma lectura en un buffer propio (para los eventos de /api/stream)
+size_t latestJson(char *buf, size_t cap) {
+  JsonWriter w(buf, cap - 1, nullptr, nullptr);
+  writeLatest(w);
+  buf[w.buffered()] = '\0';
+  return w.buffered();
+}
+
+// /api/latest -> devuelve lectura "actual"
+void handleLatest() {
+  JsonResponse res(server);
+  writeLatest(res.json());
+  res.end();
+}
+
+// /api/stream -> Server-Sent Events: la lectura se arma una vez cada
+// LIVE_INTERVAL_MS y sale a todos los suscriptores. Con la lista llena
+// contesta 503 y app.js sigue con polling a /api/latest.
+void handleStream() {
+  char buf[96];
+  latestJson(buf, sizeof(buf));
+  if (!events.subscribe(server, "reading", buf)) {
+    server.send(503, "text/plain; charset=utf-8", "Demasiados suscriptores");
+  }
+}
+
+void publishLatest() {
+  char buf[96];
+  size_t n = latestJson(buf, sizeof(buf));
+  events.publish("reading", buf, n);
+}
+
+// Muestras reales del log: un punto por muestra, con timestamp JS (ms)
+static void writeSampleTs(void *ctx, const Sample &s)   { ((JsonWriter *)ctx)->value((unsigned long long)s.ts * 1000ULL); }
+static void writeSampleTemp(void *ctx, const Sample &s) { ((JsonWriter *)ctx)->value(s.temperature, 1); }
+static void writeSampleHum(void *ctx, const Sample &s)  { ((JsonWriter *)ctx)->value(s.humidity, 0); }
+
+// Buckets agregados: una fila [ts, tMedia, tMin, tMax, hMedia, hMin, hMax, n] por bucket
+static void writeRollupRow(void *ctx, const Rollup &r) {
+  JsonWriter &w = *(JsonWriter *)ctx;
+  w.beginArray().value((unsigned long long)r.start * 1000ULL)
+    .value(r.tMean, 1).value(r.tMin, 1).value(r.tMax, 1)
+    .value(r.hMean, 1).value(r.hMin, 1).value(r.hMax, 1)
+    .value(r.count).endArray();
+}
+
+// ======== Decimación (points=N) ========
+// Con points las filas del log pasan por LTTB antes de escribirse: a lo sumo
+// points filas que conservan la forma del gráfico (ver Lttb.h), elegidas en
+// el mismo recorrido del log y sin guardar el día en RAM.
+const uint32_t MAX_POINTS = 5000;
+
+struct SampleOut { SampleStore::SampleFn fn; void *ctx; };
+struct RollupOut { SampleStore::RollupFn fn; void *ctx; };
+static void emitSample(void *ctx, const void *row) { SampleOut *o = (SampleOut *)ctx; o->fn(o->ctx, *(const Sample *)row); }
+static void emitRollup(void *ctx, const void *row) { RollupOut *o = (RollupOut *)ctx; o->fn(o->ctx, *(const Rollup *)row); }
+static void lttbSample(void *ctx, const Sample &s) { ((Lttb *)ctx)->push(s.ts, s.temperature, s.humidity, &s); }
+static void lttbRollup(void *ctx, const Rollup &r) { ((Lttb *)ctx)->push(r.start, r.tMean, r.hMean, &r); }
+
+// store.forEachInDay / forEachRollupInDay, decimados a points filas (0: todas)
+void forEachSample(int32_t day, uint32_t points, SampleStore::SampleFn fn, void *ctx) {
+  if (!points) { store.forEachInDay(day, fn, ctx); return; }
+  SampleOut out = {fn, ctx};
+  Lttb lttb(store.countInDay(day), points, sizeof(Sample), emitSample, &out);
+  store.forEachInDay(day, lttbSample, &lttb);
+  lttb.finish();
+}
+
+void forEachRollup(Resolution res, int32_t day, uint32_t points, SampleStore::RollupFn fn, void *ctx) {
+  if (!points) { store.forEachRollupInDay(res, day, fn, ctx); return; }
+  RollupOut out = {fn, ctx};
+  Lttb lttb(store.countRollupsInDay(res, day), points, sizeof(Rollup), emitRollup, &out);
+  store.forEachRollupInDay(res, day, lttbRollup, &lttb);
+  lttb.finish();
+}
+
+// Las columnas de un día crudo decimado salen de un solo LTTB: al elegir
+// cada fila se escribe su timestamp y se marca su posición en el día; la
+// temperatura y la humedad salen después de recorrer el día filtrando por
+// esas marcas. Un día nunca tiene más filas que el anillo.
+static uint8_t s_picked[(SAMPLE_STORE_CAPACITY + 7) / 8];
+
+struct PickedRow { Sample s; uint32_t pos; };
+struct PickCtx { Lttb *lttb; uint32_t pos; };
+struct PickedOut { SampleStore::SampleFn fn; void *ctx; uint32_t pos; };
+
+static void pickSample(void *ctx, const Sample &s) {
+  PickCtx &c = *(PickCtx *)ctx;
+  PickedRow row = {s, c.pos++};
+  c.lttb->push(s.ts, s.temperature, s.humidity, &row);
+}
+static void emitPickedTs(void *ctx, const void *row) {
+  const PickedRow &r = *(const PickedRow *)row;
+  if (r.pos < SAMPLE_STORE_CAPACITY) s_picked[r.pos >> 3] |= (uint8_t)(1u << (r.pos & 7));
+  writeSampleTs(ctx, r.s);
+}
+static void emitIfPicked(void *ctx, const Sample &s) {
+  PickedOut &o = *(PickedOut *)ctx;
+  uint32_t pos = o.pos++;
+  if (pos < SAMPLE_STORE_CAPACITY && (s_picked[pos >> 3] & (1u << (pos & 7)))) o.fn(o.ctx, s);
+}
+
+// Escribe los timestamps elegidos y deja las marcas para forEachPicked
+void pickSamples(JsonWriter &w, int32_t day, uint32_t points) {
+  size_t n = store.countInDay(day);
+  memset(s_picked, 0, n < SAMPLE_STORE_CAPACITY ? (n + 7) / 8 : sizeof(s_picked));
+  Lttb lttb((uint32_t)n, points, sizeof(PickedRow), emitPickedTs, &w);
+  PickCtx c = {&lttb, 0};
+  store.forEachInDay(day, pickSample, &c);
+  lttb.finish();
+}
+
+void forEachPicked(int32_t day, SampleStore::SampleFn fn, void *ctx) {
+  PickedOut out = {fn, ctx, 0};
+  store.forEachInDay(day, emitIfPicked, &out);
+}
+
+// points=N: ausente = sin decimar; si no, entre 3 y MAX_POINTS
+bool parsePoints(uint32_t &points) {
+  points = 0;
+  if (!server.hasArg("points")) return true;
+  long v = server.arg("points").toInt();
+  if (v < 3 || v > (long)MAX_POINTS) return false;
+  points = (uint32_t)v;
+  return true;
+}
+
+void writeStoredDay(JsonWriter &w, int32_t day, Resolution res, uint32_t points) {
+  w.field("source", "store");
+  w.field("resolution", SampleStore::resolutionName(res));
+  if (res != RES_RAW) {
+    w.key("fields").beginArray()
+      .value("timestamp").value("temperature").value("temperatureMin").value("temperatureMax")
+      .value("humidity").value("humidityMin").value("humidityMax").value("count")
+      .endArray();
+    w.key("buckets").beginArray();
+    forEachRollup(res, day, points, writeRollupRow, &w);
+    w.endArray();
+    return;
+  }
+  if (!points) {
+    w.key("timestamps").beginArray();
+    store.forEachInDay(day, writeSampleTs, &w);
+    w.endArray();
+    w.key("temperature").beginArray();
+    store.forEachInDay(day, writeSampleTemp, &w);
+    w.endArray();
+    w.key("humidity").beginArray();
+    store.forEachInDay(day, writeSampleHum, &w);
+    w.endArray();
+    return;
+  }
+  w.key("timestamps").beginArray();
+  pickSamples(w, day, points);
+  w.endArray();
+  w.key("temperature").beginArray();
+  forEachPicked(day, writeSampleTemp, &w);
+  w.endArray();
+  w.key("humidity").beginArray();
+  forEachPicked(day, writeSampleHum, &w);
+  w.endArray();
+}
 
-  float t = simTemp(hour, seed);
-  float h = simHum(hour, seed);
-  uint64_t ms = ((uint64_t)now) * 1000ULL;
+// Día sin datos guardados en la resolución pedida: 24 puntos por hora sintéticos
+// (determinísticos por fecha)
+void writeSimulatedDay(JsonWriter &w, uint32_t seed) {
+  w.key("hours").beginArray();
+  for (int h=0; h<24; ++h) w.value(h);
+  w.endArray();
+  w.key("temperature").beginArray();
+  for (int h=0; h<24; ++h) w.value(simTemp(h, seed), 1);
+  w.endArray();
+  w.key("humidity").beginArray();
+  for (int h=0; h<24; ++h) w.value(simHum(h, seed), 0);
+  w.endArray();
+}
+
+// ======== /api/history.bin ========
+// Cabecera: 'H' 'B' | versión (1) | tipo (0 raw, 1 minuto, 2 hora, 3 día, 4 simulado)
+//           | escala (10: valores en décimas) | varint cantidad | varint t0 (epoch s)
+// Luego una fila por punto, cada columna como delta zigzag-varint de la fila anterior:
+//   raw/simulado: dts, dT, dH
+//   buckets:      dts, dT, dTmin, dTmax, dH, dHmin, dHmax, n (n sin delta)
+struct BinCtx {
+  JsonWriter *w;
+  uint32_t prevTs;
+  int32_t prev[6];
+};
+
+static int32_t tenths(float v) { return (int32_t)lroundf(v * 10.0f); }
+
+static void binRow(BinCtx &c, uint32_t ts, const int32_t *vals, uint8_t n) {
+  writeZigzag(*c.w, (int32_t)(ts - c.prevTs));
+  c.prevTs = ts;
+  for (uint8_t i = 0; i < n; ++i) {
+    writeZigzag(*c.w, vals[i] - c.prev[i]);
+    c.prev[i] = vals[i];
+  }
+}
+
+static void binSample(void *ctx, const Sample &s) {
+  int32_t v[2] = {tenths(s.temperature), tenths(s.humidity)};
+  binRow(*(BinCtx *)ctx, s.ts, v, 2);
+}
+
+static void binRollup(void *ctx, const Rollup &r) {
+  BinCtx &c = *(BinCtx *)ctx;
+  int32_t v[6] = {tenths(r.tMean), tenths(r.tMin), tenths(r.tMax),
+                  tenths(r.hMean), tenths(r.hMin), tenths(r.hMax)};
+  binRow(c, r.start, v, 6);
+  writeVarint(*c.w, r.count);
+}
+
+void writeBinaryDay(JsonWriter &w, int32_t day, Resolution res, uint32_t seed, uint32_t points) {
+  bool stored = store.countRollupsInDay(res, day) > 0;
+  uint32_t t0 = store.dayStart(day);
+  const char header[5] = {'H', 'B', 1, (char)(stored ? res : 4), 10};
+  w.raw(header, sizeof(header));
+  writeVarint(w, stored ? Lttb::outputSize((uint32_t)store.countRollupsInDay(res, day), points) : 24);
+  writeVarint(w, t0);
+
+  BinCtx c = {&w, t0, {0, 0, 0, 0, 0, 0}};
+  if (!stored) {
+    for (int h=0; h<24; ++h) {
+      int32_t v[2] = {tenths(simTemp(h, seed)), tenths(simHum(h, seed))};
+      binRow(c, t0 + h * 3600, v, 2);
+    }
+  } else if (res == RES_RAW) {
+    forEachSample(day, points, binSample, &c);
+  } else {
+    forEachRollup(res, day, points, binRollup, &c);
+  }
+}
+
+// ======== /api/history?from=..&to=.. (rango de varios días) ========
+// from/to: YYYY-MM-DD (día local entero) o epoch en segundos; to es inclusivo
+// y por defecto es ahora. limit: filas por respuesta (máx. RANGE_MAX_ROWS).
+// La respuesta trae "cursor": el ts de la primera fila que no entró, para
+// pedir la página siguiente con &cursor=; null si no quedó nada. Las filas
+// van del log al cliente de a una (chunked): la memoria no depende del largo
+// del rango. Sólo datos guardados; los días sin muestras no se simulan.
+// Con points=N no hay páginas: el rango completo, decimado, cursor null.
+const uint32_t RANGE_MAX_ROWS = SAMPLE_STORE_CAPACITY;  // todo el anillo crudo
 
-  String json = "{";
-  json += "\"temperature\":" + String(t, 1) + ",";
-  json += "\"humidity\":" + String(h, 0) + ",";
-  json += "\"timestamp\":" + String(ms);
-  json += "}";
+// YYYY-MM-DD o epoch (s); endOfDay: para "to", el último segundo del día
+bool parseTime(const String &s, bool endOfDay, uint32_t &out) {
+  int32_t day = SampleStore::dayFromDate(s.c_str());
+  if (day >= 0) {
+    out = store.dayStart(day) + (endOfDay ? 86399 : 0);
+    return true;
+  }
+  if (s.length() == 0 || s.length() > 10) return false;
+  for (size_t i = 0; i < s.length(); ++i) {
+    if (s[i] < '0' || s[i] > '9') return false;
+  }
+  // strtoul satura en ULONG_MAX, que en el ESP32 es UINT32_MAX: 4294967296 pasaría
+  unsigned long long v = strtoull(s.c_str(), nullptr, 10);
+  if (v > UINT32_MAX) return false;
+  out = (uint32_t)v;
+  return true;
+}
+
+struct RangeCtx {
+  JsonWriter *w;
+  uint32_t limit;
+  uint32_t rows;
+  uint32_t next;   // ts de la primera fila que no entró
+  bool more;
+};
+
+static bool rangeFull(RangeCtx &c, uint32_t ts) {
+  if (c.rows < c.limit) return false;
+  c.next = ts;
+  c.more = true;
+  return true;
+}
 
-  server.send(200, "application/json; charset=utf-8", json);
+static bool rangeSample(void *ctx, const Sample &s) {
+  RangeCtx &c = *(RangeCtx *)ctx;
+  if (rangeFull(c, s.ts)) return false;
+  c.w->beginArray().value((unsigned long long)s.ts * 1000ULL)
+    .value(s.temperature, 1).value(s.humidity, 0).endArray();
+  c.rows++;
+  return true;
+}
+
+static bool rangeRollup(void *ctx, const Rollup &r) {
+  RangeCtx &c = *(RangeCtx *)ctx;
+  if (rangeFull(c, r.start)) return false;
+  writeRollupRow(c.w, r);
+  c.rows++;
+  return true;
 }
 
-// /api/history?date=YYYY-MM-DD
-void handleHistory() {
+// Con points el rango entero sale decimado en una respuesta, sin cursor.
+// LTTB necesita saber cuántas filas hay: el rango se recorre una vez para
+// contarlas y otra para decimar.
+static bool countSample(void *ctx, const Sample &) { (*(uint32_t *)ctx)++; return true; }
+static bool countRollup(void *ctx, const Rollup &) { (*(uint32_t *)ctx)++; return true; }
+static bool lttbVisitSample(void *ctx, const Sample &s) { lttbSample(ctx, s); return true; }
+static bool lttbVisitRollup(void *ctx, const Rollup &r) { lttbRollup(ctx, r); return true; }
+static void emitRangeSample(void *ctx, const void *row) { rangeSample(ctx, *(const Sample *)row); }
+static void emitRangeRollup(void *ctx, const void *row) { rangeRollup(ctx, *(const Rollup *)row); }
+
+void decimateRange(RangeCtx &c, Resolution res, uint32_t from, uint32_t to, uint32_t points) {
+  uint32_t n = 0;
+  if (res == RES_RAW) {
+    store.forEachInRange(from, to, countSample, &n);
+    Lttb lttb(n, points, sizeof(Sample), emitRangeSample, &c);
+    store.forEachInRange(from, to, lttbVisitSample, &lttb);
+    lttb.finish();
+  } else {
+    store.forEachRollupInRange(res, from, to, countRollup, &n);
+    Lttb lttb(n, points, sizeof(Rollup), emitRangeRollup, &c);
+    store.forEachRollupInRange(res, from, to, lttbVisitRollup, &lttb);
+    lttb.finish();
+  }
+}
+
+void serveRange(Resolution resolution, uint32_t points) {
+  uint32_t from, to, cursor;
+  time_t now; time(&now);
+  bool ok = parseTime(server.arg("from"), false, from);
+  to = (uint32_t)now;
+  if (server.hasArg("to")) ok = ok && parseTime(server.arg("to"), true, to);
+  if (!ok) {
+    server.send(400, "application/json; charset=utf-8", "{\"error\":\"Parámetros 'from'/'to' inválidos (YYYY-MM-DD o epoch en s)\"}");
+    return;
+  }
+  if (server.hasArg("cursor")) {
+    if (!parseTime(server.arg("cursor"), false, cursor)) {
+      server.send(400, "application/json; charset=utf-8", "{\"error\":\"Parámetro 'cursor' inválido\"}");
+      return;
+    }
+    if (cursor > from) from = cursor;
+  }
+  long limit = server.hasArg("limit") ? server.arg("limit").toInt() : (long)RANGE_MAX_ROWS;
+  if (limit < 1 || limit > (long)RANGE_MAX_ROWS) limit = RANGE_MAX_ROWS;
+
+  JsonResponse res(server);
+  JsonWriter &w = res.json();
+  w.beginObject()
+    .field("from", from).field("to", to)
+    .field("resolution", SampleStore::resolutionName(resolution));
+  w.key("fields").beginArray();
+  if (resolution == RES_RAW) {
+    w.value("timestamp").value("temperature").value("humidity");
+  } else {
+    w.value("timestamp").value("temperature").value("temperatureMin").value("temperatureMax")
+      .value("humidity").value("humidityMin").value("humidityMax").value("count");
+  }
+  w.endArray();
+
+  RangeCtx c = {&w, points ? UINT32_MAX : (uint32_t)limit, 0, 0, false};
+  w.key("rows").beginArray();
+  if (points) decimateRange(c, resolution, from, to, points);
+  else if (resolution == RES_RAW) store.forEachInRange(from, to, rangeSample, &c);
+  else store.forEachRollupInRange(resolution, from, to, rangeRollup, &c);
+  w.endArray();
+  w.field("count", c.rows);
+  if (c.more) w.field("cursor", c.next);
+  else w.key("cursor").null();
+  w.endObject();
+  res.end();
+}
+
+// /api/history?date=YYYY-MM-DD[&resolution=raw|minute|hour|day]  (JSON)
+// /api/history.bin?...                                          (binario, mismos parámetros)
+// points=N (también en rangos): a lo sumo N filas decimadas con LTTB
+void serveHistory(bool binary) {
+  uint32_t points;
+  if (!parsePoints(points)) {
+    server.send(400, "application/json; charset=utf-8", "{\"error\":\"Parámetro 'points' inválido (3..5000)\"}");
+    return;
+  }
+  if (server.hasArg("from")) {
+    Resolution resolution;
+    if (binary || !SampleStore::parseResolution(server.arg("resolution").c_str(), resolution)) {
+      server.send(400, "application/json; charset=utf-8", binary
+                  ? "{\"error\":\"Los rangos (from/to) se piden a /api/history\"}"
+                  : "{\"error\":\"Parámetro 'resolution' inválido (raw|minute|hour|day)\"}");
+      return;
+    }
+    serveRange(resolution, points);
+    return;
+  }
+
   String date = server.hasArg("date") ? server.arg("date") : "";
-  if (date.length() != 10) {
+  int32_t day = SampleStore::dayFromDate(date.c_str());
+  if (day < 0) {
     server.send(400, "application/json; charset=utf-8", "{\"error\":\"Parámetro 'date' inválido\"}");
     return;
   }
-  uint32_t seed = hashDate(date);
 
-  String hoursArr = "[";
-  String tempArr  = "[";
-  String humArr   = "[";
-
-  for (int h=0; h<24; ++h) {
-    float t = simTemp(h, seed);
-    float u = simHum(h, seed);
+  Resolution resolution;
+  if (!SampleStore::parseResolution(server.arg("resolution").c_str(), resolution)) {
+    server.send(400, "application/json; charset=utf-8", "{\"error\":\"Parámetro 'resolution' inválido (raw|minute|hour|day)\"}");
+    return;
+  }
 
-    hoursArr += String(h);
-    tempArr  += String(t, 1);
-    humArr   += String(u, 0);
+  // Respuesta ya serializada para esta fecha, resolución y puntos ("YYYY-MM-DD/h500")
+  char key[HISTORY_CACHE_KEY_LEN];
+  snprintf(key, sizeof(key), "%s/%c%u%s", date.c_str(), SampleStore::resolutionName(resolution)[0],
+           (unsigned)points, binary ? "b" : "");
+  const char *type = binary ? "application/octet-stream" : "application/json; charset=utf-8";
+  size_t cachedLen;
+  const char *cached = historyCache.get(key, cachedLen);
+  if (cached) {
+    JsonResponse::send(server, cached, cachedLen, 200, type);
+    return;
+  }
 
-    if (h < 23) { hoursArr += ","; tempArr += ","; humArr += ","; }
+  // Se escribe directo al cliente, sin armar Strings intermedios, y a la vez
+  // al cache (si no entra en el arena, el cache la descarta)
+  JsonResponse res(server, 200, type);
+  historyCache.beginPut(key);
+  res.tee(HistoryCache::sink, &historyCache);
+  JsonWriter &w = res.json();
+  if (binary) {
+    writeBinaryDay(w, day, resolution, hashDate(date), points);
+  } else {
+    w.beginObject();
+    w.field("date", date.c_str());
+    // Por resolución: pasada la retención del log crudo los rollups siguen teniendo el día
+    if (store.countRollupsInDay(resolution, day) > 0) writeStoredDay(w, day, resolution, points);
+    else writeSimulatedDay(w, hashDate(date));
+    w.endObject();
   }
-  hoursArr += "]"; tempArr += "]"; humArr += "]";
 
-  String json = "{";
-  json += "\"date\":\"" + date + "\",";
-  json += "\"hours\":" + hoursArr + ",";
-  json += "\"temperature\":" + tempArr + ",";
-  json += "\"humidity\":" + humArr;
-  json += "}";
+  res.end();
+  historyCache.commitPut();
+}
+
+void handleHistory()    { serveHistory(false); }
+void handleHistoryBin() { serveHistory(true); }
 
-  server.send(200, "application/json; charset=utf-8", json);
+// /api/metrics -> texto de Prometheus: latencia y bytes por ruta, loop(),
+// heap, RSSI y el tiempo que se pasa en SPIFFS (estáticos y log de muestras)
+void handleMetrics() {
+  JsonResponse res(server, 200, "text/plain; version=0.0.4; charset=utf-8");
+  JsonWriter &w = res.json();
+  metrics.write(w);
+
+  const StaticAssets::Stats &as = assets.stats();
+  SampleStore::Stats ss = store.stats();
+  HttpMetrics::type(w, "spiffs_read_ops_total", "counter");
+  HttpMetrics::sample(w, "spiffs_read_ops_total", "component=\"assets\"", as.fsOpens);
+  HttpMetrics::sample(w, "spiffs_read_ops_total", "component=\"samples\"", ss.fsReads);
+  HttpMetrics::type(w, "spiffs_read_seconds_total", "counter");
+  HttpMetrics::sample(w, "spiffs_read_seconds_total", "component=\"assets\"", as.fsUs / 1e6);
+  HttpMetrics::sample(w, "spiffs_read_seconds_total", "component=\"samples\"", ss.readUs / 1e6);
+  HttpMetrics::counter(w, "spiffs_samples_read_bytes_total", ss.bytesRead);
+  HttpMetrics::counter(w, "spiffs_samples_written_bytes_total", ss.bytesWritten);
+  HttpMetrics::counter(w, "history_cache_hits_total", historyCache.stats().hits);
+  res.end();
 }
 
 void setup() {
@@ -136,6 +635,8 @@ void setup() {
   } else {
     Serial.println("SPIFFS montado");
   }
+  if (!store.begin(gmtOffset_sec)) Serial.println("¡Error abriendo /samples.bin!");
+  store.onEvict(onStoreEvict, nullptr);
 
   // Obtener últimos 4 dígitos de la MAC
   String mac = WiFi.macAddress(); // Ejemplo: "24:6F:28:1A:2B:3C"
@@ -160,6 +661,9 @@ void setup() {
   // mDNS
   if (MDNS.begin(mdnsName.c_str())) {
     Serial.printf("✅ mDNS iniciado: http://%s.local/\n", mdnsName.c_str());
+    MDNS.addService("http", "tcp", 80);
+    MDNS.addServiceTxt("http", "tcp", "api", API_VERSION);
+    MDNS.addServiceTxt("http", "tcp", "caps", API_CAPS);
   } else {
     Serial.println("⚠️ Error iniciando mDNS");
   }
@@ -167,24 +671,56 @@ void setup() {
   // NTP
   configTime(gmtOffset_sec, daylightOffset_sec, ntpServer);
 
-  // Rutas
-  server.on("/", HTTP_GET, handleRoot);
-  server.on("/index.html", HTTP_GET, handleRoot);
-  server.on("/styles.css", HTTP_GET, handleStatic);
-  server.on("/app.js", HTTP_GET, handleStatic);
-  server.on("/api/latest", HTTP_GET, handleLatest);
-  server.on("/api/history", HTTP_GET, handleHistory);
+  // Rutas (cada una medida bajo su nombre en /api/metrics)
+  HttpServer::THandlerFunction root = metrics.timed("root", handleRoot);
+  HttpServer::THandlerFunction stat = metrics.timed("static", handleStatic);
+  server.on("/", HTTP_GET, root);
+  server.on("/index.html", HTTP_GET, root);
+  server.on("/styles.css", HTTP_GET, stat);
+  server.on("/app.js", HTTP_GET, stat);
+  server.on("/api/latest", HTTP_GET, metrics.timed("latest", handleLatest));
+  server.on("/api/stream", HTTP_GET, metrics.timed("stream", handleStream));
+  server.on("/api/history", HTTP_GET, metrics.timed("history", handleHistory));
+  server.on("/api/history.bin", HTTP_GET, metrics.timed("history_bin", handleHistoryBin));
+  server.on("/api/metrics", HTTP_GET, metrics.timed("metrics", handleMetrics));
 
-  server.onNotFound([](){
+  server.onNotFound(metrics.timed("not_found", [](){
     String path = server.uri();
     if (!serveFile(path)) server.send(404, "text/plain; charset=utf-8", "Recurso no encontrado");
-  });
+  }));
 
+  assets.begin();
+#ifdef HAVE_WEB_ASSETS
+  assets.setEmbedded(WEB_ASSETS, WEB_ASSETS_COUNT);
+#endif
   server.begin();
   Serial.println("Servidor HTTP iniciado");
+
+  // Primera lectura: /api/latest ya tiene dato desde el arranque
+  sampleSensor();
+  lastSensorMs = millis();
 }
 
 void loop() {
+  metrics.loopTick();
   server.handleClient();
-  MDNS.update();
+
+  unsigned long ms = millis();
+  if (ms - lastSensorMs >= SENSOR_PERIOD_MS) {
+    lastSensorMs = ms;
+    sampleSensor();
+  }
+  if (ms - lastSampleMs >= SAMPLE_INTERVAL_MS) {
+    lastSampleMs = ms;
+    recordSample();
+  }
+  store.tick(ms);
+
+  // Sin suscriptores no se lee ni se arma nada
+  if (events.count() && ms - lastLiveMs >= LIVE_INTERVAL_MS) {
+    lastLiveMs = ms;
+    publishLatest();
+  }
+  events.tick(ms);
+  // En ESP32 el mDNS corre en su propia tarea: no hay MDNS.update() como en ESP8266
 }
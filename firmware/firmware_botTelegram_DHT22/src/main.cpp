@@ -1,6 +1,31 @@
 /****************************************************
  * ESP32 + WiFiManager + DHT22 + Temp Interna + Telegram
- * + Persistencia SPIFFS (config.json) + Estabilidad
+ * + Persistencia en NVS (ConfigStore) + Estabilidad
+ *
+ * Tareas FreeRTOS (el loop() queda vacío):
+ *  - muestreo  (core 1, prioridad alta): lee el DHT22 a período fijo; la
+ *    trama llega por interrupciones (Dht22Async), sin apagarlas como la
+ *    librería de Adafruit, y la tarea duerme mientras tanto. Cada trama
+ *    pasa por SensorFilter (rango, picos, mediana, EMA) y sale el último
+ *    valor bueno: una trama fallida no llega al canal
+ *  - red       (core 0, junto a la pila WiFi): getUpdates y sendMessage
+ *  - comandos  (core 1): atiende comandos y arma el envío automático
+ * Se comunican por colas; una vuelta lenta de Telegram ya no corre el muestreo.
+ * La salida pasa por TelegramOutbox: coalescing de telemetría, límites de
+ * Telegram y reintentos con backoff, sin que nadie espere a la red.
+ * La conexión TLS con api.telegram.org queda abierta (keep-alive) y se
+ * verifica contra la CA raíz de Telegram (include/telegram_root_ca.h).
+ * La config vive en NVS: una sola escritura por arranque (el contador de
+ * reinicios) y los cambios por comando se guardan juntos a los pocos segundos.
+ * Las llamadas bloqueantes (getUpdates, sendMessage, DHT22, WiFi.reconnect,
+ * escritura de la config) se perfilan en memoria RTC (BlockProfiler): tras
+ * un reinicio por watchdog el mensaje de arranque dice cuál estaba en curso.
+ *
+ * Modo lote (/setSleep N, para batería o solar): sin tareas ni WiFi fijo.
+ * Cada despertar lee el DHT22, guarda la lectura en memoria RTC
+ * (SleepBatch) y vuelve a deep sleep hasta el próximo intervalo; cada N
+ * muestras levanta WiFi y TLS, manda el lote en un mensaje y atiende los
+ * comandos que llegaron mientras dormía. Reemplaza al envío automático.
  *
  * Comandos:
  *  /menu
@@ -13,21 +38,35 @@
  *  /reset                    (reinicia según ENABLE_SOFT_RESET)
  *  /clearResetCount
  *  /infoDevices
+ *  /profile [reset]          (llamadas bloqueantes; sobrevive a reinicios)
+ *  /setSleep [N]             (modo lote: un mensaje cada N muestras; 0 = apagado)
  ****************************************************/
 
 #include <WiFi.h>
 #include <WiFiClientSecure.h>
-#include <UniversalTelegramBot.h>
+#include <TelegramClient.h>
+#include <TelegramOutbox.h>
 #include <WiFiManager.h>       // https://github.com/tzapu/WiFiManager
-#include <Adafruit_Sensor.h>
-#include <DHT.h>
-#include <DHT_U.h>
+#include <Dht22Async.h>
+#include <SensorFilter.h>
 #include "esp_system.h"
+#include "esp_sleep.h"
 #include "esp_wifi.h"
+#include "telegram_root_ca.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+#include <JitterStats.h>
+#include <CommandTable.h>
+#include <ConfigStore.h>
+#include <BlockProfiler.h>
+#include <SleepBatch.h>
 
 #include <FS.h>
 #include <SPIFFS.h>
 #include <ArduinoJson.h>
+#include <stdarg.h>
 
 // ===== Configuración del BOT y Canal =====
 #define BOT_TOKEN        "8385145731:AAFo0sg1qxpHpMIerwlrOaTwCBf1SQ-g2S0"
@@ -39,15 +78,23 @@
 
 // ===== DHT22 =====
 #define DHTPIN   4
-#define DHTTYPE  DHT22
-DHT dht(DHTPIN, DHTTYPE);
+Dht22Async dht(DHTPIN);
+
+// Período de muestreo (el DHT22 no admite menos de 2 s entre lecturas)
+#ifndef SAMPLE_PERIOD_MS
+#define SAMPLE_PERIOD_MS 2000
+#endif
+
+// Sin un dato bueno en este tiempo la lectura deja de publicarse
+#define SENSOR_STALE_MS (5UL * SAMPLE_PERIOD_MS)
+SensorFilter sensorFilter(DHT22_TEMP_LIMITS, DHT22_HUM_LIMITS, SENSOR_STALE_MS);
 
 // ===== Control: habilitar/deshabilitar reinicio por software =====
 #define ENABLE_SOFT_RESET 0   // 0 = deshabilitado temporalmente | 1 = habilitado
 
 // ===== Objetos globales =====
 WiFiClientSecure secured_client;
-UniversalTelegramBot bot(BOT_TOKEN, secured_client);
+TelegramClient tg(secured_client, BOT_TOKEN);
 WiFiManager wm;
 
 // ===== Estado / persistencia =====
@@ -55,13 +102,68 @@ unsigned long previousMillis = 0;     // último envío
 long interval = 10000;                // ms (persistente)
 bool autoSend = true;                 // modo auto/manual (persistente)
 int resetCount = 0;                   // contador reinicios (persistente)
+uint16_t sleepEvery = 0;              // modo lote: muestras por mensaje, 0 = apagado (persistente)
+
+// Registro en NVS. Campos nuevos: al final, y subir la versión.
+struct BotConfig {
+  int32_t intervalMs;
+  uint8_t autoSend;
+  uint32_t resetCount;
+  uint16_t sleepEvery;         // v2
+};
+ConfigStore<BotConfig, 2> config("botcfg", BotConfig{10000, 1, 0, 0});
 
 // ===== Antibloqueos / redes =====
-unsigned long lastBotPoll = 0;
 const unsigned long botPollIntervalMs = 3000;  // no consultar más seguido que esto
 const int telegramLongPollSec = 10;            // long poll interno
 const uint16_t tlsTimeoutMs = 12000;           // timeout TLS
 
+// ===== Tareas y colas =====
+// Los mensajes viajan copiados en buffers fijos (las colas de FreeRTOS copian
+// por valor): ningún String cruza de una tarea a otra.
+struct Reading {
+  FilteredReading f;           // temp/hum filtrados y cuándo hubo el último dato bueno
+  float tempCPU;
+  uint32_t ms;                 // millis() de la muestra
+  DhtError err;                // resultado de la última trama
+};
+
+struct InMsg {
+  char chatId[24];
+  char text[96];               // los comandos son cortos; lo demás se trunca
+};
+
+QueueHandle_t readingQ;        // buzón de 1: siempre la última lectura (xQueueOverwrite)
+QueueHandle_t inQ;             // red -> comandos
+const UBaseType_t IN_Q_LEN = 8;
+
+// Salida: comandos/setup -> red. outboxLock nunca se tiene durante un envío;
+// outboxSignal despierta a la tarea de red cuando hay algo nuevo.
+TelegramOutbox outbox;
+SemaphoreHandle_t outboxLock;
+SemaphoreHandle_t outboxSignal;
+
+JitterStats samplerJitter(SAMPLE_PERIOD_MS);
+
+// ===== Perfil de llamadas bloqueantes =====
+// En memoria RTC: sobrevive al reinicio por watchdog. La tarea de muestreo
+// da el latido; la llamada en curso al cortarse queda registrada.
+enum ProfSite : uint8_t {
+  PROF_GET_UPDATES, PROF_SEND_MESSAGE, PROF_DHT_READ, PROF_WIFI_RECONNECT, PROF_SAVE_CONFIG, PROF_SITES
+};
+const char* const kProfNames[PROF_SITES] = {"getUpdates", "sendMessage", "DHT22", "WiFi.reconnect", "saveConfig"};
+RTC_NOINIT_ATTR BlockProfile profileRtc;
+BlockProfiler profiler(profileRtc, kProfNames, PROF_SITES);
+uint32_t inDrops = 0;          // comandos perdidos por cola llena
+
+// ===== Modo lote =====
+// Las lecturas esperan el próximo envío en RTC: sobreviven al deep sleep
+RTC_DATA_ATTR SleepBatchRtc batchRtc;
+SleepBatch batch(batchRtc);
+bool inBatchWindow = false;    // comandos atendidos dentro de una ventana de radio
+const unsigned long batchWifiTimeoutMs = 10000;  // sin AP: se reintenta más adelante
+const unsigned long batchWindowMs = 20000;       // tope de radio prendida por despertar
+
 // ===== Sensor interno de temperatura (NO calibrado) =====
 extern "C" uint8_t temprature_sens_read();
 float getInternalTempESP32() {
@@ -70,7 +172,7 @@ float getInternalTempESP32() {
 }
 
 // ===== Utilidades =====
-String getResetReason() {
+const char* getResetReason() {
   switch (esp_reset_reason()) {
     case ESP_RST_POWERON:     return "🔌 Power On";
     case ESP_RST_EXT:         return "🔁 Pin externo";
@@ -86,14 +188,15 @@ String getResetReason() {
   }
 }
 
-String fmtHMS(unsigned long ms) {
+// buf de al menos 16 bytes; las horas se topan en 99999 (más de 11 años)
+const char* fmtHMS(unsigned long ms, char* buf) {
   unsigned long s = ms / 1000;
   unsigned long h = s / 3600;
+  if (h > 99999) h = 99999;
   unsigned long m = (s % 3600) / 60;
   unsigned long ss = s % 60;
-  char buf[16];
-  snprintf(buf, sizeof(buf), "%02lu:%02lu:%02lu", h, m, ss);
-  return String(buf);
+  snprintf(buf, 16, "%02lu:%02lu:%02lu", h, m, ss);
+  return buf;
 }
 
 unsigned long remainingForNextSend() {
@@ -104,24 +207,43 @@ unsigned long remainingForNextSend() {
   return (unsigned long)interval - elapsed;
 }
 
-// ===== SPIFFS: carga/guarda config =====
-const char* CFG_PATH = "/config.json";
+// "hh:mm:ss" hasta el próximo envío automático o "N/A (manual)"
+const char* nextSendText(char* buf) {
+  return autoSend ? fmtHMS(remainingForNextSend(), buf) : "N/A (manual)";
+}
 
-bool saveConfig() {
-  StaticJsonDocument<256> doc;
-  doc["interval_ms"] = interval;
-  doc["auto_send"]   = autoSend;
-  doc["reset_count"] = resetCount;
+// Radio apagada y a dormir; el despertar arranca de nuevo en setup()
+void enterDeepSleep(uint32_t ms) {
+  WiFi.disconnect(true);
+  WiFi.mode(WIFI_OFF);
+  esp_sleep_enable_timer_wakeup((uint64_t)ms * 1000ULL);
+  esp_deep_sleep_start();
+}
 
-  File f = SPIFFS.open(CFG_PATH, FILE_WRITE);
-  if (!f) return false;
-  bool ok = (serializeJson(doc, f) > 0);
-  f.close();
-  return ok;
+// ===== Config persistente (NVS) =====
+// Los comandos cambian las variables y llaman a saveConfig(): la escritura
+// a flash la hace commandTask cuando pasan CONFIG_FLUSH_MS sin más cambios.
+void saveConfig() {
+  BotConfig& c = config.value();
+  c.intervalMs = interval;
+  c.autoSend = autoSend;
+  c.resetCount = resetCount;
+  c.sleepEvery = sleepEvery;
+  config.touch(millis());
 }
 
-bool loadConfig() {
-  if (!SPIFFS.exists(CFG_PATH)) return false;
+// La escritura a flash (la parte bloqueante de guardar la config), medida
+bool writeConfig() {
+  BlockProfiler::Scope p(profiler, PROF_SAVE_CONFIG);
+  return config.flush();
+}
+
+// Config de firmwares anteriores (JSON en SPIFFS): se importa una sola vez.
+// Sin formatear: si no hay SPIFFS tampoco hay nada que migrar.
+const char* CFG_PATH = "/config.json";
+
+bool importLegacyConfig() {
+  if (!SPIFFS.begin(false) || !SPIFFS.exists(CFG_PATH)) return false;
   File f = SPIFFS.open(CFG_PATH, FILE_READ);
   if (!f) return false;
 
@@ -136,6 +258,33 @@ bool loadConfig() {
   return true;
 }
 
+// Arranque: leer NVS, sumar el reinicio y una única escritura. Un despertar
+// del modo lote no es un reinicio: sólo lee.
+void bootConfig(bool woke) {
+  bool legacy = false;
+  if (config.begin()) {
+    const BotConfig& c = config.value();
+    interval = c.intervalMs;
+    autoSend = c.autoSend != 0;
+    resetCount = (int)c.resetCount;
+    sleepEvery = c.sleepEvery;
+  } else {
+    legacy = importLegacyConfig();
+  }
+  if (interval < 2000) interval = 10000;  // DHT22 mínimo 2s
+  if (sleepEvery > SLEEP_BATCH_CAPACITY) sleepEvery = SLEEP_BATCH_CAPACITY;
+  if (woke) return;
+
+  resetCount++;
+  saveConfig();
+  if (writeConfig() && legacy) SPIFFS.remove(CFG_PATH);  // ya está en NVS
+
+  const ConfigStoreBase::Stats& cs = config.stats();
+  Serial.printf("💾 Config: %s, lectura %u us, escritura %u us, %u escrituras en total\n",
+                legacy ? "migrada de SPIFFS" : cs.loadedVersion ? "NVS" : "por defecto",
+                (unsigned)cs.loadUs, (unsigned)cs.lastWriteUs, (unsigned)cs.lifetime);
+}
+
 // ===== AP dinámico "ESP32-XXXX" =====
 void makeDynamicApName(char* outName, size_t outLen) {
   String mac = WiFi.macAddress(); // "AA:BB:CC:DD:EE:FF"
@@ -166,241 +315,598 @@ bool connectWithWiFiManager() {
   return ok;
 }
 
-// ===== Telemetría (DHT22 + Temp Interna + 'aire' simulado) =====
-void sendSensorData() {
-  float t = dht.readTemperature();       // °C
-  float h = dht.readHumidity();          // %
-  float tempCPU = getInternalTempESP32();// °C aprox (no calibrado)
+// ===== Cola de salida =====
+// Nunca bloquea: si no hay lugar el mensaje se pierde y se cuenta
+void reply(const char* chat_id, const char* text, const char* parseMode = "",
+           TelegramOutbox::Kind kind = TelegramOutbox::REPLY) {
+  xSemaphoreTake(outboxLock, portMAX_DELAY);
+  outbox.push(chat_id, text, parseMode, kind, millis());
+  xSemaphoreGive(outboxLock);
+  xSemaphoreGive(outboxSignal);
+}
+
+uint8_t outboxDepth() {
+  xSemaphoreTake(outboxLock, portMAX_DELAY);
+  uint8_t d = outbox.depth();
+  xSemaphoreGive(outboxLock);
+  return d;
+}
+
+// Antes de reiniciar: dar tiempo a que salga lo encolado (máx. maxMs)
+void flushOutbox(unsigned long maxMs) {
+  unsigned long t0 = millis();
+  while (outboxDepth() > 0 && millis() - t0 < maxMs) {
+    vTaskDelay(pdMS_TO_TICKS(50));
+  }
+}
+
+// ===== Tarea de muestreo =====
+// Período fijo con vTaskDelayUntil: no depende de cuánto tarde la red
+void samplerTask(void*) {
+  TickType_t lastWake = xTaskGetTickCount();
+  vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(SAMPLE_PERIOD_MS));
+  samplerJitter.start(micros());  // anclado a un borde de tick
+  for (;;) {
+    Reading r;
+    profiler.beat(millis());           // fecha una llamada que corte el watchdog
+    DhtFrame f;
+    {
+      BlockProfiler::Scope p(profiler, PROF_DHT_READ);
+      f = dht.read();                  // ~8 ms durmiendo; una trama = temp + hum
+    }
+    r.ms = millis();
+    sensorFilter.push(f.t, f.h, r.ms); // NaN si la trama falló: no cambia la salida
+    r.f = sensorFilter.latest();
+    r.tempCPU = getInternalTempESP32();// °C aprox (no calibrado)
+    r.err = f.err;
+    xQueueOverwrite(readingQ, &r);
+
+    vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(SAMPLE_PERIOD_MS));
+    if (samplerJitter.wake(micros())) lastWake = xTaskGetTickCount();
+  }
+}
 
-  if (isnan(t) || isnan(h)) {
-    bot.sendMessage(CHANNEL_CHAT_ID, "⚠️ Error leyendo DHT22 (temp/hum). Revisar cableado y pull-up 10k.", "");
+// Texto de las respuestas: sólo lo usa la tarea de comandos (y setup(),
+// antes de crearla). La cola copia el mensaje, así que se reusa enseguida.
+char msgBuf[OUTBOX_TEXT];
+
+// ===== Telemetría (DHT22 + Temp Interna + 'aire' simulado) =====
+// Usa la última lectura de la tarea de muestreo: nunca lee el sensor acá
+void queueSensorData() {
+  Reading r;
+  bool have = xQueuePeek(readingQ, &r, 0) == pdTRUE;
+  if (!have || r.f.stale(millis())) {
+    snprintf(msgBuf, sizeof(msgBuf), "⚠️ Error leyendo DHT22 (%s). Revisar cableado y pull-up 10k.",
+             !have ? "sin lecturas" : r.err != DhtError::OK ? dhtErrorName(r.err) : "lecturas descartadas");
+    reply(CHANNEL_CHAT_ID, msgBuf, "", TelegramOutbox::TELEMETRY);
+    previousMillis = millis();
     return;
   }
 
   int  calidadAire        = random(100, 500); // simulado
   bool generadorEncendido = random(0, 2);     // simulado
-  String estadoGenerador  = generadorEncendido ? "Encendido 🔌" : "Apagado ❌";
-
-  String message = "📡 *Datos Sistema IoT (Reales DHT22 + Temp Interna):*\n";
-  message += "🌡️ Temp Ambiente: *" + String(t, 1) + " °C*\n";
-  message += "💧 Humedad: *"      + String(h, 1) + " %*\n";
-  message += "🔥 Temp CPU: *"     + String(tempCPU, 1) + " °C* _(sensor interno no calibrado)_\n";
-  message += "🧪 Calidad del Aire: *" + String(calidadAire) + " ppm* _(simulado)_\n";
-  message += "⚙️ Generador: *"    + estadoGenerador + "*\n";
-  message += "🕒 Próximo envío (auto): *" + (autoSend ? fmtHMS(remainingForNextSend()) : String("N/A (manual)")) + "*\n";
-  message += "\n👨‍💻 _Dev. for: Ing. Gambino_";
-
-  bot.sendMessage(CHANNEL_CHAT_ID, message, "Markdown");
+  char hms[16];
+
+  snprintf(msgBuf, sizeof(msgBuf),
+           "📡 *Datos Sistema IoT (Reales DHT22 + Temp Interna):*\n"
+           "🌡️ Temp Ambiente: *%.1f °C*\n"
+           "💧 Humedad: *%.1f %%*\n"
+           "🔥 Temp CPU: *%.1f °C* _(sensor interno no calibrado)_\n"
+           "🧪 Calidad del Aire: *%d ppm* _(simulado)_\n"
+           "⚙️ Generador: *%s*\n"
+           "🕒 Próximo envío (auto): *%s*\n"
+           "\n👨‍💻 _Dev. for: Ing. Gambino_",
+           r.f.t, r.f.h, r.tempCPU, calidadAire, generadorEncendido ? "Encendido 🔌" : "Apagado ❌",
+           nextSendText(hms));
+  reply(CHANNEL_CHAT_ID, msgBuf, "Markdown", TelegramOutbox::TELEMETRY);
 
   // Reinicia la ventana del próximo envío desde este punto
   previousMillis = millis();
 }
 
-// ===== Telegram: manejo de mensajes =====
-void handleNewMessages(int numNewMessages) {
-  for (int i = 0; i < numNewMessages; i++) {
-    String text    = bot.messages[i].text;
-    String chat_id = bot.messages[i].chat_id;
+// ===== Comandos =====
+// Un handler por comando; la tabla de abajo los une con su nombre, su
+// argumento y su línea de /menu.
+extern CommandTable commands;
+
+void cmdMenu(const char* chat_id, const CommandArgs&) {
+  commands.menu(msgBuf, sizeof(msgBuf), "📋 *Menú de Comandos:*\n\n");
+  reply(chat_id, msgBuf, "Markdown");
+}
+
+void cmdDataSensores(const char*, const CommandArgs&) {
+  if (WiFi.status() == WL_CONNECTED) queueSensorData();
+}
+
+void cmdSetInterval(const char* chat_id, const CommandArgs& args) {
+  if (args.ok && args.num >= 2) { // DHT22 mínimo 2s
+    interval = args.num * 1000L;
+    saveConfig();
+    snprintf(msgBuf, sizeof(msgBuf), "⏱️ Intervalo cambiado a *%ld* segundos.", args.num);
+    reply(chat_id, msgBuf, "Markdown");
+    previousMillis = millis(); // arranca nueva ventana
+  } else {
+    reply(chat_id, "⚠️ Intervalo inválido. Debe ser ≥ 2 segundos para DHT22.", "Markdown");
+  }
+}
+
+void cmdSetModo(const char* chat_id, const CommandArgs& args) {
+  if (args.is("auto")) {
+    autoSend = true;  saveConfig(); previousMillis = millis();
+    reply(chat_id, "🔀 Modo de envío: *AUTO* (envío periódico activado).", "Markdown");
+  } else if (args.is("manual")) {
+    autoSend = false; saveConfig();
+    reply(chat_id, "🔀 Modo de envío: *MANUAL* (solo con /DataSensores).", "Markdown");
+  } else {
+    reply(chat_id, "⚠️ Valor inválido. Usá: */setModo auto* o */setModo manual*.", "Markdown");
+  }
+}
+
+void cmdModo(const char* chat_id, const CommandArgs&) {
+  reply(chat_id, autoSend ? "🔎 Modo actual: *AUTO*." : "🔎 Modo actual: *MANUAL*.", "Markdown");
+}
+
+void cmdAPreset(const char* chat_id, const CommandArgs&) {
+  reply(chat_id, "🧹 Borrando credenciales WiFi...", "Markdown");
+  wm.resetSettings();
+  #if ENABLE_SOFT_RESET
+    reply(chat_id, "🔁 Reiniciando ESP32...", "Markdown");
+    writeConfig();
+    flushOutbox(tlsTimeoutMs);
+    ESP.restart();
+  #else
+    reply(chat_id, "⛔ Reinicio por software *deshabilitado temporalmente*.\n"
+                   "Reiniciá manualmente para aplicar los cambios.", "Markdown");
+  #endif
+}
+
+// Agrega una línea con snprintf sin pasarse de cap. Si no entra entera no
+// agrega nada y las siguientes tampoco: el Markdown nunca queda cortado.
+static void appendLine(char* buf, size_t cap, size_t& len, const char* fmt, ...) {
+  if (len >= cap) return;
+  va_list ap;
+  va_start(ap, fmt);
+  int n = vsnprintf(buf + len, cap - len, fmt, ap);
+  va_end(ap);
+  if (n < 0 || (size_t)n >= cap - len) {
+    buf[len] = '\0';
+    len = cap;
+    return;
+  }
+  len += (size_t)n;
+}
+
+void cmdStatus(const char* chat_id, const CommandArgs&) {
+  xSemaphoreTake(outboxLock, portMAX_DELAY);
+  TelegramOutbox::Stats os = outbox.stats();
+  uint8_t depth = outbox.depth();
+  xSemaphoreGive(outboxLock);
+  const TelegramClient::Stats& ts = tg.stats();
+  const ConfigStoreBase::Stats& cs = config.stats();
+  const Dht22Async::Stats& ds = dht.stats();
+  char hms[16];
+
+  size_t len = 0;
+  msgBuf[0] = '\0';
+  appendLine(msgBuf, sizeof(msgBuf), len, "📈 *Estado General:*\n");
+  appendLine(msgBuf, sizeof(msgBuf), len, "🔁 Reinicios (persistente): *%d*\n", resetCount);
+  appendLine(msgBuf, sizeof(msgBuf), len, "⏱️ Intervalo: *%ld s*\n", interval / 1000);
+  appendLine(msgBuf, sizeof(msgBuf), len, "🕹️ Modo: *%s*\n", autoSend ? "AUTO" : "MANUAL");
+  appendLine(msgBuf, sizeof(msgBuf), len, "⏳ Próximo envío: *%s*\n", nextSendText(hms));
+  appendLine(msgBuf, sizeof(msgBuf), len, "📶 WiFi: *%s*\n",
+             WiFi.status() == WL_CONNECTED ? "Conectado ✅" : "Desconectado ❌");
+  appendLine(msgBuf, sizeof(msgBuf), len, "🌐 SSID: *%s*\n", WiFi.SSID().c_str());
+  appendLine(msgBuf, sizeof(msgBuf), len, "📝 Último reinicio: *%s*\n", getResetReason());
+  appendLine(msgBuf, sizeof(msgBuf), len, "🧠 Heap libre: *%u B* (min: %u B)\n",
+             (unsigned)ESP.getFreeHeap(), (unsigned)ESP.getMinFreeHeap());
+  appendLine(msgBuf, sizeof(msgBuf), len, "⏲️ Muestreo: *%u* lecturas, jitter máx *%u µs*, perdidas *%u*\n",
+             (unsigned)samplerJitter.samples, (unsigned)samplerJitter.maxUs, (unsigned)samplerJitter.overruns);
+  appendLine(msgBuf, sizeof(msgBuf), len, "🌡️ DHT22: *%u/%u* tramas bien, último error: *%s*, picos descartados *%u*\n",
+             (unsigned)ds.ok, (unsigned)ds.frames,
+             ds.lastErr == DhtError::OK ? "ninguno" : dhtErrorName(ds.lastErr),
+             (unsigned)sensorFilter.stats().spikes);
+  appendLine(msgBuf, sizeof(msgBuf), len,
+             "📤 Salida: *%u* pendientes (máx %u), enviados *%u*, agrupados *%u*, reintentos *%u*, 429 *%u*\n",
+             depth, os.maxDepth, (unsigned)os.sent, (unsigned)os.coalesced, (unsigned)os.retries,
+             (unsigned)os.rateLimited);
+  appendLine(msgBuf, sizeof(msgBuf), len, "🗑️ Descartes: cola *%u*, vencidos *%u*, rechazados *%u*, comandos *%u*\n",
+             (unsigned)os.dropped, (unsigned)os.expired, (unsigned)os.rejected, (unsigned)inDrops);
+  appendLine(msgBuf, sizeof(msgBuf), len, "🔐 TLS: *%u* handshakes (%u ms prom.), *%u* peticiones reusando conexión\n",
+             (unsigned)ts.connects, (unsigned)(ts.connects ? ts.connectMsSum / ts.connects : 0), (unsigned)ts.reused);
+  appendLine(msgBuf, sizeof(msgBuf), len, "⏱️ sendMessage: *%u ms* prom., máx *%u ms*\n",
+             (unsigned)(ts.sends ? ts.sendMsSum / ts.sends : 0), (unsigned)ts.sendMsMax);
+  appendLine(msgBuf, sizeof(msgBuf), len, "💾 Config: *%u* escrituras a flash en este arranque, *%u* en total%s",
+             (unsigned)cs.writes, (unsigned)cs.lifetime, config.dirty() ? " (cambios pendientes)" : "");
+  reply(chat_id, msgBuf, "Markdown");
+}
+
+void cmdReset(const char* chat_id, const CommandArgs&) {
+  #if ENABLE_SOFT_RESET
+    reply(chat_id, "🔁 Reiniciando ESP32...", "Markdown");
+    writeConfig();
+    flushOutbox(tlsTimeoutMs);
+    ESP.restart();
+  #else
+    reply(chat_id, "⛔ Reinicio por software *deshabilitado temporalmente*.", "Markdown");
+  #endif
+}
+
+void cmdClearResetCount(const char* chat_id, const CommandArgs&) {
+  resetCount = 0; saveConfig();
+  reply(chat_id, "♻️ *Contador de reinicios reiniciado.*", "Markdown");
+}
+
+void cmdInfoDevices(const char* chat_id, const CommandArgs&) {
+  char hms[16], up[16];
+  snprintf(msgBuf, sizeof(msgBuf),
+           "🖥️ *Info del Dispositivo:*\n"
+           "🆔 ID: *%x*\n"
+           "🔗 MAC: *%s*\n"
+           "🌐 SSID: *%s*\n"
+           "📡 IP: *%s*\n"
+           "📶 RSSI: *%d dBm*\n"
+           "🌡️ Temp CPU: *%.1f °C* _(sensor interno no calibrado)_\n"
+           "⏳ Próximo envío: *%s*\n"
+           "⏱️ Uptime: *%s*",
+           (unsigned)(uint32_t)ESP.getEfuseMac(), WiFi.macAddress().c_str(), WiFi.SSID().c_str(),
+           WiFi.localIP().toString().c_str(), (int)WiFi.RSSI(), getInternalTempESP32(), nextSendText(hms),
+           fmtHMS(millis(), up));
+  reply(chat_id, msgBuf, "Markdown");
+}
+
+// /profile: histograma y peores llamadas bloqueantes (de todos los
+// arranques desde el último encendido); /profile reset lo borra
+void cmdProfile(const char* chat_id, const CommandArgs& args) {
+  if (args.is("reset")) {
+    profiler.clear();
+    reply(chat_id, "🧹 *Perfil de llamadas borrado.*", "Markdown");
+    return;
+  }
+  profiler.report(msgBuf, sizeof(msgBuf));
+  reply(chat_id, msgBuf, "Markdown");
+}
+
+// /setSleep N: modo lote, una lectura por intervalo en deep sleep y un
+// mensaje cada N. Activado desde el modo normal se duerme enseguida; dentro
+// de una ventana de radio se aplica al terminarla (0: sigue el arranque normal).
+void cmdSetSleep(const char* chat_id, const CommandArgs& args) {
+  if (!args.ok || args.num < 0 || args.num > SLEEP_BATCH_CAPACITY) {
+    snprintf(msgBuf, sizeof(msgBuf), "⚠️ Usá */setSleep N* (1 a %u muestras por mensaje) o */setSleep 0* para apagarlo.",
+             (unsigned)SLEEP_BATCH_CAPACITY);
+    reply(chat_id, msgBuf, "Markdown");
+    return;
+  }
+  sleepEvery = (uint16_t)args.num;
+  saveConfig();
+  if (!sleepEvery) {
+    reply(chat_id, "☀️ Modo lote *apagado*: el bot queda siempre conectado.", "Markdown");
+    return;
+  }
+  snprintf(msgBuf, sizeof(msgBuf),
+           "🌙 Modo lote: una lectura cada *%ld s* y un mensaje cada *%u*. "
+           "Los comandos se atienden al mandar cada lote.", interval / 1000, (unsigned)sleepEvery);
+  reply(chat_id, msgBuf, "Markdown");
+  if (!inBatchWindow) {
+    writeConfig();
+    flushOutbox(tlsTimeoutMs);
+    enterDeepSleep(interval);
+  }
+}
 
-    // Si es vacío o no es comando → sugerimos el menú
-    if (text.length() == 0 || !text.startsWith("/")) {
-      if (chat_id.length() > 0) {
-        bot.sendMessage(chat_id, "ℹ️ Mensaje recibido.\nUsá */menu* para ver los comandos disponibles.", "Markdown");
+// Orden = orden de /menu. help nullptr: no aparece en el menú.
+const Command kCommands[] = {
+  {"/menu",            "📋", "",                nullptr,                              ArgType::NONE, cmdMenu},
+  {"/DataSensores",    "📊", "",                "Enviar datos actuales al canal",     ArgType::NONE, cmdDataSensores},
+  {"/APreset",         "🧹", "",                "Borrar WiFi y reiniciar",            ArgType::NONE, cmdAPreset},
+  {"/setInterval",     "⏱️", "[seg]",           "Cambiar intervalo (≥2s)",            ArgType::INT,  cmdSetInterval},
+  {"/setModo",         "🔀", "[auto|manual]",   "Seleccionar modo de envío",          ArgType::WORD, cmdSetModo},
+  {"/modo",            "🔎", "",                "Mostrar modo actual (auto/manual)",  ArgType::NONE, cmdModo},
+  {"/status",          "📈", "",                "Estado general (incluye tiempo restante)", ArgType::NONE, cmdStatus},
+  {"/reset",           "🔁", "",                "Reiniciar ESP32",                    ArgType::NONE, cmdReset},
+  {"/infoDevices",     "🖥️", "",                "Info del dispositivo",               ArgType::NONE, cmdInfoDevices},
+  {"/clearResetCount", "♻️", "",                "Resetear contador",                  ArgType::NONE, cmdClearResetCount},
+  {"/profile",         "🧭", "[reset]",         "Llamadas bloqueantes (entre reinicios)", ArgType::WORD, cmdProfile},
+  {"/setSleep",        "🌙", "[N]",             "Modo lote: deep sleep, 1 mensaje cada N (0 = no)", ArgType::INT, cmdSetSleep},
+};
+CommandTable commands(kCommands);
+
+// ===== Telegram: manejo de mensajes (tarea de comandos) =====
+void handleCommand(const InMsg& msg) {
+  switch (commands.dispatch(msg.chatId, msg.text)) {
+    case CommandTable::HANDLED:
+      break;
+    case CommandTable::NOT_COMMAND:
+      // Si es vacío o no es comando → sugerimos el menú
+      if (msg.chatId[0]) {
+        reply(msg.chatId, "ℹ️ Mensaje recibido.\nUsá */menu* para ver los comandos disponibles.", "Markdown");
       }
+      break;
+    case CommandTable::UNKNOWN:
+      reply(msg.chatId, "❌ *Comando no reconocido.*\nℹ️ Usá */menu* para ver los comandos disponibles.", "Markdown");
+      break;
+  }
+}
+
+// ===== Tarea de comandos =====
+// Espera comandos hasta que toque el envío automático; nunca toca la red
+void commandTask(void*) {
+  InMsg msg;
+  for (;;) {
+    // Salida casi llena: los comandos esperan en inQ (y en Telegram) a que la
+    // red envíe algo, así una ráfaga no pierde respuestas. Quedan 2 lugares
+    // para comandos que contestan más de un mensaje.
+    if (outboxDepth() >= OUTBOX_SLOTS - 2) {
+      vTaskDelay(pdMS_TO_TICKS(20));
       continue;
     }
-
-    // ---- Comandos ----
-    if (text == "/menu") {
-      String reply = "📋 *Menú de Comandos:*\n\n";
-      reply += "📊 /DataSensores - Enviar datos actuales al canal\n";
-      reply += "🧹 /APreset - Borrar WiFi y reiniciar\n";
-      reply += "⏱️ /setInterval [seg] - Cambiar intervalo (≥2s)\n";
-      reply += "🔀 /setModo [auto|manual] - Seleccionar modo de envío\n";
-      reply += "🔎 /modo - Mostrar modo actual (auto/manual)\n";
-      reply += "📈 /status - Estado general (incluye tiempo restante)\n";
-      reply += "🔁 /reset - Reiniciar ESP32\n";
-      reply += "🖥️ /infoDevices - Info del dispositivo\n";
-      reply += "♻️ /clearResetCount - Resetear contador";
-      bot.sendMessage(chat_id, reply, "Markdown");
-
-    } else if (text == "/DataSensores") {
-      if (WiFi.status() == WL_CONNECTED) sendSensorData();
-
-    } else if (text.startsWith("/setInterval ")) {
-      String arg = text.substring(13);
-      long newInterval = arg.toInt() * 1000L;
-      if (newInterval >= 2000) { // DHT22 mínimo 2s
-        interval = newInterval;
-        saveConfig();
-        bot.sendMessage(chat_id, "⏱️ Intervalo cambiado a *" + String(newInterval / 1000) + "* segundos.", "Markdown");
-        previousMillis = millis(); // arranca nueva ventana
+    uint32_t waitMs = config.dueInMs(millis());
+    if (autoSend && remainingForNextSend() < waitMs) waitMs = remainingForNextSend();
+    TickType_t wait = waitMs == UINT32_MAX ? portMAX_DELAY : pdMS_TO_TICKS(waitMs);
+    if (xQueueReceive(inQ, &msg, wait) == pdTRUE) handleCommand(msg);
+
+    // Config cambiada por comandos: se escribe cuando dejan de llegar cambios
+    if (config.dueInMs(millis()) == 0) writeConfig();
+
+    // Envío automático
+    if (autoSend && remainingForNextSend() == 0) {
+      if (WiFi.status() == WL_CONNECTED) {
+        queueSensorData();
       } else {
-        bot.sendMessage(chat_id, "⚠️ Intervalo inválido. Debe ser ≥ 2 segundos para DHT22.", "Markdown");
+        previousMillis = millis(); // evita saturar si no hay WiFi
       }
+    }
+  }
+}
 
-    } else if (text.startsWith("/setModo ")) {
-      String arg = text.substring(9); arg.toLowerCase();
-      if (arg == "auto") {
-        autoSend = true;  saveConfig(); previousMillis = millis();
-        bot.sendMessage(chat_id, "🔀 Modo de envío: *AUTO* (envío periódico activado).", "Markdown");
-      } else if (arg == "manual") {
-        autoSend = false; saveConfig();
-        bot.sendMessage(chat_id, "🔀 Modo de envío: *MANUAL* (solo con /DataSensores).", "Markdown");
-      } else {
-        bot.sendMessage(chat_id, "⚠️ Valor inválido. Usá: */setModo auto* o */setModo manual*.", "Markdown");
-      }
+// ===== Tarea de red =====
+// Única dueña de la conexión TLS: vacía la cola de salida y hace el polling
+// de Telegram. Sus bloqueos (long poll, handshakes) sólo la frenan a ella.
+
+// Envía lo que la cola deje salir ahora. Devuelve cuánto falta para el
+// próximo envío posible (UINT32_MAX si no queda nada).
+uint32_t drainOutbox() {
+  for (;;) {
+    int id;
+    xSemaphoreTake(outboxLock, portMAX_DELAY);
+    const TelegramOutbox::Msg* m = outbox.next(millis(), id);
+    uint32_t wait = m ? 0 : outbox.waitMs(millis());
+    xSemaphoreGive(outboxLock);
+    if (!m) return wait;
+
+    // El slot queda reservado hasta complete(): se envía sin tener el lock
+    TelegramClient::Result r;
+    {
+      BlockProfiler::Scope p(profiler, PROF_SEND_MESSAGE);
+      r = tg.sendMessage(m->chatId, m->text, m->parseMode);
+    }
+    if (r.status != 200) {
+      Serial.printf("⚠️ sendMessage a %s: HTTP %d\n", m->chatId, r.status);
+    }
+    xSemaphoreTake(outboxLock, portMAX_DELAY);
+    outbox.complete(id, r.status, r.retryAfterS * 1000UL, millis());
+    xSemaphoreGive(outboxLock);
+  }
+}
 
-    } else if (text == "/modo") {
-      bot.sendMessage(chat_id, String("🔎 Modo actual: *") + (autoSend ? "AUTO" : "MANUAL") + "*.", "Markdown");
-
-    } else if (text == "/APreset") {
-      bot.sendMessage(chat_id, "🧹 Borrando credenciales WiFi...", "Markdown");
-      wm.resetSettings();
-      #if ENABLE_SOFT_RESET
-        bot.sendMessage(chat_id, "🔁 Reiniciando ESP32...", "Markdown");
-        delay(200);
-        ESP.restart();
-      #else
-        bot.sendMessage(chat_id, "⛔ Reinicio por software *deshabilitado temporalmente*.\n"
-                                 "Reiniciá manualmente para aplicar los cambios.", "Markdown");
-      #endif
-
-    } else if (text == "/status") {
-      unsigned long rem = remainingForNextSend();
-      String message = "📈 *Estado General:*\n";
-      message += "🔁 Reinicios (persistente): *" + String(resetCount) + "*\n";
-      message += "⏱️ Intervalo: *" + String(interval / 1000) + " s*\n";
-      message += "🕹️ Modo: *" + String(autoSend ? "AUTO" : "MANUAL") + "*\n";
-      message += "⏳ Próximo envío: *" + (autoSend ? fmtHMS(rem) : String("N/A (manual)")) + "*\n";
-      message += "📶 WiFi: *" + String(WiFi.status() == WL_CONNECTED ? "Conectado ✅" : "Desconectado ❌") + "*\n";
-      message += "🌐 SSID: *" + WiFi.SSID() + "*\n";
-      message += "📝 Último reinicio: *" + getResetReason() + "*\n";
-      message += "🧠 Heap libre: *" + String(ESP.getFreeHeap()) + " B* (min: " + String(ESP.getMinFreeHeap()) + " B)";
-      bot.sendMessage(chat_id, message, "Markdown");
-
-    } else if (text == "/reset") {
-      #if ENABLE_SOFT_RESET
-        bot.sendMessage(chat_id, "🔁 Reiniciando ESP32...", "Markdown");
-        delay(300);
-        ESP.restart();
-      #else
-        bot.sendMessage(chat_id, "⛔ Reinicio por software *deshabilitado temporalmente*.", "Markdown");
-      #endif
-
-    } else if (text == "/clearResetCount") {
-      resetCount = 0; saveConfig();
-      bot.sendMessage(chat_id, "♻️ *Contador de reinicios reiniciado.*", "Markdown");
-
-    } else if (text == "/infoDevices") {
-      float tempCPU = getInternalTempESP32();
-      String message = "🖥️ *Info del Dispositivo:*\n";
-      message += "🆔 ID: *" + String((uint32_t)ESP.getEfuseMac(), HEX) + "*\n";
-      message += "🔗 MAC: *" + WiFi.macAddress() + "*\n";
-      message += "🌐 SSID: *" + WiFi.SSID() + "*\n";
-      message += "📡 IP: *" + WiFi.localIP().toString() + "*\n";
-      message += "📶 RSSI: *" + String(WiFi.RSSI()) + " dBm*\n";
-      message += "🌡️ Temp CPU: *" + String(tempCPU, 1) + " °C* _(sensor interno no calibrado)_\n";
-      unsigned long rem = remainingForNextSend();
-      message += "⏳ Próximo envío: *" + (autoSend ? fmtHMS(rem) : String("N/A (manual)")) + "*\n";
-      unsigned long up = millis();
-      message += "⏱️ Uptime: *" + fmtHMS(up) + "*";
-      bot.sendMessage(chat_id, message, "Markdown");
+void networkTask(void*) {
+  TelegramClient::Update updates[4];
+  InMsg in;
+  unsigned long lastBotPoll = 0;
+  unsigned long lastTry = 0;
+  bool backlog = false;        // el último getUpdates vino lleno: hay más esperando
+  for (;;) {
+    unsigned long now = millis();
+
+    // Reintento básico de WiFi (cada 30s)
+    if (WiFi.status() != WL_CONNECTED) {
+      if (now - lastTry > 30000UL) {
+        lastTry = now;
+        {
+          BlockProfiler::Scope p(profiler, PROF_WIFI_RECONNECT);
+          WiFi.reconnect();
+        }
+        tg.stop();  // la conexión TLS no sobrevive al corte
+      }
+      vTaskDelay(pdMS_TO_TICKS(500));
+      continue;
+    }
 
+    // Primero lo pendiente (respuestas y telemetría)
+    uint32_t outWait = drainOutbox();
+
+    // Polling de Telegram: no más frecuente que botPollIntervalMs, salvo
+    // que haya updates acumulados (entonces en lotes completos, apenas haya
+    // lugar). Se piden sólo los que entran en inQ: el resto queda en
+    // Telegram hasta el próximo poll.
+    now = millis();
+    int room = (int)uxQueueSpacesAvailable(inQ);
+    if (room > 4) room = 4;
+    if (backlog ? room == 4 : (room > 0 && now - lastBotPoll >= botPollIntervalMs)) {
+      lastBotPoll = now;
+      // Que el long poll termine antes del próximo envío automático o de
+      // que la cola pueda volver a enviar (backoff, límite por chat)
+      unsigned long rem = outWait;
+      if (autoSend && remainingForNextSend() < rem) rem = remainingForNextSend();
+      int pollS = rem / 1000 < (unsigned long)telegramLongPollSec ? (int)(rem / 1000) : telegramLongPollSec;
+      int n;
+      {
+        BlockProfiler::Scope p(profiler, PROF_GET_UPDATES);
+        n = tg.getUpdates(backlog ? 0 : pollS, updates, room);
+      }
+      for (int i = 0; i < n; i++) {
+        memcpy(in.chatId, updates[i].chatId, sizeof(in.chatId));
+        memcpy(in.text, updates[i].text, sizeof(in.text));
+        if (xQueueSend(inQ, &in, 0) != pdTRUE) inDrops++;
+      }
+      backlog = n == room;
     } else {
-      bot.sendMessage(chat_id, "❌ *Comando no reconocido.*\nℹ️ Usá */menu* para ver los comandos disponibles.", "Markdown");
+      // Hasta el próximo poll: despertar apenas haya algo para enviar
+      unsigned long idle = backlog ? 50 : botPollIntervalMs - (now - lastBotPoll);
+      if (outWait < idle) idle = outWait;
+      xSemaphoreTake(outboxSignal, pdMS_TO_TICKS(idle));
     }
   }
 }
 
+// ===== Modo lote: un despertar =====
+// Ventana de radio: WiFi con las credenciales guardadas (sin portal: a
+// batería no se puede esperar a nadie), el lote en uno o más mensajes, los
+// comandos pendientes y sus respuestas. false si la red no anduvo.
+bool batchWindow() {
+  unsigned long t0 = millis();
+  WiFi.mode(WIFI_STA);
+  WiFi.begin();
+  while (WiFi.status() != WL_CONNECTED && millis() - t0 < batchWifiTimeoutMs) delay(50);
+  if (WiFi.status() != WL_CONNECTED) return false;
+
+  bool ok = true;
+  while (ok && batch.pending() > 0 && millis() - t0 < batchWindowMs) {
+    uint16_t taken;
+    batch.format(msgBuf, sizeof(msgBuf), interval, millis(), taken);
+    TelegramClient::Result r;
+    {
+      BlockProfiler::Scope p(profiler, PROF_SEND_MESSAGE);
+      r = tg.sendMessage(CHANNEL_CHAT_ID, msgBuf, "Markdown");
+    }
+    ok = r.status == 200;
+    if (ok) batch.sent(taken);
+    else Serial.printf("⚠️ Lote: HTTP %d\n", r.status);
+  }
+  if (!ok) return false;
+
+  // Comandos que llegaron mientras dormía: sin long poll
+  TelegramClient::Update updates[4];
+  int n;
+  {
+    BlockProfiler::Scope p(profiler, PROF_GET_UPDATES);
+    n = tg.getUpdates(0, updates, 4);
+  }
+  InMsg in;
+  inBatchWindow = true;
+  for (int i = 0; i < n; i++) {
+    memcpy(in.chatId, updates[i].chatId, sizeof(in.chatId));
+    memcpy(in.text, updates[i].text, sizeof(in.text));
+    handleCommand(in);
+  }
+  inBatchWindow = false;
+  if (config.dirty()) writeConfig();
+
+  // Respuestas: lo que no salga antes del tope se pierde con el sueño
+  while (outboxDepth() > 0 && millis() - t0 < batchWindowMs) {
+    uint32_t wait = drainOutbox();
+    if (outboxDepth() > 0) delay(wait < 200 ? wait : 200);
+  }
+  return true;
+}
+
+// Lectura, ventana de radio si toca y a dormir. Sólo vuelve si un
+// /setSleep 0 apagó el modo lote: entonces sigue el arranque normal.
+void sleepCycle(bool retained) {
+  batch.begin(retained);
+  DhtFrame f;
+  {
+    BlockProfiler::Scope p(profiler, PROF_DHT_READ);
+    f = dht.read();
+  }
+  batch.push(f.t, f.h, millis());
+
+  // La misma lectura para /DataSensores dentro de la ventana
+  Reading r;
+  r.ms = millis();
+  sensorFilter.push(f.t, f.h, r.ms);
+  r.f = sensorFilter.latest();
+  r.tempCPU = getInternalTempESP32();
+  r.err = f.err;
+  xQueueOverwrite(readingQ, &r);
+
+  if (batch.radioDue()) {
+    unsigned long t0 = millis();
+    bool ok = batchWindow();
+    batch.radioDone(ok, sleepEvery, millis() - t0);
+  }
+  if (!sleepEvery) return;
+  profiler.beat(millis());
+  enterDeepSleep(batch.sleepMs(interval, millis()));
+}
+
 // ===== SETUP =====
 void setup() {
   Serial.begin(115200);
   Serial.println("\n=== BOOT ===");
-  Serial.printf("Reset reason: %s\n", getResetReason().c_str());
-
-  // FS
-  if (!SPIFFS.begin(true)) {
-    Serial.println("❌ SPIFFS no montó. (Se intentó formatear)");
-  }
+  Serial.printf("Reset reason: %s\n", getResetReason());
 
-  // Cargar config
-  if (!loadConfig()) {
-    interval = 10000;
-    autoSend = true;
-    resetCount = 0;
-    saveConfig();
-  }
+  // Perfil y lote en RTC: se conservan salvo encendido o brownout
+  esp_reset_reason_t why = esp_reset_reason();
+  bool retained = why != ESP_RST_POWERON && why != ESP_RST_BROWNOUT && why != ESP_RST_UNKNOWN;
+  profiler.begin(retained);
+  uint8_t cutSite;
+  uint32_t cutMs;
+  bool cut = profiler.interrupted(cutSite, cutMs);
+  if (cut) Serial.printf("🧭 Reinicio durante %s (>= %u ms)\n", profiler.name(cutSite), (unsigned)cutMs);
 
-  // Contador de reinicios (persistente)
-  resetCount++;
-  saveConfig();
+  // Config (NVS) + contador de reinicios: una escritura
+  bootConfig(why == ESP_RST_DEEPSLEEP);
 
   // DHT22
   dht.begin();
 
-  // WiFiManager
-  bool wifiOk = connectWithWiFiManager();
+  // Índice de comandos (hash perfecto sobre kCommands)
+  if (!commands.begin()) Serial.println("❌ Tabla de comandos: nombres repetidos");
 
   // TLS / Telegram
-  secured_client.setInsecure();          // Para producción, usar setCACert() con root CA de Telegram
+  secured_client.setCACert(TELEGRAM_ROOT_CA);  // verifica cadena y nombre (api.telegram.org)
   secured_client.setTimeout(tlsTimeoutMs);
-  bot.longPoll = telegramLongPollSec;
+  tg.setTimeout(tlsTimeoutMs);
+
+  // Colas (antes del modo lote y del mensaje de arranque, que ya las usan)
+  readingQ = xQueueCreate(1, sizeof(Reading));
+  inQ = xQueueCreate(IN_Q_LEN, sizeof(InMsg));
+  outboxLock = xSemaphoreCreateMutex();
+  outboxSignal = xSemaphoreCreateBinary();
+
+  // Modo lote: no vuelve de acá (duerme) salvo que lo apaguen por comando
+  if (sleepEvery) sleepCycle(retained);
+
+  // WiFiManager
+  bool wifiOk = connectWithWiFiManager();
 
   // Ventana de envío
   previousMillis = millis();
-  lastBotPoll = 0;
 
   // Mensaje de arranque
   if (wifiOk) {
     String bootMsg = "✅ *Sistema Iniciado*\n";
     bootMsg += "📅 Build: " + String(__DATE__) + " " + String(__TIME__) + "\n";
-    bootMsg += "📝 Motivo: *" + getResetReason() + "*\n";
+    bootMsg += "📝 Motivo: *" + String(getResetReason()) + "*\n";
+    if (cut) {
+      bootMsg += "🧭 En curso al reiniciar: *" + String(profiler.name(cutSite)) + "* (≥ " + String(cutMs) + " ms)\n";
+    }
+    uint8_t worstSite;
+    BlockCall worst;
+    if (profiler.worst(worstSite, worst)) {
+      bootMsg += "🐢 Peor llamada: *" + String(profiler.name(worstSite)) + "* " + String(worst.us / 1000) +
+                 " ms (arranque " + String(worst.boot) + ")\n";
+    }
     bootMsg += "🔁 Reinicios (persistente): *" + String(resetCount) + "*\n";
     bootMsg += "🕹️ Modo: *" + String(autoSend ? "AUTO" : "MANUAL") + "* | ⏱️ Intervalo: *" + String(interval / 1000) + " s*\n";
     bootMsg += "🌐 SSID: *" + WiFi.SSID() + "*\n";
     bootMsg += "📶 WiFi: *" + String(WiFi.status() == WL_CONNECTED ? "✅" : "❌") + "*\n";
     bootMsg += "🧠 Heap libre: *" + String(ESP.getFreeHeap()) + " B*"; // 
-    bot.sendMessage(CHANNEL_CHAT_ID, bootMsg, "Markdown");
+    reply(CHANNEL_CHAT_ID, bootMsg.c_str(), "Markdown");
   } else {
     Serial.println("📶 Configurá WiFi desde el portal (AP) para habilitar Telegram.");
   }
 
   randomSeed(esp_random());
+
+  // Tareas: la red en el core 0 (donde corre la pila WiFi), el resto en el 1
+  xTaskCreatePinnedToCore(samplerTask, "muestreo", 3072, nullptr, 5, nullptr, 1);
+  xTaskCreatePinnedToCore(commandTask, "comandos", 6144, nullptr, 2, nullptr, 1);
+  xTaskCreatePinnedToCore(networkTask, "red", 8192, nullptr, 1, nullptr, 0);
 }
 
 // ===== LOOP =====
+// Todo corre en las tareas: la tarea del loop de Arduino ya no hace falta
 void loop() {
-  unsigned long now = millis();
-
-  // Envío automático
-  if (autoSend && (now - previousMillis >= (unsigned long)interval)) {
-    if (WiFi.status() == WL_CONNECTED) {
-      sendSensorData();
-    } else {
-      previousMillis = now; // evita saturar si no hay WiFi
-    }
-  }
-
-  // Polling de Telegram: no más frecuente que botPollIntervalMs
-  if (WiFi.status() == WL_CONNECTED) {
-    if (now - lastBotPoll >= botPollIntervalMs) {
-      lastBotPoll = now;
-      int numMessages = bot.getUpdates(bot.last_message_received + 1);
-      if (numMessages > 0) {
-        handleNewMessages(numMessages);
-      }
-    }
-  }
-
-  // Reintento básico de WiFi (cada 30s)
-  if (WiFi.status() != WL_CONNECTED) {
-    static unsigned long lastTry = 0;
-    if (now - lastTry > 30000UL) {
-      lastTry = now;
-      WiFi.reconnect();
-    }
-  }
-
-  delay(50); // cede tiempo al scheduler; ayuda contra WDT
+  vTaskDelete(NULL);
 }
@@ -0,0 +1,187 @@
+// Pruebas de CommandTable en el entorno native:
+//   pio test -e native
+// Una tabla chica con los tres tipos de argumento; los handlers dejan en
+// s_last lo que recibieron para comparar.
+#include <Arduino.h>
+#include <CommandTable.h>
+#include <unity.h>
+
+#include <string>
+
+namespace {
+
+struct Call {
+  int handler;        // 0: ninguno
+  std::string chatId;
+  std::string arg;
+  bool ok;
+  long num;
+};
+Call s_last;
+
+void record(int handler, const char *chatId, const CommandArgs &args) {
+  s_last.handler = handler;
+  s_last.chatId = chatId;
+  s_last.arg.assign(args.arg, args.len);
+  s_last.ok = args.ok;
+  s_last.num = args.num;
+}
+void onStatus(const char *chatId, const CommandArgs &args) { record(1, chatId, args); }
+void onInterval(const char *chatId, const CommandArgs &args) { record(2, chatId, args); }
+void onModo(const char *chatId, const CommandArgs &args) { record(3, chatId, args); }
+void onHidden(const char *chatId, const CommandArgs &args) { record(4, chatId, args); }
+
+const Command kCommands[] = {
+  {"/status",      "📈", "",              "Estado general",     ArgType::NONE, onStatus},
+  {"/setInterval", "⏱️", "[seg]",         "Cambiar intervalo",  ArgType::INT,  onInterval},
+  {"/setModo",     "🔀", "[auto|manual]", "Modo de envío",      ArgType::WORD, onModo},
+  {"/oculto",      "",   "",              nullptr,              ArgType::NONE, onHidden},
+};
+CommandTable s_table(kCommands);
+
+CommandTable::Result send(const char *text) {
+  s_last = Call{0, "", "", false, 0};
+  return s_table.dispatch("1001", text);
+}
+
+} // namespace
+
+void setUp() {}
+void tearDown() {}
+
+void test_begin_finds_seed() {
+  TEST_ASSERT_TRUE(s_table.begin());
+  TEST_ASSERT_TRUE(s_table.seed() != 0);
+}
+
+void test_begin_rejects_duplicate_names() {
+  static const Command dup[] = {
+    {"/status", "", "", nullptr, ArgType::NONE, onStatus},
+    {"/status", "", "", nullptr, ArgType::NONE, onHidden},
+  };
+  CommandTable t(dup);
+  TEST_ASSERT_FALSE(t.begin());
+  TEST_ASSERT_NULL(t.find("/status", 7));
+}
+
+void test_find_hit_and_miss() {
+  TEST_ASSERT_EQUAL_PTR(&kCommands[0], s_table.find("/status", 7));
+  TEST_ASSERT_EQUAL_PTR(&kCommands[3], s_table.find("/oculto", 7));
+  TEST_ASSERT_NULL(s_table.find("/statu", 6));
+  TEST_ASSERT_NULL(s_table.find("/statuses", 9));
+  TEST_ASSERT_NULL(s_table.find("/nada", 5));
+}
+
+void test_dispatch_hit() {
+  TEST_ASSERT_EQUAL(CommandTable::HANDLED, send("/status"));
+  TEST_ASSERT_EQUAL(1, s_last.handler);
+  TEST_ASSERT_EQUAL_STRING("1001", s_last.chatId.c_str());
+}
+
+void test_dispatch_not_command_and_unknown() {
+  TEST_ASSERT_EQUAL(CommandTable::NOT_COMMAND, send("hola"));
+  TEST_ASSERT_EQUAL(CommandTable::NOT_COMMAND, send(""));
+  TEST_ASSERT_EQUAL(CommandTable::UNKNOWN, send("/foo"));
+  TEST_ASSERT_EQUAL(CommandTable::UNKNOWN, send("/"));
+  TEST_ASSERT_EQUAL(0, s_last.handler);
+}
+
+// Los nombres distinguen mayúsculas (como los comandos de Telegram); los
+// argumentos se comparan con is() sin distinguirlas
+void test_case_handling() {
+  TEST_ASSERT_EQUAL(CommandTable::UNKNOWN, send("/Status"));
+  TEST_ASSERT_EQUAL(CommandTable::UNKNOWN, send("/setinterval 30"));
+  TEST_ASSERT_EQUAL(CommandTable::HANDLED, send("/setModo AUTO"));
+  CommandArgs args = {"AUTO", 4, true, 0};
+  TEST_ASSERT_TRUE(args.is("auto"));
+  TEST_ASSERT_FALSE(args.is("aut"));
+  TEST_ASSERT_FALSE(args.is("manual"));
+}
+
+void test_bot_suffix() {
+  TEST_ASSERT_EQUAL(CommandTable::HANDLED, send("/status@MiBot"));
+  TEST_ASSERT_EQUAL(1, s_last.handler);
+  TEST_ASSERT_EQUAL(CommandTable::HANDLED, send("/setInterval@MiBot 15"));
+  TEST_ASSERT_TRUE(s_last.ok);
+  TEST_ASSERT_EQUAL(15, s_last.num);
+}
+
+void test_int_argument() {
+  send("/setInterval 30");
+  TEST_ASSERT_EQUAL(2, s_last.handler);
+  TEST_ASSERT_TRUE(s_last.ok);
+  TEST_ASSERT_EQUAL(30, s_last.num);
+  TEST_ASSERT_EQUAL_STRING("30", s_last.arg.c_str());
+
+  send("/setInterval   -5 y más");
+  TEST_ASSERT_TRUE(s_last.ok);
+  TEST_ASSERT_EQUAL(-5, s_last.num);
+
+  send("/setInterval\n7");
+  TEST_ASSERT_TRUE(s_last.ok);
+  TEST_ASSERT_EQUAL(7, s_last.num);
+
+  send("/setInterval");
+  TEST_ASSERT_EQUAL(2, s_last.handler);
+  TEST_ASSERT_FALSE(s_last.ok);
+
+  send("/setInterval 12abc");
+  TEST_ASSERT_FALSE(s_last.ok);
+
+  send("/setInterval abc");
+  TEST_ASSERT_FALSE(s_last.ok);
+}
+
+void test_word_argument() {
+  send("/setModo manual ahora");
+  TEST_ASSERT_EQUAL(3, s_last.handler);
+  TEST_ASSERT_TRUE(s_last.ok);
+  TEST_ASSERT_EQUAL_STRING("manual", s_last.arg.c_str());
+
+  send("/setModo");
+  TEST_ASSERT_FALSE(s_last.ok);
+  TEST_ASSERT_EQUAL_STRING("", s_last.arg.c_str());
+}
+
+void test_none_argument_ignores_rest() {
+  TEST_ASSERT_EQUAL(CommandTable::HANDLED, send("/status ya mismo"));
+  TEST_ASSERT_EQUAL(1, s_last.handler);
+  TEST_ASSERT_FALSE(s_last.ok);
+}
+
+void test_menu_lists_commands_with_help() {
+  char out[256];
+  size_t n = s_table.menu(out, sizeof(out), "Menú:\n");
+  TEST_ASSERT_EQUAL_STRING("Menú:\n"
+                           "📈 /status - Estado general\n"
+                           "⏱️ /setInterval [seg] - Cambiar intervalo\n"
+                           "🔀 /setModo [auto|manual] - Modo de envío",
+                           out);
+  TEST_ASSERT_EQUAL(strlen(out), n);
+}
+
+void test_menu_truncates_to_cap() {
+  char out[24];
+  memset(out, 'x', sizeof(out));
+  size_t n = s_table.menu(out, sizeof(out), "Menú:\n");
+  TEST_ASSERT_EQUAL(sizeof(out) - 1, n);
+  TEST_ASSERT_EQUAL(strlen(out), n);
+  TEST_ASSERT_EQUAL(0, s_table.menu(out, 0, "Menú:\n"));
+}
+
+int main(int, char **) {
+  UNITY_BEGIN();
+  RUN_TEST(test_begin_finds_seed);
+  RUN_TEST(test_begin_rejects_duplicate_names);
+  RUN_TEST(test_find_hit_and_miss);
+  RUN_TEST(test_dispatch_hit);
+  RUN_TEST(test_dispatch_not_command_and_unknown);
+  RUN_TEST(test_case_handling);
+  RUN_TEST(test_bot_suffix);
+  RUN_TEST(test_int_argument);
+  RUN_TEST(test_word_argument);
+  RUN_TEST(test_none_argument_ignores_rest);
+  RUN_TEST(test_menu_lists_commands_with_help);
+  RUN_TEST(test_menu_truncates_to_cap);
+  return UNITY_END();
+}
@@ -0,0 +1,270 @@
+// ======== Benchmark del ADC continuo (firmwareLumus, env:native) ========
+// 1. Verifica los kernels de AdcFilter: respuesta del FIR de diseño (ganancia
+//    en continua, banda de paso, rechazo de 100/120 Hz), la cadena caja + FIR
+//    contra una luz con parpadeo, WindowStats contra una referencia en double
+//    y que partir la entrada en tramas de cualquier largo no cambie la salida.
+// 2. Mide cada kernel en muestras/s en un núcleo (un hilo) y cuántas veces el
+//    tiempo real de 20 kHz entra en ese núcleo.
+// 3. Corre setup() del firmware con el ADC simulado (continua + parpadeo de
+//    100 Hz + ruido a 20 kHz reales), espera unas ventanas y pide /api/latest.
+// Uso:
+//   pio run -e native -t exec
+//   .pio/build/native/program [msPorCaso] [ventanas]
+#include <Arduino.h>
+#include <HttpServer.h>
+#include <AdcFilter.h>
+#include <driver/adc.h>
+
+#include <chrono>
+#include <math.h>
+#include <random>
+#include <string>
+#include <vector>
+
+// Símbolos del firmware bajo prueba
+extern HttpServer server;
+void setup();
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+volatile double s_sink;  // evita que el compilador elimine el trabajo medido
+unsigned s_msPerCase = 300;
+
+const double kRate = 20000.0;       // ADC
+const uint16_t kBox = 20;           // 20 kHz -> 1 kHz
+const uint16_t kTaps = 64;
+const uint16_t kFir = 10;           // 1 kHz -> 100 Hz
+const float kCutoff = 0.03f;        // mismos valores que firmwareLumus
+const size_t kFrame = 1000;
+
+int check(bool ok, const char *what) {
+  printf("  %s %s\n", ok ? "✓" : "✗", what);
+  return ok ? 0 : 1;
+}
+
+// |H(f)| del FIR en dB, con f como fracción de la frecuencia de entrada
+double gainDb(const float *taps, uint16_t n, double f) {
+  double re = 0, im = 0;
+  for (uint16_t k = 0; k < n; ++k) {
+    re += taps[k] * cos(2.0 * M_PI * f * k);
+    im -= taps[k] * sin(2.0 * M_PI * f * k);
+  }
+  return 20.0 * log10(sqrt(re * re + im * im));
+}
+
+// Luz con parpadeo: continua + senoidal, cuantizada a 12 bits
+std::vector<uint16_t> flickerSignal(size_t n, double dc, double amp, double hz, double noise, uint32_t seed) {
+  std::mt19937 rng(seed);
+  std::uniform_real_distribution<double> u(-noise, noise);
+  std::vector<uint16_t> v(n);
+  for (size_t i = 0; i < n; ++i) {
+    double x = dc + amp * sin(2.0 * M_PI * hz * i / kRate) + (noise > 0 ? u(rng) : 0.0);
+    v[i] = (uint16_t)lround(x < 0 ? 0 : x > 4095 ? 4095 : x);
+  }
+  return v;
+}
+
+// Cadena del firmware sobre una señal entera; devuelve el nivel (100 Hz)
+std::vector<float> runChain(const std::vector<uint16_t> &in, const float *taps) {
+  BoxDecimator box(kBox);
+  FirDecimator fir(taps, kTaps, kFir);
+  std::vector<float> mid(in.size() / kBox + 1), out(in.size() / kBox / kFir + 2);
+  size_t m = box.process(in.data(), in.size(), mid.data());
+  out.resize(fir.process(mid.data(), m, out.data()));
+  return out;
+}
+
+// Máxima desviación del nivel respecto de dc, salteando el arranque
+double levelRipple(const std::vector<float> &level, double dc) {
+  double worst = 0;
+  for (size_t i = 20; i < level.size(); ++i) worst = std::max(worst, fabs(level[i] - dc));
+  return worst;
+}
+
+int runKernelChecks(const float *taps) {
+  int fails = 0;
+  printf("\n== Filtros (caja ÷%u a %.0f Hz, FIR %u coef. ÷%u, corte %.0f Hz) ==\n", kBox, kRate, kTaps, kFir,
+         kCutoff * kRate / kBox);
+  double mid = kRate / kBox;
+  double g10 = gainDb(taps, kTaps, 10.0 / mid), g30 = gainDb(taps, kTaps, 30.0 / mid);
+  double g100 = gainDb(taps, kTaps, 100.0 / mid), g120 = gainDb(taps, kTaps, 120.0 / mid);
+  double worstStop = -1e9;
+  for (double f = 90.0; f <= 500.0; f += 0.5) worstStop = std::max(worstStop, gainDb(taps, kTaps, f / mid));
+  printf("FIR: 0 Hz %.4f dB, 10 Hz %.3f dB, 30 Hz %.2f dB, 100 Hz %.1f dB, 120 Hz %.1f dB, peor 90..500 Hz %.1f dB\n",
+         gainDb(taps, kTaps, 0.0), g10, g30, g100, g120, worstStop);
+
+  std::vector<uint16_t> dc(20000, 1234);
+  std::vector<float> out = runChain(dc, taps);
+  bool dcExact = out.size() == 20000u / kBox / kFir;
+  for (float v : out) dcExact = dcExact && fabsf(v - 1234.0f) < 1e-3f;
+  fails += check(dcExact, "continua: sale igual desde la primera muestra, una salida cada 200 entradas");
+  fails += check(fabs(g10) < 0.5 && worstStop < -45.0, "FIR: menos de 0,5 dB hasta 10 Hz, ≥ 45 dB de rechazo desde 90 Hz");
+
+  double r100 = levelRipple(runChain(flickerSignal(40000, 1500, 300, 100, 0, 1), taps), 1500);
+  double r120 = levelRipple(runChain(flickerSignal(40000, 1500, 300, 120, 0, 1), taps), 1500);
+  printf("nivel con parpadeo de ±300 cuentas sobre 1500: desvío máx %.2f (100 Hz) / %.2f (120 Hz) cuentas\n", r100,
+         r120);
+  fails += check(r100 < 1.5 && r120 < 1.5, "parpadeo de 100/120 Hz: el nivel se mueve menos de 1,5 cuentas");
+
+  // WindowStats contra double
+  std::mt19937 rng(7);
+  std::uniform_int_distribution<int> u12(0, 4095);
+  std::vector<uint16_t> rnd(1000003);
+  for (uint16_t &v : rnd) v = (uint16_t)u12(rng);
+  double sum = 0, sum2 = 0;
+  uint16_t mn = 4095, mx = 0;
+  for (uint16_t v : rnd) {
+    sum += v;
+    sum2 += (double)v * v;
+    mn = std::min(mn, v);
+    mx = std::max(mx, v);
+  }
+  double mean = sum / rnd.size(), rms = sqrt(sum2 / rnd.size()), ac = sqrt(sum2 / rnd.size() - mean * mean);
+  WindowStats ws;
+  ws.push(rnd.data(), rnd.size());
+  AdcSummary s = ws.summary();
+  printf("WindowStats (%zu muestras al azar): media %.3f/%.3f rms %.3f/%.3f ac %.3f/%.3f (kernel/double)\n",
+         rnd.size(), s.mean, mean, s.rms, rms, s.acRms, ac);
+  fails += check(s.count == rnd.size() && s.min == mn && s.max == mx && fabs(s.mean - mean) < 1e-3 &&
+                     fabs(s.rms - rms) < 1e-3 && fabs(s.acRms - ac) < 1e-3,
+                 "WindowStats: mín/máx exactos, media/RMS/RMS alterna iguales a la referencia");
+
+  // Por tramas de largo al azar contra todo de una vez
+  std::vector<uint16_t> sig = flickerSignal(200000, 1800, 500, 100, 30, 3);
+  std::vector<float> whole = runChain(sig, taps);
+  WindowStats wsWhole, wsParts;
+  wsWhole.push(sig.data(), sig.size());
+  BoxDecimator box(kBox);
+  FirDecimator fir(taps, kTaps, kFir);
+  std::vector<float> parts, mid1(3001 / kBox + 1), lvl(3001 / kBox / kFir + 2);
+  std::uniform_int_distribution<int> len(1, 3000);
+  for (size_t i = 0; i < sig.size();) {
+    size_t n = std::min((size_t)len(rng), sig.size() - i);
+    wsParts.push(&sig[i], n);
+    size_t m = box.process(&sig[i], n, mid1.data());
+    size_t k = fir.process(mid1.data(), m, lvl.data());
+    parts.insert(parts.end(), lvl.begin(), lvl.begin() + k);
+    i += n;
+  }
+  AdcSummary a = wsWhole.summary(), b = wsParts.summary();
+  fails += check(parts == whole && a.min == b.min && a.max == b.max && a.mean == b.mean && a.rms == b.rms,
+                 "por tramas de 1..3000 muestras: salida idéntica a procesar todo junto");
+  return fails;
+}
+
+template <class F> double samplesPerSec(size_t n, F fn) {
+  for (int i = 0; i < 3; ++i) fn();  // calentamiento
+  uint64_t iters = 0;
+  Clock::time_point t0 = Clock::now(), deadline = t0 + std::chrono::milliseconds(s_msPerCase), t1;
+  do {
+    fn();
+    iters++;
+    t1 = Clock::now();
+  } while (t1 < deadline);
+  return (double)n * iters / std::chrono::duration<double>(t1 - t0).count();
+}
+
+void row(const char *name, double inRate, double sps) {
+  printf("%-34s %10.1f %10.2f %12.0f\n", name, sps / 1e6, 1e9 / sps, sps / inRate);
+}
+
+void runThroughput(const float *taps) {
+  printf("\n== Throughput en un núcleo (muestras de entrada por segundo) ==\n");
+  printf("%-34s %10s %10s %12s\n", "kernel", "Mmuestras/s", "ns/muestra", "x tiempo real");
+  const size_t n = 100000;  // 5 s de ADC, de a tramas como en el firmware
+  std::vector<uint16_t> sig = flickerSignal(n, 1500, 300, 100, 20, 5);
+  std::vector<float> mid(n / kBox + kFrame), lvl(n / kBox + kFrame);
+  for (size_t i = 0; i < mid.size(); ++i) mid[i] = 1500.0f + (float)(i % 37);
+
+  BoxDecimator box(kBox);
+  row("caja D=20 (u16 -> float)", kRate, samplesPerSec(n, [&]() {
+        for (size_t i = 0; i < n; i += kFrame) box.process(&sig[i], kFrame, mid.data());
+        s_sink = mid[0];
+      }));
+  FirDecimator fir(taps, kTaps, kFir), full(taps, kTaps, 1);
+  const size_t m = n / kBox;
+  row("FIR 64 coef. D=10", kRate / kBox, samplesPerSec(m, [&]() {
+        fir.process(mid.data(), m, lvl.data());
+        s_sink = lvl[0];
+      }));
+  row("FIR 64 coef. sin decimar", kRate / kBox, samplesPerSec(m, [&]() {
+        full.process(mid.data(), m, lvl.data());
+        s_sink = lvl[0];
+      }));
+  WindowStats ws;
+  row("WindowStats (u16)", kRate, samplesPerSec(n, [&]() {
+        for (size_t i = 0; i < n; i += kFrame) ws.push(&sig[i], kFrame);
+        s_sink = ws.summary().rms;
+        ws.reset();
+      }));
+  RangeStats rs;
+  row("RangeStats (float)", kRate / kBox, samplesPerSec(m, [&]() {
+        rs.push(mid.data(), m);
+        s_sink = rs.mean();
+        rs.reset();
+      }));
+  // Lo que hace dspTask por trama, contado por muestra cruda
+  RangeStats midRange, levelRange;
+  row("cadena completa (por muestra ADC)", kRate, samplesPerSec(n, [&]() {
+        for (size_t i = 0; i < n; i += kFrame) {
+          ws.push(&sig[i], kFrame);
+          size_t k = box.process(&sig[i], kFrame, mid.data());
+          midRange.push(mid.data(), k);
+          levelRange.push(lvl.data(), fir.process(mid.data(), k, lvl.data()));
+        }
+        s_sink = levelRange.mean() + ws.summary().mean;
+      }));
+}
+
+// Campo numérico del JSON (la primera aparición de "key":)
+double jsonNumber(const std::string &body, const char *key) {
+  std::string k = std::string("\"") + key + "\":";
+  size_t p = body.find(k);
+  return p == std::string::npos ? NAN : atof(body.c_str() + p + k.size());
+}
+
+int runFirmware(unsigned windows) {
+  native::AdcInput &in = native::adcInput;
+  in.dc = 1500.0f;
+  in.flickerHz = 100.0f;
+  in.flickerAmp = 300.0f;
+  in.noise = 20.0f;
+  setup();
+  delay(windows * 1000 + 300);
+
+  std::string body;
+  server.nativeBodySink = [&](const char *d, size_t n) { body.append(d, n); };
+  const NativeResponse &r = server.nativeRequest(HTTP_GET, "/api/latest");
+  server.nativeBodySink = nullptr;
+  printf("\n== firmwareLumus tras %u ventanas de 1 s (continua 1500 ± 300 a 100 Hz, ruido ±20) ==\n", windows);
+  printf("GET /api/latest -> %d (%zu B)\n%s\n", r.code, r.bodyBytes, body.c_str());
+  printf("ADC simulado: muestras=%llu perdidas por desborde=%llu\n", (unsigned long long)in.samples,
+         (unsigned long long)in.lost);
+
+  double level = jsonNumber(body, "level"), flicker = jsonNumber(body, "flicker");
+  double expectedLevel = 1500.0 * 100.0 / 4095.0;
+  double expectedFlicker = 100.0 * 300.0 / 1500.0;
+  int fails = 0;
+  fails += check(r.code == 200 && jsonNumber(body, "samples") == 20000, "ventana completa de 20000 muestras");
+  fails += check(fabs(level - expectedLevel) < 0.2, "nivel = continua de la entrada (±0,2 %)");
+  fails += check(fabs(flicker - expectedFlicker) < 1.5, "% de parpadeo = amplitud / continua (±1,5)");
+  fails += check(jsonNumber(body, "dropped") == 0 && jsonNumber(body, "overruns") == 0 && in.lost == 0,
+                 "sin tramas descartadas ni desbordes del DMA");
+  return fails;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  if (argc > 1) s_msPerCase = (unsigned)atoi(argv[1]);
+  unsigned windows = argc > 2 ? (unsigned)atoi(argv[2]) : 3;
+  float taps[kTaps];
+  FirDecimator::lowpass(taps, kTaps, kCutoff);
+
+  int fails = runKernelChecks(taps);
+  runThroughput(taps);
+  fails += runFirmware(windows);
+  return fails ? 1 : 0;
+}
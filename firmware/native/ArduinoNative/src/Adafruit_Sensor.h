@@ -0,0 +1,2 @@
+// ======== Adafruit_Sensor.h: vacío en native (lo incluyen los sketches con DHT) ========
+#pragma once
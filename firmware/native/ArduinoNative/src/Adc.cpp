@@ -0,0 +1,123 @@
+#include "Arduino.h"
+#include "driver/adc.h"
+
+#include <chrono>
+#include <math.h>
+#include <thread>
+
+// ======== ADC continuo simulado ========
+native::AdcInput native::adcInput;
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+struct AdcState {
+  adc_digi_init_config_t init;
+  uint32_t rateHz = 0;
+  uint8_t channel = 0;
+  bool initialized = false;
+  bool running = false;
+  Clock::time_point start;
+  uint64_t produced = 0;   // índice de la próxima muestra a entregar
+  uint32_t noiseSeed = 12345;
+};
+AdcState s_adc;
+
+uint16_t sampleAt(uint64_t n) {
+  const native::AdcInput &in = native::adcInput;
+  const double t = (double)n / s_adc.rateHz;
+  s_adc.noiseSeed = s_adc.noiseSeed * 1664525u + 1013904223u;
+  float noise = ((float)(s_adc.noiseSeed >> 8) / 8388608.0f - 1.0f) * in.noise;
+  float v = in.dc + in.flickerAmp * (float)sin(2.0 * M_PI * in.flickerHz * t) + noise;
+  if (v < 0.0f) v = 0.0f;
+  if (v > 4095.0f) v = 4095.0f;
+  return (uint16_t)lrintf(v);
+}
+
+// Muestras que el "DMA" ya convirtió desde adc_digi_start()
+uint64_t convertedUntilNow() {
+  double us = std::chrono::duration<double, std::micro>(Clock::now() - s_adc.start).count();
+  return (uint64_t)(us * s_adc.rateHz / 1e6);
+}
+
+} // namespace
+
+esp_err_t adc_digi_initialize(const adc_digi_init_config_t *init_config) {
+  if (!init_config || init_config->max_store_buf_size < sizeof(adc_digi_output_data_t)) return ESP_ERR_INVALID_ARG;
+  s_adc.init = *init_config;
+  s_adc.initialized = true;
+  return ESP_OK;
+}
+
+esp_err_t adc_digi_controller_configure(const adc_digi_configuration_t *config) {
+  if (!s_adc.initialized) return ESP_ERR_INVALID_STATE;
+  if (!config || config->pattern_num < 1 || !config->adc_pattern ||
+      config->sample_freq_hz < SOC_ADC_SAMPLE_FREQ_THRES_LOW ||
+      config->sample_freq_hz > SOC_ADC_SAMPLE_FREQ_THRES_HIGH)
+    return ESP_ERR_INVALID_ARG;
+  s_adc.rateHz = config->sample_freq_hz;
+  s_adc.channel = config->adc_pattern[0].channel;
+  return ESP_OK;
+}
+
+esp_err_t adc_digi_start() {
+  if (!s_adc.initialized || !s_adc.rateHz) return ESP_ERR_INVALID_STATE;
+  s_adc.start = Clock::now();
+  s_adc.produced = 0;
+  s_adc.running = true;
+  return ESP_OK;
+}
+
+esp_err_t adc_digi_stop() {
+  s_adc.running = false;
+  return ESP_OK;
+}
+
+esp_err_t adc_digi_deinitialize() {
+  s_adc.running = false;
+  s_adc.initialized = false;
+  return ESP_OK;
+}
+
+esp_err_t adc_digi_read_bytes(uint8_t *buf, uint32_t length_max, uint32_t *out_length, uint32_t timeout_ms) {
+  *out_length = 0;
+  if (!s_adc.running) return ESP_ERR_INVALID_STATE;
+  const uint64_t want = length_max / sizeof(adc_digi_output_data_t);
+  if (!want) return ESP_ERR_INVALID_ARG;
+
+  // Desborde: el ringbuffer guarda a lo sumo max_store_buf_size bytes
+  esp_err_t ret = ESP_OK;
+  const uint64_t capacity = s_adc.init.max_store_buf_size / sizeof(adc_digi_output_data_t);
+  uint64_t ready = convertedUntilNow();
+  if (ready - s_adc.produced > capacity) {
+    uint64_t lost = ready - s_adc.produced - capacity;
+    native::adcInput.lost += lost;
+    for (uint64_t i = 0; i < lost; ++i) sampleAt(s_adc.produced + i);  // el ruido sigue su curso
+    s_adc.produced += lost;
+    ret = ESP_ERR_INVALID_STATE;
+  }
+
+  // Espera a que haya una trama completa (o vence el timeout)
+  Clock::time_point deadline =
+      timeout_ms == ADC_MAX_DELAY ? Clock::time_point::max() : Clock::now() + std::chrono::milliseconds(timeout_ms);
+  while ((ready = convertedUntilNow()) < s_adc.produced + want) {
+    uint64_t missing = s_adc.produced + want - ready;
+    Clock::time_point wake = Clock::now() + std::chrono::microseconds(missing * 1000000 / s_adc.rateHz + 1);
+    if (wake > deadline) {
+      std::this_thread::sleep_until(deadline);
+      return ESP_ERR_TIMEOUT;
+    }
+    std::this_thread::sleep_until(wake);
+  }
+
+  adc_digi_output_data_t *out = (adc_digi_output_data_t *)buf;
+  for (uint64_t i = 0; i < want; ++i) {
+    out[i].type1.data = sampleAt(s_adc.produced + i);
+    out[i].type1.channel = s_adc.channel;
+  }
+  s_adc.produced += want;
+  native::adcInput.samples += want;
+  *out_length = (uint32_t)(want * sizeof(adc_digi_output_data_t));
+  return ret;
+}
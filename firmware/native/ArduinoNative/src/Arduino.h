@@ -0,0 +1,143 @@
+// ======== Arduino.h mínimo para compilar los firmwares en Linux (env:native) ========
+// Sólo cubre lo que usan nuestros sketches; no intenta ser un core completo.
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include "WString.h"
+
+#ifndef PI
+#define PI 3.1415926535897932384626433832795
+#endif
+#define DEC 10
+#define HEX 16
+#define BIT(nr) (1UL << (nr))
+
+#define PROGMEM
+#define PGM_P const char *
+#define pgm_read_byte(addr) (*(const uint8_t *)(addr))
+#define memcpy_P memcpy
+// Memoria RTC: en native es RAM común (no hay reinicios que sobrevivir)
+#define RTC_NOINIT_ATTR
+#define RTC_DATA_ATTR
+
+// ======== Contadores de heap (los lee el benchmark) ========
+namespace native {
+struct HeapStats {
+  uint64_t allocs;      // cantidad de malloc/realloc/new
+  uint64_t allocBytes;  // bytes pedidos en total
+  size_t   inUse;       // bytes vivos ahora
+  size_t   peak;        // pico de bytes vivos (high-water mark)
+};
+extern HeapStats heap;
+void resetHeapPeak();
+
+// Heap "virtual" del ESP32 para getFreeHeap()/getMinFreeHeap()
+const size_t kHeapSize = 320 * 1024;
+
+void *trackedRealloc(void *ptr, size_t size);
+void trackedFree(void *ptr);
+}
+
+// ======== Tiempo ========
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void yield();
+
+// ======== GPIO ========
+// Sólo lo que usan los drivers: no hay pines reales. Un periférico simulado
+// (DHT.cpp) contesta cuando la placa suelta la línea después de bajarla, y
+// dispara la interrupción del pin con cada flanco.
+#define LOW 0x0
+#define HIGH 0x1
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define PULLUP 0x04
+#define INPUT_PULLUP 0x05
+#define OPEN_DRAIN 0x10
+#define OUTPUT_OPEN_DRAIN 0x13
+#define RISING 0x01
+#define FALLING 0x02
+#define CHANGE 0x03
+#define IRAM_ATTR
+#define digitalPinToInterrupt(p) (p)
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+int digitalRead(uint8_t pin);
+void attachInterruptArg(uint8_t pin, void (*isr)(void *), void *arg, int mode);
+void detachInterrupt(uint8_t pin);
+
+namespace native {
+// Lo llama un periférico simulado: cambia el nivel de la línea en el
+// instante atUs (micros() devuelve atUs mientras corre la interrupción)
+void gpioDrive(uint8_t pin, uint8_t level, unsigned long atUs);
+}
+
+// ======== Random (misma semántica que el core) ========
+void randomSeed(unsigned long seed);
+long random(long howbig);
+long random(long howsmall, long howbig);
+
+template <class T> inline T constrain(T x, T lo, T hi) { return x < lo ? lo : (x > hi ? hi : x); }
+
+// ======== Print / Serial ========
+class Printable;
+class Print {
+public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t c) = 0;
+  virtual size_t write(const uint8_t *buf, size_t size);
+  size_t write(const char *s) { return write((const uint8_t *)s, strlen(s)); }
+
+  size_t print(const char *s) { return write(s); }
+  size_t print(const String &s) { return write((const uint8_t *)s.c_str(), s.length()); }
+  size_t print(char c) { return write((uint8_t)c); }
+  size_t print(int v) { return print(String(v)); }
+  size_t print(unsigned int v) { return print(String(v)); }
+  size_t print(long v) { return print(String(v)); }
+  size_t print(unsigned long v) { return print(String(v)); }
+  size_t print(double v, int decimals = 2) { return print(String(v, decimals)); }
+  size_t print(const Printable &p);
+  template <class T> size_t println(const T &v) { size_t n = print(v); return n + print("\n"); }
+  size_t println() { return print("\n"); }
+  size_t printf(const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+};
+
+class Printable {
+public:
+  virtual ~Printable() {}
+  virtual size_t printTo(Print &p) const = 0;
+};
+
+class HardwareSerial : public Print {
+public:
+  void begin(unsigned long) {}
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t *buf, size_t size) override;
+  using Print::write;
+};
+extern HardwareSerial Serial;
+
+// ======== ESP ========
+class EspClass {
+public:
+  uint32_t getFreeHeap();
+  uint32_t getMinFreeHeap();
+  uint32_t getMaxAllocHeap();
+  uint64_t getEfuseMac() { return 0x3C2B1A286F24ULL; }
+  void restart();
+};
+extern EspClass ESP;
+
+uint32_t esp_random();
+
+void configTime(long gmtOffset_sec, int daylightOffset_sec, const char *server1,
+                const char *server2 = nullptr, const char *server3 = nullptr);
@@ -0,0 +1,94 @@
+#include "ArduinoJson.h"
+
+int JsonDocument::find(const char *key) const {
+  for (int i = 0; i < count_; ++i) {
+    if (keys_[i] == key) return i;
+  }
+  return -1;
+}
+
+JsonVariant JsonDocument::operator[](const char *key) {
+  int i = find(key);
+  if (i < 0 && count_ < kMaxKeys) {
+    i = count_++;
+    keys_[i] = key;
+    values_[i] = "null";
+  }
+  return JsonVariant(this, i);
+}
+
+JsonVariant &JsonVariant::setRaw(const String &raw) {
+  if (index_ >= 0) doc_->values_[index_] = raw;
+  return *this;
+}
+
+const String *JsonVariant::raw() const { return index_ >= 0 ? &doc_->values_[index_] : nullptr; }
+
+bool JsonVariant::isNull() const { return !raw() || *raw() == "null"; }
+
+// Strings sin escapes: alcanza para claves y valores de configuración
+JsonVariant &JsonVariant::operator=(const char *v) {
+  String raw("\"");
+  raw += v;
+  raw += "\"";
+  return setRaw(raw);
+}
+
+template <> String JsonVariant::as<String>() const {
+  if (!raw() || !raw()->startsWith("\"")) return isNull() ? String() : *raw();
+  return raw()->substring(1, raw()->length() - 1);
+}
+
+size_t serializeJson(const JsonDocument &doc, Print &out) {
+  size_t n = out.print("{");
+  for (int i = 0; i < doc.count_; ++i) {
+    if (i) n += out.print(",");
+    n += out.print("\"");
+    n += out.print(doc.keys_[i]);
+    n += out.print("\":");
+    n += out.print(doc.values_[i]);
+  }
+  return n + out.print("}");
+}
+
+// {"clave":valor,...} con valores escalares
+DeserializationError deserializeJson(JsonDocument &doc, fs::File &in) {
+  String text;
+  for (int c = in.read(); c >= 0; c = in.read()) text += (char)c;
+  doc.clear();
+  const char *p = text.c_str();
+  auto skip = [&]() { while (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t') ++p; };
+  skip();
+  if (*p++ != '{') return DeserializationError::InvalidInput;
+  skip();
+  if (*p == '}') return DeserializationError::Ok;
+  for (;;) {
+    skip();
+    if (*p++ != '"') return DeserializationError::InvalidInput;
+    const char *k = p;
+    while (*p && *p != '"') ++p;
+    if (!*p) return DeserializationError::InvalidInput;
+    String key = text.substring((unsigned)(k - text.c_str()), (unsigned)(p - text.c_str()));
+    ++p;
+    skip();
+    if (*p++ != ':') return DeserializationError::InvalidInput;
+    skip();
+    const char *v = p;
+    if (*p == '"') {
+      ++p;
+      while (*p && *p != '"') ++p;
+      if (!*p) return DeserializationError::InvalidInput;
+      ++p;
+    } else {
+      while (*p && *p != ',' && *p != '}' && *p != ' ' && *p != '\n') ++p;
+    }
+    if (p == v) return DeserializationError::InvalidInput;
+    if (doc.count_ >= JsonDocument::kMaxKeys) return DeserializationError::NoMemory;
+    doc.keys_[doc.count_] = key;
+    doc.values_[doc.count_++] = text.substring((unsigned)(v - text.c_str()), (unsigned)(p - text.c_str()));
+    skip();
+    if (*p == ',') { ++p; continue; }
+    if (*p == '}') return DeserializationError::Ok;
+    return DeserializationError::InvalidInput;
+  }
+}
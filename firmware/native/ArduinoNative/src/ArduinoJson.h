@@ -0,0 +1,74 @@
+// ======== ArduinoJson mínimo: objetos planos de números, bool y strings ========
+// Alcanza para los config.json de los sketches (StaticJsonDocument,
+// containsKey, as<T>(), serializeJson/deserializeJson sobre un File). No es la
+// librería real: no hay arrays ni objetos anidados.
+#pragma once
+
+#include "Arduino.h"
+#include "FS.h"
+
+class JsonDocument;
+
+class JsonVariant {
+public:
+  JsonVariant(JsonDocument *doc, int index) : doc_(doc), index_(index) {}
+
+  JsonVariant &operator=(long v) { return setRaw(String(v)); }
+  JsonVariant &operator=(int v) { return setRaw(String(v)); }
+  JsonVariant &operator=(unsigned long v) { return setRaw(String(v)); }
+  JsonVariant &operator=(unsigned int v) { return setRaw(String(v)); }
+  JsonVariant &operator=(double v) { return setRaw(String(v, 6)); }
+  JsonVariant &operator=(bool v) { return setRaw(String(v ? "true" : "false")); }
+  JsonVariant &operator=(const char *v);
+  JsonVariant &operator=(const String &v) { return *this = v.c_str(); }
+
+  template <class T> T as() const;
+  bool isNull() const;
+
+private:
+  JsonVariant &setRaw(const String &raw);
+  const String *raw() const;
+  JsonDocument *doc_;
+  int index_;
+};
+
+class JsonDocument {
+public:
+  static const int kMaxKeys = 16;
+
+  JsonVariant operator[](const char *key);
+  bool containsKey(const char *key) const { return find(key) >= 0; }
+  void clear() { count_ = 0; }
+
+private:
+  friend class JsonVariant;
+  friend size_t serializeJson(const JsonDocument &doc, Print &out);
+  friend class DeserializationError deserializeJson(JsonDocument &doc, fs::File &in);
+  int find(const char *key) const;
+  String keys_[kMaxKeys];
+  String values_[kMaxKeys];  // JSON crudo: 123, true, "texto"
+  int count_ = 0;
+};
+
+template <size_t N> class StaticJsonDocument : public JsonDocument {};
+
+class DeserializationError {
+public:
+  enum Code { Ok, InvalidInput, NoMemory };
+  DeserializationError(Code c = Ok) : code_(c) {}
+  explicit operator bool() const { return code_ != Ok; }
+  const char *c_str() const { return code_ == Ok ? "Ok" : code_ == NoMemory ? "NoMemory" : "InvalidInput"; }
+
+private:
+  Code code_;
+};
+
+size_t serializeJson(const JsonDocument &doc, Print &out);
+DeserializationError deserializeJson(JsonDocument &doc, fs::File &in);
+
+template <> inline long JsonVariant::as<long>() const { return raw() ? strtol(raw()->c_str(), nullptr, 10) : 0; }
+template <> inline int JsonVariant::as<int>() const { return (int)as<long>(); }
+template <> inline unsigned long JsonVariant::as<unsigned long>() const { return (unsigned long)as<long>(); }
+template <> inline float JsonVariant::as<float>() const { return raw() ? strtof(raw()->c_str(), nullptr) : 0; }
+template <> inline bool JsonVariant::as<bool>() const { return raw() && *raw() == "true"; }
+template <> String JsonVariant::as<String>() const;
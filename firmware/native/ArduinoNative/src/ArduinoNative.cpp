@@ -0,0 +1,201 @@
+#include "Arduino.h"
+#include "IPAddress.h"
+#include "WiFi.h"
+#include "ESPmDNS.h"
+#include "esp_system.h"
+#include "esp_sleep.h"
+
+#include <chrono>
+#include <new>
+#include <malloc.h>
+#include <stdarg.h>
+#include <unistd.h>
+
+// ======== Heap con contadores ========
+namespace native {
+HeapStats heap = {0, 0, 0, 0};
+
+void resetHeapPeak() { heap.peak = heap.inUse; }
+
+// Atómicos: con las tareas de FreeRTOS (hilos) también se pide heap en paralelo
+void *trackedRealloc(void *ptr, size_t size) {
+  size_t before = ptr ? malloc_usable_size(ptr) : 0;
+  void *p = realloc(ptr, size);
+  if (!p) return nullptr;
+  __atomic_add_fetch(&heap.allocs, 1, __ATOMIC_RELAXED);
+  __atomic_add_fetch(&heap.allocBytes, size, __ATOMIC_RELAXED);
+  size_t inUse = __atomic_add_fetch(&heap.inUse, malloc_usable_size(p) - before, __ATOMIC_RELAXED);
+  if (inUse > heap.peak) heap.peak = inUse;
+  return p;
+}
+
+void trackedFree(void *ptr) {
+  if (!ptr) return;
+  __atomic_sub_fetch(&heap.inUse, malloc_usable_size(ptr), __ATOMIC_RELAXED);
+  free(ptr);
+}
+} // namespace native
+
+// Los new/delete de std::function, std::vector, etc. también cuentan
+void *operator new(size_t size) {
+  void *p = native::trackedRealloc(nullptr, size ? size : 1);
+  if (!p) throw std::bad_alloc();
+  return p;
+}
+void *operator new[](size_t size) { return operator new(size); }
+void operator delete(void *p) noexcept { native::trackedFree(p); }
+void operator delete[](void *p) noexcept { native::trackedFree(p); }
+void operator delete(void *p, size_t) noexcept { native::trackedFree(p); }
+void operator delete[](void *p, size_t) noexcept { native::trackedFree(p); }
+
+// ======== Tiempo ========
+static const auto s_boot = std::chrono::steady_clock::now();
+
+unsigned long millis() {
+  return (unsigned long)std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::steady_clock::now() - s_boot).count();
+}
+// Reloj de la interrupción que está corriendo (0 = el reloj real)
+static thread_local unsigned long s_isrUs = 0;
+
+unsigned long micros() {
+  if (s_isrUs) return s_isrUs;
+  return (unsigned long)std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - s_boot).count();
+}
+void delay(unsigned long ms) { usleep(ms * 1000); }
+void yield() {}
+
+// configTime(): en native sólo fija la zona horaria para localtime_r()
+void configTime(long gmtOffset_sec, int daylightOffset_sec, const char *server1, const char *server2,
+                const char *server3) {
+  (void)daylightOffset_sec; (void)server1; (void)server2; (void)server3;
+  char tz[16];
+  snprintf(tz, sizeof(tz), "UTC%+d", (int)(-gmtOffset_sec / 3600)); // POSIX invierte el signo
+  setenv("TZ", tz, 1);
+  tzset();
+}
+
+// ======== GPIO ========
+namespace {
+struct Pin {
+  uint8_t out = HIGH;         // lo que maneja la placa (open-drain: HIGH = suelta)
+  uint8_t line = HIGH;        // nivel real de la línea
+  unsigned long lowSinceUs = 0;
+  void (*isr)(void *) = nullptr;
+  void *arg = nullptr;
+};
+Pin s_pins[40];
+} // namespace
+
+// Periférico simulado en la línea (DHT.cpp): la placa soltó el pin después
+// de tenerlo lowUs en LOW
+void nativeDhtRelease(uint8_t pin, unsigned long lowUs);
+
+void pinMode(uint8_t pin, uint8_t mode) { (void)pin; (void)mode; }
+
+void digitalWrite(uint8_t pin, uint8_t val) {
+  if (pin >= 40) return;
+  Pin &p = s_pins[pin];
+  if (p.out == val) return;
+  p.out = val;
+  unsigned long now = micros();
+  native::gpioDrive(pin, val, now);
+  if (val == LOW) p.lowSinceUs = now;
+  else nativeDhtRelease(pin, now - p.lowSinceUs);
+}
+
+int digitalRead(uint8_t pin) { return pin < 40 ? s_pins[pin].line : LOW; }
+
+void attachInterruptArg(uint8_t pin, void (*isr)(void *), void *arg, int mode) {
+  (void)mode;  // siempre CHANGE
+  if (pin >= 40) return;
+  s_pins[pin].isr = isr;
+  s_pins[pin].arg = arg;
+}
+
+void detachInterrupt(uint8_t pin) {
+  if (pin < 40) s_pins[pin].isr = nullptr;
+}
+
+void native::gpioDrive(uint8_t pin, uint8_t level, unsigned long atUs) {
+  Pin &p = s_pins[pin];
+  if (p.line == level) return;
+  p.line = level;
+  if (!p.isr) return;
+  s_isrUs = atUs;
+  p.isr(p.arg);
+  s_isrUs = 0;
+}
+
+// ======== Random ========
+void randomSeed(unsigned long seed) { if (seed != 0) srand((unsigned)seed); }
+long random(long howbig) { return howbig == 0 ? 0 : rand() % howbig; }
+long random(long howsmall, long howbig) {
+  if (howsmall >= howbig) return howsmall;
+  return random(howbig - howsmall) + howsmall;
+}
+uint32_t esp_random() { return ((uint32_t)rand() << 16) ^ (uint32_t)rand(); }
+
+// ======== Print / Serial ========
+size_t Print::write(const uint8_t *buf, size_t size) {
+  size_t n = 0;
+  while (size--) n += write(*buf++);
+  return n;
+}
+
+size_t Print::print(const Printable &p) { return p.printTo(*this); }
+
+size_t Print::printf(const char *fmt, ...) {
+  char buf[256];
+  va_list ap;
+  va_start(ap, fmt);
+  int n = vsnprintf(buf, sizeof(buf), fmt, ap);
+  va_end(ap);
+  if (n < 0) return 0;
+  return write((const uint8_t *)buf, (size_t)n < sizeof(buf) ? (size_t)n : sizeof(buf) - 1);
+}
+
+// Serial va a stderr para no mezclarse con la salida del benchmark
+HardwareSerial Serial;
+size_t HardwareSerial::write(uint8_t c) { return fputc(c, stderr) == EOF ? 0 : 1; }
+size_t HardwareSerial::write(const uint8_t *buf, size_t size) { return fwrite(buf, 1, size, stderr); }
+
+// ======== ESP ========
+EspClass ESP;
+uint32_t EspClass::getFreeHeap() { return (uint32_t)(native::kHeapSize - native::heap.inUse); }
+uint32_t EspClass::getMinFreeHeap() { return (uint32_t)(native::kHeapSize - native::heap.peak); }
+uint32_t EspClass::getMaxAllocHeap() { return getFreeHeap(); }
+void EspClass::restart() { exit(0); }
+
+esp_reset_reason_t esp_reset_reason() { return ESP_RST_POWERON; }
+
+// Deep sleep: en native no hay despertar, termina como ESP.restart()
+uint64_t native::sleepWakeupUs = 0;
+esp_err_t esp_sleep_enable_timer_wakeup(uint64_t us) {
+  native::sleepWakeupUs = us;
+  return ESP_OK;
+}
+void esp_deep_sleep_start() {
+  fprintf(stderr, "[native] deep sleep %llu ms: fin\n", (unsigned long long)(native::sleepWakeupUs / 1000));
+  exit(0);
+}
+extern "C" uint8_t temprature_sens_read() { return 128; }  // ~53 °C, como un chip tibio
+
+// ======== Red ========
+String IPAddress::toString() const {
+  char buf[16];
+  snprintf(buf, sizeof(buf), "%u.%u.%u.%u", b_[0], b_[1], b_[2], b_[3]);
+  return String(buf);
+}
+size_t IPAddress::printTo(Print &p) const { return p.print(toString()); }
+
+WiFiClass WiFi;
+wl_status_t WiFiClass::begin(const char *ssid, const char *pass) {
+  (void)pass;
+  ssid_ = ssid ? ssid : "";
+  status_ = WL_CONNECTED;
+  return status_;
+}
+
+MDNSResponder MDNS;
@@ -0,0 +1,19 @@
+// ======== Client: interfaz de una conexión saliente (como en el core) ========
+#pragma once
+
+#include "Arduino.h"
+
+class Client : public Print {
+public:
+  virtual int connect(const char *host, uint16_t port) = 0;
+  virtual size_t write(uint8_t c) = 0;
+  virtual size_t write(const uint8_t *buf, size_t size) = 0;
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual int read(uint8_t *buf, size_t size) = 0;
+  virtual void flush() {}
+  virtual void stop() = 0;
+  virtual uint8_t connected() = 0;
+  virtual operator bool() = 0;
+  using Print::write;
+};
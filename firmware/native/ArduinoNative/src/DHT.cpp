@@ -0,0 +1,90 @@
+#include "DHT.h"
+
+#include <unistd.h>
+
+static const unsigned kReadUs = 5000;  // trama de 40 bits + arranque
+
+static float simTemperature() {
+  return 22.0f + 3.0f * sinf(millis() / 60000.0f) + (float)random(-5, 6) / 10.0f;
+}
+
+static float simHumidity() {
+  return 55.0f + 10.0f * cosf(millis() / 90000.0f) + (float)random(-10, 11) / 10.0f;
+}
+
+float DHT::readTemperature(bool fahrenheit) {
+  usleep(kReadUs);
+  nativeReads++;
+  if (nativeFail) return NAN;
+  float c = simTemperature();
+  return fahrenheit ? c * 1.8f + 32.0f : c;
+}
+
+float DHT::readHumidity() {
+  usleep(kReadUs);
+  nativeReads++;
+  if (nativeFail) return NAN;
+  return simHumidity();
+}
+
+// ======== DHT22 en la línea ========
+native::DhtLine native::dhtLine;
+
+namespace {
+
+enum Defect { NONE, FLIP_BIT, LOST_EDGE, CUT, SILENT, GLITCH };
+
+// Arma la trama flanco por flanco con algo de jitter (latencia de la
+// interrupción) y la pasa a la línea a partir de t
+struct FrameWriter {
+  uint8_t pin;
+  unsigned long t;
+  uint8_t level = HIGH;
+  int edge = 0;
+  int lostEdge = -1;
+
+  void pulse(uint8_t lvl, unsigned us) {
+    if (edge++ != lostEdge) native::gpioDrive(pin, lvl, t);
+    level = lvl;
+    t += us >= 20 ? us + random(-4, 5) : us;
+  }
+};
+
+} // namespace
+
+void nativeDhtRelease(uint8_t pin, unsigned long lowUs) {
+  if (lowUs < 1000) return;  // el DHT22 pide al menos 1 ms de arranque
+  native::DhtLine &line = native::dhtLine;
+  line.frames++;
+
+  Defect defect = NONE;
+  if ((long)random(100) < line.corruptPct) defect = (Defect)(1 + random(5));
+  if (defect == GLITCH) line.noisy++;
+  else if (defect != NONE) line.corrupted++;
+  if (defect == SILENT) return;
+
+  uint16_t h = (uint16_t)lroundf(simHumidity() * 10.0f);
+  float tc = simTemperature();
+  uint16_t t = (uint16_t)lroundf(fabsf(tc) * 10.0f) | (tc < 0 ? 0x8000 : 0);
+  uint8_t raw[5] = {(uint8_t)(h >> 8), (uint8_t)h, (uint8_t)(t >> 8), (uint8_t)t, 0};
+  raw[4] = (uint8_t)(raw[0] + raw[1] + raw[2] + raw[3]);
+  int bad = (int)random(40);
+  if (defect == FLIP_BIT) raw[bad / 8] ^= (uint8_t)(0x80 >> (bad % 8));
+
+  FrameWriter w{pin, micros() + 30};
+  if (defect == LOST_EDGE) w.lostEdge = 3 + 2 * bad;
+  w.pulse(LOW, 80);
+  w.pulse(HIGH, 80);
+  for (int i = 0; i < 40; ++i) {
+    if (defect == CUT && i == bad) return;
+    w.pulse(LOW, 50);
+    bool one = raw[i / 8] & (0x80 >> (i % 8));
+    if (defect == GLITCH && i == bad) {
+      w.pulse(HIGH, 2);  // pico de ruido dentro del LOW
+      w.pulse(LOW, 2);
+    }
+    w.pulse(HIGH, one ? 70 : 27);
+  }
+  w.pulse(LOW, 50);
+  w.pulse(HIGH, 0);  // el sensor suelta la línea
+}
@@ -0,0 +1,34 @@
+// ======== DHT simulado (misma API que la librería de Adafruit) ========
+// Cada lectura tarda lo que el protocolo real (~5 ms, en la placa con las
+// interrupciones apagadas) y devuelve valores que varían despacio.
+// Además hay un DHT22 "en la línea" para los drivers que leen la trama por
+// interrupciones (Dht22Async): cuando la placa suelta un pin que tuvo al
+// menos 1 ms en LOW, contesta con los flancos de una trama real.
+#pragma once
+
+#include "Arduino.h"
+
+#define DHT11 11
+#define DHT22 22
+
+class DHT {
+public:
+  DHT(uint8_t pin, uint8_t type) { (void)pin; (void)type; }
+  void begin() {}
+  float readTemperature(bool fahrenheit = false);
+  float readHumidity();
+
+  // Sólo native: simular lecturas fallidas (NaN)
+  bool nativeFail = false;
+  uint32_t nativeReads = 0;
+};
+
+namespace native {
+struct DhtLine {
+  uint8_t corruptPct = 0;   // % de tramas con un defecto (ver DHT.cpp)
+  uint32_t frames = 0;      // tramas enviadas
+  uint32_t corrupted = 0;   // de ésas, con defecto que el decodificador debe rechazar
+  uint32_t noisy = 0;       // con ruido que el decodificador debe tolerar
+};
+extern DhtLine dhtLine;
+}
@@ -0,0 +1,4 @@
+// ======== DHT_U.h: vacío en native ========
+#pragma once
+
+#include "DHT.h"
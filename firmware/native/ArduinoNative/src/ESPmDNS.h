@@ -0,0 +1,41 @@
+#pragma once
+
+#include "Arduino.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+// No anuncia nada en la red: guarda los servicios y el TXT para que el
+// bench muestre lo que publicaría la placa
+class MDNSResponder {
+public:
+  struct Service {
+    std::string service, proto;   // "http", "tcp"
+    uint16_t port;
+    std::vector<std::pair<std::string, std::string>> txt;
+  };
+
+  bool begin(const char *hostName) { hostname_ = hostName; return true; }
+  void end() { services_.clear(); }
+  void addService(const char *service, const char *proto, uint16_t port) {
+    services_.push_back(Service{service, proto, port, {}});
+  }
+  bool addServiceTxt(const char *service, const char *proto, const char *key, const char *value) {
+    for (Service &s : services_) {
+      if (s.service == service && s.proto == proto) {
+        s.txt.emplace_back(key, value);
+        return true;
+      }
+    }
+    return false;   // como el core: el servicio tiene que existir
+  }
+
+  const String &nativeHostname() const { return hostname_; }
+  const std::vector<Service> &nativeServices() const { return services_; }
+
+private:
+  String hostname_;
+  std::vector<Service> services_;
+};
+extern MDNSResponder MDNS;
@@ -0,0 +1,144 @@
+#include "FS.h"
+#include "SPIFFS.h"
+
+#include <dirent.h>
+#include <sys/stat.h>
+
+namespace fs {
+
+struct FileImpl {
+  FILE *fp = nullptr;
+  String name;
+  String path;
+  FS *owner = nullptr;
+  ~FileImpl() { if (fp) fclose(fp); }
+};
+
+File::operator bool() const { return impl_ && impl_->fp; }
+
+size_t File::write(uint8_t c) { return write(&c, 1); }
+size_t File::write(const uint8_t *buf, size_t size) {
+  if (!*this) return 0;
+  if (impl_->owner) {
+    impl_->owner->nativeWrites++;
+    if (impl_->owner->nativeWritesLeft == 0) return 0;
+    if (impl_->owner->nativeWritesLeft > 0) impl_->owner->nativeWritesLeft--;
+  }
+  return fwrite(buf, 1, size, impl_->fp);
+}
+
+int File::available() {
+  if (!*this) return 0;
+  long n = (long)size() - (long)position();
+  return n > 0 ? (int)n : 0;
+}
+
+int File::read() {
+  uint8_t c;
+  return read(&c, 1) == 1 ? c : -1;
+}
+size_t File::read(uint8_t *buf, size_t size) { return *this ? fread(buf, 1, size, impl_->fp) : 0; }
+
+int File::peek() {
+  if (!*this) return -1;
+  int c = fgetc(impl_->fp);
+  if (c != EOF) ungetc(c, impl_->fp);
+  return c == EOF ? -1 : c;
+}
+
+void File::flush() { if (*this) fflush(impl_->fp); }
+
+bool File::seek(uint32_t pos, SeekMode mode) {
+  if (!*this) return false;
+  int whence = mode == SeekSet ? SEEK_SET : (mode == SeekCur ? SEEK_CUR : SEEK_END);
+  return fseek(impl_->fp, (long)pos, whence) == 0;
+}
+
+size_t File::position() const { return *this ? (size_t)ftell(impl_->fp) : 0; }
+
+size_t File::size() const {
+  if (!*this) return 0;
+  fflush(impl_->fp);
+  struct stat st;
+  return fstat(fileno(impl_->fp), &st) == 0 ? (size_t)st.st_size : 0;
+}
+
+void File::close() {
+  if (impl_ && impl_->fp) { fclose(impl_->fp); impl_->fp = nullptr; }
+}
+
+const char *File::name() const { return impl_ ? impl_->name.c_str() : ""; }
+const char *File::path() const { return impl_ ? impl_->path.c_str() : ""; }
+
+String FS::hostPath(const char *path) const {
+  String p(root_);
+  if (path[0] != '/') p += "/";
+  p += path;
+  return p;
+}
+
+File FS::open(const char *path, const char *mode, bool create) {
+  (void)create;
+  String hp = hostPath(path);
+  struct stat st;
+  if (mode[0] == 'r' && (stat(hp.c_str(), &st) != 0 || S_ISDIR(st.st_mode))) return File();
+  // "r" del FS de Arduino es sólo lectura; "w"/"a" siempre binarios
+  char m[4] = {mode[0], 'b', mode[1] == '+' ? '+' : '\0', '\0'};
+  FILE *fp = fopen(hp.c_str(), m);
+  if (!fp) return File();
+  nativeOpens++;
+  auto impl = std::make_shared<FileImpl>();
+  impl->fp = fp;
+  impl->path = path;
+  const char *slash = strrchr(path, '/');
+  impl->name = slash ? slash + 1 : path;
+  impl->owner = this;
+  return File(impl);
+}
+
+bool FS::exists(const char *path) {
+  struct stat st;
+  return stat(hostPath(path).c_str(), &st) == 0;
+}
+
+bool FS::remove(const char *path) { return ::remove(hostPath(path).c_str()) == 0; }
+
+bool FS::rename(const char *from, const char *to) {
+  return ::rename(hostPath(from).c_str(), hostPath(to).c_str()) == 0;
+}
+
+bool SPIFFSFS::begin(bool formatOnFail, const char *basePath, uint8_t maxOpenFiles, const char *partitionLabel) {
+  (void)basePath; (void)maxOpenFiles; (void)partitionLabel;
+  struct stat st;
+  if (stat(root_.c_str(), &st) == 0) return S_ISDIR(st.st_mode);
+  return formatOnFail && mkdir(root_.c_str(), 0755) == 0;
+}
+
+bool SPIFFSFS::format() {
+  DIR *d = opendir(root_.c_str());
+  if (!d) return false;
+  struct dirent *e;
+  while ((e = readdir(d)) != nullptr) {
+    if (e->d_name[0] == '.') continue;
+    ::remove(hostPath(e->d_name).c_str());
+  }
+  closedir(d);
+  return true;
+}
+
+size_t SPIFFSFS::usedBytes() {
+  size_t used = 0;
+  DIR *d = opendir(root_.c_str());
+  if (!d) return 0;
+  struct dirent *e;
+  struct stat st;
+  while ((e = readdir(d)) != nullptr) {
+    if (stat(hostPath(e->d_name).c_str(), &st) == 0 && S_ISREG(st.st_mode)) used += (size_t)st.st_size;
+  }
+  closedir(d);
+  return used;
+}
+
+} // namespace fs
+
+fs::SPIFFSFS SPIFFS;
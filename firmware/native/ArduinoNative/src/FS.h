@@ -0,0 +1,80 @@
+// ======== FS sobre un directorio del host ========
+// Cada ruta "/x" del FS se mapea a <root>/x en Linux, así que la carpeta
+// data/ del proyecto hace de imagen de SPIFFS sin pasar por uploadfs.
+#pragma once
+
+#include <memory>
+#include "Arduino.h"
+
+#define FILE_READ   "r"
+#define FILE_WRITE  "w"
+#define FILE_APPEND "a"
+
+namespace fs {
+
+enum SeekMode { SeekSet = 0, SeekCur = 1, SeekEnd = 2 };
+
+struct FileImpl;
+
+class File : public Print {
+public:
+  File() {}
+  explicit File(std::shared_ptr<FileImpl> impl) : impl_(impl) {}
+
+  explicit operator bool() const;
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t *buf, size_t size) override;
+  using Print::write;
+  int available();
+  int read();
+  size_t read(uint8_t *buf, size_t size);
+  int peek();
+  void flush();
+  bool seek(uint32_t pos, SeekMode mode = SeekSet);
+  size_t position() const;
+  size_t size() const;
+  void close();
+  const char *name() const;
+  const char *path() const;
+  bool isDirectory() const { return false; }
+
+private:
+  std::shared_ptr<FileImpl> impl_;
+};
+
+class FS {
+public:
+  explicit FS(const char *root) : root_(root) {}
+  File open(const char *path, const char *mode = FILE_READ, bool create = false);
+  File open(const String &path, const char *mode = FILE_READ, bool create = false) {
+    return open(path.c_str(), mode, create);
+  }
+  bool exists(const char *path);
+  bool exists(const String &path) { return exists(path.c_str()); }
+  bool remove(const char *path);
+  bool remove(const String &path) { return remove(path.c_str()); }
+  bool rename(const char *from, const char *to);
+
+  // Sólo native: cambia la carpeta del host que hace de FS
+  void nativeSetRoot(const char *root) { root_ = root; }
+  const char *nativeRoot() const { return root_.c_str(); }
+
+  // Sólo native: contadores de acceso (los usa el benchmark)
+  uint32_t nativeOpens = 0;
+  uint32_t nativeWrites = 0;
+  // Sólo native: corte de luz simulado. Con >= 0 cada write() descuenta uno
+  // y en 0 ya no escribe nada (-1: sin límite)
+  int32_t nativeWritesLeft = -1;
+
+protected:
+  String hostPath(const char *path) const;
+  String root_;
+};
+
+} // namespace fs
+
+using fs::File;
+using fs::FS;
+using fs::SeekSet;
+using fs::SeekCur;
+using fs::SeekEnd;
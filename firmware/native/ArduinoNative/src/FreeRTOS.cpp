@@ -0,0 +1,133 @@
+#include "Arduino.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <pthread.h>
+#include <thread>
+
+// ======== Tareas ========
+struct NativeTask {
+  const char *name;
+  uint32_t stackDepth;
+};
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char *name, uint32_t stackDepth, void *param,
+                                   UBaseType_t priority, TaskHandle_t *handle, BaseType_t coreId) {
+  (void)priority; (void)coreId;
+  NativeTask *t = new NativeTask{name, stackDepth};
+  std::thread(fn, param).detach();
+  if (handle) *handle = t;
+  return pdPASS;
+}
+
+void vTaskDelete(TaskHandle_t task) {
+  if (!task) pthread_exit(nullptr);
+}
+
+TickType_t xTaskGetTickCount() { return (TickType_t)millis(); }
+
+void vTaskDelay(TickType_t ticks) {
+  if (ticks == portMAX_DELAY) for (;;) std::this_thread::sleep_for(std::chrono::hours(1));
+  std::this_thread::sleep_for(std::chrono::milliseconds(ticks));
+}
+
+// Como en FreeRTOS: el período se mide desde el despertar anterior, no desde
+// ahora, así el tiempo de trabajo de la tarea no se acumula como deriva
+void vTaskDelayUntil(TickType_t *previousWakeTime, TickType_t increment) {
+  *previousWakeTime += increment;
+  int32_t wait = (int32_t)(*previousWakeTime - xTaskGetTickCount());
+  if (wait <= 0) return;
+  // Despertar sobre el borde del tick en micros, no millis()+espera
+  uint64_t targetUs = (uint64_t)*previousWakeTime * 1000;
+  int64_t us = (int64_t)targetUs - (int64_t)micros();
+  if (us > 0) std::this_thread::sleep_for(std::chrono::microseconds(us));
+}
+
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task) { return task ? task->stackDepth : 0; }
+
+// ======== Colas ========
+struct NativeQueue {
+  std::mutex mu;
+  std::condition_variable notEmpty, notFull;
+  UBaseType_t length, itemSize;
+  UBaseType_t head = 0, count = 0;
+  uint8_t *storage;
+};
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize) {
+  NativeQueue *q = new NativeQueue;
+  q->length = length;
+  q->itemSize = itemSize;
+  q->storage = itemSize ? new uint8_t[length * itemSize] : nullptr;
+  return q;
+}
+
+// Espera una condición con timeout en ticks (portMAX_DELAY = sin límite)
+template <class Pred> static bool waitFor(std::condition_variable &cv, std::unique_lock<std::mutex> &lk,
+                                          TickType_t wait, Pred pred) {
+  if (wait == portMAX_DELAY) {
+    cv.wait(lk, pred);
+    return true;
+  }
+  return cv.wait_for(lk, std::chrono::milliseconds(wait), pred);
+}
+
+static BaseType_t queueSend(QueueHandle_t q, const void *item, TickType_t wait, bool front) {
+  std::unique_lock<std::mutex> lk(q->mu);
+  if (!waitFor(q->notFull, lk, wait, [q]() { return q->count < q->length; })) return errQUEUE_FULL;
+  UBaseType_t slot;
+  if (front) {
+    q->head = (q->head + q->length - 1) % q->length;
+    slot = q->head;
+  } else {
+    slot = (q->head + q->count) % q->length;
+  }
+  if (q->itemSize) memcpy(q->storage + slot * q->itemSize, item, q->itemSize);
+  q->count++;
+  q->notEmpty.notify_one();
+  return pdPASS;
+}
+
+BaseType_t xQueueSend(QueueHandle_t q, const void *item, TickType_t wait) { return queueSend(q, item, wait, false); }
+BaseType_t xQueueSendToFront(QueueHandle_t q, const void *item, TickType_t wait) {
+  return queueSend(q, item, wait, true);
+}
+
+static BaseType_t queueRead(QueueHandle_t q, void *item, TickType_t wait, bool remove) {
+  std::unique_lock<std::mutex> lk(q->mu);
+  if (!waitFor(q->notEmpty, lk, wait, [q]() { return q->count > 0; })) return pdFALSE;
+  if (q->itemSize) memcpy(item, q->storage + q->head * q->itemSize, q->itemSize);
+  if (remove) {
+    q->head = (q->head + 1) % q->length;
+    q->count--;
+    q->notFull.notify_one();
+  } else {
+    q->notEmpty.notify_one();  // otro lector también puede mirar
+  }
+  return pdTRUE;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t q, void *item, TickType_t wait) { return queueRead(q, item, wait, true); }
+BaseType_t xQueuePeek(QueueHandle_t q, void *item, TickType_t wait) { return queueRead(q, item, wait, false); }
+
+BaseType_t xQueueOverwrite(QueueHandle_t q, const void *item) {
+  std::lock_guard<std::mutex> lk(q->mu);
+  memcpy(q->storage + q->head * q->itemSize, item, q->itemSize);
+  q->count = 1;
+  q->notEmpty.notify_all();
+  return pdPASS;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t q) {
+  std::lock_guard<std::mutex> lk(q->mu);
+  return q->count;
+}
+
+UBaseType_t uxQueueSpacesAvailable(QueueHandle_t q) {
+  std::lock_guard<std::mutex> lk(q->mu);
+  return q->length - q->count;
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+#include "Arduino.h"
+
+class IPAddress : public Printable {
+public:
+  IPAddress(uint8_t a = 0, uint8_t b = 0, uint8_t c = 0, uint8_t d = 0) : b_{a, b, c, d} {}
+  uint8_t operator[](int i) const { return b_[i]; }
+  String toString() const;
+  size_t printTo(Print &p) const override;
+
+private:
+  uint8_t b_[4];
+};
@@ -0,0 +1,79 @@
+#include "Preferences.h"
+
+#include <map>
+#include <mutex>
+#include <vector>
+
+#include <string.h>
+
+uint32_t Preferences::nativeWrites = 0;
+
+namespace {
+std::mutex s_mu;
+std::map<std::string, std::vector<uint8_t>> s_nvs;  // "namespace/clave"
+
+std::string fullKey(const std::string &ns, const char *key) { return ns + "/" + key; }
+} // namespace
+
+bool Preferences::begin(const char *name, bool readOnly, const char *) {
+  if (!name || strlen(name) > 15) return false;  // límite de NVS
+  ns_ = name;
+  readOnly_ = readOnly;
+  open_ = true;
+  return true;
+}
+
+size_t Preferences::putBytes(const char *key, const void *value, size_t len) {
+  if (!open_ || readOnly_ || !key || strlen(key) > 15) return 0;
+  std::lock_guard<std::mutex> lk(s_mu);
+  const uint8_t *p = (const uint8_t *)value;
+  s_nvs[fullKey(ns_, key)].assign(p, p + len);
+  __atomic_add_fetch(&nativeWrites, 1, __ATOMIC_RELAXED);
+  return len;
+}
+
+size_t Preferences::getBytes(const char *key, void *buf, size_t maxLen) {
+  if (!open_) return 0;
+  std::lock_guard<std::mutex> lk(s_mu);
+  auto it = s_nvs.find(fullKey(ns_, key));
+  if (it == s_nvs.end() || it->second.size() > maxLen) return 0;  // como el core: no trunca
+  memcpy(buf, it->second.data(), it->second.size());
+  return it->second.size();
+}
+
+size_t Preferences::getBytesLength(const char *key) {
+  if (!open_) return 0;
+  std::lock_guard<std::mutex> lk(s_mu);
+  auto it = s_nvs.find(fullKey(ns_, key));
+  return it == s_nvs.end() ? 0 : it->second.size();
+}
+
+bool Preferences::isKey(const char *key) {
+  if (!open_) return false;
+  std::lock_guard<std::mutex> lk(s_mu);
+  return s_nvs.count(fullKey(ns_, key)) > 0;
+}
+
+bool Preferences::remove(const char *key) {
+  if (!open_ || readOnly_) return false;
+  std::lock_guard<std::mutex> lk(s_mu);
+  __atomic_add_fetch(&nativeWrites, 1, __ATOMIC_RELAXED);
+  return s_nvs.erase(fullKey(ns_, key)) > 0;
+}
+
+bool Preferences::clear() {
+  if (!open_ || readOnly_) return false;
+  std::lock_guard<std::mutex> lk(s_mu);
+  std::string prefix = ns_ + "/";
+  for (auto it = s_nvs.begin(); it != s_nvs.end();) {
+    if (it->first.compare(0, prefix.size(), prefix) == 0) it = s_nvs.erase(it);
+    else ++it;
+  }
+  __atomic_add_fetch(&nativeWrites, 1, __ATOMIC_RELAXED);
+  return true;
+}
+
+void Preferences::nativeErase() {
+  std::lock_guard<std::mutex> lk(s_mu);
+  s_nvs.clear();
+}
@@ -0,0 +1,32 @@
+// ======== Preferences (NVS) en memoria ========
+// Misma API que la del core para blobs: cada namespace/clave es un vector
+// que vive mientras dure el proceso (sobrevive a un "reinicio" simulado
+// llamando otra vez a setup()). nativeWrites cuenta las escrituras, que en
+// el ESP32 son las que gastan flash.
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+class Preferences {
+public:
+  bool begin(const char *name, bool readOnly = false, const char *partitionLabel = nullptr);
+  void end() { open_ = false; }
+
+  size_t putBytes(const char *key, const void *value, size_t len);
+  size_t getBytes(const char *key, void *buf, size_t maxLen);
+  size_t getBytesLength(const char *key);
+  bool isKey(const char *key);
+  bool remove(const char *key);
+  bool clear();
+
+  // Sólo native
+  static uint32_t nativeWrites;  // putBytes/remove/clear (todas las instancias)
+  static void nativeErase();     // como borrar la partición NVS
+
+private:
+  std::string ns_;
+  bool open_ = false;
+  bool readOnly_ = false;
+};
@@ -0,0 +1,18 @@
+#pragma once
+
+#include "FS.h"
+
+namespace fs {
+class SPIFFSFS : public FS {
+public:
+  SPIFFSFS() : FS("data") {}
+  bool begin(bool formatOnFail = false, const char *basePath = "/spiffs", uint8_t maxOpenFiles = 10,
+             const char *partitionLabel = nullptr);
+  void end() {}
+  bool format();
+  size_t totalBytes() { return 1441792; }
+  size_t usedBytes();
+};
+} // namespace fs
+
+extern fs::SPIFFSFS SPIFFS;
@@ -0,0 +1,182 @@
+#include "WString.h"
+#include "Arduino.h"
+
+#include <ctype.h>
+
+String::String(const char *cstr) { init(); if (cstr) copy(cstr, strlen(cstr)); }
+String::String(const String &s) { init(); copy(s.c_str(), s.len_); }
+String::String(String &&s) noexcept { init(); move(s); }
+String::String(char c) { init(); copy(&c, 1); }
+
+String::String(int v, unsigned char base) : String((long)v, base) {}
+String::String(unsigned int v, unsigned char base) : String((unsigned long)v, base) {}
+String::String(long v, unsigned char base) : String((long long)v, base) {}
+String::String(unsigned long v, unsigned char base) : String((unsigned long long)v, base) {}
+
+String::String(long long v, unsigned char base) {
+  init();
+  if (v < 0 && base == 10) {
+    char buf[24];
+    snprintf(buf, sizeof(buf), "%lld", v);
+    copy(buf, strlen(buf));
+  } else {
+    *this = String((unsigned long long)v, base);
+  }
+}
+
+String::String(unsigned long long v, unsigned char base) {
+  init();
+  char buf[66];
+  char *p = buf + sizeof(buf) - 1;
+  *p = '\0';
+  do {
+    unsigned d = (unsigned)(v % base);
+    *--p = (char)(d < 10 ? '0' + d : 'a' + d - 10);
+    v /= base;
+  } while (v);
+  copy(p, strlen(p));
+}
+
+String::String(float v, unsigned int decimals) : String((double)v, decimals) {}
+
+String::String(double v, unsigned int decimals) {
+  init();
+  char buf[48];
+  snprintf(buf, sizeof(buf), "%.*f", (int)decimals, v);
+  copy(buf, strlen(buf));
+}
+
+String::~String() { native::trackedFree(buf_); }
+
+String &String::operator=(const String &rhs) {
+  if (this != &rhs) copy(rhs.c_str(), rhs.len_);
+  return *this;
+}
+String &String::operator=(String &&rhs) noexcept {
+  if (this != &rhs) move(rhs);
+  return *this;
+}
+String &String::operator=(const char *cstr) {
+  copy(cstr ? cstr : "", cstr ? strlen(cstr) : 0);
+  return *this;
+}
+
+void String::move(String &rhs) {
+  native::trackedFree(buf_);
+  buf_ = rhs.buf_; len_ = rhs.len_; cap_ = rhs.cap_;
+  rhs.init();
+}
+
+bool String::reserve(unsigned int size) {
+  if (buf_ && cap_ >= size) return true;
+  char *nb = (char *)native::trackedRealloc(buf_, size + 1);
+  if (!nb) return false;
+  if (!buf_) nb[0] = '\0';
+  buf_ = nb;
+  cap_ = size;
+  return true;
+}
+
+bool String::copy(const char *cstr, unsigned int length) {
+  if (!reserve(length)) return false;
+  memmove(buf_, cstr, length);
+  len_ = length;
+  buf_[len_] = '\0';
+  return true;
+}
+
+// Igual que el core: crece exactamente a lo necesario (una realloc por concat)
+bool String::concat(const char *cstr, unsigned int length) {
+  if (!cstr) return false;
+  if (length == 0) return true;
+  unsigned int newlen = len_ + length;
+  if (!reserve(newlen)) return false;
+  memmove(buf_ + len_, cstr, length);
+  len_ = newlen;
+  buf_[len_] = '\0';
+  return true;
+}
+
+bool String::concat(const char *cstr) { return cstr ? concat(cstr, strlen(cstr)) : false; }
+
+String operator+(const String &lhs, const String &rhs) { String r(lhs); r.concat(rhs); return r; }
+String operator+(const String &lhs, const char *rhs) { String r(lhs); r.concat(rhs); return r; }
+String operator+(const char *lhs, const String &rhs) { String r(lhs); r.concat(rhs); return r; }
+
+bool String::equals(const char *cstr) const {
+  if (!cstr) return len_ == 0;
+  return strcmp(c_str(), cstr) == 0;
+}
+
+bool String::startsWith(const char *prefix) const {
+  size_t n = strlen(prefix);
+  return n <= len_ && strncmp(c_str(), prefix, n) == 0;
+}
+bool String::startsWith(const String &prefix) const { return startsWith(prefix.c_str()); }
+
+bool String::endsWith(const char *suffix) const {
+  size_t n = strlen(suffix);
+  return n <= len_ && strcmp(c_str() + len_ - n, suffix) == 0;
+}
+bool String::endsWith(const String &suffix) const { return endsWith(suffix.c_str()); }
+
+int String::indexOf(char c, unsigned int from) const {
+  if (from >= len_) return -1;
+  const char *p = strchr(c_str() + from, c);
+  return p ? (int)(p - c_str()) : -1;
+}
+
+int String::indexOf(const char *str, unsigned int from) const {
+  if (from >= len_) return -1;
+  const char *p = strstr(c_str() + from, str);
+  return p ? (int)(p - c_str()) : -1;
+}
+
+String String::substring(unsigned int from, unsigned int to) const {
+  if (from > to) { unsigned int t = from; from = to; to = t; }
+  if (from >= len_) return String();
+  if (to > len_) to = len_;
+  String r;
+  r.copy(c_str() + from, to - from);
+  return r;
+}
+
+void String::replace(const char *find, const char *with) {
+  size_t fl = strlen(find);
+  if (fl == 0 || len_ == 0) return;
+  String out;
+  const char *p = c_str();
+  const char *hit;
+  while ((hit = strstr(p, find)) != nullptr) {
+    out.concat(p, (unsigned int)(hit - p));
+    out.concat(with);
+    p = hit + fl;
+  }
+  out.concat(p);
+  *this = out;
+}
+
+void String::toLowerCase() { for (unsigned int i = 0; i < len_; ++i) buf_[i] = (char)tolower((unsigned char)buf_[i]); }
+void String::toUpperCase() { for (unsigned int i = 0; i < len_; ++i) buf_[i] = (char)toupper((unsigned char)buf_[i]); }
+
+void String::trim() {
+  if (len_ == 0) return;
+  unsigned int b = 0, e = len_;
+  while (b < e && isspace((unsigned char)buf_[b])) ++b;
+  while (e > b && isspace((unsigned char)buf_[e - 1])) --e;
+  memmove(buf_, buf_ + b, e - b);
+  len_ = e - b;
+  buf_[len_] = '\0';
+}
+
+long String::toInt() const { return atol(c_str()); }
+float String::toFloat() const { return (float)atof(c_str()); }
+
+void String::toCharArray(char *buf, unsigned int bufsize, unsigned int index) const {
+  if (!bufsize || !buf) return;
+  if (index >= len_) { buf[0] = '\0'; return; }
+  unsigned int n = bufsize - 1;
+  if (n > len_ - index) n = len_ - index;
+  memcpy(buf, c_str() + index, n);
+  buf[n] = '\0';
+}
@@ -0,0 +1,84 @@
+// ======== String (subset compatible con Arduino) para el entorno native ========
+// Usa un buffer propio con realloc (igual que el core ESP32) para que los
+// benchmarks cuenten las mismas realocaciones que se ven en la placa.
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+class String {
+public:
+  String(const char *cstr = "");
+  String(const String &s);
+  String(String &&s) noexcept;
+  explicit String(char c);
+  explicit String(int v, unsigned char base = 10);
+  explicit String(unsigned int v, unsigned char base = 10);
+  explicit String(long v, unsigned char base = 10);
+  explicit String(unsigned long v, unsigned char base = 10);
+  explicit String(long long v, unsigned char base = 10);
+  explicit String(unsigned long long v, unsigned char base = 10);
+  explicit String(float v, unsigned int decimals = 2);
+  explicit String(double v, unsigned int decimals = 2);
+  ~String();
+
+  String &operator=(const String &rhs);
+  String &operator=(String &&rhs) noexcept;
+  String &operator=(const char *cstr);
+
+  bool reserve(unsigned int size);
+  unsigned int length() const { return len_; }
+  bool isEmpty() const { return len_ == 0; }
+  const char *c_str() const { return buf_ ? buf_ : ""; }
+
+  bool concat(const char *cstr, unsigned int length);
+  bool concat(const char *cstr);
+  bool concat(const String &s) { return concat(s.c_str(), s.length()); }
+  bool concat(char c) { return concat(&c, 1); }
+
+  String &operator+=(const String &rhs) { concat(rhs); return *this; }
+  String &operator+=(const char *cstr) { concat(cstr); return *this; }
+  String &operator+=(char c) { concat(c); return *this; }
+  String &operator+=(int v) { concat(String(v)); return *this; }
+  String &operator+=(unsigned int v) { concat(String(v)); return *this; }
+  String &operator+=(long v) { concat(String(v)); return *this; }
+  String &operator+=(unsigned long v) { concat(String(v)); return *this; }
+
+  friend String operator+(const String &lhs, const String &rhs);
+  friend String operator+(const String &lhs, const char *rhs);
+  friend String operator+(const char *lhs, const String &rhs);
+
+  bool equals(const char *cstr) const;
+  bool operator==(const String &rhs) const { return equals(rhs.c_str()); }
+  bool operator==(const char *cstr) const { return equals(cstr); }
+  bool operator!=(const String &rhs) const { return !equals(rhs.c_str()); }
+  bool operator!=(const char *cstr) const { return !equals(cstr); }
+
+  char operator[](unsigned int index) const { return index < len_ ? buf_[index] : 0; }
+  char charAt(unsigned int index) const { return (*this)[index]; }
+
+  bool startsWith(const String &prefix) const;
+  bool startsWith(const char *prefix) const;
+  bool endsWith(const String &suffix) const;
+  bool endsWith(const char *suffix) const;
+  int indexOf(char c, unsigned int from = 0) const;
+  int indexOf(const char *str, unsigned int from = 0) const;
+  String substring(unsigned int from) const { return substring(from, len_); }
+  String substring(unsigned int from, unsigned int to) const;
+  void replace(const char *find, const char *with);
+  void toLowerCase();
+  void toUpperCase();
+  void trim();
+  long toInt() const;
+  float toFloat() const;
+  void toCharArray(char *buf, unsigned int bufsize, unsigned int index = 0) const;
+
+private:
+  void init() { buf_ = nullptr; len_ = 0; cap_ = 0; }
+  void move(String &rhs);
+  bool copy(const char *cstr, unsigned int length);
+
+  char *buf_;
+  unsigned int len_;
+  unsigned int cap_;
+};
@@ -0,0 +1,287 @@
+#include "WebServer.h"
+
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+static const char *reasonPhrase(int code) {
+  switch (code) {
+    case 200: return "OK";
+    case 204: return "No Content";
+    case 206: return "Partial Content";
+    case 304: return "Not Modified";
+    case 400: return "Bad Request";
+    case 404: return "Not Found";
+    case 500: return "Internal Server Error";
+    case 503: return "Service Unavailable";
+    default:  return "";
+  }
+}
+
+static String urlDecode(const char *s, size_t n) {
+  String out;
+  for (size_t i = 0; i < n; ++i) {
+    char c = s[i];
+    if (c == '+') {
+      c = ' ';
+    } else if (c == '%' && i + 2 < n && isxdigit((unsigned char)s[i + 1]) && isxdigit((unsigned char)s[i + 2])) {
+      char hex[3] = {s[i + 1], s[i + 2], 0};
+      c = (char)strtol(hex, nullptr, 16);
+      i += 2;
+    }
+    out += c;
+  }
+  return out;
+}
+
+void WebServer::on(const String &uri, HTTPMethod method, THandlerFunction fn) {
+  routes_.push_back(Route{uri, method, fn});
+}
+
+String WebServer::arg(const String &name) const {
+  for (const KV &kv : args_) if (kv.key == name) return kv.value;
+  return String();
+}
+
+bool WebServer::hasArg(const String &name) const {
+  for (const KV &kv : args_) if (kv.key == name) return true;
+  return false;
+}
+
+String WebServer::header(const String &name) const {
+  for (const KV &kv : reqHeaders_) if (strcasecmp(kv.key.c_str(), name.c_str()) == 0) return kv.value;
+  return String();
+}
+
+bool WebServer::hasHeader(const String &name) const {
+  for (const KV &kv : reqHeaders_) if (strcasecmp(kv.key.c_str(), name.c_str()) == 0) return true;
+  return false;
+}
+
+// Igual que el core: las cabeceras extra se acumulan en un String
+static String s_extraHeaders;
+
+void WebServer::sendHeader(const String &name, const String &value, bool first) {
+  String line = name + ": " + value + "\r\n";
+  if (first) s_extraHeaders = line + s_extraHeaders;
+  else s_extraHeaders += line;
+}
+
+void WebServer::sendHeaders(int code, const char *contentType, size_t contentLength) {
+  String h = "HTTP/1.1 " + String(code) + " " + reasonPhrase(code) + "\r\n";
+  if (contentType && *contentType) h += String("Content-Type: ") + contentType + "\r\n";
+  if (contentLength == CONTENT_LENGTH_UNKNOWN) {
+    h += "Transfer-Encoding: chunked\r\n";
+    resp_.chunked = true;
+  } else {
+    h += "Content-Length: " + String((unsigned long)contentLength) + "\r\n";
+  }
+  h += s_extraHeaders;
+  h += "Connection: close\r\n\r\n";
+  s_extraHeaders = "";
+  sockWrite(h.c_str(), h.length());
+  size_t n = h.length() < sizeof(lastHeaders_) - 1 ? h.length() : sizeof(lastHeaders_) - 1;
+  memcpy(lastHeaders_, h.c_str(), n);
+  lastHeaders_[n] = '\0';
+  resp_.code = code;
+  resp_.headerBytes += h.length();
+  resp_.writes++;
+  headersSent_ = true;
+  contentLength_ = CONTENT_LENGTH_NOT_SET;
+}
+
+void WebServer::nativeWrite(const char *data, size_t len) {
+  if (len == 0) return;
+  resp_.bodyBytes += len;
+  resp_.writes++;
+  if (nativeBodySink) nativeBodySink(data, len);
+  sockWrite(data, len);
+}
+
+// Escritura bloqueante como WiFiClient::write (sólo con cliente real)
+void WebServer::sockWrite(const char *data, size_t len) {
+  while (clientFd_ >= 0 && len > 0) {
+    ssize_t n = ::send(clientFd_, data, len, MSG_NOSIGNAL);
+    if (n <= 0) return;
+    data += n;
+    len -= (size_t)n;
+  }
+}
+
+void WebServer::send(int code, const char *contentType, const String &content) {
+  send(code, contentType, content.c_str());
+}
+
+void WebServer::send(int code, const char *contentType, const char *content) {
+  size_t len = content ? strlen(content) : 0;
+  size_t cl = contentLength_ == CONTENT_LENGTH_NOT_SET ? len : contentLength_;
+  sendHeaders(code, contentType, cl);
+  if (len) sendContent(content, len);
+}
+
+void WebServer::send_P(int code, PGM_P contentType, PGM_P content, size_t contentLength) {
+  setContentLength(contentLength);
+  sendHeaders(code, contentType, contentLength);
+  nativeWrite(content, contentLength);
+}
+
+void WebServer::sendContent(const char *content, size_t contentLength) {
+  if (resp_.chunked) {
+    // Framing chunked: "<hex>\r\n" + datos + "\r\n"; el bloque vacío cierra la respuesta
+    char frame[12];
+    int n = snprintf(frame, sizeof(frame), "%zx\r\n", contentLength);
+    resp_.headerBytes += (size_t)n + 2;
+    sockWrite(frame, (size_t)n);
+    if (contentLength == 0) { resp_.writes++; sockWrite("\r\n", 2); return; }
+    nativeWrite(content, contentLength);
+    sockWrite("\r\n", 2);
+    return;
+  }
+  nativeWrite(content, contentLength);
+}
+
+String WebServer::nativeResponseHeader(const char *name) const {
+  size_t n = strlen(name);
+  const char *p = lastHeaders_;
+  while ((p = strstr(p, "\r\n")) != nullptr) {
+    p += 2;
+    if (strncasecmp(p, name, n) == 0 && p[n] == ':') {
+      const char *v = p + n + 1;
+      while (*v == ' ') ++v;
+      const char *e = strstr(v, "\r\n");
+      return String(v).substring(0, e ? (unsigned int)(e - v) : strlen(v));
+    }
+  }
+  return String();
+}
+
+const NativeResponse &WebServer::nativeRequest(HTTPMethod method, const char *url, const char *headers) {
+  resp_ = NativeResponse();
+  headersSent_ = false;
+  lastHeaders_[0] = '\0';
+  contentLength_ = CONTENT_LENGTH_NOT_SET;
+  method_ = method;
+  args_.clear();
+  reqHeaders_.clear();
+
+  const char *q = strchr(url, '?');
+  uri_ = q ? String(url).substring(0, (unsigned int)(q - url)) : String(url);
+  if (q) {
+    const char *p = q + 1;
+    while (*p) {
+      const char *amp = strchr(p, '&');
+      size_t n = amp ? (size_t)(amp - p) : strlen(p);
+      const char *eq = (const char *)memchr(p, '=', n);
+      size_t kn = eq ? (size_t)(eq - p) : n;
+      KV kv{urlDecode(p, kn), eq ? urlDecode(eq + 1, n - kn - 1) : String()};
+      args_.push_back(kv);
+      p += n + (amp ? 1 : 0);
+    }
+  }
+
+  if (headers) {
+    const char *p = headers;
+    while (*p) {
+      const char *nl = strchr(p, '\n');
+      size_t n = nl ? (size_t)(nl - p) : strlen(p);
+      const char *colon = (const char *)memchr(p, ':', n);
+      if (colon) {
+        String key = String(p).substring(0, (unsigned int)(colon - p));
+        String value = String(colon + 1).substring(0, (unsigned int)(n - (colon - p) - 1));
+        key.trim(); value.trim();
+        reqHeaders_.push_back(KV{key, value});
+      }
+      p += n + (nl ? 1 : 0);
+    }
+  }
+
+  for (const Route &r : routes_) {
+    if (r.uri == uri_ && (r.method == HTTP_ANY || r.method == method)) {
+      r.fn();
+      return resp_;
+    }
+  }
+  if (notFound_) notFound_();
+  else send(404, "text/plain", "Not found");
+  return resp_;
+}
+
+// ======== Modo socket ========
+void WebServer::begin(uint16_t port) {
+  close();
+  port_ = port;
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  if (fd < 0) return;
+  int one = 1;
+  setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+  sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_ANY);
+  addr.sin_port = htons(port);
+  if (bind(fd, (sockaddr *)&addr, sizeof(addr)) != 0 || listen(fd, 16) != 0) {
+    Serial.printf("WebServer: no se pudo escuchar en el puerto %u\n", (unsigned)port);
+    ::close(fd);
+    return;
+  }
+  fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+  listenFd_ = fd;
+}
+
+void WebServer::close() {
+  if (listenFd_ >= 0) ::close(listenFd_);
+  listenFd_ = -1;
+}
+
+// Como el core: toma un cliente, espera la petición entera (hasta 5 s,
+// HTTP_MAX_DATA_WAIT), la atiende escribiendo bloqueante y cierra
+void WebServer::handleClient() {
+  if (listenFd_ < 0) return;
+  int fd = accept(listenFd_, nullptr, nullptr);
+  if (fd < 0) return;
+  int one = 1;
+  setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+#ifdef HTTP_TCP_SNDBUF
+  int sndbuf = HTTP_TCP_SNDBUF / 2;  // Linux lo duplica
+  setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &sndbuf, sizeof(sndbuf));
+#endif
+  timeval tv = {5, 0};
+  setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+  char buf[1024];
+  size_t len = 0;
+  char *end = nullptr;
+  while (!end && len < sizeof(buf) - 1) {
+    ssize_t n = recv(fd, buf + len, sizeof(buf) - 1 - len, 0);
+    if (n <= 0) break;
+    len += (size_t)n;
+    buf[len] = '\0';
+    end = strstr(buf, "\r\n\r\n");
+  }
+  client_ = WiFiClient(fd);  // se cierra al soltar la última copia
+  if (!end) {
+    client_ = WiFiClient();
+    return;
+  }
+  *end = '\0';
+
+  // "GET /url HTTP/1.1" + cabeceras al formato de nativeRequest ("K: v\n")
+  char *eol = strstr(buf, "\r\n");
+  char *headers = eol ? eol + 2 : end;
+  if (eol) *eol = '\0';
+  for (char *p = headers; (p = strstr(p, "\r\n")) != nullptr; ) { p[0] = '\n'; memmove(p + 1, p + 2, strlen(p + 2) + 1); }
+  char *sp1 = strchr(buf, ' ');
+  char *sp2 = sp1 ? strchr(sp1 + 1, ' ') : nullptr;
+  if (sp2) {
+    *sp1 = *sp2 = '\0';
+    HTTPMethod m = strcmp(buf, "GET") == 0 ? HTTP_GET : strcmp(buf, "HEAD") == 0 ? HTTP_HEAD : HTTP_POST;
+    clientFd_ = fd;
+    nativeRequest(m, sp1 + 1, headers);
+    clientFd_ = -1;
+  }
+  client_ = WiFiClient();
+}
@@ -0,0 +1,113 @@
+// ======== WebServer simulado (misma API que el del core ESP32) ========
+// Las peticiones se inyectan con nativeRequest() y las respuestas se cuentan
+// (código, bytes, cabeceras) en lugar de enviarse. begin() además escucha en
+// un socket real y handleClient() atiende como el core: un cliente por
+// llamada, lectura y escritura bloqueantes y "Connection: close" (lo usa la
+// prueba de carga para comparar con AsyncHttpServer).
+#pragma once
+
+#include <functional>
+#include <vector>
+#include "Arduino.h"
+#include "FS.h"
+#include "WiFiClient.h"
+
+enum HTTPMethod { HTTP_ANY, HTTP_GET, HTTP_HEAD, HTTP_POST, HTTP_PUT, HTTP_PATCH, HTTP_DELETE, HTTP_OPTIONS };
+
+#define CONTENT_LENGTH_UNKNOWN ((size_t)-1)
+#define CONTENT_LENGTH_NOT_SET ((size_t)-2)
+
+// Resultado de la última petición inyectada
+struct NativeResponse {
+  int code = 0;
+  size_t bodyBytes = 0;    // bytes de cuerpo (sin cabeceras ni framing chunked)
+  size_t headerBytes = 0;  // bytes de cabeceras de respuesta
+  size_t writes = 0;       // llamadas de escritura al "socket"
+  bool chunked = false;
+};
+
+class WebServer {
+public:
+  typedef std::function<void(void)> THandlerFunction;
+
+  explicit WebServer(int port = 80) : port_(port) { lastHeaders_[0] = '\0'; }
+  ~WebServer() { close(); }
+
+  void begin() { begin((uint16_t)port_); }
+  void begin(uint16_t port);
+  void close();
+  void stop() { close(); }
+  void handleClient();
+  void on(const String &uri, THandlerFunction fn) { on(uri, HTTP_ANY, fn); }
+  void on(const String &uri, HTTPMethod method, THandlerFunction fn);
+  void onNotFound(THandlerFunction fn) { notFound_ = fn; }
+
+  WiFiClient client() { return client_; }
+  String uri() const { return uri_; }
+  HTTPMethod method() const { return method_; }
+  String arg(const String &name) const;
+  bool hasArg(const String &name) const;
+  int args() const { return (int)args_.size(); }
+  String header(const String &name) const;
+  bool hasHeader(const String &name) const;
+  void collectHeaders(const char *headerKeys[], const size_t headerKeysCount) { (void)headerKeys; (void)headerKeysCount; }
+
+  void setContentLength(const size_t contentLength) { contentLength_ = contentLength; }
+  void sendHeader(const String &name, const String &value, bool first = false);
+  void send(int code, const char *contentType = nullptr, const String &content = String(""));
+  void send(int code, const String &contentType, const String &content) { send(code, contentType.c_str(), content); }
+  void send(int code, const char *contentType, const char *content);
+  void send_P(int code, PGM_P contentType, PGM_P content, size_t contentLength);
+  void sendContent(const String &content) { sendContent(content.c_str(), content.length()); }
+  void sendContent(const char *content, size_t contentLength);
+
+  template <typename T> size_t streamFile(T &file, const String &contentType, const int code = 200) {
+    setContentLength(file.size());
+    if (String(file.name()).endsWith(".gz") && contentType != "application/x-gzip" &&
+        contentType != "application/octet-stream") {
+      sendHeader("Content-Encoding", "gzip");
+    }
+    send(code, contentType.c_str(), "");
+    uint8_t buf[1360];
+    size_t total = 0, n;
+    while ((n = file.read(buf, sizeof(buf))) > 0) {
+      nativeWrite((const char *)buf, n);
+      total += n;
+    }
+    return total;
+  }
+
+  // ======== Sólo native ========
+  // url puede incluir query string ("/api/history?date=2025-01-01").
+  // headers: pares "Nombre: valor" separados por '\n'.
+  const NativeResponse &nativeRequest(HTTPMethod method, const char *url, const char *headers = nullptr);
+  const NativeResponse &nativeLastResponse() const { return resp_; }
+  // Valor de una cabecera de la última respuesta ("" si no estaba)
+  String nativeResponseHeader(const char *name) const;
+  // Si se define, recibe cada bloque de cuerpo enviado (para inspeccionar la salida)
+  std::function<void(const char *, size_t)> nativeBodySink;
+
+private:
+  struct Route { String uri; HTTPMethod method; THandlerFunction fn; };
+  struct KV { String key; String value; };
+
+  void nativeWrite(const char *data, size_t len);
+  void sockWrite(const char *data, size_t len);
+  void sendHeaders(int code, const char *contentType, size_t contentLength);
+
+  int port_;
+  int listenFd_ = -1;
+  int clientFd_ = -1;  // cliente atendido por handleClient() (-1: nativeRequest)
+  WiFiClient client_;
+  std::vector<Route> routes_;
+  THandlerFunction notFound_;
+  String uri_;
+  HTTPMethod method_ = HTTP_GET;
+  std::vector<KV> args_;
+  std::vector<KV> reqHeaders_;
+  size_t contentLength_ = CONTENT_LENGTH_NOT_SET;
+  size_t pendingHeaderBytes_ = 0;
+  bool headersSent_ = false;
+  char lastHeaders_[512];  // copia (truncada) de las cabeceras enviadas
+  NativeResponse resp_;
+};
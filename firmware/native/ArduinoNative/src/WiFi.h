@@ -0,0 +1,41 @@
+// ======== WiFi simulado: siempre "conectado" en 127.0.0.1 ========
+#pragma once
+
+#include "Arduino.h"
+#include "IPAddress.h"
+#include "WiFiClient.h"
+
+typedef enum { WIFI_OFF = 0, WIFI_STA = 1, WIFI_AP = 2, WIFI_AP_STA = 3 } wifi_mode_t;
+typedef enum {
+  WL_IDLE_STATUS = 0,
+  WL_NO_SSID_AVAIL = 1,
+  WL_CONNECTED = 3,
+  WL_CONNECT_FAILED = 4,
+  WL_CONNECTION_LOST = 5,
+  WL_DISCONNECTED = 6
+} wl_status_t;
+
+class WiFiClass {
+public:
+  bool mode(wifi_mode_t m) { mode_ = m; return true; }
+  wl_status_t begin(const char *ssid, const char *pass = nullptr);
+  wl_status_t begin() { status_ = WL_CONNECTED; return status_; }  // credenciales guardadas
+  wl_status_t status() const { return status_; }
+  bool reconnect() { status_ = WL_CONNECTED; return true; }
+  bool disconnect(bool wifioff = false) { (void)wifioff; status_ = WL_DISCONNECTED; return true; }
+  bool setAutoReconnect(bool) { return true; }
+  void persistent(bool) {}
+  IPAddress localIP() const { return IPAddress(127, 0, 0, 1); }
+  String macAddress() const { return String("24:6F:28:1A:2B:3C"); }
+  String SSID() const { return ssid_; }
+  int8_t RSSI() const { return -58; }
+
+  // Sólo native: permite simular cortes de red
+  void nativeSetStatus(wl_status_t s) { status_ = s; }
+
+private:
+  wifi_mode_t mode_ = WIFI_OFF;
+  wl_status_t status_ = WL_CONNECTED;
+  String ssid_ = String("native");
+};
+extern WiFiClass WiFi;
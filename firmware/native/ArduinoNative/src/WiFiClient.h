@@ -0,0 +1,26 @@
+// ======== WiFiClient simulado: sólo el handle del socket ========
+// Como en el core, las copias comparten el socket y se cierra al soltar la
+// última (stop() suelta sólo esta copia).
+#pragma once
+
+#include <memory>
+#include <unistd.h>
+
+class WiFiClient {
+public:
+  WiFiClient() {}
+  explicit WiFiClient(int fd) : sock_(std::make_shared<Socket>(fd)) {}
+
+  int fd() const { return sock_ ? sock_->fd : -1; }
+  uint8_t connected() const { return sock_ ? 1 : 0; }
+  void stop() { sock_.reset(); }
+  explicit operator bool() const { return connected(); }
+
+private:
+  struct Socket {
+    explicit Socket(int f) : fd(f) {}
+    ~Socket() { if (fd >= 0) ::close(fd); }
+    int fd;
+  };
+  std::shared_ptr<Socket> sock_;
+};
@@ -0,0 +1,18 @@
+// ======== WiFiManager simulado (la red ya está "configurada") ========
+#pragma once
+
+#include "WiFi.h"
+
+class WiFiManager {
+public:
+  void setTimeout(unsigned long seconds) { (void)seconds; }
+  void setConfigPortalTimeout(unsigned long seconds) { (void)seconds; }
+  bool autoConnect(const char *apName = nullptr, const char *apPassword = nullptr) {
+    (void)apName; (void)apPassword;
+    return WiFi.begin("native") == WL_CONNECTED;
+  }
+  bool startConfigPortal(const char *apName = nullptr, const char *apPassword = nullptr) {
+    return autoConnect(apName, apPassword);
+  }
+  void resetSettings() {}
+};
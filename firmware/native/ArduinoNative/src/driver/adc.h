@@ -0,0 +1,83 @@
+// ======== driver/adc.h: ADC en modo continuo (DMA) de ESP-IDF 4.4 ========
+// Sólo lo que usa el firmware: ADC1, una entrada, salida tipo 1 (12 bits de
+// dato + 4 de canal). En native no hay DMA: adc_digi_read_bytes entrega
+// muestras de native::adcInput al ritmo real de sample_freq_hz. Si nadie
+// lee durante más de lo que entra en max_store_buf_size, las más viejas se
+// pierden y la próxima lectura devuelve ESP_ERR_INVALID_STATE, como el
+// ringbuffer del driver cuando se desborda.
+#pragma once
+
+#include <stdint.h>
+
+#include "esp_err.h"
+
+#define ADC_MAX_DELAY UINT32_MAX
+#define SOC_ADC_DIGI_MAX_BITWIDTH 12
+#define SOC_ADC_PATT_LEN_MAX 16
+#define SOC_ADC_SAMPLE_FREQ_THRES_LOW 20000
+#define SOC_ADC_SAMPLE_FREQ_THRES_HIGH 2000000
+
+typedef enum { ADC_UNIT_1 = 1, ADC_UNIT_2 = 2 } adc_unit_t;
+typedef enum {
+  ADC1_CHANNEL_0 = 0, ADC1_CHANNEL_1, ADC1_CHANNEL_2, ADC1_CHANNEL_3,
+  ADC1_CHANNEL_4, ADC1_CHANNEL_5, ADC1_CHANNEL_6, ADC1_CHANNEL_7,
+} adc1_channel_t;
+typedef enum { ADC_ATTEN_DB_0 = 0, ADC_ATTEN_DB_2_5, ADC_ATTEN_DB_6, ADC_ATTEN_DB_11 } adc_atten_t;
+typedef enum {
+  ADC_CONV_SINGLE_UNIT_1 = 1, ADC_CONV_SINGLE_UNIT_2 = 2, ADC_CONV_BOTH_UNIT = 3, ADC_CONV_ALTER_UNIT = 7,
+} adc_digi_convert_mode_t;
+typedef enum { ADC_DIGI_OUTPUT_FORMAT_TYPE1, ADC_DIGI_OUTPUT_FORMAT_TYPE2 } adc_digi_output_format_t;
+
+typedef struct {
+  uint32_t max_store_buf_size;   // bytes del ringbuffer del driver
+  uint32_t conv_num_each_intr;   // bytes por interrupción (una trama del DMA)
+  uint32_t adc1_chan_mask;
+  uint32_t adc2_chan_mask;
+} adc_digi_init_config_t;
+
+typedef struct {
+  uint8_t atten;
+  uint8_t channel;
+  uint8_t unit;
+  uint8_t bit_width;
+} adc_digi_pattern_config_t;
+
+typedef struct {
+  bool conv_limit_en;
+  uint32_t conv_limit_num;
+  uint32_t pattern_num;
+  adc_digi_pattern_config_t *adc_pattern;
+  uint32_t sample_freq_hz;
+  adc_digi_convert_mode_t conv_mode;
+  adc_digi_output_format_t format;
+} adc_digi_configuration_t;
+
+typedef struct {
+  union {
+    struct {
+      uint16_t data : 12;
+      uint16_t channel : 4;
+    } type1;
+    uint16_t val;
+  };
+} adc_digi_output_data_t;
+
+esp_err_t adc_digi_initialize(const adc_digi_init_config_t *init_config);
+esp_err_t adc_digi_controller_configure(const adc_digi_configuration_t *config);
+esp_err_t adc_digi_start();
+esp_err_t adc_digi_stop();
+esp_err_t adc_digi_read_bytes(uint8_t *buf, uint32_t length_max, uint32_t *out_length, uint32_t timeout_ms);
+esp_err_t adc_digi_deinitialize();
+
+namespace native {
+// Señal en la entrada: continua + parpadeo senoidal + ruido (en cuentas)
+struct AdcInput {
+  float dc = 1500.0f;
+  float flickerHz = 100.0f;   // el doble de la red de 50 Hz
+  float flickerAmp = 300.0f;
+  float noise = 20.0f;        // amplitud pico del ruido uniforme
+  uint64_t samples = 0;       // muestras entregadas
+  uint64_t lost = 0;          // muestras pisadas por desborde
+};
+extern AdcInput adcInput;
+}
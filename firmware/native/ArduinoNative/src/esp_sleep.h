@@ -0,0 +1,13 @@
+// ======== esp_sleep.h: deep sleep por timer (en native termina el proceso) ========
+#pragma once
+
+#include <stdint.h>
+
+#include "esp_err.h"
+
+esp_err_t esp_sleep_enable_timer_wakeup(uint64_t us);
+void esp_deep_sleep_start();
+
+namespace native {
+extern uint64_t sleepWakeupUs;  // lo pedido en el último esp_sleep_enable_timer_wakeup
+}
@@ -0,0 +1,2 @@
+// ======== esp_wifi.h: vacío en native (el sketch sólo lo incluye) ========
+#pragma once
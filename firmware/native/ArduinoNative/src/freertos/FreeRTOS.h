@@ -0,0 +1,24 @@
+// ======== FreeRTOS mínimo sobre std::thread (env:native) ========
+// Un tick = 1 ms (CONFIG_FREERTOS_HZ=1000 como el core ESP32). Las tareas son
+// hilos del host: corren en paralelo de verdad, pero el core y la prioridad
+// se ignoran. Sólo cubre lo que usan nuestros sketches.
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+
+#define pdFALSE 0
+#define pdTRUE 1
+#define pdPASS pdTRUE
+#define pdFAIL pdFALSE
+#define errQUEUE_FULL pdFALSE
+
+#define configTICK_RATE_HZ 1000
+#define portTICK_PERIOD_MS ((TickType_t)1000 / configTICK_RATE_HZ)
+#define portMAX_DELAY ((TickType_t)0xffffffffUL)
+#define pdMS_TO_TICKS(ms) ((TickType_t)(((TickType_t)(ms) * (TickType_t)configTICK_RATE_HZ) / (TickType_t)1000U))
+#define tskNO_AFFINITY 0x7fffffff
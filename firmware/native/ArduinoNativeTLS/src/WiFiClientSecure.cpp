@@ -0,0 +1,214 @@
+#include "WiFiClientSecure.h"
+
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <errno.h>
+#include <netdb.h>
+#include <poll.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+
+#include <openssl/err.h>
+#include <openssl/pem.h>
+#include <openssl/ssl.h>
+#include <openssl/x509.h>
+
+uint32_t WiFiClientSecure::nativeHandshakes = 0;
+uint32_t WiFiClientSecure::nativeResumed = 0;
+
+namespace {
+
+struct Redirect {
+  std::string host;
+  std::string ip;
+  uint16_t port;
+  std::string caPem;
+};
+std::mutex s_mu;
+std::vector<Redirect> s_redirects;
+
+SSL_CTX *sharedCtx(int (*onNewSession)(SSL *, SSL_SESSION *)) {
+  static SSL_CTX *ctx = [onNewSession]() {
+    SSL_CTX *c = SSL_CTX_new(TLS_client_method());
+    SSL_CTX_set_min_proto_version(c, TLS1_2_VERSION);
+    // Sin cache interna: cada instancia se queda con su última sesión (en
+    // TLS 1.3 el ticket llega después del handshake, por eso el callback)
+    SSL_CTX_set_session_cache_mode(c, SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+    SSL_CTX_sess_set_new_cb(c, onNewSession);
+    return c;
+  }();
+  return ctx;
+}
+
+// Agrega los certificados PEM de rootCA al store de esta conexión
+bool loadRootCA(SSL *ssl, const char *pem) {
+  BIO *bio = BIO_new_mem_buf(pem, -1);
+  X509_STORE *store = X509_STORE_new();
+  int n = 0;
+  while (X509 *cert = PEM_read_bio_X509(bio, nullptr, nullptr, nullptr)) {
+    X509_STORE_add_cert(store, cert);
+    X509_free(cert);
+    n++;
+  }
+  BIO_free(bio);
+  ERR_clear_error();
+  SSL_set1_verify_cert_store(ssl, store);
+  X509_STORE_free(store);
+  return n > 0;
+}
+
+} // namespace
+
+void WiFiClientSecure::nativeRedirect(const char *host, const char *ip, uint16_t port, const char *caPem) {
+  std::lock_guard<std::mutex> lk(s_mu);
+  s_redirects.push_back(Redirect{host, ip, port, caPem ? caPem : ""});
+}
+
+WiFiClientSecure::~WiFiClientSecure() {
+  stop();
+  if (session_) SSL_SESSION_free(session_);
+}
+
+int WiFiClientSecure::onNewSession(SSL *ssl, SSL_SESSION *session) {
+  WiFiClientSecure *self = (WiFiClientSecure *)SSL_get_app_data(ssl);
+  if (!self || !self->nativeSessionReuse) return 0;
+  if (self->session_) SSL_SESSION_free(self->session_);
+  self->session_ = session;
+  return 1;  // la referencia queda en la instancia
+}
+
+int WiFiClientSecure::connect(const char *host, uint16_t port) {
+  stop();
+  std::string ip, caPem;
+  {
+    std::lock_guard<std::mutex> lk(s_mu);
+    for (const Redirect &r : s_redirects) {
+      if (r.host == host) {
+        ip = r.ip;
+        port = r.port;
+        caPem = r.caPem;
+      }
+    }
+  }
+  addrinfo hints = {}, *res = nullptr;
+  hints.ai_family = AF_INET;
+  hints.ai_socktype = SOCK_STREAM;
+  char portStr[8];
+  snprintf(portStr, sizeof(portStr), "%u", port);
+  if (getaddrinfo(ip.empty() ? host : ip.c_str(), portStr, &hints, &res) != 0) return 0;
+  fd_ = socket(AF_INET, SOCK_STREAM, 0);
+  timeval tv = {(time_t)(timeoutMs_ / 1000), (suseconds_t)((timeoutMs_ % 1000) * 1000)};
+  setsockopt(fd_, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+  setsockopt(fd_, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+  int one = 1;
+  setsockopt(fd_, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+  bool ok = ::connect(fd_, res->ai_addr, res->ai_addrlen) == 0;
+  freeaddrinfo(res);
+  if (!ok) {
+    stop();
+    return 0;
+  }
+
+  ssl_ = SSL_new(sharedCtx(onNewSession));
+  SSL_set_app_data(ssl_, this);
+  SSL_set_fd(ssl_, fd_);
+  SSL_set_tlsext_host_name(ssl_, host);
+  if (session_ && nativeSessionReuse) SSL_set_session(ssl_, session_);
+  const char *ca = caPem.empty() ? rootCA_ : caPem.c_str();
+  if (insecure_) {
+    SSL_set_verify(ssl_, SSL_VERIFY_NONE, nullptr);
+  } else {
+    if (!ca || !loadRootCA(ssl_, ca)) {
+      stop();
+      return 0;
+    }
+    SSL_set_verify(ssl_, SSL_VERIFY_PEER, nullptr);
+    SSL_set1_host(ssl_, host);
+  }
+  if (SSL_connect(ssl_) != 1) {
+    ERR_clear_error();
+    stop();
+    return 0;
+  }
+  __atomic_add_fetch(&nativeHandshakes, 1, __ATOMIC_RELAXED);
+  if (SSL_session_reused(ssl_)) __atomic_add_fetch(&nativeResumed, 1, __ATOMIC_RELAXED);
+  return 1;
+}
+
+size_t WiFiClientSecure::write(const uint8_t *buf, size_t size) {
+  if (!ssl_ || size == 0) return 0;
+  int n = SSL_write(ssl_, buf, (int)size);
+  if (n <= 0) {
+    ERR_clear_error();
+    eof_ = true;
+    return 0;
+  }
+  return (size_t)n;
+}
+
+bool WiFiClientSecure::fill() {
+  if (!ssl_ || eof_) return false;
+  int n = SSL_read(ssl_, rx_, sizeof(rx_));
+  if (n <= 0) {
+    ERR_clear_error();
+    eof_ = true;
+    return false;
+  }
+  rxPos_ = 0;
+  rxLen_ = (size_t)n;
+  return true;
+}
+
+// Como en el core: no bloquea; sólo lee si el socket ya tiene datos
+int WiFiClientSecure::available() {
+  if (rxPos_ < rxLen_) return (int)(rxLen_ - rxPos_);
+  if (!ssl_ || eof_) return 0;
+  if (SSL_pending(ssl_) == 0) {
+    pollfd p = {fd_, POLLIN, 0};
+    if (poll(&p, 1, 0) <= 0) return 0;
+  }
+  return fill() ? (int)(rxLen_ - rxPos_) : 0;
+}
+
+int WiFiClientSecure::read() {
+  uint8_t c;
+  return read(&c, 1) == 1 ? c : -1;
+}
+
+int WiFiClientSecure::read(uint8_t *buf, size_t size) {
+  if (rxPos_ >= rxLen_ && !available()) return -1;
+  size_t n = rxLen_ - rxPos_;
+  if (n > size) n = size;
+  memcpy(buf, rx_ + rxPos_, n);
+  rxPos_ += n;
+  return (int)n;
+}
+
+uint8_t WiFiClientSecure::connected() {
+  if (rxPos_ < rxLen_) return 1;
+  if (!ssl_ || eof_) return 0;
+  available();  // detecta el cierre del otro lado
+  return ssl_ && (!eof_ || rxPos_ < rxLen_);
+}
+
+void WiFiClientSecure::stop() {
+  if (ssl_) {
+    // Si el otro lado ya cerró, cierre "silencioso": sin escribir en el
+    // socket, pero la sesión queda válida para retomarla
+    if (eof_) SSL_set_quiet_shutdown(ssl_, 1);
+    SSL_shutdown(ssl_);
+    SSL_free(ssl_);
+    ssl_ = nullptr;
+  }
+  if (fd_ >= 0) {
+    ::close(fd_);
+    fd_ = -1;
+  }
+  rxPos_ = rxLen_ = 0;
+  eof_ = false;
+}
@@ -0,0 +1,58 @@
+// ======== WiFiClientSecure sobre OpenSSL (env:native) ========
+// Conexión TLS real con la API del core: connect/write/available/read/stop,
+// setInsecure() o setCACert() (verifica la cadena y el nombre del host).
+// nativeRedirect() manda un host a otra IP:puerto, así el sketch sigue
+// conectando a api.telegram.org:443 y llega a un servidor de prueba local;
+// con caPem la verificación usa esa CA en lugar de la que fijó el sketch.
+// Cada instancia guarda la última sesión TLS y la ofrece al reconectar
+// (resumption: sin intercambio de claves ni certificados).
+#pragma once
+
+#include "Client.h"
+
+typedef struct ssl_st SSL;
+typedef struct ssl_session_st SSL_SESSION;
+
+class WiFiClientSecure : public Client {
+public:
+  WiFiClientSecure() {}
+  ~WiFiClientSecure();
+  WiFiClientSecure(const WiFiClientSecure &) = delete;
+  WiFiClientSecure &operator=(const WiFiClientSecure &) = delete;
+
+  int connect(const char *host, uint16_t port) override;
+  size_t write(uint8_t c) override { return write(&c, 1); }
+  size_t write(const uint8_t *buf, size_t size) override;
+  int available() override;
+  int read() override;
+  int read(uint8_t *buf, size_t size) override;
+  void stop() override;
+  uint8_t connected() override;
+  operator bool() override { return connected(); }
+  using Print::write;
+
+  void setInsecure() { insecure_ = true; rootCA_ = nullptr; }
+  void setCACert(const char *rootCA) { rootCA_ = rootCA; insecure_ = false; }
+  void setTimeout(uint32_t ms) { timeoutMs_ = ms; }
+
+  // Sólo native
+  static void nativeRedirect(const char *host, const char *ip, uint16_t port, const char *caPem = nullptr);
+  static uint32_t nativeHandshakes;  // handshakes TLS (todas las instancias)
+  static uint32_t nativeResumed;     // de ésos, cuántos retomaron sesión
+  bool nativeSessionReuse = true;
+
+private:
+  bool fill();  // lee un registro TLS al buffer; false si se cerró
+  static int onNewSession(SSL *ssl, SSL_SESSION *session);
+
+  int fd_ = -1;
+  SSL *ssl_ = nullptr;
+  SSL_SESSION *session_ = nullptr;
+  bool insecure_ = false;
+  const char *rootCA_ = nullptr;
+  uint32_t timeoutMs_ = 5000;
+  uint8_t rx_[4096];
+  size_t rxPos_ = 0;
+  size_t rxLen_ = 0;
+  bool eof_ = false;
+};
@@ -0,0 +1,159 @@
+#include "ClientBench.h"
+
+#include <Arduino.h>
+#include <Client.h>
+#include <TelegramClient.h>
+
+#include <deque>
+#include <string>
+
+namespace {
+
+// Conexión falsa: cada petición (lo escrito desde la última respuesta) se
+// contesta con la siguiente respuesta del guión
+class ScriptedClient : public Client {
+public:
+  struct Reply {
+    enum Kind { DATA, CLOSE, SILENT } kind;
+    std::string data;
+  };
+
+  std::deque<Reply> script;
+  std::string sent;          // todo lo escrito
+  uint32_t connects = 0;
+
+  int connect(const char *, uint16_t) override {
+    open_ = true;
+    connects++;
+    return 1;
+  }
+  size_t write(uint8_t c) override { return write(&c, 1); }
+  size_t write(const uint8_t *buf, size_t size) override {
+    if (!open_) return 0;
+    sent.append((const char *)buf, size);
+    asked_ = true;
+    return size;
+  }
+  int available() override {
+    answer();
+    return open_ ? (int)(in_.size() - pos_) : 0;
+  }
+  int read() override {
+    uint8_t c;
+    return read(&c, 1) == 1 ? c : -1;
+  }
+  int read(uint8_t *buf, size_t size) override {
+    answer();
+    size_t n = in_.size() - pos_ < size ? in_.size() - pos_ : size;
+    memcpy(buf, in_.data() + pos_, n);
+    pos_ += n;
+    return (int)n;
+  }
+  void stop() override { open_ = false; }
+  uint8_t connected() override {
+    answer();
+    return open_;
+  }
+  operator bool() override { return open_; }
+
+private:
+  // La respuesta sale recién cuando el cliente escribió la petición
+  void answer() {
+    if (!asked_ || !open_) return;
+    asked_ = false;
+    in_.clear();
+    pos_ = 0;
+    if (script.empty()) return;
+    Reply r = script.front();
+    script.pop_front();
+    if (r.kind == Reply::CLOSE) open_ = false;
+    else if (r.kind == Reply::DATA) in_ = r.data;
+  }
+
+  bool open_ = false;
+  bool asked_ = false;
+  std::string in_;
+  size_t pos_ = 0;
+};
+
+std::string http200(const std::string &body) {
+  return "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nContent-Length: " + std::to_string(body.size()) +
+         "\r\n\r\n" + body;
+}
+
+std::string update(long id, const std::string &message) {
+  return "{\"update_id\":" + std::to_string(id) + ",\"message\":" + message + "}";
+}
+
+int check(bool ok, const char *what) {
+  printf("  %s %s\n", ok ? "✓" : "✗", what);
+  return ok ? 0 : 1;
+}
+
+} // namespace
+
+int runClientBench() {
+  printf("\n== TelegramClient contra respuestas armadas (sin red) ==\n");
+  ScriptedClient net;
+  TelegramClient tg(net, "123:bench");
+  tg.setTimeout(200);
+  TelegramClient::Update u[4];
+  int fails = 0;
+
+  // Respuesta a un mensaje con "/reset" y foto con caption: sólo cuenta el
+  // texto del propio mensaje, nunca el del citado
+  std::string reply = "{\"message_id\":7,\"from\":{\"id\":1001},\"chat\":{\"id\":1001,\"type\":\"private\"},"
+                      "\"date\":1757000000,\"reply_to_message\":{\"message_id\":6,\"chat\":{\"id\":-555},"
+                      "\"text\":\"/reset\"},\"text\":\"/status\"}";
+  std::string photo = "{\"message_id\":8,\"chat\":{\"id\":1001,\"type\":\"private\"},\"date\":1757000001,"
+                      "\"reply_to_message\":{\"message_id\":6,\"chat\":{\"id\":-555},\"text\":\"/reset\"},"
+                      "\"photo\":[{\"file_id\":\"x\",\"width\":90}],\"caption\":\"/reset\"}";
+  net.script.push_back({ScriptedClient::Reply::DATA,
+                        http200("{\"ok\":true,\"result\":[" + update(10, reply) + "," + update(11, photo) + "]}")});
+  int n = tg.getUpdates(0, u, 4);
+  fails += check(n == 2 && u[0].id == 10 && strcmp(u[0].text, "/status") == 0 && strcmp(u[0].chatId, "1001") == 0,
+                 "respuesta a un mensaje: texto y chat del propio mensaje, no del citado");
+  fails += check(n == 2 && u[1].text[0] == '\0' && strcmp(u[1].chatId, "1001") == 0 && tg.lastUpdateId == 11,
+                 "foto con caption y mensaje citado: sin texto");
+
+  // Cuerpo más grande que TELEGRAM_RX_BUF: el update cortado queda para el
+  // próximo poll; si ni solo entra, se saltea
+  std::string longText(TELEGRAM_RX_BUF, 'a');
+  std::string big = "{\"message_id\":9,\"chat\":{\"id\":1001},\"date\":1757000002,\"text\":\"" + longText + "\"}";
+  std::string small = "{\"message_id\":10,\"chat\":{\"id\":1001},\"date\":1757000003,\"text\":\"/menu\"}";
+  net.script.push_back({ScriptedClient::Reply::DATA,
+                        http200("{\"ok\":true,\"result\":[" + update(12, small) + "," + update(13, big) + "]}")});
+  n = tg.getUpdates(0, u, 4);
+  fails += check(n == 1 && u[0].id == 12 && tg.lastUpdateId == 12,
+                 "update cortado al final del buffer: no se cuenta ni se confirma");
+  net.script.push_back({ScriptedClient::Reply::DATA,
+                        http200("{\"ok\":true,\"result\":[" + update(13, big) + "," + update(14, small) + "]}")});
+  n = tg.getUpdates(0, u, 4);
+  fails += check(n == 0 && tg.lastUpdateId == 13 && tg.stats().skippedUpdates == 1,
+                 "update que no entra solo en el buffer: se saltea y se cuenta");
+  net.script.push_back({ScriptedClient::Reply::DATA, http200("{\"ok\":true,\"result\":[" + update(14, small) + "]}")});
+  n = tg.getUpdates(0, u, 4);
+  fails += check(net.sent.find("offset=14&") != std::string::npos && n == 1 && u[0].id == 14,
+                 "el poll siguiente pide desde el 14");
+
+  // Conexión reusada que el servidor cerró sin contestar: se repite una vez.
+  // Timeout con la petición ya escrita: no (el mensaje pudo haber salido).
+  const std::string sentOk = http200("{\"ok\":true,\"result\":{\"message_id\":1}}");
+  size_t posts = 0;
+  for (size_t p = 0; (p = net.sent.find("POST ", p)) != std::string::npos; ++p) posts++;
+  uint32_t connects = net.connects;
+  net.script.push_back({ScriptedClient::Reply::CLOSE, ""});
+  net.script.push_back({ScriptedClient::Reply::DATA, sentOk});
+  TelegramClient::Result r = tg.sendMessage("1001", "hola");
+  fails += check(r.status == 200 && tg.stats().staleRetries == 1 && net.connects == connects + 1,
+                 "conexión ociosa cerrada (EOF antes del primer byte): se repite por una nueva");
+  net.script.push_back({ScriptedClient::Reply::SILENT, ""});
+  net.script.push_back({ScriptedClient::Reply::DATA, sentOk});
+  r = tg.sendMessage("1001", "hola");
+  size_t postsAfter = 0;
+  for (size_t p = 0; (p = net.sent.find("POST ", p)) != std::string::npos; ++p) postsAfter++;
+  fails += check(r.status == 0 && tg.stats().staleRetries == 1 && postsAfter == posts + 3,
+                 "timeout con la petición escrita: no se repite (sendMessage no se duplica)");
+  net.script.clear();
+  return fails;
+}
@@ -0,0 +1,11 @@
+// ======== TelegramClient contra respuestas armadas ========
+// Un Client falso contesta cada petición con lo que diga el guión (una
+// respuesta HTTP, o cerrar o callar antes del primer byte) y el cliente se
+// prueba sin red ni TLS: getUpdates con updates anidados (reply_to_message,
+// fotos con caption) y con un cuerpo más grande que TELEGRAM_RX_BUF, y
+// cuándo se repite una petición por una conexión reusada (cierre del
+// servidor sí, timeout no).
+#pragma once
+
+// Devuelve la cantidad de comprobaciones que fallaron
+int runClientBench();
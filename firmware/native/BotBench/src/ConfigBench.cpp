@@ -0,0 +1,90 @@
+#include "ConfigBench.h"
+
+#include <Arduino.h>
+#include <ConfigStore.h>
+#include <Preferences.h>
+
+#include <chrono>
+
+namespace {
+
+struct CfgV1 {
+  int32_t intervalMs;
+  uint8_t autoSend;
+  uint32_t resetCount;
+};
+
+// Misma config con un campo nuevo al final (firmware más nuevo)
+struct CfgV2 {
+  int32_t intervalMs;
+  uint8_t autoSend;
+  uint32_t resetCount;
+  int16_t tempOffsetCx10;
+};
+
+const CfgV1 kDefaults = {10000, 1, 0};
+
+// Lo que hace bootConfig() del firmware
+uint32_t boot() {
+  ConfigStore<CfgV1, 1> cfg("bench", kDefaults);
+  cfg.begin();
+  cfg.value().resetCount++;
+  cfg.touch(0);
+  cfg.flush();
+  return cfg.value().resetCount;
+}
+
+} // namespace
+
+void runConfigBench(int boots, int commands) {
+  using Clock = std::chrono::steady_clock;
+  Preferences prefs;
+  prefs.begin("bench");
+  prefs.clear();
+  prefs.end();
+
+  printf("\n== Config en NVS (ConfigStore, escritura diferida %u ms) ==\n", (unsigned)CONFIG_FLUSH_MS);
+  printf("%-40s %10s %14s %10s\n", "caso", "escrituras", "antes (SPIFFS)", "us/op");
+
+  uint32_t w0 = Preferences::nativeWrites;
+  Clock::time_point t0 = Clock::now();
+  uint32_t count = 0;
+  for (int i = 0; i < boots; ++i) count = boot();
+  double us = std::chrono::duration<double, std::micro>(Clock::now() - t0).count() / boots;
+  printf("%-40s %10u %14d %10.1f\n", "arranques seguidos", Preferences::nativeWrites - w0, boots, us);
+  if (count != (uint32_t)boots) printf("  ⚠️ contador de reinicios = %u (esperado %d)\n", count, boots);
+
+  // Ráfaga de /setInterval cada 200 ms y después silencio
+  ConfigStore<CfgV1, 1> cfg("bench", kDefaults);
+  cfg.begin();
+  w0 = Preferences::nativeWrites;
+  uint32_t now = 0;
+  for (int i = 0; i < commands; ++i, now += 200) {
+    cfg.value().intervalMs = (2 + i % 5) * 1000;
+    cfg.touch(now);
+    cfg.tick(now);
+  }
+  for (uint32_t end = now + CONFIG_FLUSH_MS + 1000; now < end; now += 100) cfg.tick(now);
+  printf("%-40s %10u %14d %10s\n", "ráfaga de comandos (200 ms entre sí)", Preferences::nativeWrites - w0, commands,
+         "-");
+
+  // El mismo valor una y otra vez no gasta flash
+  w0 = Preferences::nativeWrites;
+  for (int i = 0; i < commands; ++i) {
+    cfg.touch(now);
+    now += CONFIG_FLUSH_MS;
+    cfg.tick(now);
+  }
+  printf("%-40s %10u %14d %10s\n", "mismo valor repetido", Preferences::nativeWrites - w0, commands, "-");
+
+  // Firmware nuevo leyendo el registro viejo: conserva los valores, el campo
+  // nuevo queda con su default y se reescribe una sola vez
+  ConfigStore<CfgV2, 2> v2("bench", CfgV2{10000, 1, 0, -15});
+  bool loaded = v2.begin();
+  w0 = Preferences::nativeWrites;
+  v2.flush();
+  v2.flush();
+  printf("%-40s %10u %14s %10s\n", "migración v1 -> v2", Preferences::nativeWrites - w0, "-", "-");
+  printf("  v1 leída=%s reinicios=%u offset=%d escrituras de por vida=%u\n", loaded ? "sí" : "no",
+         (unsigned)v2.value().resetCount, v2.value().tempOffsetCx10, (unsigned)v2.stats().lifetime);
+}
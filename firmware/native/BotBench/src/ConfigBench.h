@@ -0,0 +1,8 @@
+// ======== Escrituras a flash de la config ========
+// Simula arranques seguidos y ráfagas de comandos sobre ConfigStore (con el
+// NVS en memoria del shim) y cuenta las escrituras. Como referencia, el
+// sketch anterior reescribía /config.json en SPIFFS una vez por arranque y
+// una por cada comando que tocaba la config.
+#pragma once
+
+void runConfigBench(int boots, int commands);
@@ -0,0 +1,133 @@
+#include "DhtBench.h"
+
+#include <Dht22Decoder.h>
+
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+
+namespace {
+
+// Trazas de la línea del DHT22 (duraciones en µs, niveles alternados a
+// partir del inicial). Las primeras arrancan con el HIGH de cuando la
+// placa suelta la línea.
+// El ejemplo de la hoja de datos: 65.2 %HR, 35.1 °C
+const uint16_t kDatasheet[] = {
+  31, 78, 81, 53, 23, 48, 29, 52, 23, 50, 27, 48, 27, 49, 23, 48, 70, 51, 23, 49, 67, 52, 26, 48,
+  29, 52, 23, 49, 72, 53, 71, 48, 27, 52, 26, 48, 24, 48, 27, 54, 24, 50, 26, 49, 27, 48, 27, 50,
+  27, 54, 72, 49, 23, 52, 71, 53, 24, 50, 67, 52, 72, 48, 71, 48, 71, 49, 70, 53, 71, 51, 73, 50,
+  70, 52, 26, 50, 69, 49, 73, 49, 72, 54, 24, 47
+};
+
+// -10.1 °C (bit de signo), 48.3 %HR
+const uint16_t kNegative[] = {
+  33, 79, 82, 51, 25, 53, 26, 50, 27, 48, 23, 52, 26, 49, 29, 50, 24, 51, 70, 48, 72, 48, 73, 52,
+  71, 54, 29, 50, 25, 53, 25, 52, 70, 52, 73, 51, 67, 54, 23, 50, 26, 53, 28, 48, 23, 53, 28, 50,
+  28, 52, 28, 54, 26, 50, 72, 51, 72, 50, 23, 51, 25, 49, 71, 48, 26, 48, 68, 54, 69, 49, 72, 49,
+  26, 51, 29, 51, 67, 49, 26, 51, 27, 50, 68, 53
+};
+
+// Sin el HIGH inicial (la interrupción se activó tarde): 21.8 °C, 40.2 %HR
+const uint16_t kNoRelease[] = {
+  80, 84, 52, 25, 53, 26, 50, 28, 51, 24, 49, 23, 49, 24, 49, 28, 49, 67, 51, 73, 52, 24, 50, 25,
+  48, 68, 51, 27, 50, 27, 52, 69, 49, 28, 54, 27, 52, 28, 53, 28, 48, 26, 54, 29, 54, 28, 54, 27,
+  51, 26, 51, 70, 48, 70, 53, 26, 48, 68, 48, 68, 51, 24, 48, 69, 52, 23, 48, 23, 52, 68, 52, 67,
+  50, 27, 48, 67, 54, 68, 52, 26, 49, 72, 49
+};
+
+// Flancos corridos hasta ±12 µs por latencia con WiFi: 26.3 °C, 71.1 %HR
+const uint16_t kWifiJitter[] = {
+  31, 87, 80, 54, 17, 42, 29, 53, 29, 54, 23, 41, 18, 42, 37, 49, 81, 47, 29, 61, 63, 55, 58, 45,
+  30, 50, 18, 61, 31, 39, 82, 55, 67, 59, 60, 61, 22, 55, 25, 44, 25, 63, 21, 56, 31, 63, 30, 49,
+  34, 46, 77, 63, 20, 46, 26, 62, 21, 45, 30, 54, 25, 62, 58, 39, 66, 54, 66, 45, 80, 58, 69, 53,
+  37, 50, 69, 41, 21, 42, 21, 54, 20, 49, 64, 53
+};
+
+// Pico de 3 µs dentro del LOW del bit 17: 24.0 °C, 56.0 %HR
+const uint16_t kGlitch[] = {
+  33, 81, 84, 48, 26, 53, 25, 54, 28, 48, 29, 53, 23, 51, 29, 53, 73, 49, 26, 49, 26, 54, 28, 50,
+  67, 54, 72, 51, 26, 51, 28, 48, 28, 49, 24, 49, 23, 24, 3, 22, 27, 51, 29, 53, 24, 52, 29, 52,
+  26, 53, 25, 49, 27, 52, 68, 48, 67, 54, 72, 53, 67, 52, 28, 49, 26, 54, 24, 54, 29, 49, 23, 50,
+  24, 50, 71, 49, 29, 52, 25, 50, 27, 51, 73, 49, 23, 52
+};
+
+// Se perdió la subida del bit 9: desde ahí los niveles quedan corridos
+const uint16_t kLostEdge[] = {
+  31, 80, 83, 52, 29, 52, 26, 54, 27, 49, 27, 49, 27, 52, 23, 54, 70, 54, 24, 52, 23, 83, 49, 68,
+  49, 70, 52, 28, 48, 27, 48, 25, 53, 27, 52, 27, 51, 29, 54, 23, 52, 23, 49, 24, 50, 23, 54, 23,
+  52, 26, 52, 67, 54, 67, 51, 69, 52, 71, 52, 27, 49, 28, 50, 26, 52, 27, 54, 26, 52, 24, 53, 71,
+  50, 27, 49, 29, 51, 24, 51, 67, 51, 26, 49
+};
+
+// Bit 21 cambiado por ruido
+const uint16_t kFlippedBit[] = {
+  29, 82, 79, 51, 23, 49, 28, 50, 29, 48, 29, 49, 28, 53, 28, 50, 68, 50, 24, 51, 24, 53, 23, 51,
+  70, 49, 72, 54, 24, 49, 28, 51, 27, 51, 25, 51, 24, 50, 25, 48, 28, 50, 23, 50, 27, 51, 70, 53,
+  23, 51, 25, 52, 71, 50, 71, 48, 67, 54, 68, 48, 23, 50, 25, 48, 29, 49, 25, 54, 24, 54, 26, 54,
+  72, 54, 25, 51, 24, 52, 27, 52, 70, 53, 25, 47
+};
+
+// El sensor dejó de contestar en el bit 25
+const uint16_t kCut[] = {
+  31, 77, 84, 53, 24, 51, 23, 50, 23, 53, 23, 54, 25, 48, 27, 54, 68, 48, 25, 54, 23, 51, 23, 50,
+  71, 51, 69, 52, 24, 48, 27, 53, 24, 48, 24, 50, 23, 49, 24, 50, 28, 50, 27, 54, 24, 50, 26, 52,
+  28, 49, 25, 50, 73
+};
+
+// Nadie contesta: la línea queda en HIGH
+const uint16_t kSilent[] = {2400};
+
+struct Trace {
+  const char *name;
+  const uint16_t *us;
+  size_t n;
+  uint8_t level0;
+  DhtError expect;
+  float t, h;
+};
+
+#define TRACE(arr, lvl, err, t, h) {#arr, arr, sizeof(arr) / sizeof(arr[0]), lvl, err, t, h}
+
+const Trace kTraces[] = {
+  TRACE(kDatasheet, 1, DhtError::OK, 35.1f, 65.2f),
+  TRACE(kNegative, 1, DhtError::OK, -10.1f, 48.3f),
+  TRACE(kNoRelease, 0, DhtError::OK, 21.8f, 40.2f),
+  TRACE(kWifiJitter, 1, DhtError::OK, 26.3f, 71.1f),
+  TRACE(kGlitch, 1, DhtError::OK, 24.0f, 56.0f),
+  TRACE(kLostEdge, 1, DhtError::BAD_PULSE, NAN, NAN),
+  TRACE(kFlippedBit, 1, DhtError::CHECKSUM, NAN, NAN),
+  TRACE(kCut, 1, DhtError::TRUNCATED, NAN, NAN),
+  TRACE(kSilent, 1, DhtError::NO_RESPONSE, NAN, NAN),
+};
+
+size_t toPulses(const Trace &tr, DhtPulse *out) {
+  for (size_t i = 0; i < tr.n; ++i) out[i] = DhtPulse{tr.us[i], (uint8_t)((tr.level0 + i) & 1)};
+  return tr.n;
+}
+
+bool same(float a, float b) { return (isnan(a) && isnan(b)) || fabsf(a - b) < 0.05f; }
+
+} // namespace
+
+int runDhtBench(int rounds) {
+  using Clock = std::chrono::steady_clock;
+  printf("\n== Decodificador DHT22 contra trazas grabadas ==\n");
+  printf("%-14s %-16s %-16s %8s %8s %8s\n", "traza", "esperado", "obtenido", "°C", "%HR", "ns");
+
+  int failures = 0;
+  DhtPulse pulses[128];
+  volatile float sink = 0;
+  for (const Trace &tr : kTraces) {
+    size_t n = toPulses(tr, pulses);
+    DhtFrame f = decodeDht22(pulses, n);
+    Clock::time_point t0 = Clock::now();
+    for (int i = 0; i < rounds; ++i) sink = sink + decodeDht22(pulses, n).bits;
+    double ns = std::chrono::duration<double, std::nano>(Clock::now() - t0).count() / rounds;
+
+    bool ok = f.err == tr.expect && same(f.t, tr.t) && same(f.h, tr.h);
+    if (!ok) failures++;
+    printf("%-14s %-16s %-16s %8.1f %8.1f %8.0f %s\n", tr.name + 1, dhtErrorName(tr.expect), dhtErrorName(f.err), f.t,
+           f.h, ns, ok ? "✓" : "✗");
+  }
+  return failures;
+}
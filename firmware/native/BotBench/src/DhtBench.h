@@ -0,0 +1,9 @@
+// ======== Decodificador del DHT22 contra trazas grabadas ========
+// Pasa por decodeDht22() tramas buenas (con y sin el flanco de cuando la
+// placa suelta la línea, temperatura negativa, jitter de interrupciones con
+// WiFi, un pico de ruido) y tramas rotas (flanco perdido, bit cambiado,
+// trama cortada, sensor mudo), compara contra lo esperado y mide cuánto
+// tarda decodificar cada una. Devuelve la cantidad de trazas que fallan.
+#pragma once
+
+int runDhtBench(int rounds);
@@ -0,0 +1,93 @@
+#include "DispatchBench.h"
+
+#include <Arduino.h>
+#include <CommandTable.h>
+
+#include <chrono>
+#include <vector>
+
+namespace {
+
+volatile long s_sink;  // que el compilador no descarte los handlers
+
+void noop(const char *, const CommandArgs &args) { s_sink += args.num + args.len; }
+
+// Mismos nombres y argumentos que la tabla del firmware
+const Command kBenchCommands[] = {
+  {"/menu", "", "", nullptr, ArgType::NONE, noop},
+  {"/DataSensores", "", "", "", ArgType::NONE, noop},
+  {"/APreset", "", "", "", ArgType::NONE, noop},
+  {"/setInterval", "", "[seg]", "", ArgType::INT, noop},
+  {"/setModo", "", "[auto|manual]", "", ArgType::WORD, noop},
+  {"/modo", "", "", "", ArgType::NONE, noop},
+  {"/status", "", "", "", ArgType::NONE, noop},
+  {"/reset", "", "", "", ArgType::NONE, noop},
+  {"/infoDevices", "", "", "", ArgType::NONE, noop},
+  {"/clearResetCount", "", "", "", ArgType::NONE, noop},
+};
+
+// La cadena anterior, con los mismos Strings y substring()
+void legacyDispatch(const char *chatId, const char *msgText) {
+  String text = msgText;
+  String chat_id = chatId;
+  if (text.length() == 0 || !text.startsWith("/")) {
+    s_sink += chat_id.length();
+    return;
+  }
+  if (text == "/menu") s_sink += 1;
+  else if (text == "/DataSensores") s_sink += 2;
+  else if (text.startsWith("/setInterval ")) {
+    String arg = text.substring(13);
+    s_sink += arg.toInt();
+  } else if (text.startsWith("/setModo ")) {
+    String arg = text.substring(9);
+    arg.toLowerCase();
+    s_sink += arg == "auto";
+  } else if (text == "/modo") s_sink += 3;
+  else if (text == "/APreset") s_sink += 4;
+  else if (text == "/status") s_sink += 5;
+  else if (text == "/reset") s_sink += 6;
+  else if (text == "/clearResetCount") s_sink += 7;
+  else if (text == "/infoDevices") s_sink += 8;
+  else s_sink += 9;
+}
+
+// Mezcla de lo que llega en una ráfaga: comandos frecuentes, con argumento,
+// desconocidos y texto suelto
+const char *const kMix[] = {
+  "/status", "/DataSensores", "/setInterval 30", "/menu", "/setModo Auto", "/infoDevices",
+  "/clearResetCount", "hola", "/foo", "/modo",
+};
+
+struct Result {
+  double nsPerUpdate;
+  double allocsPerUpdate;
+};
+
+template <typename F>
+Result measure(int updates, int rounds, F dispatch) {
+  size_t nMix = sizeof(kMix) / sizeof(kMix[0]);
+  uint64_t allocs0 = native::heap.allocs;
+  auto t0 = std::chrono::steady_clock::now();
+  for (int r = 0; r < rounds; ++r) {
+    for (int i = 0; i < updates; ++i) dispatch("1001", kMix[(size_t)i % nMix]);
+  }
+  double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count();
+  double n = (double)updates * rounds;
+  return Result{ns / n, (double)(native::heap.allocs - allocs0) / n};
+}
+
+} // namespace
+
+void runDispatchBench(int updates, int rounds) {
+  CommandTable table(kBenchCommands);
+  table.begin();
+  Result chain = measure(updates, rounds, legacyDispatch);
+  Result hashed = measure(updates, rounds, [&](const char *chat, const char *text) { table.dispatch(chat, text); });
+
+  printf("\n== Despacho de comandos (%d updates x %d rondas, handlers vacíos) ==\n", updates, rounds);
+  printf("%-28s %10s %12s\n", "", "ns/update", "allocs/upd");
+  printf("%-28s %10.1f %12.2f\n", "if/else con String", chain.nsPerUpdate, chain.allocsPerUpdate);
+  printf("%-28s %10.1f %12.2f\n", "CommandTable (hash perfecto)", hashed.nsPerUpdate, hashed.allocsPerUpdate);
+  printf("semilla del hash: %u\n", (unsigned)table.seed());
+}
@@ -0,0 +1,7 @@
+// ======== Costo del despacho de comandos ========
+// Compara la CommandTable (hash perfecto, argumentos sin copias) con la
+// cadena if/else de Strings que tenía handleNewMessages, con handlers
+// vacíos: mide sólo encontrar el comando y leer su argumento.
+#pragma once
+
+void runDispatchBench(int updates, int rounds);
@@ -0,0 +1,71 @@
+#include "FilterBench.h"
+
+#include <Arduino.h>
+#include <SensorFilter.h>
+
+#include <chrono>
+#include <math.h>
+#include <random>
+
+namespace {
+
+struct Err {
+  double sum2 = 0, max = 0;
+  int n = 0;
+  void add(double e) {
+    sum2 += e * e;
+    if (fabs(e) > max) max = fabs(e);
+    n++;
+  }
+  double rms() const { return n ? sqrt(sum2 / n) : 0; }
+};
+
+} // namespace
+
+void runFilterBench(int samples) {
+  using Clock = std::chrono::steady_clock;
+  std::mt19937 rng(42);
+  std::normal_distribution<float> noiseT(0.0f, 0.3f), noiseH(0.0f, 1.5f);
+  std::uniform_real_distribution<float> u(0.0f, 1.0f);
+
+  SensorFilter filter(DHT22_TEMP_LIMITS, DHT22_HUM_LIMITS, 10000);
+  Err rawT, rawH, outT, outH;
+  int stepAt = samples / 2, followedAt = -1;
+  double ns = 0;
+  uint64_t allocs0 = native::heap.allocs;
+
+  for (int i = 0; i < samples; ++i) {
+    float trueT = 22.0f + 2.0f * sinf(i / 300.0f) + (i >= stepAt ? 5.0f : 0.0f);
+    float trueH = 55.0f + 8.0f * cosf(i / 400.0f);
+    float t = trueT + noiseT(rng), h = trueH + noiseH(rng);
+    float r = u(rng);
+    if (r < 0.03f) t = h = NAN;                     // trama fallida
+    else if (r < 0.04f) t += u(rng) < 0.5f ? 12.0f : -12.0f;  // pico
+    else if (r < 0.05f) h = u(rng) < 0.5f ? 99.9f : 1.0f;
+
+    Clock::time_point t0 = Clock::now();
+    filter.push(t, h, (uint32_t)i * 2000);
+    FilteredReading out = filter.latest();
+    ns += std::chrono::duration<double, std::nano>(Clock::now() - t0).count();
+
+    if (!isnan(t)) {
+      rawT.add(t - trueT);
+      rawH.add(h - trueH);
+    }
+    if (i >= stepAt && followedAt < 0 && fabsf(out.t - trueT) < 0.5f) followedAt = i - stepAt;
+    // El tramo en que el filtro sigue al escalón no cuenta como error
+    if (i < stepAt || i >= stepAt + 10) {
+      outT.add(out.t - trueT);
+      outH.add(out.h - trueH);
+    }
+  }
+
+  const SensorFilter::Stats &st = filter.stats();
+  printf("\n== Filtro de lecturas (%d muestras: ruido, 3%% NaN, 2%% picos, escalón de +5 °C) ==\n", samples);
+  printf("%-10s %10s %10s %10s %10s\n", "", "RMS °C", "máx °C", "RMS %HR", "máx %HR");
+  printf("%-10s %10.2f %10.2f %10.2f %10.2f\n", "crudo", rawT.rms(), rawT.max, rawH.rms(), rawH.max);
+  printf("%-10s %10.2f %10.2f %10.2f %10.2f\n", "filtrado", outT.rms(), outT.max, outH.rms(), outH.max);
+  printf("aceptadas=%u inválidas=%u picos=%u escalones=%u, sigue el escalón en %d muestras, %.0f ns/muestra, "
+         "allocs=%llu\n", st.accepted, st.invalid, st.spikes, st.steps, followedAt, ns / samples,
+         (unsigned long long)(native::heap.allocs - allocs0));
+}
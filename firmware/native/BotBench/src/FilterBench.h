@@ -0,0 +1,8 @@
+// ======== Filtro de lecturas contra una señal con ruido ========
+// Alimenta SensorFilter con una temperatura/humedad conocida más ruido,
+// picos, NaN (tramas fallidas) y un cambio real de 5 °C a la mitad.
+// Compara el error de lo crudo y lo filtrado, cuenta picos descartados,
+// cuántas muestras tarda en seguir el cambio, ns y allocs por muestra.
+#pragma once
+
+void runFilterBench(int samples);
@@ -0,0 +1,64 @@
+#include "ProfileBench.h"
+
+#include <Arduino.h>
+#include <BlockProfiler.h>
+#include <TelegramOutbox.h>
+
+#include <chrono>
+
+namespace {
+
+enum Site : uint8_t { RED, SENSOR, NVS, SITES };
+const char *const kNames[SITES] = {"red", "sensor", "nvs"};
+BlockProfile s_rtc;  // en el firmware: RTC_NOINIT_ATTR
+
+int check(bool ok, const char *what) {
+  printf("  %s %s\n", ok ? "✓" : "✗", what);
+  return ok ? 0 : 1;
+}
+
+} // namespace
+
+int runProfileBench(int calls) {
+  using Clock = std::chrono::steady_clock;
+  BlockProfiler prof(s_rtc, kNames, SITES);
+  prof.begin(false);
+
+  printf("\n== Perfil de llamadas bloqueantes (BlockProfiler, %u bytes en RTC) ==\n", (unsigned)sizeof(s_rtc));
+  Clock::time_point t0 = Clock::now();
+  for (int i = 0; i < calls; ++i) {
+    BlockProfiler::Scope p(prof, SENSOR);
+  }
+  double ns = std::chrono::duration<double, std::nano>(Clock::now() - t0).count() / calls;
+  printf("costo de medir: %.0f ns por llamada (enter + leave)\n", ns);
+
+  // Arranque 1: algunas llamadas normales y una que se cuelga
+  uint32_t t = prof.enter(NVS);
+  delay(30);
+  prof.leave(NVS, t);
+  prof.enter(RED);                    // nunca vuelve: el watchdog reinicia
+  prof.beat(millis() + 6000);         // el último latido llegó 6 s después
+
+  // Arranque 2: reinicio por watchdog (la RAM RTC se conserva)
+  prof.begin(true);
+  int fails = 0;
+  uint8_t site = 0;
+  uint32_t ms = 0;
+  bool cut = prof.interrupted(site, ms);
+  fails += check(cut && site == RED && ms >= 6000 && ms < 6100, "watchdog: la llamada cortada es \"red\" (≥ 6 s)");
+  BlockCall worst;
+  fails += check(prof.worst(site, worst) && site == RED && worst.interrupted && worst.boot == 1,
+                 "la peor llamada es la cortada, del arranque 1");
+  fails += check(prof.site(SENSOR).count == (uint32_t)calls && prof.boots() == 2,
+                 "las cuentas del arranque anterior siguen");
+
+  char text[OUTBOX_TEXT];
+  size_t len = prof.report(text, sizeof(text));
+  printf("/profile (%zu de %u bytes):\n%s\n", len, (unsigned)sizeof(text), text);
+
+  // Encendido: la RAM RTC trae basura y no se confía en ella
+  prof.begin(false);
+  fails += check(!prof.interrupted(site, ms) && prof.boots() == 1 && prof.site(SENSOR).count == 0,
+                 "encendido: perfil vacío");
+  return fails;
+}
@@ -0,0 +1,9 @@
+// ======== Perfil de llamadas bloqueantes (BlockProfiler) ========
+// Mide el costo de medir (enter + leave por llamada) y simula lo que ve el
+// firmware tras un reinicio por watchdog: una llamada que nunca volvió queda
+// registrada como cortada, con su duración hasta el último latido. Después
+// un encendido (RAM RTC perdida) tiene que empezar de cero.
+#pragma once
+
+// Devuelve la cantidad de comprobaciones que fallaron
+int runProfileBench(int calls);
@@ -0,0 +1,177 @@
+#include "SleepBench.h"
+
+#include <Arduino.h>
+#include <SleepBatch.h>
+#include <TelegramOutbox.h>
+
+#include <chrono>
+
+namespace {
+
+// Modelo de costos (ms) y consumo (mA) de un ESP32 típico a 3,3 V
+const uint32_t kPeriodMs = 300000;   // una muestra cada 5 min
+const uint32_t kWakeMs = 40;         // setup() hasta tener la lectura del DHT22
+const uint32_t kWifiMs = 1800;       // asociación + DHCP con credenciales guardadas
+const uint32_t kTlsMs = 900;         // handshake completo (la sesión no sobrevive al sueño)
+const uint32_t kSendMs = 300;        // sendMessage
+const uint32_t kPollMs = 300;        // getUpdates sin espera
+const uint32_t kWifiTimeoutMs = 10000;
+const uint32_t kWindowMs = 20000;
+const double kSleepMa = 0.05, kAwakeMa = 40, kRadioMa = 120, kAlwaysOnMa = 80;
+const double kBatteryMah = 3000;     // una 18650
+
+SleepBatchRtc s_rtc;                 // en el firmware: RTC_DATA_ATTR
+
+struct Result {
+  uint32_t samples, delivered, pending, lost;
+  uint32_t windows, windowFails, messages;
+  uint32_t cadenceErrors;
+  size_t maxLen;
+  double radioMs, awakeMs, avgMa;
+};
+
+int check(bool ok, const char *what) {
+  printf("  %s %s\n", ok ? "✓" : "✗", what);
+  return ok ? 0 : 1;
+}
+
+// Lecturas "T/H" en las filas del mensaje (las que empiezan con la edad)
+uint32_t countReadings(const char *text) {
+  uint32_t n = 0;
+  bool row = false;
+  for (const char *p = text; *p; ++p) {
+    if (p == text || p[-1] == '\n') row = *p == '`';
+    if (row && *p == '/') n++;
+  }
+  return n;
+}
+
+// Un despertar por muestra durante `samples`; la red no anda en [outFrom, outTo)
+Result simulate(uint16_t every, uint32_t samples, uint32_t outFrom, uint32_t outTo, char *example) {
+  SleepBatch b(s_rtc);
+  Result res = {};
+  char text[OUTBOX_TEXT];
+  for (uint32_t i = 0; i < samples; ++i) {
+    b.begin(i > 0);
+    uint32_t now = kWakeMs;
+    b.push(i % 50 == 49 ? NAN : 20.0f + (i % 288) / 24.0f, 60.0f - (i % 288) / 12.0f, now);
+
+    if (b.radioDue()) {
+      uint32_t t0 = now;
+      bool ok = i < outFrom || i >= outTo;
+      if (!ok) {
+        now += kWifiTimeoutMs;
+      } else {
+        now += kWifiMs + kTlsMs;
+        while (b.pending() > 0 && now - t0 < kWindowMs) {
+          uint16_t taken;
+          size_t len = b.format(text, sizeof(text), kPeriodMs, now, taken);
+          if (len > res.maxLen) res.maxLen = len;
+          if (countReadings(text) != taken) res.cadenceErrors++;  // el texto no trae lo que dice
+          if (example && !example[0] && taken == every) memcpy(example, text, len + 1);
+          now += kSendMs;
+          b.sent(taken);
+          res.delivered += taken;
+        }
+        now += kPollMs;
+      }
+      b.radioDone(ok, every, now - t0);
+    }
+    uint32_t sleep = b.sleepMs(kPeriodMs, now);
+    if (sleep + now != kPeriodMs) res.cadenceErrors++;
+  }
+
+  const SleepBatchRtc &r = b.rtc();
+  res.samples = r.samples;
+  res.pending = r.count;
+  res.lost = r.lost;
+  res.windows = r.windows;
+  res.windowFails = r.windowFails;
+  res.messages = r.messages;
+  res.radioMs = (double)r.radioMs / r.samples;
+  res.awakeMs = (double)r.awakeMs / r.samples;
+  double radio = r.radioMs, awake = r.awakeMs - radio, asleep = (double)r.clockMs - r.awakeMs;
+  res.avgMa = (radio * kRadioMa + awake * kAwakeMa + asleep * kSleepMa) / r.clockMs;
+  return res;
+}
+
+void printRow(const char *name, const Result &r) {
+  printf("%-28s %8u %8u %6u %10.0f %10.0f %8.2f %9.0f\n", name, (unsigned)r.windows, (unsigned)r.messages,
+         (unsigned)r.lost, r.radioMs, r.awakeMs, r.avgMa, kBatteryMah / r.avgMa / 24);
+}
+
+} // namespace
+
+int runSleepBench(unsigned days) {
+  uint32_t samples = days * (86400000UL / kPeriodMs);
+  printf("\n== Modo lote con deep sleep (SleepBatch, %u bytes en RTC, %u días a %u s) ==\n", (unsigned)sizeof(s_rtc),
+         days, (unsigned)(kPeriodMs / 1000));
+  printf("%-28s %8s %8s %6s %10s %10s %8s %9s\n", "modo", "ventanas", "mensajes", "perd.", "radio ms/m",
+         "desp. ms/m", "mA prom", "días*");
+  printf("%-28s %8s %8s %6s %10u %10u %8.2f %9.0f\n", "siempre conectado", "-", "-", "-", (unsigned)kPeriodMs,
+         (unsigned)kPeriodMs, kAlwaysOnMa, kBatteryMah / kAlwaysOnMa / 24);
+
+  int fails = 0;
+  char example[OUTBOX_TEXT] = "";
+  Result r1 = simulate(1, samples, 0, 0, nullptr);
+  printRow("lote de 1 (radio cada vez)", r1);
+  Result r6 = simulate(6, samples, 0, 0, nullptr);
+  printRow("lote de 6", r6);
+  Result r12 = simulate(12, samples, 0, 0, example);
+  printRow("lote de 12", r12);
+  Result r24 = simulate(24, samples, 0, 0, nullptr);
+  printRow("lote de 24", r24);
+  // Corte de red de ~17 h a mitad de la corrida
+  uint32_t outFrom = samples / 2, outTo = outFrom + 200;
+  Result rc = simulate(12, samples, outFrom, outTo, nullptr);
+  printRow("lote de 12, corte de 17 h", rc);
+  printf("* autonomía con %.0f mAh: radio %.0f mA, despierto %.0f mA, deep sleep %.2f mA\n", kBatteryMah, kRadioMa,
+         kAwakeMa, kSleepMa);
+
+  const Result *all[] = {&r1, &r6, &r12, &r24, &rc};
+  bool accounted = true, cadence = true, fits = true;
+  for (const Result *r : all) {
+    accounted = accounted && r->delivered + r->pending + r->lost == r->samples;
+    cadence = cadence && r->cadenceErrors == 0;
+    fits = fits && r->maxLen < OUTBOX_TEXT;
+  }
+  fails += check(accounted, "cada muestra se envió, sigue pendiente o se contó como perdida");
+  fails += check(r1.lost == 0 && r12.lost == 0 && r24.lost == 0, "sin cortes no se pierde ninguna");
+  fails += check(cadence, "período exacto en cada despertar y mensajes con las lecturas que dicen");
+  fails += check(fits, "los mensajes entran en la cola de salida");
+  fails += check(r12.radioMs * 10 <= r1.radioMs, "lote de 12: radio por muestra ≥ 10× menor que con radio cada vez");
+  // Corte: 200 muestras, una ventana fallida cada 24, 48, 96, 96... muestras.
+  // Se pierde lo que pasa del anillo entre el último envío y el primero
+  // después del corte, que puede llegar hasta 8 lotes tarde.
+  uint32_t expectedLost = 200 + 12 + (12 << SLEEP_BATCH_MAX_BACKOFF) - SLEEP_BATCH_CAPACITY;
+  fails += check(rc.windowFails <= 4, "corte: la radio se reintenta con backoff, no en cada despertar");
+  fails += check(rc.lost > 0 && rc.lost <= expectedLost, "corte: sólo se pierde lo que no entra en el anillo hasta el reintento");
+
+  // RTC: encendido y registro de otra versión empiezan de cero
+  SleepBatch b(s_rtc);
+  b.begin(true);
+  b.push(21.0f, 50.0f, 10);
+  bool kept = b.pending() > 0;
+  b.begin(false);
+  bool cleared = b.pending() == 0 && b.rtc().wakes == 1 && b.radioDue();
+  b.push(21.0f, 50.0f, 10);
+  s_rtc.version++;
+  b.begin(true);
+  fails += check(kept && cleared && b.pending() == 0, "encendido o RTC inválida: lote vacío y radio en el primer despertar");
+
+  // Costo de un despertar sin radio (lo que corre en cada muestra)
+  using Clock = std::chrono::steady_clock;
+  const int wakes = 1000000;
+  b.clear();
+  Clock::time_point t0 = Clock::now();
+  for (int i = 0; i < wakes; ++i) {
+    b.begin(true);
+    b.push(21.0f, 50.0f, kWakeMs);
+    if (b.radioDue()) b.radioDone(true, 1000, 0);
+    b.sleepMs(kPeriodMs, kWakeMs);
+  }
+  printf("costo de SleepBatch por despertar: %.0f ns\n",
+         std::chrono::duration<double, std::nano>(Clock::now() - t0).count() / wakes);
+  printf("mensaje de un lote de 12 (%zu bytes):\n%s", strlen(example), example);
+  return fails;
+}
@@ -0,0 +1,13 @@
+// ======== Modo lote con deep sleep (SleepBatch) ========
+// Simula semanas de despertares con un reloj virtual: cada despertar lee,
+// guarda en el "RTC" y duerme; las ventanas de radio cuestan lo que dice el
+// modelo (WiFi con credenciales guardadas, handshake TLS, envíos). Reporta
+// radio prendida por muestra, corriente media y autonomía estimada contra
+// el firmware siempre conectado, y comprueba que no se pierdan muestras
+// (salvo las que no entran en el anillo durante un corte), que el período
+// se mantenga y que un corte de red no deje la radio prendida en cada
+// despertar.
+#pragma once
+
+// Devuelve la cantidad de comprobaciones que fallaron
+int runSleepBench(unsigned days);
@@ -0,0 +1,323 @@
+#include "TelegramStandIn.h"
+
+#include <chrono>
+#include <random>
+
+#include <string.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+
+#include <openssl/err.h>
+#include <openssl/pem.h>
+#include <openssl/ssl.h>
+#include <openssl/x509v3.h>
+
+namespace {
+
+uint64_t nowMs() {
+  return (uint64_t)std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+X509 *makeCert(EVP_PKEY *key, const char *cn, X509 *issuer, EVP_PKEY *issuerKey, bool ca) {
+  X509 *x = X509_new();
+  X509_set_version(x, 2);
+  ASN1_INTEGER_set(X509_get_serialNumber(x), ca ? 1 : 2);
+  X509_gmtime_adj(X509_getm_notBefore(x), -3600);
+  X509_gmtime_adj(X509_getm_notAfter(x), 30L * 86400);
+  X509_set_pubkey(x, key);
+  X509_NAME *name = X509_get_subject_name(x);
+  X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC, (const unsigned char *)cn, -1, -1, 0);
+  X509_set_issuer_name(x, issuer ? X509_get_subject_name(issuer) : name);
+  X509V3_CTX v3;
+  X509V3_set_ctx_nodb(&v3);
+  X509V3_set_ctx(&v3, issuer ? issuer : x, x, nullptr, nullptr, 0);
+  X509_EXTENSION *ext = ca ? X509V3_EXT_conf_nid(nullptr, &v3, NID_basic_constraints, "critical,CA:TRUE")
+                           : X509V3_EXT_conf_nid(nullptr, &v3, NID_subject_alt_name, "DNS:api.telegram.org");
+  X509_add_ext(x, ext, -1);
+  X509_EXTENSION_free(ext);
+  X509_sign(x, issuerKey ? issuerKey : key, EVP_sha256());
+  return x;
+}
+
+std::string jsonField(const std::string &body, const char *key) {
+  std::string k = std::string("\"") + key + "\":";
+  size_t p = body.find(k);
+  if (p == std::string::npos) return "";
+  p += k.size();
+  if (body[p] != '"') return body.substr(p, body.find_first_of(",}", p) - p);
+  std::string out;
+  for (++p; p < body.size() && body[p] != '"'; ++p) {
+    if (body[p] == '\\' && p + 1 < body.size()) {
+      char c = body[++p];
+      out += c == 'n' ? '\n' : c;
+    } else {
+      out += body[p];
+    }
+  }
+  return out;
+}
+
+// Como Telegram: todo lo que no es ASCII va como \uXXXX (pares sustitutos
+// para los emojis)
+std::string jsonEscape(const std::string &s) {
+  std::string out;
+  char esc[16];
+  for (size_t i = 0; i < s.size();) {
+    unsigned char c = (unsigned char)s[i];
+    if (c < 0x80) {
+      if (c == '"' || c == '\\') { out += '\\'; out += (char)c; }
+      else if (c == '\n') out += "\\n";
+      else out += (char)c;
+      ++i;
+      continue;
+    }
+    int extra = c >= 0xF0 ? 3 : c >= 0xE0 ? 2 : 1;
+    uint32_t cp = c & (0x3F >> extra);
+    for (int k = 1; k <= extra && i + k < s.size(); ++k) cp = (cp << 6) | ((unsigned char)s[i + k] & 0x3F);
+    i += (size_t)extra + 1;
+    if (cp >= 0x10000) {
+      cp -= 0x10000;
+      snprintf(esc, sizeof(esc), "\\u%04x\\u%04x", 0xD800 + (cp >> 10), 0xDC00 + (cp & 0x3FF));
+    } else {
+      snprintf(esc, sizeof(esc), "\\u%04x", cp);
+    }
+    out += esc;
+  }
+  return out;
+}
+
+long queryParam(const std::string &query, const char *name, long def) {
+  std::string k = std::string(name) + "=";
+  size_t p = query.find(k);
+  return p == std::string::npos ? def : strtol(query.c_str() + p + k.size(), nullptr, 10);
+}
+
+} // namespace
+
+bool TelegramStandIn::start(uint16_t port) {
+  EVP_PKEY *caKey = EVP_EC_gen("P-256");
+  EVP_PKEY *leafKey = EVP_EC_gen("P-256");
+  X509 *ca = makeCert(caKey, "Bench Root CA", nullptr, nullptr, true);
+  X509 *leaf = makeCert(leafKey, "api.telegram.org", ca, caKey, false);
+
+  BIO *bio = BIO_new(BIO_s_mem());
+  PEM_write_bio_X509(bio, ca);
+  char *pem;
+  long len = BIO_get_mem_data(bio, &pem);
+  certPem_.assign(pem, (size_t)len);
+  BIO_free(bio);
+
+  SSL_CTX *ctx = SSL_CTX_new(TLS_server_method());
+  SSL_CTX_use_certificate(ctx, leaf);
+  SSL_CTX_use_PrivateKey(ctx, leafKey);
+  ctx_ = ctx;
+  X509_free(ca);
+  X509_free(leaf);
+  EVP_PKEY_free(caKey);
+  EVP_PKEY_free(leafKey);
+
+  listenFd_ = socket(AF_INET, SOCK_STREAM, 0);
+  int one = 1;
+  setsockopt(listenFd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+  sockaddr_in addr = {};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  if (bind(listenFd_, (sockaddr *)&addr, sizeof(addr)) != 0 || listen(listenFd_, 16) != 0) {
+    close(listenFd_);
+    listenFd_ = -1;
+    return false;
+  }
+  stop_ = false;
+  acceptThread_ = std::thread(&TelegramStandIn::acceptLoop, this);
+  return true;
+}
+
+void TelegramStandIn::stop() {
+  if (listenFd_ < 0) return;
+  stop_ = true;
+  cv_.notify_all();
+  acceptThread_.join();
+  close(listenFd_);
+  listenFd_ = -1;
+}
+
+void TelegramStandIn::inject(const char *chatId, const char *text) {
+  std::lock_guard<std::mutex> lk(mu_);
+  updates_.push_back(Update{nextUpdateId_++, chatId, text});
+  cv_.notify_all();
+}
+
+TelegramStandIn::Stats TelegramStandIn::stats() {
+  std::lock_guard<std::mutex> lk(mu_);
+  return stats_;
+}
+
+void TelegramStandIn::acceptLoop() {
+  while (!stop_) {
+    pollfd p = {listenFd_, POLLIN, 0};
+    if (poll(&p, 1, 100) <= 0) continue;
+    int fd = accept(listenFd_, nullptr, nullptr);
+    if (fd < 0) continue;
+    {
+      std::lock_guard<std::mutex> lk(mu_);
+      stats_.connections++;
+    }
+    std::thread(&TelegramStandIn::serve, this, fd).detach();
+  }
+}
+
+// Una conexión: peticiones en keep-alive hasta que el cliente cierre
+void TelegramStandIn::serve(int fd) {
+  int one = 1;
+  setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+  timeval tv = {60, 0};  // para un cliente que deja una petición a medias
+  setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+  SSL *ssl = SSL_new((SSL_CTX *)ctx_);
+  SSL_set_fd(ssl, fd);
+  if (SSL_accept(ssl) == 1) {
+    {
+      std::lock_guard<std::mutex> lk(mu_);
+      stats_.handshakes++;
+      if (SSL_session_reused(ssl)) stats_.resumed++;
+    }
+    std::string in;
+    char buf[4096];
+    bool keepAlive = true;
+    while (keepAlive && !stop_) {
+      // Entre peticiones: esperar la próxima hasta idleCloseMs
+      if (in.empty() && SSL_pending(ssl) == 0) {
+        pollfd p = {fd, POLLIN, 0};
+        if (poll(&p, 1, (int)idleCloseMs.load()) == 0) {
+          std::lock_guard<std::mutex> lk(mu_);
+          stats_.idleClosed++;
+          break;
+        }
+      }
+      size_t end;
+      while ((end = in.find("\r\n\r\n")) == std::string::npos) {
+        int n = SSL_read(ssl, buf, sizeof(buf));
+        if (n <= 0) goto done;
+        in.append(buf, (size_t)n);
+      }
+      std::string head = in.substr(0, end + 2);
+      in.erase(0, end + 4);
+      std::string lower = head;
+      for (char &c : lower) c = (char)tolower(c);
+      size_t cl = lower.find("\r\ncontent-length:");
+      size_t want = cl == std::string::npos ? 0 : strtoul(head.c_str() + cl + 17, nullptr, 10);
+      while (in.size() < want) {
+        int n = SSL_read(ssl, buf, sizeof(buf));
+        if (n <= 0) goto done;
+        in.append(buf, (size_t)n);
+      }
+      std::string body = in.substr(0, want);
+      in.erase(0, want);
+      keepAlive = lower.find("\r\nconnection: close") == std::string::npos;
+
+      size_t sp1 = head.find(' '), sp2 = head.find(' ', sp1 + 1);
+      int status = 200;
+      std::string resp = handle(head.substr(0, sp1), head.substr(sp1 + 1, sp2 - sp1 - 1), body, status);
+      const char *reason = status == 200 ? "OK" : status == 429 ? "Too Many Requests" : status == 502 ? "Bad Gateway" : "Not Found";
+      char hdr[192];
+      int hn = snprintf(hdr, sizeof(hdr),
+                        "HTTP/1.1 %d %s\r\nServer: nginx\r\nContent-Type: application/json\r\n"
+                        "Content-Length: %zu\r\nConnection: %s\r\n\r\n",
+                        status, reason, resp.size(), keepAlive ? "keep-alive" : "close");
+      std::string out(hdr, (size_t)hn);
+      out += resp;
+      if (SSL_write(ssl, out.data(), (int)out.size()) <= 0) break;
+    }
+  done:
+    SSL_shutdown(ssl);
+  }
+  ERR_clear_error();
+  SSL_free(ssl);
+  close(fd);
+}
+
+std::string TelegramStandIn::handle(const std::string &method, const std::string &path, const std::string &body,
+                                    int &status) {
+  {
+    std::lock_guard<std::mutex> lk(mu_);
+    stats_.requests++;
+  }
+  unsigned lat = latencyMs;
+  if (lat) std::this_thread::sleep_for(std::chrono::milliseconds(lat));
+  size_t slash = path.find('/', 4);  // después de /bot<token>
+  std::string api = slash == std::string::npos ? "" : path.substr(slash + 1);
+  if (method == "POST" && api == "sendMessage") return sendMessage(body, status);
+  if (method == "GET" && api.compare(0, 10, "getUpdates") == 0) return getUpdates(api);
+  status = 404;
+  return "{\"ok\":false,\"error_code\":404,\"description\":\"Not Found\"}";
+}
+
+std::string TelegramStandIn::sendMessage(const std::string &body, int &status) {
+  static thread_local std::mt19937 rng(std::random_device{}());
+  std::string chatId = jsonField(body, "chat_id");
+  std::string text = jsonField(body, "text");
+  char out[160];
+  uint32_t messageId;
+  {
+    std::lock_guard<std::mutex> lk(mu_);
+    if (std::uniform_real_distribution<double>(0, 1)(rng) < errorRate.load()) {
+      stats_.errors++;
+      status = 502;
+      return "{\"ok\":false,\"error_code\":502,\"description\":\"Bad Gateway\"}";
+    }
+    bool group = !chatId.empty() && (chatId[0] == '@' || chatId[0] == '-');
+    uint64_t window = group ? 60000 : 1000;
+    size_t limit = group ? 20 : 1;
+    uint64_t now = nowMs();
+    std::deque<uint64_t> &sent = sentAt_[chatId];
+    while (!sent.empty() && now - sent.front() >= window) sent.pop_front();
+    if (sent.size() >= limit) {
+      unsigned retry = (unsigned)((sent.front() + window - now + 999) / 1000);
+      stats_.tooMany++;
+      status = 429;
+      snprintf(out, sizeof(out),
+               "{\"ok\":false,\"error_code\":429,\"description\":\"Too Many Requests: retry after %u\","
+               "\"parameters\":{\"retry_after\":%u}}", retry, retry);
+      return out;
+    }
+    sent.push_back(now);
+    messageId = ++stats_.delivered;
+  }
+  if (onMessage) onMessage(chatId, text);
+  snprintf(out, sizeof(out), "{\"ok\":true,\"result\":{\"message_id\":%u,\"date\":0,\"text\":\"...\"}}",
+           messageId);
+  return out;
+}
+
+std::string TelegramStandIn::getUpdates(const std::string &query) {
+  long offset = queryParam(query, "offset", 0);
+  long timeout = queryParam(query, "timeout", 0);
+  long limit = queryParam(query, "limit", 100);
+  std::unique_lock<std::mutex> lk(mu_);
+  stats_.polls++;
+  while (!updates_.empty() && updates_.front().id < offset) updates_.pop_front();  // confirmados
+  if (updates_.empty() && timeout > 0) {
+    cv_.wait_for(lk, std::chrono::seconds(timeout), [this]() { return !updates_.empty() || stop_; });
+  }
+  std::string out = "{\"ok\":true,\"result\":[";
+  long n = 0;
+  for (const Update &u : updates_) {
+    if (n == limit) break;
+    char head[320];
+    snprintf(head, sizeof(head),
+             "%s{\"update_id\":%ld,\"message\":{\"message_id\":%ld,\"from\":{\"id\":%s,\"is_bot\":false,"
+             "\"first_name\":\"Bench\"},\"chat\":{\"id\":%s,\"first_name\":\"Bench\",\"type\":\"private\"},"
+             "\"date\":1757000000,\"text\":\"",
+             n ? "," : "", u.id, u.id, u.chatId.c_str(), u.chatId.c_str());
+    out += head;
+    out += jsonEscape(u.text);
+    out += "\"}}";
+    n++;
+  }
+  return out + "]}";
+}
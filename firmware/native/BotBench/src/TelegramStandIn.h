@@ -0,0 +1,80 @@
+// ======== Servidor HTTPS local que imita api.telegram.org ========
+// Para probar el bot sin salir de la máquina: TLS real (certificado propio
+// generado al arrancar, CN=api.telegram.org), keep-alive, y las dos rutas
+// que usa el firmware:
+//   POST /bot<token>/sendMessage   aplica los límites de Telegram (1 msg/s
+//                                  por chat privado, 20/min en grupos y
+//                                  canales) y contesta 429 + retry_after
+//   GET  /bot<token>/getUpdates    long poll con offset/timeout/limit sobre
+//                                  los mensajes inyectados con inject()
+// latencyMs se suma a cada respuesta (ida y vuelta lenta) y errorRate
+// contesta 502 a esa fracción de los envíos. idleCloseMs cierra las
+// conexiones keep-alive ociosas (como hace el nginx de Telegram). Acepta
+// tickets de sesión TLS y cuenta los handshakes que retoman una sesión.
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class TelegramStandIn {
+public:
+  struct Stats {
+    uint32_t connections;
+    uint32_t handshakes;
+    uint32_t resumed;       // handshakes abreviados (sesión retomada)
+    uint32_t idleClosed;
+    uint32_t requests;
+    uint32_t delivered;     // sendMessage aceptados
+    uint32_t tooMany;       // 429 devueltos
+    uint32_t errors;        // 502 simulados
+    uint32_t polls;
+  };
+
+  ~TelegramStandIn() { stop(); }
+  bool start(uint16_t port);
+  void stop();
+
+  void inject(const char *chatId, const char *text);
+  Stats stats();
+  std::string certPem() const { return certPem_; }
+
+  std::atomic<unsigned> latencyMs{0};
+  std::atomic<double> errorRate{0.0};
+  std::atomic<unsigned> idleCloseMs{60000};
+  // Mensaje entregado (desde el hilo de la conexión)
+  std::function<void(const std::string &chatId, const std::string &text)> onMessage;
+
+private:
+  struct Update {
+    long id;
+    std::string chatId;
+    std::string text;
+  };
+
+  void acceptLoop();
+  void serve(int fd);
+  std::string handle(const std::string &method, const std::string &path, const std::string &body, int &status);
+  std::string sendMessage(const std::string &body, int &status);
+  std::string getUpdates(const std::string &query);
+
+  void *ctx_ = nullptr;  // SSL_CTX
+  std::string certPem_;
+  int listenFd_ = -1;
+  std::atomic<bool> stop_{false};
+  std::thread acceptThread_;
+
+  std::mutex mu_;
+  std::condition_variable cv_;
+  std::deque<Update> updates_;
+  long nextUpdateId_ = 1;
+  std::map<std::string, std::deque<uint64_t>> sentAt_;  // ms de los últimos envíos por chat
+  Stats stats_ = {};
+};
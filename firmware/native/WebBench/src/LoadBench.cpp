@@ -0,0 +1,247 @@
+#include "LoadBench.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include <string.h>
+#include <strings.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Shared {
+  uint16_t port;
+  std::atomic<bool> go{false};
+  std::atomic<bool> stop{false};
+  std::atomic<int> alive{0};
+};
+
+struct Client {
+  Shared *shared;
+  bool slow;
+  std::vector<uint32_t> latUs;  // reservado antes de arrancar: el hilo no usa heap
+  uint32_t errors = 0;
+  uint32_t connects = 0;
+  uint32_t requests = 0;
+};
+
+const char *const kUrls[] = {
+  "/", "/api/latest", "/app.js", "/api/history?date=2025-09-01", "/styles.css", "/api/latest",
+};
+
+int connectTo(uint16_t port, bool slow) {
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  if (fd < 0) return -1;
+  int one = 1;
+  setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+  if (slow) {
+    int rcv = 1024;  // ventana chica: el servidor no puede adelantar el envío
+    setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcv, sizeof(rcv));
+  }
+  timeval tv = {10, 0};
+  setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+  sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  if (connect(fd, (sockaddr *)&addr, sizeof(addr)) != 0) {
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+// Lee una respuesta entera (Content-Length o chunked). keepAlive queda en
+// false si el servidor pidió cerrar.
+bool readResponse(int fd, bool slow, bool &keepAlive) {
+  char buf[4096];
+  size_t len = 0;
+  char *body = nullptr;
+  while (!body) {
+    if (len >= sizeof(buf) - 1) return false;
+    ssize_t n = recv(fd, buf + len, sizeof(buf) - 1 - len, 0);
+    if (n <= 0) return false;
+    len += (size_t)n;
+    buf[len] = '\0';
+    char *end = strstr(buf, "\r\n\r\n");
+    if (end) body = end + 4;
+  }
+  keepAlive = strcasestr(buf, "\r\nConnection: close") == nullptr;
+  bool chunked = strcasestr(buf, "\r\nTransfer-Encoding: chunked") != nullptr;
+  const char *cl = strcasestr(buf, "\r\nContent-Length:");
+  size_t have = len - (size_t)(body - buf);
+
+  if (!chunked) {
+    size_t want = cl ? strtoul(cl + 17, nullptr, 10) : 0;
+    while (have < want) {
+      size_t chunk = slow ? 256 : sizeof(buf);
+      ssize_t n = recv(fd, buf, std::min(chunk, want - have), 0);
+      if (n <= 0) return false;
+      have += (size_t)n;
+      if (slow) usleep(10000);
+    }
+    return true;
+  }
+
+  // chunked: alcanza con ver el bloque final "\r\n0\r\n\r\n" (el cuerpo es JSON)
+  char tail[8] = {0};
+  auto feed = [&](const char *p, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+      memmove(tail, tail + 1, 6);
+      tail[6] = p[i];
+    }
+    return memcmp(tail, "\r\n0\r\n\r\n", 7) == 0;
+  };
+  if (feed(body, have)) return true;
+  for (;;) {
+    ssize_t n = recv(fd, buf, sizeof(buf), 0);
+    if (n <= 0) return false;
+    if (feed(buf, (size_t)n)) return true;
+  }
+}
+
+void clientMain(Client *c) {
+  Shared &s = *c->shared;
+  while (!s.go.load()) std::this_thread::yield();
+  int fd = -1;
+  unsigned i = 0;
+  char req[160];
+  while (!s.stop.load()) {
+    const char *url = c->slow ? "/app.js" : kUrls[i++ % (sizeof(kUrls) / sizeof(kUrls[0]))];
+    int n = snprintf(req, sizeof(req), "GET %s HTTP/1.1\r\nHost: bench\r\n%s\r\n", url,
+                     c->slow ? "" : "Accept-Encoding: gzip\r\n");
+    Clock::time_point t0 = Clock::now();
+    bool reused = fd >= 0;
+  retry:
+    if (fd < 0) {
+      fd = connectTo(s.port, c->slow);
+      c->connects++;
+      if (fd < 0) {
+        c->errors++;
+        usleep(1000);
+        continue;
+      }
+    }
+    bool keepAlive = false;
+    if (send(fd, req, (size_t)n, MSG_NOSIGNAL) != n || !readResponse(fd, c->slow, keepAlive)) {
+      close(fd);
+      fd = -1;
+      // Como un navegador: si el servidor cerró la keep-alive, un reintento
+      if (reused) {
+        reused = false;
+        goto retry;
+      }
+      c->errors++;
+      continue;
+    }
+    c->requests++;
+    uint32_t us = (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - t0).count();
+    if (c->latUs.size() < c->latUs.capacity()) c->latUs.push_back(us);
+    if (!keepAlive) {
+      close(fd);
+      fd = -1;
+    }
+  }
+  if (fd >= 0) close(fd);
+  s.alive--;
+}
+
+} // namespace
+
+LoadResult runLoad(uint16_t port, int clients, unsigned ms, bool slowClient, void (*serve)()) {
+  Shared shared;
+  shared.port = port;
+  int total = clients + (slowClient ? 1 : 0);
+  std::vector<Client> cs((size_t)total);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < total; ++i) {
+    cs[(size_t)i].shared = &shared;
+    cs[(size_t)i].slow = i >= clients;
+    cs[(size_t)i].latUs.reserve(1 << 18);
+  }
+  shared.alive = total;
+  for (int i = 0; i < total; ++i) threads.emplace_back(clientMain, &cs[(size_t)i]);
+
+  shared.go = true;
+  Clock::time_point t0 = Clock::now();
+  Clock::time_point deadline = t0 + std::chrono::milliseconds(ms);
+  while (Clock::now() < deadline) serve();
+  shared.stop = true;
+  Clock::time_point t1 = Clock::now();
+  // Seguir atendiendo hasta que los clientes terminen su última petición
+  while (shared.alive.load() > 0) serve();
+  for (std::thread &t : threads) t.join();
+
+  LoadResult r = {};
+  std::vector<uint32_t> all;
+  for (const Client &c : cs) {
+    r.errors += c.errors;
+    r.connects += c.connects;
+    if (c.slow) {
+      r.slowRequests += c.requests;
+      continue;
+    }
+    r.requests += c.requests;
+    all.insert(all.end(), c.latUs.begin(), c.latUs.end());
+  }
+  double secs = std::chrono::duration<double>(t1 - t0).count();
+  r.reqPerSec = r.requests / secs;
+  if (!all.empty()) {
+    std::sort(all.begin(), all.end());
+    r.p50Ms = all[all.size() / 2] / 1000.0;
+    r.p99Ms = all[std::min(all.size() - 1, all.size() * 99 / 100)] / 1000.0;
+    r.maxMs = all.back() / 1000.0;
+  }
+  return r;
+}
+
+bool StreamClients::start(uint16_t port, int n) {
+  stop();
+  stop_ = false;
+  static const char req[] = "GET /api/stream HTTP/1.1\r\nHost: bench\r\nAccept: text/event-stream\r\n\r\n";
+  for (n_ = 0; n_ < n && n_ < kMax; ++n_) {
+    int fd = connectTo(port, false);
+    if (fd < 0 || send(fd, req, sizeof(req) - 1, MSG_NOSIGNAL) != (ssize_t)(sizeof(req) - 1)) {
+      if (fd >= 0) close(fd);
+      stop();
+      return false;
+    }
+    fds_[n_] = fd;
+  }
+  thread_ = new std::thread([this]() {
+    pollfd pfds[kMax];
+    char buf[2048];
+    for (int i = 0; i < n_; ++i) pfds[i] = pollfd{fds_[i], POLLIN, 0};
+    while (!stop_) {
+      if (poll(pfds, (nfds_t)n_, 10) <= 0) continue;
+      for (int i = 0; i < n_; ++i) {
+        if (pfds[i].revents & POLLIN) recv(pfds[i].fd, buf, sizeof(buf), 0);
+      }
+    }
+  });
+  return true;
+}
+
+void StreamClients::stop() {
+  if (thread_) {
+    stop_ = true;
+    thread_->join();
+    delete thread_;
+    thread_ = nullptr;
+  }
+  for (int i = 0; i < n_; ++i) close(fds_[i]);
+  n_ = 0;
+}
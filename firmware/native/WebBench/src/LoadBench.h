@@ -0,0 +1,40 @@
+// ======== Prueba de carga concurrente sobre sockets reales ========
+// N hilos cliente piden una mezcla de rutas (/, estáticos, /api/latest,
+// /api/history) a 127.0.0.1:port reusando la conexión cuando el servidor
+// contesta keep-alive. Mientras tanto el hilo principal corre el loop() del
+// firmware, igual que en el ESP32. Opcionalmente agrega un cliente lento que
+// baja app.js de a poco (WiFi con mala señal).
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include <thread>
+
+struct LoadResult {
+  uint32_t requests;   // respuestas completas de los clientes normales
+  uint32_t errors;
+  uint32_t connects;
+  uint32_t slowRequests;
+  double reqPerSec;
+  double p50Ms;
+  double p99Ms;
+  double maxMs;
+};
+
+LoadResult runLoad(uint16_t port, int clients, unsigned ms, bool slowClient, void (*serve)());
+
+// Suscriptores reales de /api/stream: conectan, piden el stream y un hilo
+// aparte lee todo lo que llega (como n dashboards abiertos)
+class StreamClients {
+public:
+  ~StreamClients() { stop(); }
+  bool start(uint16_t port, int n);
+  void stop();
+
+private:
+  static const int kMax = 16;
+  int fds_[kMax];
+  int n_ = 0;
+  std::atomic<bool> stop_{false};
+  std::thread *thread_ = nullptr;
+};
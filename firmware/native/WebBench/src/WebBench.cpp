@@ -0,0 +1,626 @@
+// ======== Benchmark de rutas HTTP (env:native) ========
+// Corre setup() del firmware contra el shim, inyecta peticiones a cada ruta y
+// reporta ns/op, allocs/op (malloc/realloc/new), bytes de heap pedidos por
+// petición y bytes de respuesta. Uso:
+//   pio run -e native -t exec            (usa ./data como SPIFFS)
+//   .pio/build/native/program [dataDir] [msPorCaso]
+// dataDir se copia a un directorio temporal: el benchmark nunca modifica data/.
+// Al final corre la prueba de carga (LoadBench) sobre sockets reales contra el
+// servidor compilado: WebServer, o AsyncHttpServer con -D WEB_ASYNC=1.
+#include <Arduino.h>
+#include <HttpServer.h>
+#include <SPIFFS.h>
+#include <HistoryCache.h>
+#include <SampleStore.h>
+#include <StaticAssets.h>
+#include <EventStream.h>
+#include <HttpMetrics.h>
+#include <ESPmDNS.h>
+#include "LoadBench.h"
+
+#include <chrono>
+#include <filesystem>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Símbolos del firmware bajo prueba
+extern HttpServer server;
+extern HistoryCache historyCache;
+extern SampleStore store;
+extern StaticAssets assets;
+extern EventStream events;
+extern HttpMetrics metrics;
+void publishLatest();
+void setup();
+void loop();
+String contentType(const String &path);
+uint32_t hashDate(const String &s);
+float simTemp(float hour, uint32_t seed);
+float simHum(float hour, uint32_t seed);
+
+static volatile uint64_t s_sink;  // evita que el compilador elimine el trabajo medido
+static unsigned s_msPerCase = 300;
+static const uint16_t kLoadPort = 18080;
+
+struct Measurement {
+  double nsPerOp;
+  double allocsPerOp;
+  double heapBytesPerOp;
+  double fsOpensPerOp;  // SPIFFS.open() por operación
+  size_t peakBytes;  // high-water mark de heap sobre el inicio del caso
+};
+
+template <class F> static Measurement measure(F fn) {
+  using clock = std::chrono::steady_clock;
+  for (int i = 0; i < 50; ++i) fn();  // calentamiento
+
+  // Calibración: repetir hasta cubrir el tiempo pedido
+  uint64_t iters = 0;
+  uint64_t allocs0 = native::heap.allocs, bytes0 = native::heap.allocBytes;
+  uint32_t opens0 = SPIFFS.nativeOpens;
+  size_t base = native::heap.inUse;
+  native::resetHeapPeak();
+  auto t0 = clock::now();
+  auto deadline = t0 + std::chrono::milliseconds(s_msPerCase);
+  auto t1 = t0;
+  do {
+    for (int i = 0; i < 64; ++i) fn();
+    iters += 64;
+    t1 = clock::now();
+  } while (t1 < deadline);
+
+  Measurement s;
+  s.nsPerOp = std::chrono::duration<double, std::nano>(t1 - t0).count() / (double)iters;
+  s.allocsPerOp = (double)(native::heap.allocs - allocs0) / (double)iters;
+  s.heapBytesPerOp = (double)(native::heap.allocBytes - bytes0) / (double)iters;
+  s.fsOpensPerOp = (double)(SPIFFS.nativeOpens - opens0) / (double)iters;
+  s.peakBytes = native::heap.peak > base ? native::heap.peak - base : 0;
+  return s;
+}
+
+static void header(const char *title) {
+  printf("\n%s\n", title);
+  printf("%-34s %12s %10s %12s %10s %6s %10s %5s\n", "caso", "ns/op", "allocs/op", "heapB/op", "peakB", "fs/op",
+         "respB", "code");
+}
+
+#if !WEB_ASYNC
+static void benchRoute(const char *name, const char *url, const char *headers = nullptr) {
+  NativeResponse last;
+  Measurement s = measure([&]() { last = server.nativeRequest(HTTP_GET, url, headers); });
+  printf("%-34s %12.0f %10.1f %12.0f %10zu %6.1f %10zu %5d\n", name, s.nsPerOp, s.allocsPerOp, s.heapBytesPerOp,
+         s.peakBytes, s.fsOpensPerOp, last.bodyBytes + last.headerBytes, last.code);
+}
+#endif
+
+template <class F> static void benchFn(const char *name, F fn) {
+  Measurement s = measure(fn);
+  printf("%-34s %12.1f %10.1f %12.0f %10zu %6s %10s %5s\n", name, s.nsPerOp, s.allocsPerOp, s.heapBytesPerOp,
+         s.peakBytes, "-", "-", "-");
+}
+
+// Costo del envoltorio de HttpMetrics::timed() sobre un handler vacío
+static void benchTimed() {
+  static uint32_t bytes = 0;
+  HttpMetrics m([]() { return bytes; });
+  HttpServer::THandlerFunction plain = []() { s_sink++; };
+  HttpServer::THandlerFunction timed = m.timed("bench", plain);
+  benchFn("handler vacío (sin medir)", [&]() { plain(); });
+  benchFn("handler vacío (timed)", [&]() { timed(); });
+}
+
+// /api/metrics tal como lo vería Prometheus, sin las líneas de buckets
+static void printMetrics() {
+  std::string text;
+  char buf[256];
+  JsonWriter w(buf, sizeof(buf), [](void *ctx, const char *d, size_t n) { ((std::string *)ctx)->append(d, n); },
+               &text);
+  metrics.write(w);
+  w.flush();
+  std::istringstream in(text);
+  std::string line;
+  while (std::getline(in, line)) {
+    if (line[0] == '#' || line.find("_bucket{") != std::string::npos) continue;
+    printf("  %s\n", line.c_str());
+  }
+  printf("  (%zu bytes en total)\n", text.size());
+}
+
+#if !WEB_ASYNC
+// Recorre un rango de a `limit` filas siguiendo el cursor de cada respuesta;
+// devuelve las filas recibidas (deben ser todas, sin repetir)
+static uint32_t pageThrough(const char *range, unsigned limit, unsigned &pages, size_t &maxBody) {
+  std::string body;
+  server.nativeBodySink = [&](const char *d, size_t n) { body.append(d, n); };
+  uint32_t rows = 0;
+  char url[128];
+  std::string cursor;
+  pages = 0;
+  maxBody = 0;
+  for (;;) {
+    snprintf(url, sizeof(url), "/api/history?%s&limit=%u%s%s", range, limit, cursor.empty() ? "" : "&cursor=",
+             cursor.c_str());
+    body.clear();
+    if (server.nativeRequest(HTTP_GET, url).code != 200) break;
+    pages++;
+    if (body.size() > maxBody) maxBody = body.size();
+    const char *count = strstr(body.c_str(), "\"count\":");
+    const char *next = strstr(body.c_str(), "\"cursor\":");
+    if (!count || !next) break;
+    rows += (uint32_t)atoi(count + 8);
+    next += 9;
+    if (strncmp(next, "null", 4) == 0) break;
+    cursor.assign(next, strspn(next, "0123456789"));
+  }
+  server.nativeBodySink = nullptr;
+  return rows;
+}
+
+// Ruta con points=N sin pasar por el cache: mide la decimación (LTTB) y no
+// la copia de una respuesta ya armada
+static void benchDecimated(const char *name, const char *url) {
+  NativeResponse last;
+  Measurement s = measure([&]() {
+    historyCache.clear();
+    last = server.nativeRequest(HTTP_GET, url);
+  });
+  printf("%-34s %12.0f %10.1f %12.0f %10zu %6.1f %10zu %5d\n", name, s.nsPerOp, s.allocsPerOp, s.heapBytesPerOp,
+         s.peakBytes, s.fsOpensPerOp, last.bodyBytes + last.headerBytes, last.code);
+}
+
+// Filas y cursor de un rango pedido con points: deben ser points y null
+static bool checkDecimatedRange(const char *url, unsigned points) {
+  std::string body;
+  server.nativeBodySink = [&](const char *d, size_t n) { body.append(d, n); };
+  int code = server.nativeRequest(HTTP_GET, url).code;
+  server.nativeBodySink = nullptr;
+  const char *count = strstr(body.c_str(), "\"count\":");
+  const char *cursor = strstr(body.c_str(), "\"cursor\":null");
+  unsigned rows = count ? (unsigned)atoi(count + 8) : 0;
+  printf("rango 3 días con points=%u: %u filas, cursor %s %s\n", points, rows, cursor ? "null" : "presente",
+         code == 200 && rows == points && cursor ? "✓" : "✗");
+  return rows == points;
+}
+
+// Cuerpo de una respuesta y si salió del cache
+static std::string fetch(const char *url, bool *hit = nullptr) {
+  std::string body;
+  uint32_t hits = historyCache.stats().hits;
+  server.nativeBodySink = [&](const char *d, size_t n) { body.append(d, n); };
+  server.nativeRequest(HTTP_GET, url);
+  server.nativeBodySink = nullptr;
+  if (hit) *hit = historyCache.stats().hits > hits;
+  return body;
+}
+
+// Números de una columna del JSON ("key":[a,b,...]) en décimas
+static std::vector<long> jsonColumn(const std::string &body, const char *key) {
+  std::vector<long> out;
+  std::string k = std::string("\"") + key + "\":[";
+  size_t p = body.find(k);
+  if (p == std::string::npos) return out;
+  const char *c = body.c_str() + p + k.size();
+  while (*c && *c != ']') {
+    char *end;
+    double v = strtod(c, &end);
+    out.push_back(lround(v * 10.0));
+    c = *end == ',' ? end + 1 : end;
+  }
+  return out;
+}
+
+static uint32_t readVarint(const uint8_t *&p) {
+  uint32_t v = 0;
+  for (int shift = 0;; shift += 7) {
+    uint8_t b = *p++;
+    v |= (uint32_t)(b & 0x7f) << shift;
+    if (!(b & 0x80)) return v;
+  }
+}
+
+// El día crudo decimado en JSON (columnas) tiene que traer las mismas filas
+// que el binario (por filas) con el mismo points
+static bool checkDecimatedColumns(const char *date, unsigned points) {
+  char url[96];
+  historyCache.clear();
+  snprintf(url, sizeof(url), "/api/history?date=%s&points=%u", date, points);
+  std::string json = fetch(url);
+  snprintf(url, sizeof(url), "/api/history.bin?date=%s&points=%u", date, points);
+  std::string bin = fetch(url);
+
+  std::vector<long> ts = jsonColumn(json, "timestamps");
+  std::vector<long> temp = jsonColumn(json, "temperature");
+  std::vector<long> hum = jsonColumn(json, "humidity");
+  const uint8_t *p = (const uint8_t *)bin.data() + 5;
+  uint32_t n = readVarint(p);
+  uint32_t t = readVarint(p);
+  int32_t tv = 0, hv = 0;
+  bool same = ts.size() == n && temp.size() == n && hum.size() == n;
+  for (uint32_t i = 0; same && i < n; ++i) {
+    uint32_t d = readVarint(p);
+    t += (uint32_t)((d >> 1) ^ -(d & 1));
+    d = readVarint(p);
+    tv += (int32_t)((d >> 1) ^ -(d & 1));
+    d = readVarint(p);
+    hv += (int32_t)((d >> 1) ^ -(d & 1));
+    same = ts[i] == (long)t * 10000L && temp[i] == tv && labs(hum[i] - hv) <= 5;   // humedad sin decimales
+  }
+  printf("día crudo con points=%u: %zu timestamps, %zu temperaturas, %zu humedades, iguales al binario %s\n",
+         points, ts.size(), temp.size(), hum.size(), same && n == points ? "✓" : "✗");
+  return same;
+}
+
+// Un día guardado se cachea aunque no entre en el buffer de JsonResponse,
+// y la segunda vez sale igual del cache
+static bool checkStoredDayCached(const char *url) {
+  historyCache.clear();
+  bool hit1, hit2;
+  std::string a = fetch(url, &hit1), b = fetch(url, &hit2);
+  bool ok = !hit1 && hit2 && a == b && a.size() > JSON_STREAM_BUF_SIZE;
+  printf("cache de un día guardado (%zu B, %s): 2ª respuesta del cache e igual %s\n", a.size(), url + 13,
+         ok ? "✓" : "✗");
+  return ok;
+}
+
+// Un día que el log crudo ya pisó pero los rollups de hora y día conservan:
+// raw y minute salen simulados, hour y day del log (JSON y binario). Antes,
+// respuestas de 2025-09-02 cacheadas: las crudas dejan de valer cuando el
+// anillo pisa ese día, las de hour no.
+static bool checkRollupOnlyDay() {
+  historyCache.clear();
+  const char *raw02 = "/api/history?date=2025-09-02&points=200";
+  const char *hour02 = "/api/history?date=2025-09-02&resolution=hour";
+  bool primed = fetch(raw02).find("\"source\":\"store\"") != std::string::npos;
+  std::string hourBefore = fetch(hour02);
+
+  int32_t first = SampleStore::dayFromDate("2025-09-05");
+  for (int32_t d = 0; d < 8; ++d) {
+    uint32_t start = store.dayStart(first + d);
+    for (uint32_t m = 0; m < 1440; ++m) store.append(start + m * 60, 18.0f + (m % 120) * 0.05f, 60.0f);
+  }
+  store.flush();
+  bool rawHit, hourHit;
+  bool rawGone = fetch(raw02, &rawHit).find("\"source\":\"store\"") == std::string::npos;
+  bool hourSame = fetch(hour02, &hourHit) == hourBefore;
+  bool evictOk = primed && rawGone && !rawHit && hourSame && hourHit;
+  printf("2025-09-02 cacheado y pisado por el anillo: raw %s, hour %s %s\n", rawGone ? "simulado" : "viejo",
+         hourHit ? "del cache" : "rearmado", evictOk ? "✓" : "✗");
+
+  // Los días nuevos se agregaron sin recordSample (que invalida su fecha)
+  historyCache.clear();
+  std::string body;
+  server.nativeBodySink = [&](const char *d, size_t n) { body.append(d, n); };
+  static const struct { const char *res; bool stored; char binType; } cases[] = {
+      {"raw", false, 4}, {"minute", false, 4}, {"hour", true, RES_HOUR}, {"day", true, RES_DAY}};
+  bool ok = true;
+  printf("2025-09-05 (fuera del log crudo):");
+  for (const auto &c : cases) {
+    char url[80];
+    snprintf(url, sizeof(url), "/api/history?date=2025-09-05&resolution=%s", c.res);
+    body.clear();
+    server.nativeRequest(HTTP_GET, url);
+    bool stored = body.find("\"source\":\"store\"") != std::string::npos;
+    snprintf(url, sizeof(url), "/api/history.bin?date=2025-09-05&resolution=%s", c.res);
+    body.clear();
+    server.nativeRequest(HTTP_GET, url);
+    bool binOk = body.size() > 3 && body[3] == c.binType;
+    printf(" %s=%s", c.res, stored ? "log" : "simulado");
+    ok = ok && stored == c.stored && binOk;
+  }
+  server.nativeBodySink = nullptr;
+  printf(" %s\n", ok ? "✓" : "✗");
+  return ok && evictOk;
+}
+
+// Fechas imposibles y epochs fuera de 32 bits: 400, no un día vecino
+static bool checkDateValidation() {
+  static const struct { const char *url; int code; } cases[] = {
+      {"/api/history?date=2024-02-29", 200}, {"/api/history?date=2023-02-29", 400},
+      {"/api/history?date=2024-02-31", 400}, {"/api/history?date=2025-04-31", 400},
+      {"/api/history?date=2025-12-31", 200}, {"/api/history?from=4294967295&to=4294967295", 200},
+      {"/api/history?from=4294967296", 400}, {"/api/history?from=2025-09-02&to=9999999999", 400}};
+  bool ok = true;
+  for (const auto &c : cases) ok = ok && server.nativeRequest(HTTP_GET, c.url).code == c.code;
+  printf("fechas inválidas (31/02, 29/02 no bisiesto, epoch > 32 bits) -> 400 %s\n", ok ? "✓" : "✗");
+  return ok;
+}
+
+// Fechas rotando entre más días de los que entran en el cache: todo miss
+static void benchHistoryMiss() {
+  static char url[40];
+  unsigned day = 0;
+  NativeResponse last;
+  Measurement s = measure([&]() {
+    snprintf(url, sizeof(url), "/api/history?date=2025-%02u-%02u", 1 + (day / 28) % 12, 1 + day % 28);
+    day++;
+    last = server.nativeRequest(HTTP_GET, url);
+  });
+  printf("%-34s %12.0f %10.1f %12.0f %10zu %6.1f %10zu %5d\n", "GET /api/history (cache miss)", s.nsPerOp,
+         s.allocsPerOp, s.heapBytesPerOp, s.peakBytes, s.fsOpensPerOp, last.bodyBytes + last.headerBytes, last.code);
+}
+#endif
+
+// Retención de cada nivel: un año y medio al ritmo del firmware (1/min) en un
+// SampleStore aparte (su propia carpeta) y cuántos días se pueden pedir
+static void checkRetention() {
+  namespace stdfs = std::filesystem;
+  char tmpl[] = "/tmp/webbench-ret-XXXXXX";
+  const char *dir = mkdtemp(tmpl);
+  std::string prevRoot = SPIFFS.nativeRoot();
+  SPIFFS.nativeSetRoot(dir);
+  const int32_t days = 550;
+  const int32_t first = SampleStore::dayFromDate("2024-01-01");
+  {
+    SampleStore s(SPIFFS);
+    s.begin(-3 * 3600);
+    auto t0 = std::chrono::steady_clock::now();
+    for (int32_t d = 0; d < days; ++d) {
+      uint32_t start = s.dayStart(first + d);
+      for (uint32_t m = 0; m < 1440; ++m) s.append(start + m * 60, 20.0f + (m % 60) * 0.1f, 50.0f);
+    }
+    s.flush();
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    printf("\n== Retención (%d días a 1 muestra/min, %.0f ms) ==\n", days, ms);
+    struct Level { Resolution res; const char *name; uint32_t want; } levels[] = {
+        {RES_RAW, "raw", SAMPLE_STORE_CAPACITY / 1440},
+        {RES_MINUTE, "minute", SAMPLE_STORE_MINUTE_CAPACITY / 1440},
+        {RES_HOUR, "hour", SAMPLE_STORE_HOUR_CAPACITY / 24},
+        {RES_DAY, "day", SAMPLE_STORE_DAY_CAPACITY}};
+    for (const Level &l : levels) {
+      uint32_t reachable = 0;
+      for (int32_t d = 0; d < days; ++d) reachable += s.countRollupsInDay(l.res, first + d) > 0;
+      printf("%-8s %4u días con datos (capacidad: %u días completos) %s\n", l.name, reachable, l.want,
+             reachable >= l.want ? "✓" : "✗");
+    }
+  }
+  SPIFFS.nativeSetRoot(prevRoot.c_str());
+  stdfs::remove_all(dir);
+}
+
+// Corte de luz entre los registros y la cabecera con el anillo crudo ya
+// lleno: el lote pisa las 16 muestras más viejas del primer día. Al reabrir
+// ese día tiene que tener 16 menos, y todas suyas.
+static void checkTornFlush() {
+  namespace stdfs = std::filesystem;
+  char tmpl[] = "/tmp/webbench-torn-XXXXXX";
+  const char *dir = mkdtemp(tmpl);
+  std::string prevRoot = SPIFFS.nativeRoot();
+  SPIFFS.nativeSetRoot(dir);
+  const int32_t first = SampleStore::dayFromDate("2024-03-01");
+  size_t before;
+  {
+    SampleStore s(SPIFFS);
+    s.begin(-3 * 3600);
+    for (int32_t d = 0; d < 6; ++d) {
+      for (uint32_t m = 0; m < 1440; ++m) s.append(s.dayStart(first + d) + m * 60, 20.0f, 50.0f);
+    }
+    s.flush();
+    before = s.countInDay(first);
+    uint32_t start = s.dayStart(first + 6);
+    for (uint32_t m = 0; m + 1 < SAMPLE_STORE_BATCH; ++m) s.append(start + m * 60, 21.0f, 51.0f);
+    SPIFFS.nativeWritesLeft = 1;   // entra el lote, la cabecera no
+    s.append(start + (SAMPLE_STORE_BATCH - 1) * 60, 21.0f, 51.0f);
+    SPIFFS.nativeWritesLeft = -1;
+  }
+  SampleStore s(SPIFFS);
+  s.begin(-3 * 3600);
+  struct Ctx { const SampleStore *s; int32_t day; size_t n, foreign; } c = {&s, first, 0, 0};
+  s.forEachInDay(first, [](void *p, const Sample &x) {
+    Ctx *c = (Ctx *)p;
+    c->n++;
+    c->foreign += c->s->dayOf(x.ts) != c->day;
+  }, &c);
+  bool ok = c.n + SAMPLE_STORE_BATCH == before && c.foreign == 0 && s.countInDay(first) == c.n;
+  printf("\n== Corte de luz a mitad de un flush (anillo lleno) ==\n");
+  printf("día más viejo: %zu muestras antes, %zu después, %zu de otro día %s\n", before, c.n, c.foreign,
+         ok ? "✓" : "✗");
+  SPIFFS.nativeSetRoot(prevRoot.c_str());
+  stdfs::remove_all(dir);
+}
+
+// Reinicio a mitad del día (dos veces seguidas, como un watchdog en bucle):
+// los buckets en curso se rearman con el log crudo y el rollup diario y los
+// horarios tienen que seguir cuadrando con las muestras crudas
+static void checkReopenMidDay() {
+  namespace stdfs = std::filesystem;
+  char tmpl[] = "/tmp/webbench-reopen-XXXXXX";
+  const char *dir = mkdtemp(tmpl);
+  std::string prevRoot = SPIFFS.nativeRoot();
+  SPIFFS.nativeSetRoot(dir);
+  const int32_t day = SampleStore::dayFromDate("2024-05-01");
+  auto temp = [](uint32_t m) { return m == 5 ? 10.0f : m == 1190 ? 30.0f : 20.0f + (m % 7) * 0.1f; };
+  uint32_t start;
+  {
+    SampleStore s(SPIFFS);
+    s.begin(-3 * 3600);
+    start = s.dayStart(day);
+    for (uint32_t m = 0; m < 1200; ++m) s.append(start + m * 60, temp(m), 50.0f);
+    s.flush();
+  }
+  { SampleStore s(SPIFFS); s.begin(-3 * 3600); }
+  SampleStore s(SPIFFS);
+  s.begin(-3 * 3600);
+  for (uint32_t m = 1200; m < 1260; ++m) s.append(start + m * 60, temp(m), 50.0f);
+
+  struct Raw { size_t n; float tMin, tMax; } raw = {0, 1e9f, -1e9f};
+  s.forEachInDay(day, [](void *p, const Sample &x) {
+    Raw *r = (Raw *)p;
+    r->n++;
+    if (x.temperature < r->tMin) r->tMin = x.temperature;
+    if (x.temperature > r->tMax) r->tMax = x.temperature;
+  }, &raw);
+  Rollup d = {};
+  s.forEachRollupInDay(RES_DAY, day, [](void *p, const Rollup &r) { *(Rollup *)p = r; }, &d);
+  struct Hours { size_t buckets; uint32_t count; float tMax; } h = {0, 0, -1e9f};
+  s.forEachRollupInDay(RES_HOUR, day, [](void *p, const Rollup &r) {
+    Hours *h = (Hours *)p;
+    h->buckets++;
+    h->count += r.count;
+    if (r.tMax > h->tMax) h->tMax = r.tMax;
+  }, &h);
+  bool ok = raw.n == 1260 && d.count == raw.n && d.tMin == raw.tMin && d.tMax == raw.tMax &&
+            s.countRollupsInDay(RES_DAY, day) == 1 && h.buckets == 21 && h.count == raw.n && h.tMax == raw.tMax;
+  printf("\n== Reinicio a mitad del día (20 h, dos reaperturas, 1 h más) ==\n");
+  printf("crudo %zu muestras [%.1f, %.1f]; day count=%u [%.1f, %.1f]; hour %zu buckets, %u muestras %s\n", raw.n,
+         raw.tMin, raw.tMax, d.count, d.tMin, d.tMax, h.buckets, h.count, ok ? "✓" : "✗");
+  SPIFFS.nativeSetRoot(prevRoot.c_str());
+  stdfs::remove_all(dir);
+}
+
+int main(int argc, char **argv) {
+  namespace stdfs = std::filesystem;
+  const char *dataDir = argc > 1 ? argv[1] : "data";
+  if (argc > 2) s_msPerCase = (unsigned)atoi(argv[2]);
+  char tmpl[] = "/tmp/webbench-XXXXXX";
+  const char *spiffsDir = mkdtemp(tmpl);
+  stdfs::copy(dataDir, spiffsDir, stdfs::copy_options::recursive);
+  SPIFFS.nativeSetRoot(spiffsDir);
+
+  setup();
+
+  // Lo que anunciaría la placa por mDNS (el colector de tools/collector lo lee)
+  for (const MDNSResponder::Service &sv : MDNS.nativeServices()) {
+    printf("mDNS: %s.local _%s._%s:%u", MDNS.nativeHostname().c_str(), sv.service.c_str(), sv.proto.c_str(), sv.port);
+    for (const auto &kv : sv.txt) printf(" %s=%s", kv.first.c_str(), kv.second.c_str());
+    printf("\n");
+  }
+
+  // Un día completo de muestras reales (1/min) en el log
+  int32_t storedDay = SampleStore::dayFromDate("2025-09-02");
+  for (uint32_t i = 0; i < 1440; ++i) store.append(store.dayStart(storedDay) + i * 60, 20.0f + (i % 100) * 0.1f, 50.0f);
+  // Y dos días más cada 5 min, para las consultas por rango
+  for (uint32_t i = 0; i < 2 * 288; ++i) store.append(store.dayStart(storedDay + 1) + i * 300, 22.0f, 55.0f);
+  store.flush();
+
+#if !WEB_ASYNC
+  header("== Rutas HTTP ==");
+  benchRoute("GET /", "/");
+  benchRoute("GET /styles.css", "/styles.css");
+  benchRoute("GET /app.js", "/app.js");
+  benchRoute("GET /app.js (gzip)", "/app.js", "Accept-Encoding: gzip, deflate");
+  server.nativeRequest(HTTP_GET, "/app.js", "Accept-Encoding: gzip");
+  static char revalidate[96];
+  snprintf(revalidate, sizeof(revalidate), "Accept-Encoding: gzip\nIf-None-Match: %s",
+           server.nativeResponseHeader("ETag").c_str());
+  benchRoute("GET /app.js (304)", "/app.js", revalidate);
+  benchRoute("GET /api/latest", "/api/latest");
+  benchRoute("GET /api/history (cache hit)", "/api/history?date=2025-09-01");
+  benchHistoryMiss();
+  benchRoute("GET /api/history (log, 1440 m.)", "/api/history?date=2025-09-02");
+  benchRoute("GET /api/history.bin (log, 1440 m.)", "/api/history.bin?date=2025-09-02");
+  benchRoute("GET /api/history (log, minute)", "/api/history?date=2025-09-02&resolution=minute");
+  benchRoute("GET /api/history (log, hour)", "/api/history?date=2025-09-02&resolution=hour");
+  benchRoute("GET /api/history (log, day)", "/api/history?date=2025-09-02&resolution=day");
+  benchRoute("GET /api/history (400)", "/api/history");
+  benchRoute("GET /no-existe (404)", "/no-existe");
+  benchRoute("GET /api/history (3 días, raw)", "/api/history?from=2025-09-02&to=2025-09-04");
+  benchRoute("GET /api/history (3 días, limit=500)", "/api/history?from=2025-09-02&to=2025-09-04&limit=500");
+  benchRoute("GET /api/history (3 días, hour)", "/api/history?from=2025-09-02&to=2025-09-04&resolution=hour");
+  benchDecimated("GET /api/history (points=200)", "/api/history?date=2025-09-02&points=200");
+  benchDecimated("GET /api/history.bin (points=200)", "/api/history.bin?date=2025-09-02&points=200");
+  benchDecimated("GET /api/history (3 días, pts=300)", "/api/history?from=2025-09-02&to=2025-09-04&points=300");
+  benchRoute("GET /api/history (points=2, 400)", "/api/history?date=2025-09-02&points=2");
+  benchRoute("GET /api/metrics", "/api/metrics");
+
+  unsigned pages;
+  size_t maxBody;
+  uint32_t expected = store.countInDay(storedDay) + store.countInDay(storedDay + 1) + store.countInDay(storedDay + 2);
+  uint32_t got = pageThrough("from=2025-09-02&to=2025-09-04", 500, pages, maxBody);
+  printf("rango 3 días de a 500 filas: %u/%u filas en %u páginas (máx %zu B por página) %s\n", got, expected, pages,
+         maxBody, got == expected ? "✓" : "✗");
+  checkDecimatedRange("/api/history?from=2025-09-02&to=2025-09-04&points=300", 300);
+  checkDecimatedColumns("2025-09-02", 200);
+  checkStoredDayCached("/api/history?date=2025-09-02&resolution=hour");
+  checkStoredDayCached("/api/history?date=2025-09-02&points=200");
+  checkRollupOnlyDay();
+  checkDateValidation();
+#else
+  printf("\n(WEB_ASYNC: las rutas se miden en la prueba de carga)\n");
+#endif
+
+  header("== Helpers ==");
+  const String date("2025-09-01");
+  const String path("/app.js");
+  benchFn("hashDate", [&]() { s_sink += hashDate(date); });
+  benchFn("simTemp", [&]() { s_sink += (uint64_t)simTemp(13.0f, 1234u); });
+  benchFn("simHum", [&]() { s_sink += (uint64_t)simHum(13.0f, 1234u); });
+  benchFn("contentType", [&]() { s_sink += contentType(path).length(); });
+  benchTimed();
+
+  const HistoryCache::Stats &cs = historyCache.stats();
+  printf("\n== Cache /api/history ==\n");
+  printf("hits=%u misses=%u inserts=%u evictions=%u rejected=%u bytes=%zu/%zu entradas=%u\n", cs.hits,
+         cs.misses, cs.inserts, cs.evictions, cs.rejected, historyCache.bytesUsed(), historyCache.capacity(),
+         historyCache.count());
+
+  const SampleStore::Stats &ss = store.stats();
+  printf("\n== Log de muestras ==\n");
+  printf("muestras=%u flushes=%u registros=%u bytesEscritos=%u errores=%u lecturas=%u bytesLeídos=%u msLectura=%.1f\n",
+         ss.appended, ss.flushes, ss.recordsWritten, ss.bytesWritten, ss.writeErrors, ss.fsReads, ss.bytesRead,
+         ss.readUs / 1000.0);
+
+  checkRetention();
+  checkTornFlush();
+  checkReopenMidDay();
+
+  const StaticAssets::Stats &as = assets.stats();
+  printf("\n== Archivos estáticos ==\n");
+  printf("servidos=%u gzip=%u embebidos=%u 304=%u hasheados=%u bytes=%u aperturasFS=%u msFS=%.1f\n", as.served,
+         as.servedGzip, as.servedEmbedded, as.notModified, as.hashed, as.bytes, as.fsOpens, as.fsUs / 1000.0);
+
+  printf("\n== Carga concurrente (%s, 127.0.0.1:%u, %u ms por caso) ==\n",
+         WEB_ASYNC ? "AsyncHttpServer" : "WebServer", kLoadPort, s_msPerCase * 4);
+  printf("%-18s %10s %9s %9s %9s %8s %10s %8s\n", "clientes", "req/s", "p50 ms", "p99 ms", "max ms", "errores",
+         "conexiones", "lento");
+  server.close();
+  server.begin(kLoadPort);
+  static const struct { int clients; bool slow; } loads[] = {{8, false}, {16, false}, {8, true}, {16, true}};
+  for (const auto &l : loads) {
+    LoadResult r = runLoad(kLoadPort, l.clients, s_msPerCase * 4, l.slow, loop);
+    char name[24];
+    snprintf(name, sizeof(name), "%d%s", l.clients, l.slow ? " + 1 lento" : "");
+    printf("%-18s %10.0f %9.2f %9.2f %9.2f %8u %10u %8u\n", name, r.reqPerSec, r.p50Ms, r.p99Ms, r.maxMs, r.errors,
+           r.connects, r.slowRequests);
+  }
+#if WEB_ASYNC
+  const AsyncHttpServer::Stats &hs = server.stats();
+  printf("aceptadas=%u peticiones=%u reusadas=%u desalojadas=%u timeouts=%u esperasEscritura=%u picoConexiones=%u\n",
+         hs.accepted, hs.requests, hs.reused, hs.evicted, hs.timeouts, hs.writeWaits, hs.peakActive);
+#endif
+
+  // Costo de una lectura en vivo con N dashboards: un evento para todos
+  // contra N polls (éstos sin contar la petición, TCP ni el parseo)
+  const int subs = EVENT_STREAM_MAX_SUBS;
+  StreamClients streamClients;
+  if (streamClients.start(kLoadPort, subs)) {
+    unsigned long t0 = millis();
+    while (events.count() < subs && millis() - t0 < 2000) loop();
+    char name[40];
+    header("== /api/stream ==");
+    EventStream::Stats e0 = events.stats();
+    Measurement s = measure(publishLatest);
+    EventStream::Stats e1 = events.stats();
+    snprintf(name, sizeof(name), "publish (%u suscriptores)", events.count());
+    printf("%-34s %12.0f %10.1f %12.0f %10zu %6.1f %10u %5s\n", name, s.nsPerOp, s.allocsPerOp, s.heapBytesPerOp,
+           s.peakBytes, s.fsOpensPerOp, (e1.bytes - e0.bytes) / (e1.events - e0.events), "-");
+#if !WEB_ASYNC
+    NativeResponse last;
+    s = measure([&]() { for (int i = 0; i < subs; ++i) last = server.nativeRequest(HTTP_GET, "/api/latest"); });
+    snprintf(name, sizeof(name), "GET /api/latest x%d (polling)", subs);
+    printf("%-34s %12.0f %10.1f %12.0f %10zu %6.1f %10zu %5d\n", name, s.nsPerOp, s.allocsPerOp, s.heapBytesPerOp,
+           s.peakBytes, s.fsOpensPerOp, subs * (last.bodyBytes + last.headerBytes), last.code);
+#endif
+    const EventStream::Stats &es = events.stats();
+    printf("suscriptos=%u rechazados=%u eventos=%u entregados=%u reemplazados=%u salteados=%u cortados=%u\n",
+           es.subscribed, es.rejected, es.events, es.sent, es.coalesced, es.skipped, es.dropped);
+    streamClients.stop();
+  }
+  server.close();
+
+  printf("\n== /api/metrics (rutas, carga incluida) ==\n");
+  printMetrics();
+
+  stdfs::remove_all(spiffsDir);
+  return 0;
+}
@@ -0,0 +1,297 @@
+// ======== Benchmark del colector contra una flota local ========
+// Levanta FleetStandIn (placas en 127.0.0.1 + responder mDNS) y:
+//  1. descubre la flota por mDNS (una placa de cada 10 contesta sólo el
+//     PTR, más un servidor HTTP ajeno que hay que ignorar);
+//  2. corre el colector unas rondas con placas keep-alive, con
+//     Connection: close, colgadas y que rechazan la conexión; por ronda
+//     reporta cuándo terminó la última placa sana (okMs) contra el plazo
+//     por petición: las colgadas no deben demorar a las demás;
+//  3. compara una ronda concurrente contra una secuencial (-c 1);
+//  4. cierra las keep-alive ociosas más rápido que el intervalo y verifica
+//     que el colector reconecta sin errores;
+//  5. lee el archivo columnar: todas las placas registradas, historial sin
+//     huecos ni duplicados por placa, valores iguales a los servidos, y
+//     recuperación de un bloque cortado al final.
+// Uso: fleetbench [placas] [rondas]
+#include "Collector.h"
+#include "ColumnFile.h"
+#include "FleetStandIn.h"
+#include "Mdns.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <strings.h>
+#include <sys/resource.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+const uint16_t kBasePort = 19000;
+const uint16_t kMdnsPort = 15353;
+const uint32_t kTimeoutMs = 500;
+
+int check(bool ok, const char *what) {
+  printf("  %s %s\n", ok ? "✓" : "✗", what);
+  return ok ? 0 : 1;
+}
+
+double cpuMs() {
+  rusage ru;
+  getrusage(RUSAGE_SELF, &ru);
+  return (ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) * 1e3 + (ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) / 1e3;
+}
+
+const char *modeName(FleetStandIn::Mode m) {
+  switch (m) {
+    case FleetStandIn::KEEP_ALIVE: return "keep-alive";
+    case FleetStandIn::CLOSE:      return "close";
+    case FleetStandIn::HANG:       return "colgada";
+    default:                       return "rechaza";
+  }
+}
+
+void roundHeader() {
+  printf("%-6s %7s %5s %8s %10s %9s %10s %8s %7s\n", "ronda", "placas", "ok", "fallaron", "salteadas", "ocupadas",
+         "okMs", "totalMs", "filas");
+}
+
+void printRound(const Collector::RoundStats &r) {
+  printf("%-6u %7u %5u %8u %10u %9u %10u %8u %7u\n", r.round, r.devices, r.ok, r.failed, r.skipped, r.busy, r.okMs,
+         r.ms, r.rows);
+}
+
+// Totales por modo de placa
+void printByMode(const Collector &col, const FleetStandIn &fleet, const std::map<std::string, size_t> &board) {
+  printf("%-12s %7s %9s %6s %9s %8s %11s %9s %8s %8s\n", "modo", "placas", "peticiones", "ok", "timeouts", "errores",
+         "conexiones", "reusadas", "stale", "máx ms");
+  for (int m = FleetStandIn::KEEP_ALIVE; m <= FleetStandIn::REFUSE; ++m) {
+    Collector::DeviceStats t = {};
+    uint32_t n = 0;
+    for (size_t i = 0; i < col.size(); ++i) {
+      if (fleet.mode(board.at(col.name(i))) != m) continue;
+      const Collector::DeviceStats &s = col.stats(i);
+      n++;
+      t.requests += s.requests;
+      t.ok += s.ok;
+      t.timeouts += s.timeouts;
+      t.errors += s.errors;
+      t.connects += s.connects;
+      t.reused += s.reused;
+      t.staleRetries += s.staleRetries;
+      t.maxMs = std::max(t.maxMs, s.maxMs);
+    }
+    printf("%-12s %7u %9u %6u %9u %8u %11u %9u %8u %8u\n", modeName((FleetStandIn::Mode)m), n, t.requests, t.ok,
+           t.timeouts, t.errors, t.connects, t.reused, t.staleRetries, t.maxMs);
+  }
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  size_t boards = argc > 1 ? (size_t)atoi(argv[1]) : 200;
+  uint32_t rounds = argc > 2 ? (uint32_t)atoi(argv[2]) : 4;
+  rlimit rl;
+  if (getrlimit(RLIMIT_NOFILE, &rl) == 0) {
+    rl.rlim_cur = rl.rlim_max;
+    setrlimit(RLIMIT_NOFILE, &rl);
+  }
+
+  // 80 % keep-alive, 10 % close, 5 % colgadas, 5 % rechazan
+  std::vector<FleetStandIn::Mode> modes(boards);
+  for (size_t i = 0; i < boards; ++i) {
+    size_t k = i % 20;
+    modes[i] = k < 16 ? FleetStandIn::KEEP_ALIVE : k < 18 ? FleetStandIn::CLOSE
+             : k == 18 ? FleetStandIn::HANG : FleetStandIn::REFUSE;
+  }
+  FleetStandIn fleet;
+  if (!fleet.start(kBasePort, modes, kMdnsPort)) return 1;
+  std::map<std::string, size_t> board;
+  for (size_t i = 0; i < boards; ++i) board[fleet.name(i)] = i;
+  int fails = 0;
+
+  // ---- 1. Descubrimiento ----
+  sockaddr_in to;
+  parseEndpoint("127.0.0.1", kMdnsPort, to);
+  MdnsBrowseStats ms;
+  Clock::time_point t0 = Clock::now();
+  std::vector<MdnsService> found = mdnsBrowse("_http._tcp.local", to, 300, &ms);
+  double browseMs = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+  printf("\n== Descubrimiento mDNS (%zu placas + 1 servidor ajeno, 127.0.0.1:%u) ==\n", boards, kMdnsPort);
+  printf("servicios=%zu preguntas=%u respuestas=%u ilegibles=%u en %.0f ms\n", found.size(), ms.queries, ms.packets,
+         ms.malformed, browseMs);
+  size_t good = 0;
+  for (const MdnsService &s : found) {
+    auto it = board.find(s.instance);
+    if (it == board.end()) continue;
+    if (s.port == fleet.port(it->second) && s.ip == "127.0.0.1" && strcasecmp(s.host.c_str(), (fleet.name(it->second) + ".local").c_str()) == 0 &&
+        s.txt.count("api") && s.txt.at("api") == "1" && s.txt.count("caps") && s.txt.at("caps") == FleetStandIn::kCaps)
+      good++;
+  }
+  fails += check(found.size() == boards + 1 && good == boards,
+                 "todas las placas con puerto, host, IP y TXT (api, caps), también las que mandaron sólo el PTR");
+
+  // ---- 2. Rondas concurrentes ----
+  char path[] = "/tmp/fleetbench-XXXXXX";
+  int tmp = mkstemp(path);
+  close(tmp);
+  unlink(path);
+  CollectorConfig cfg;
+  cfg.intervalMs = 1000;
+  cfg.timeoutMs = kTimeoutMs;
+  cfg.maxActive = (uint16_t)std::max<size_t>(64, boards / 4);   // que el plazo no lo tape la cola
+  cfg.historyEvery = 2;
+  cfg.backfillSec = 600;   // 600 muestras: dos páginas de 500 en la primera ronda
+  cfg.pageRows = 500;
+  uint32_t firstTs = (uint32_t)time(nullptr) - cfg.backfillSec;
+
+  ColumnWriter out;
+  out.open(path);
+  Collector col(cfg, out);
+  int ignored = 0;
+  for (const MdnsService &s : found) ignored += col.add(s) == 0;
+  printf("\n== Colector: %zu placas, -c %u, plazo %u ms, latencia %u ms, historial cada %u rondas ==\n", col.size(),
+         cfg.maxActive, cfg.timeoutMs, fleet.latencyMs.load(), cfg.historyEvery);
+  roundHeader();
+  std::vector<Collector::RoundStats> rs;
+  col.onRound = [&](const Collector::RoundStats &r) {
+    printRound(r);
+    rs.push_back(r);
+  };
+  double cpu0 = cpuMs();
+  t0 = Clock::now();
+  col.run(rounds);
+  double wallMs = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+  double cpu = cpuMs() - cpu0;
+  out.flush();
+  printByMode(col, fleet, board);
+  Collector::DeviceStats tot = col.total();
+  printf("total: %u peticiones (%u conexiones, %u reusadas), %u filas, %.1f MB recibidos; CPU %.0f ms en %.0f ms "
+         "(%.2f ms CPU/petición)\n", tot.requests, tot.connects, tot.reused, tot.rows, tot.bytes / 1e6, cpu, wallMs,
+         tot.requests ? cpu / tot.requests : 0.0);
+
+  bool healthyClean = true, hungBackoff = true, reuse = true;
+  for (size_t i = 0; i < col.size(); ++i) {
+    const Collector::DeviceStats &s = col.stats(i);
+    FleetStandIn::Mode m = fleet.mode(board.at(col.name(i)));
+    if (m == FleetStandIn::KEEP_ALIVE || m == FleetStandIn::CLOSE) healthyClean = healthyClean && s.timeouts == 0 && s.errors == 0;
+    if (m == FleetStandIn::HANG) hungBackoff = hungBackoff && s.timeouts > 0 && s.timeouts < rounds;
+    if (m == FleetStandIn::KEEP_ALIVE) reuse = reuse && s.connects == 1 && s.reused + 1 == s.requests;
+  }
+  // La primera ronda trae todo el backfill: dura lo que tarda en
+  // transferirse, no lo que esperan las colgadas
+  bool notStalled = rs.size() > 1;
+  for (size_t i = 1; i < rs.size(); ++i) notStalled = notStalled && rs[i].okMs < kTimeoutMs;
+  fails += check(ignored == 1, "el servidor sin TXT api queda afuera");
+  fails += check(healthyClean, "placas sanas: ningún timeout ni error en ninguna ronda");
+  fails += check(notStalled, "rondas después del backfill: la última placa sana termina antes del plazo de las colgadas");
+  fails += check(hungBackoff, "colgadas: vencen por plazo y con backoff no se reintentan en cada ronda");
+  fails += check(reuse, "keep-alive: una sola conexión por placa para todas las peticiones y rondas");
+
+  // ---- 3. Secuencial contra concurrente (una ronda sin historial) ----
+  printf("\n== Una ronda de /api/latest a las %zu placas ==\n", col.size());
+  printf("%-18s %10s %6s %9s\n", "modo", "ms", "ok", "timeouts");
+  double seqMs = 0, parMs = 0;
+  for (uint16_t c : {(uint16_t)1, (uint16_t)64}) {
+    CollectorConfig one = cfg;
+    one.maxActive = c;
+    one.historyEvery = 0;
+    ColumnWriter none;
+    Collector solo(one, none);
+    for (const MdnsService &s : found) solo.add(s);
+    t0 = Clock::now();
+    solo.run(1);
+    double ms1 = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+    Collector::DeviceStats t = solo.total();
+    printf("%-18s %10.0f %6u %9u\n", c == 1 ? "secuencial (-c 1)" : "concurrente (-c 64)", ms1, t.ok, t.timeouts);
+    (c == 1 ? seqMs : parMs) = ms1;
+  }
+  fails += check(parMs * 10 < seqMs, "concurrente ≥ 10× más rápido que de a una");
+
+  // ---- 4. El servidor cierra las ociosas antes de la ronda siguiente ----
+  fleet.idleCloseMs = 300;
+  {
+    CollectorConfig c2 = cfg;
+    c2.historyEvery = 0;
+    ColumnWriter none;
+    Collector idle(c2, none);
+    for (size_t i = 0; i < boards && idle.size() < 40; ++i) {
+      if (fleet.mode(i) == FleetStandIn::KEEP_ALIVE) idle.add(fleet.name(i), fleet.name(i) + ".local", "127.0.0.1", fleet.port(i), true);
+    }
+    uint32_t closed0 = fleet.stats().idleClosed;
+    idle.run(3);
+    Collector::DeviceStats t = idle.total();
+    printf("\n== Keep-alive con cierre de ociosas a 300 ms (40 placas, 3 rondas) ==\n");
+    printf("peticiones=%u ok=%u conexiones=%u reusadas=%u stale=%u errores=%u cerradas por el servidor=%u\n",
+           t.requests, t.ok, t.connects, t.reused, t.staleRetries, t.errors, fleet.stats().idleClosed - closed0);
+    fails += check(t.ok == t.requests && t.errors == 0, "conexiones cerradas por el servidor: se reabren sin errores");
+  }
+  fleet.idleCloseMs = 5000;
+
+  // ---- 5. Archivo ----
+  out.close();
+  std::map<uint16_t, std::string> names;
+  std::map<uint16_t, std::vector<int64_t>> hist;
+  uint64_t rows = 0, latestRows = 0;
+  bool valuesOk = true;
+  long bytes = readColumnFile(path, [&](const ColumnDevice &d) { names[d.id] = d.name; },
+                              [&](const ColumnRows &r) {
+                                for (size_t i = 0; i < r.size(); ++i) {
+                                  rows++;
+                                  size_t b = board.at(names.at(r.dev[i]));
+                                  uint32_t ts = (uint32_t)(r.ts[i] / 1000);
+                                  valuesOk = valuesOk && r.temperature[i] == FleetStandIn::temperature(b, ts) &&
+                                             r.humidity[i] == FleetStandIn::humidity(b, ts);
+                                  if (r.source[i] == ColumnWriter::HISTORY) hist[r.dev[i]].push_back(r.ts[i]);
+                                  else latestRows++;
+                                }
+                              });
+  printf("\n== Archivo columnar (%s) ==\n", path);
+  printf("%ld bytes, %llu filas (%llu latest, %llu historial), %.1f bytes/fila, %u bloques\n", bytes,
+         (unsigned long long)rows, (unsigned long long)latestRows, (unsigned long long)(rows - latestRows),
+         rows ? (double)bytes / rows : 0.0, out.stats().blocks);
+  bool contiguous = true;
+  size_t withHistory = 0;
+  for (const auto &h : hist) {
+    withHistory++;
+    const std::vector<int64_t> &v = h.second;
+    contiguous = contiguous && v.front() / 1000 <= (int64_t)firstTs + 1;
+    for (size_t i = 1; i < v.size(); ++i) contiguous = contiguous && v[i] == v[i - 1] + 1000;
+  }
+  size_t healthy = 0;
+  for (size_t i = 0; i < boards; ++i) healthy += modes[i] == FleetStandIn::KEEP_ALIVE || modes[i] == FleetStandIn::CLOSE;
+  fails += check(names.size() == boards, "cada placa registrada una vez");
+  fails += check(withHistory == healthy && contiguous,
+                 "historial: cada placa sana desde el inicio del backfill, un ts por segundo, sin huecos ni duplicados");
+  fails += check(valuesOk, "valores iguales a los que sirvió cada placa");
+
+  // Un bloque cortado a la mitad al final (corte de luz)
+  FILE *f = fopen(path, "ab");
+  fwrite("FLCR\x40\x00\x00\x00partial", 1, 15, f);
+  fclose(f);
+  ColumnWriter again;
+  again.open(path);
+  uint64_t recovered = again.stats().recovered;
+  again.append(0, 1, 1.0f, 1.0f, ColumnWriter::LATEST);
+  again.close();
+  uint64_t rows2 = 0;
+  readColumnFile(path, nullptr, [&](const ColumnRows &r) { rows2 += r.size(); });
+  fails += check(recovered == 15 && rows2 == rows + 1, "cola rota: se recorta al reabrir y lo nuevo se sigue leyendo");
+  unlink(path);
+
+  FleetStandIn::Stats fs = fleet.stats();
+  printf("\nflota: conexiones=%u peticiones=%u latest=%u páginas de historial=%u cerradas por ociosas=%u\n",
+         fs.connections, fs.requests, fs.latest, fs.historyPages, fs.idleClosed);
+  fleet.stop();
+  return fails ? 1 : 0;
+}
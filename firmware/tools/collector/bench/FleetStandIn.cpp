@@ -0,0 +1,408 @@
+#include "FleetStandIn.h"
+
+#include "Mdns.h"
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <math.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+const char *const FleetStandIn::kCaps = "latest,history,history.bin,range,points,stream,metrics";
+
+namespace {
+
+const uint64_t kListenTag = 1ull << 63;
+const uint64_t kMdnsTag = 1ull << 62;
+const uint64_t kWakeTag = 1ull << 61;
+
+uint64_t monoMs() {
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+std::string lower(std::string s) {
+  for (char &c : s) c = (char)tolower((unsigned char)c);
+  return s;
+}
+
+// Cuerpo en chunks de 1 KB, como JsonResponse cuando se le llena el buffer
+void appendChunked(std::string &out, const std::string &body) {
+  for (size_t i = 0; i < body.size(); i += 1024) {
+    size_t n = std::min<size_t>(1024, body.size() - i);
+    char head[16];
+    snprintf(head, sizeof(head), "%zx\r\n", n);
+    out += head;
+    out.append(body, i, n);
+    out += "\r\n";
+  }
+  out += "0\r\n\r\n";
+}
+
+} // namespace
+
+struct FleetStandIn::Conn {
+  int fd;
+  size_t board;
+  std::string in, out;
+  std::string path;       // petición esperando su latencia
+  uint64_t dueMs = 0;     // 0: nada pendiente
+  uint64_t lastMs;
+  bool closeAfter = false;
+};
+
+std::string FleetStandIn::name(size_t i) const {
+  char buf[16];
+  snprintf(buf, sizeof(buf), "esp32-%04X", (unsigned)(0x2B00 + i));
+  return buf;
+}
+
+float FleetStandIn::temperature(size_t board, uint32_t ts) {
+  return roundf((20.0f + (float)(board % 10) + 2.0f * sinf(ts / 3600.0f)) * 10.0f) / 10.0f;
+}
+
+float FleetStandIn::humidity(size_t board, uint32_t ts) {
+  return (float)(40 + (board + ts / 60) % 30);
+}
+
+FleetStandIn::Stats FleetStandIn::stats() const {
+  Stats s = {connections_.load(), requests_.load(), latest_.load(), historyPages_.load(), idleClosed_.load(),
+             mdnsQueries_.load(), mdnsPackets_.load()};
+  return s;
+}
+
+// ======== Arranque ========
+bool FleetStandIn::start(uint16_t basePort, const std::vector<Mode> &modes, uint16_t mdnsPort) {
+  basePort_ = basePort;
+  ep_ = epoll_create1(EPOLL_CLOEXEC);
+  wakeFd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  epoll_event ev = {};
+  ev.events = EPOLLIN;
+  ev.data.u64 = kWakeTag;
+  epoll_ctl(ep_, EPOLL_CTL_ADD, wakeFd_, &ev);
+
+  sockaddr_in addr = {};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  for (size_t i = 0; i < modes.size(); ++i) {
+    Board b = {modes[i], -1};
+    byName_[lower(name(i))] = i;
+    if (b.mode != REFUSE) {
+      b.listenFd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+      int one = 1;
+      setsockopt(b.listenFd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+      addr.sin_port = htons(port(i));
+      if (bind(b.listenFd, (sockaddr *)&addr, sizeof(addr)) != 0 || listen(b.listenFd, 64) != 0) {
+        fprintf(stderr, "no se pudo abrir 127.0.0.1:%u\n", port(i));
+        return false;
+      }
+      ev.events = EPOLLIN;
+      ev.data.u64 = kListenTag | i;
+      epoll_ctl(ep_, EPOLL_CTL_ADD, b.listenFd, &ev);
+    }
+    boards_.push_back(b);
+  }
+
+  mdnsFd_ = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  int snd = 1 << 20;
+  setsockopt(mdnsFd_, SOL_SOCKET, SO_SNDBUF, &snd, sizeof(snd));
+  addr.sin_port = htons(mdnsPort);
+  if (bind(mdnsFd_, (sockaddr *)&addr, sizeof(addr)) != 0) {
+    fprintf(stderr, "no se pudo abrir udp 127.0.0.1:%u\n", mdnsPort);
+    return false;
+  }
+  ev.events = EPOLLIN;
+  ev.data.u64 = kMdnsTag;
+  epoll_ctl(ep_, EPOLL_CTL_ADD, mdnsFd_, &ev);
+
+  running_ = true;
+  thread_ = std::thread(&FleetStandIn::loop, this);
+  return true;
+}
+
+void FleetStandIn::stop() {
+  if (!running_.exchange(false)) return;
+  uint64_t one = 1;
+  if (write(wakeFd_, &one, sizeof(one)) < 0) {}
+  thread_.join();
+  for (Conn *c : conns_) {
+    close(c->fd);
+    delete c;
+  }
+  conns_.clear();
+  for (Board &b : boards_) {
+    if (b.listenFd >= 0) close(b.listenFd);
+  }
+  boards_.clear();
+  close(mdnsFd_);
+  close(wakeFd_);
+  close(ep_);
+}
+
+// ======== Loop ========
+void FleetStandIn::loop() {
+  epoll_event ev[128];
+  while (running_) {
+    uint64_t now = monoMs();
+    uint64_t wake = now + 50;   // también para cerrar ociosas
+    for (const Conn *c : conns_) {
+      if (c->dueMs && c->dueMs < wake) wake = c->dueMs;
+    }
+    for (const Datagram &d : replies_) {
+      if (d.dueMs < wake) wake = d.dueMs;
+    }
+    int n = epoll_wait(ep_, ev, 128, wake > now ? (int)(wake - now) : 0);
+    for (int i = 0; i < n; ++i) {
+      uint64_t tag = ev[i].data.u64;
+      if (tag & kListenTag) accept((size_t)(tag & ~kListenTag));
+      else if (tag == kMdnsTag) onMdns();
+      else if (tag == kWakeTag) continue;
+      else if (ev[i].events & EPOLLOUT) flushOut((Conn *)ev[i].data.ptr);
+      else onReadable((Conn *)ev[i].data.ptr);
+    }
+    now = monoMs();
+    sendDue(now);
+    for (size_t i = 0; i < conns_.size();) {
+      Conn *c = conns_[i];
+      if (c->dueMs && c->dueMs <= now) {
+        c->dueMs = 0;
+        respond(c);   // puede cerrar (y sacar de conns_) la conexión
+        if (i < conns_.size() && conns_[i] == c) ++i;
+        continue;
+      }
+      bool idle = !c->dueMs && c->out.empty() && boards_[c->board].mode == KEEP_ALIVE &&
+                  now - c->lastMs >= idleCloseMs.load();
+      if (idle) closeConn(c, true);
+      else ++i;
+    }
+  }
+}
+
+void FleetStandIn::accept(size_t board) {
+  for (;;) {
+    int fd = accept4(boards_[board].listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+    if (fd < 0) return;
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    Conn *c = new Conn;
+    c->fd = fd;
+    c->board = board;
+    c->lastMs = monoMs();
+    conns_.push_back(c);
+    epoll_event ev = {};
+    ev.events = EPOLLIN;
+    ev.data.ptr = c;
+    epoll_ctl(ep_, EPOLL_CTL_ADD, fd, &ev);
+    connections_++;
+  }
+}
+
+void FleetStandIn::closeConn(Conn *c, bool idle) {
+  if (idle) idleClosed_++;
+  epoll_ctl(ep_, EPOLL_CTL_DEL, c->fd, nullptr);
+  close(c->fd);
+  for (size_t i = 0; i < conns_.size(); ++i) {
+    if (conns_[i] == c) {
+      conns_[i] = conns_.back();
+      conns_.pop_back();
+      break;
+    }
+  }
+  delete c;
+}
+
+void FleetStandIn::onReadable(Conn *c) {
+  char buf[4096];
+  for (;;) {
+    ssize_t n = recv(c->fd, buf, sizeof(buf), 0);
+    if (n > 0) {
+      c->in.append(buf, (size_t)n);
+      continue;
+    }
+    if (n < 0 && errno == EAGAIN) break;
+    closeConn(c, false);
+    return;
+  }
+  c->lastMs = monoMs();
+  size_t end = c->in.find("\r\n\r\n");
+  if (end == std::string::npos || c->dueMs) return;
+  size_t sp1 = c->in.find(' '), sp2 = c->in.find(' ', sp1 + 1);
+  std::string path = sp1 != std::string::npos && sp2 != std::string::npos ? c->in.substr(sp1 + 1, sp2 - sp1 - 1) : "/";
+  c->in.erase(0, end + 4);
+  requests_++;
+  if (boards_[c->board].mode == HANG) return;  // leída y nunca contestada
+  c->path = path;
+  c->dueMs = c->lastMs + latencyMs.load() + 1;
+}
+
+// ======== Respuestas (mismo JSON que el firmware) ========
+void FleetStandIn::respond(Conn *c) {
+  const size_t b = c->board;
+  const uint32_t step = sampleSec.load() ? sampleSec.load() : 1;
+  const uint32_t now = (uint32_t)time(nullptr) / step * step;
+  std::string body;
+  int code = 200;
+  bool chunked = false;
+  char buf[160];
+  if (c->path == "/api/latest") {
+    latest_++;
+    snprintf(buf, sizeof(buf), "{\"temperature\":%.1f,\"humidity\":%.0f,\"timestamp\":%llu,\"stale\":false}",
+             temperature(b, now), humidity(b, now), (unsigned long long)now * 1000ULL);
+    body = buf;
+  } else if (c->path.compare(0, 18, "/api/history?from=") == 0) {
+    historyPages_++;
+    chunked = true;
+    uint32_t from = (uint32_t)strtoul(c->path.c_str() + 18, nullptr, 10);
+    size_t lim = c->path.find("limit=");
+    uint32_t limit = lim != std::string::npos ? (uint32_t)atoi(c->path.c_str() + lim + 6) : 1440;
+    if (!limit) limit = 1440;
+    if (from + 86400 < now) from = now - 86400;   // lo que guarda el anillo
+    uint32_t first = (from + step - 1) / step * step;
+    snprintf(buf, sizeof(buf), "{\"from\":%u,\"to\":%u,\"resolution\":\"raw\",\"fields\":[\"timestamp\","
+             "\"temperature\",\"humidity\"],\"rows\":[", from, now);
+    body = buf;
+    uint32_t rows = 0, ts = first;
+    for (; ts <= now && rows < limit; ts += step, ++rows) {
+      snprintf(buf, sizeof(buf), "%s[%llu,%.1f,%.0f]", rows ? "," : "", (unsigned long long)ts * 1000ULL,
+               temperature(b, ts), humidity(b, ts));
+      body += buf;
+    }
+    if (ts <= now) snprintf(buf, sizeof(buf), "],\"count\":%u,\"cursor\":%u}", rows, ts);
+    else snprintf(buf, sizeof(buf), "],\"count\":%u,\"cursor\":null}", rows);
+    body += buf;
+  } else {
+    code = 404;
+    body = "Recurso no encontrado";
+  }
+
+  const bool keep = boards_[b].mode == KEEP_ALIVE;
+  snprintf(buf, sizeof(buf), "HTTP/1.1 %d %s\r\nContent-Type: %s\r\n", code, code == 200 ? "OK" : "Not Found",
+           code == 200 ? "application/json; charset=utf-8" : "text/plain; charset=utf-8");
+  c->out += buf;
+  if (!keep) c->out += "Connection: close\r\n";
+  if (chunked) {
+    c->out += "Transfer-Encoding: chunked\r\n\r\n";
+    appendChunked(c->out, body);
+  } else {
+    snprintf(buf, sizeof(buf), "Content-Length: %zu\r\n\r\n", body.size());
+    c->out += buf;
+    c->out += body;
+  }
+  c->closeAfter = !keep;
+  flushOut(c);
+}
+
+void FleetStandIn::flushOut(Conn *c) {
+  while (!c->out.empty()) {
+    ssize_t n = send(c->fd, c->out.data(), c->out.size(), MSG_NOSIGNAL);
+    if (n > 0) {
+      c->out.erase(0, (size_t)n);
+      continue;
+    }
+    if (n < 0 && errno == EAGAIN) {
+      epoll_event ev = {};
+      ev.events = EPOLLOUT;
+      ev.data.ptr = c;
+      epoll_ctl(ep_, EPOLL_CTL_MOD, c->fd, &ev);
+      return;
+    }
+    closeConn(c, false);
+    return;
+  }
+  c->lastMs = monoMs();
+  if (c->closeAfter) {
+    closeConn(c, false);
+    return;
+  }
+  epoll_event ev = {};
+  ev.events = EPOLLIN;
+  ev.data.ptr = c;
+  epoll_ctl(ep_, EPOLL_CTL_MOD, c->fd, &ev);
+}
+
+// ======== mDNS ========
+void FleetStandIn::sendDue(uint64_t now) {
+  for (size_t i = 0; i < replies_.size();) {
+    Datagram &d = replies_[i];
+    if (d.dueMs > now) {
+      ++i;
+      continue;
+    }
+    sendto(mdnsFd_, d.bytes.data(), d.bytes.size(), 0, (sockaddr *)&d.to, sizeof(d.to));
+    mdnsPackets_++;
+    d = std::move(replies_.back());
+    replies_.pop_back();
+  }
+}
+
+void FleetStandIn::onMdns() {
+  uint8_t buf[9000];   // tope de mDNS (RFC 6762 §17)
+  for (;;) {
+    sockaddr_in src;
+    socklen_t sl = sizeof(src);
+    ssize_t n = recvfrom(mdnsFd_, buf, sizeof(buf), 0, (sockaddr *)&src, &sl);
+    if (n <= 0) return;
+    dns::Message q;
+    if (!dns::parse(buf, (size_t)n, q) || (q.flags & 0x8000)) continue;
+    mdnsQueries_++;
+
+    in_addr lo;
+    lo.s_addr = htonl(INADDR_LOOPBACK);
+    const std::string svc = "_http._tcp.local";
+    // Como un responder real con registros compartidos (PTR): cada placa
+    // contesta tras 20..120 ms al azar, así cientos no llegan juntas
+    uint64_t now = monoMs();
+    auto reply = [&](const dns::Writer &w) {
+      replies_.push_back(Datagram{now + 20 + (uint64_t)(rand() % 101), src, w.bytes()});
+    };
+    for (const auto &question : q.questions) {
+      std::string qn = lower(question.first);
+      if (qn == svc && (question.second == dns::PTR || question.second == dns::ANY)) {
+        // Un paquete por placa, como si contestara cada una
+        for (size_t i = 0; i < boards_.size(); ++i) {
+          std::string inst = name(i) + "." + svc, host = name(i) + ".local";
+          dns::Writer w(0x8400);
+          w.ptr(0, svc, inst, 4500);
+          if (i % 10 != 9) {
+            w.srv(2, inst, port(i), host, 120);
+            w.txt(2, inst, {{"api", "1"}, {"caps", kCaps}}, 4500);
+            w.a(2, host, lo, 120);
+          }
+          reply(w);
+        }
+        // Otro servidor HTTP de la red (sin TXT api)
+        dns::Writer w(0x8400);
+        w.ptr(0, svc, "impresora." + svc, 4500);
+        w.srv(2, "impresora." + svc, 631, "impresora.local", 120);
+        w.txt(2, "impresora." + svc, {{"path", "/"}}, 4500);
+        w.a(2, "impresora.local", lo, 120);
+        reply(w);
+        continue;
+      }
+      // Preguntas de la segunda vuelta: instancia (SRV/TXT/ANY) o host (A)
+      size_t dot = qn.find('.');
+      auto it = byName_.find(qn.substr(0, dot));
+      if (it == byName_.end()) continue;
+      size_t i = it->second;
+      std::string inst = name(i) + "." + svc, host = name(i) + ".local";
+      dns::Writer w(0x8400);
+      if (qn == lower(host)) {
+        w.a(0, host, lo, 120);
+      } else {
+        w.srv(0, inst, port(i), host, 120);
+        w.txt(0, inst, {{"api", "1"}, {"caps", kCaps}}, 4500);
+        w.a(2, host, lo, 120);
+      }
+      reply(w);
+    }
+  }
+}
@@ -0,0 +1,95 @@
+// ======== Flota de placas de mentira en 127.0.0.1 ========
+// Cientos de servidores HTTP (uno por puerto, todos atendidos por un solo
+// hilo con epoll) que contestan /api/latest y /api/history?from=&limit=
+// como firmwareWifiManager_WebServer_mDNS: misma forma del JSON, historial
+// chunked con cursor. Cada placa tiene un modo:
+//   KEEP_ALIVE  HTTP/1.1 persistente (como AsyncHttpServer); cierra las
+//               conexiones ociosas a los idleCloseMs
+//   CLOSE       Connection: close en cada respuesta (como el WebServer del core)
+//   HANG        acepta y lee, nunca contesta
+//   REFUSE      no escucha (conexión rechazada)
+// latencyMs demora cada respuesta sin frenar a las demás placas. Las
+// muestras salen cada sampleSec segundos de reloj, con valores que dependen
+// sólo de la placa y el ts (el benchmark las puede verificar).
+//
+// Además un responder mDNS en 127.0.0.1 que contesta la pregunta PTR por
+// _http._tcp.local con un paquete por placa (PTR + SRV/TXT/A adicionales),
+// como lo harían las placas reales, más un servidor HTTP ajeno sin TXT api.
+// Una de cada 10 placas manda sólo el PTR: el resto se lo tiene que pedir
+// el colector en la segunda vuelta.
+#pragma once
+
+#include <netinet/in.h>
+#include <stdint.h>
+
+#include <atomic>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+class FleetStandIn {
+public:
+  enum Mode : uint8_t { KEEP_ALIVE, CLOSE, HANG, REFUSE };
+
+  struct Stats {
+    uint32_t connections;
+    uint32_t requests;
+    uint32_t latest;
+    uint32_t historyPages;
+    uint32_t idleClosed;
+    uint32_t mdnsQueries;
+    uint32_t mdnsPackets;
+  };
+
+  ~FleetStandIn() { stop(); }
+  // Una placa por modo, en los puertos basePort, basePort + 1, ...
+  bool start(uint16_t basePort, const std::vector<Mode> &modes, uint16_t mdnsPort);
+  void stop();
+
+  size_t size() const { return boards_.size(); }
+  std::string name(size_t i) const;   // "esp32-XXXX"
+  uint16_t port(size_t i) const { return (uint16_t)(basePort_ + i); }
+  Mode mode(size_t i) const { return boards_[i].mode; }
+  Stats stats() const;
+
+  static float temperature(size_t board, uint32_t ts);
+  static float humidity(size_t board, uint32_t ts);
+
+  std::atomic<unsigned> latencyMs{20};
+  std::atomic<unsigned> idleCloseMs{5000};
+  std::atomic<unsigned> sampleSec{1};
+  static const char *const kCaps;     // TXT caps de las placas
+
+private:
+  struct Board {
+    Mode mode;
+    int listenFd;
+  };
+  struct Conn;
+  struct Datagram {
+    uint64_t dueMs;
+    sockaddr_in to;
+    std::vector<uint8_t> bytes;
+  };
+
+  void loop();
+  void onMdns();
+  void sendDue(uint64_t now);
+  void accept(size_t board);
+  void onReadable(Conn *c);
+  void respond(Conn *c);
+  void flushOut(Conn *c);
+  void closeConn(Conn *c, bool idle);
+
+  std::vector<Board> boards_;
+  std::map<std::string, size_t> byName_;   // "esp32-xxxx" (minúsculas) -> placa
+  uint16_t basePort_ = 0;
+  int ep_ = -1, mdnsFd_ = -1, wakeFd_ = -1;
+  std::thread thread_;
+  std::vector<Conn *> conns_;
+  std::vector<Datagram> replies_;          // respuestas mDNS demoradas
+  std::atomic<bool> running_{false};
+  std::atomic<uint32_t> connections_{0}, requests_{0}, latest_{0}, historyPages_{0}, idleClosed_{0};
+  std::atomic<uint32_t> mdnsQueries_{0}, mdnsPackets_{0};
+};
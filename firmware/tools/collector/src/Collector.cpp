@@ -0,0 +1,460 @@
+#include "Collector.h"
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <math.h>
+#include <netinet/tcp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+static uint64_t monoMs() {
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+// ======== JSON de la API (lo justo para /api/latest y /api/history) ========
+// Número o null (NAN) en p; avanza p
+static bool jsonValue(const char *&p, double &out) {
+  while (*p == ' ') p++;
+  if (strncmp(p, "null", 4) == 0) {
+    out = NAN;
+    p += 4;
+    return true;
+  }
+  char *end;
+  out = strtod(p, &end);
+  if (end == p) return false;
+  p = end;
+  return true;
+}
+
+// Valor de "key": en el objeto; false si no está o no es número/null
+static bool jsonField(const std::string &body, const char *key, double &out) {
+  char k[48];
+  snprintf(k, sizeof(k), "\"%s\":", key);
+  size_t at = body.find(k);
+  if (at == std::string::npos) return false;
+  const char *p = body.c_str() + at + strlen(k);
+  return jsonValue(p, out);
+}
+
+// ======== Alta y estadísticas ========
+Collector::Collector(const CollectorConfig &cfg, ColumnWriter &out) : cfg_(cfg), out_(out) {
+  ep_ = epoll_create1(EPOLL_CLOEXEC);
+  if (!cfg_.maxActive) cfg_.maxActive = 1;
+}
+
+Collector::~Collector() {
+  for (Device *d : devices_) {
+    closeConn(*d);
+    delete d;
+  }
+  if (ep_ >= 0) close(ep_);
+}
+
+bool Collector::add(const std::string &name, const std::string &host, const std::string &ip, uint16_t port,
+                    bool history) {
+  Device *d = new Device;
+  memset(&d->addr, 0, sizeof(d->addr));
+  d->addr.sin_family = AF_INET;
+  d->addr.sin_port = htons(port);
+  if (inet_pton(AF_INET, ip.c_str(), &d->addr.sin_addr) != 1) {
+    delete d;
+    return false;
+  }
+  for (const Device *o : devices_) {
+    if (o->addr.sin_addr.s_addr == d->addr.sin_addr.s_addr && o->addr.sin_port == d->addr.sin_port) {
+      delete d;
+      return false;
+    }
+  }
+  d->name = name;
+  d->host = host;
+  d->history = history;
+  d->id = out_.device(name, host, ip, port);
+  d->historyFrom = (uint32_t)time(nullptr) - cfg_.backfillSec;
+  devices_.push_back(d);
+  return true;
+}
+
+int Collector::add(const MdnsService &s) {
+  auto api = s.txt.find("api");
+  if (api == s.txt.end()) return 0;
+  if (atoi(api->second.c_str()) != COLLECTOR_API_VERSION) return -1;
+  auto caps = s.txt.find("caps");
+  bool history = caps != s.txt.end() && ("," + caps->second + ",").find(",range,") != std::string::npos;
+  return add(s.instance, s.host, s.ip, s.port, history) ? 1 : 0;
+}
+
+Collector::DeviceStats Collector::total() const {
+  DeviceStats t = {};
+  for (const Device *d : devices_) {
+    const DeviceStats &s = d->stats;
+    t.requests += s.requests;
+    t.ok += s.ok;
+    t.timeouts += s.timeouts;
+    t.errors += s.errors;
+    t.connects += s.connects;
+    t.reused += s.reused;
+    t.staleRetries += s.staleRetries;
+    t.skipped += s.skipped;
+    t.rows += s.rows;
+    t.bytes += s.bytes;
+    t.maxMs = std::max(t.maxMs, s.maxMs);
+  }
+  return t;
+}
+
+// ======== Rondas ========
+Collector::Round *Collector::findRound(uint32_t n) {
+  for (Round &r : rounds_) {
+    if (r.st.round == n) return &r;
+  }
+  return nullptr;
+}
+
+void Collector::startRound(uint64_t now) {
+  round_++;
+  Round r = {};
+  r.st.round = round_;
+  r.startMs = now;
+  // Las que fallaron la última vez van al final de la cola: si están
+  // colgadas ocupan lugares de maxActive hasta el plazo, y así no los
+  // ocupan antes que las sanas
+  std::vector<Device *> late;
+  for (Device *d : devices_) {
+    if (d->step != IDLE) {
+      r.st.busy++;
+      d->stats.skipped++;
+      continue;
+    }
+    if (round_ < d->skipUntil) {
+      r.st.skipped++;
+      d->stats.skipped++;
+      continue;
+    }
+    d->step = LATEST;
+    d->round = round_;
+    d->wantHistory = d->history && cfg_.historyEvery && (round_ - 1) % cfg_.historyEvery == 0;
+    if (d->fails) late.push_back(d);
+    else waiting_.push_back(d);
+    r.st.devices++;
+    r.pending++;
+  }
+  waiting_.insert(waiting_.end(), late.begin(), late.end());
+  if (r.pending) rounds_.push_back(r);
+  else if (onRound) onRound(r.st);
+}
+
+void Collector::admit(uint64_t now) {
+  while (active_.size() < cfg_.maxActive && !waiting_.empty()) {
+    Device *d = waiting_.front();
+    waiting_.pop_front();
+    active_.push_back(d);
+    send(*d, now);
+  }
+}
+
+void Collector::finish(Device &d, bool ok, uint64_t now) {
+  if (ok) d.fails = 0;
+  d.step = IDLE;
+  active_.erase(std::find(active_.begin(), active_.end(), &d));
+  Round *r = findRound(d.round);
+  if (!r) return;
+  uint32_t ms = (uint32_t)(now - r->startMs);
+  if (ok) {
+    r->st.ok++;
+    r->st.okMs = ms;
+  } else {
+    r->st.failed++;
+  }
+  r->st.ms = ms;
+  if (--r->pending) return;
+  out_.flush();  // un bloque por ronda: lo recolectado queda en disco
+  RoundStats st = r->st;
+  rounds_.erase(rounds_.begin() + (r - rounds_.data()));
+  if (onRound) onRound(st);
+}
+
+void Collector::run(uint32_t rounds) {
+  stop_ = false;
+  uint32_t started = 0;
+  uint64_t next = monoMs();
+  epoll_event ev[64];
+  while (!stop_) {
+    uint64_t now = monoMs();
+    bool more = rounds == 0 || started < rounds;
+    if (more && now >= next) {
+      startRound(now);
+      started++;
+      next += cfg_.intervalMs;
+      if (next <= now) next = now + cfg_.intervalMs;  // tras una ronda larga no se disparan varias juntas
+      more = rounds == 0 || started < rounds;
+    }
+    admit(now);
+    if (!more && active_.empty() && waiting_.empty()) break;
+
+    uint64_t wake = more ? next : now + 1000;
+    for (const Device *d : active_) wake = std::min(wake, d->deadlineMs);
+    int wait = wake > now ? (int)std::min<uint64_t>(wake - now, 1000) : 0;
+    int n = epoll_wait(ep_, ev, 64, wait);
+    now = monoMs();
+    for (int i = 0; i < n; ++i) onEvent(*(Device *)ev[i].data.ptr, ev[i].events, now);
+    // Plazos vencidos: fail() saca a la placa de active_
+    for (size_t i = 0; i < active_.size();) {
+      if (now >= active_[i]->deadlineMs) fail(*active_[i], true, now);
+      else ++i;
+    }
+  }
+  out_.flush();
+}
+
+// ======== Conexión y petición ========
+void Collector::closeConn(Device &d) {
+  if (d.fd >= 0) {
+    epoll_ctl(ep_, EPOLL_CTL_DEL, d.fd, nullptr);
+    close(d.fd);
+  }
+  d.fd = -1;
+  d.state = CLOSED;
+}
+
+void Collector::watch(Device &d, uint32_t events) {
+  epoll_event ev = {};
+  ev.events = events;
+  ev.data.ptr = &d;
+  epoll_ctl(ep_, EPOLL_CTL_MOD, d.fd, &ev);
+}
+
+bool Collector::connect(Device &d) {
+  d.fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  if (d.fd < 0) return false;
+  int one = 1;
+  setsockopt(d.fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+  d.stats.connects++;
+  int r = ::connect(d.fd, (const sockaddr *)&d.addr, sizeof(d.addr));
+  if (r < 0 && errno != EINPROGRESS) {
+    close(d.fd);
+    d.fd = -1;
+    return false;
+  }
+  d.state = r == 0 ? WRITING : CONNECTING;
+  epoll_event ev = {};
+  ev.events = EPOLLOUT;
+  ev.data.ptr = &d;
+  epoll_ctl(ep_, EPOLL_CTL_ADD, d.fd, &ev);
+  return true;
+}
+
+void Collector::send(Device &d, uint64_t now, bool retry) {
+  char path[96];
+  if (d.step == HISTORY) {
+    snprintf(path, sizeof(path), "/api/history?from=%u&limit=%u", (unsigned)d.historyFrom, (unsigned)cfg_.pageRows);
+  } else {
+    snprintf(path, sizeof(path), "/api/latest");
+  }
+  char req[256];
+  snprintf(req, sizeof(req), "GET %s HTTP/1.1\r\nHost: %s\r\nConnection: keep-alive\r\n\r\n", path, d.host.c_str());
+  d.out = req;
+  d.outOff = 0;
+  d.resp.reset();
+  d.startMs = now;
+  d.deadlineMs = now + cfg_.timeoutMs;
+  if (!retry) d.stats.requests++;
+
+  if (d.state == KEPT) {
+    d.reused = true;
+    d.stats.reused++;
+    d.state = WRITING;
+    writeSome(d, now);
+    return;
+  }
+  d.reused = false;
+  if (!connect(d)) {
+    fail(d, false, now);
+    return;
+  }
+  if (d.state == WRITING) writeSome(d, now);
+}
+
+// La conexión reusada estaba muerta y todavía no llegó nada: otra vez en una nueva
+bool Collector::retryStale(Device &d, uint64_t now) {
+  if (!d.reused || d.retried || d.resp.bytes() > 0) return false;
+  d.retried = true;
+  d.stats.staleRetries++;
+  closeConn(d);
+  send(d, now, true);
+  return true;
+}
+
+void Collector::onEvent(Device &d, uint32_t events, uint64_t now) {
+  // Ociosa (o esperando turno) y pasó algo: el servidor la cerró
+  if (d.state == KEPT || d.step == IDLE) {
+    closeConn(d);
+    return;
+  }
+  switch (d.state) {
+    case CONNECTING: {
+      if (!(events & (EPOLLOUT | EPOLLERR | EPOLLHUP))) return;
+      int err = 0;
+      socklen_t len = sizeof(err);
+      getsockopt(d.fd, SOL_SOCKET, SO_ERROR, &err, &len);
+      if (err) {
+        fail(d, false, now);
+        return;
+      }
+      d.state = WRITING;
+      writeSome(d, now);
+      return;
+    }
+    case WRITING:
+      if (events & (EPOLLERR | EPOLLHUP)) readSome(d, now);
+      else if (events & EPOLLOUT) writeSome(d, now);
+      return;
+    case READING:
+      readSome(d, now);
+      return;
+    default:
+      return;
+  }
+}
+
+void Collector::writeSome(Device &d, uint64_t now) {
+  while (d.outOff < d.out.size()) {
+    ssize_t n = ::send(d.fd, d.out.data() + d.outOff, d.out.size() - d.outOff, MSG_NOSIGNAL);
+    if (n > 0) {
+      d.outOff += (size_t)n;
+      continue;
+    }
+    if (n < 0 && (errno == EAGAIN || errno == EINTR)) {
+      watch(d, EPOLLOUT);
+      return;
+    }
+    if (!retryStale(d, now)) fail(d, false, now);
+    return;
+  }
+  d.state = READING;
+  watch(d, EPOLLIN);
+}
+
+void Collector::readSome(Device &d, uint64_t now) {
+  char buf[16384];
+  for (;;) {
+    ssize_t n = recv(d.fd, buf, sizeof(buf), 0);
+    if (n > 0) {
+      d.stats.bytes += (uint64_t)n;
+      HttpParser::Result r = d.resp.feed(buf, (size_t)n);
+      if (r == HttpParser::DONE) {
+        complete(d, now);
+        return;
+      }
+      if (r == HttpParser::BAD) {
+        fail(d, false, now);
+        return;
+      }
+      continue;
+    }
+    if (n < 0 && (errno == EAGAIN || errno == EINTR)) return;
+    // Cerrada por el servidor (o cortada)
+    if (retryStale(d, now)) return;
+    HttpParser::Result r = n == 0 ? d.resp.closed() : HttpParser::BAD;
+    closeConn(d);
+    if (r == HttpParser::DONE) complete(d, now);
+    else fail(d, false, now);
+    return;
+  }
+}
+
+void Collector::fail(Device &d, bool timeout, uint64_t now) {
+  closeConn(d);
+  if (timeout) d.stats.timeouts++;
+  else d.stats.errors++;
+  d.fails++;
+  uint32_t shift = std::min<uint32_t>(d.fails - 1, cfg_.maxBackoff);
+  d.skipUntil = d.round + 1 + ((1u << shift) - 1);
+  finish(d, false, now);
+}
+
+void Collector::complete(Device &d, uint64_t now) {
+  if (d.state != CLOSED) {
+    if (d.resp.keepAlive()) {
+      d.state = KEPT;
+      watch(d, EPOLLIN | EPOLLRDHUP);  // para enterarse si la cierra mientras está ociosa
+    } else {
+      closeConn(d);
+    }
+  }
+  bool more = false;
+  bool ok = d.resp.status() == 200 && (d.step == LATEST ? handleLatest(d) : handleHistory(d, more));
+  if (!ok) {
+    fail(d, false, now);
+    return;
+  }
+  d.stats.ok++;
+  d.stats.maxMs = std::max(d.stats.maxMs, (uint32_t)(now - d.startMs));
+  d.retried = false;
+  if (d.step == LATEST && d.wantHistory) {
+    d.step = HISTORY;
+    send(d, now);
+  } else if (d.step == HISTORY && more) {
+    send(d, now);  // página siguiente, por la misma conexión si quedó abierta
+  } else {
+    finish(d, true, now);
+  }
+}
+
+// ======== Respuestas ========
+// {"temperature":23.4,"humidity":55,"timestamp":1757000000000,"stale":false}
+bool Collector::handleLatest(Device &d) {
+  const std::string &body = d.resp.body();
+  double t, h, ts;
+  if (!jsonField(body, "temperature", t) || !jsonField(body, "humidity", h)) return false;
+  if (!jsonField(body, "timestamp", ts)) ts = (double)time(nullptr) * 1000.0;
+  // Sin dato bueno todavía, vencido o repetido: respuesta válida, nada que guardar
+  if (isnan(t) || body.find("\"stale\":true") != std::string::npos || (int64_t)ts == d.lastLatestMs) return true;
+  d.lastLatestMs = (int64_t)ts;
+  out_.append(d.id, (int64_t)ts, (float)t, (float)h, ColumnWriter::LATEST);
+  d.stats.rows++;
+  if (Round *r = findRound(d.round)) r->st.rows++;
+  return true;
+}
+
+// {"from":..,"to":..,"resolution":"raw","fields":[..],"rows":[[ts,t,h],..],"count":n,"cursor":ts|null}
+bool Collector::handleHistory(Device &d, bool &more) {
+  const std::string &body = d.resp.body();
+  size_t at = body.find("\"rows\":[");
+  if (at == std::string::npos) return false;
+  const char *p = body.c_str() + at + 8;
+  int64_t lastTs = -1;
+  uint32_t rows = 0;
+  for (;;) {
+    while (*p == ' ' || *p == ',') p++;
+    if (*p == ']') break;
+    if (*p != '[') return false;
+    p++;
+    double ts, t, h;
+    if (!jsonValue(p, ts) || *p++ != ',' || !jsonValue(p, t) || *p++ != ',' || !jsonValue(p, h)) return false;
+    while (*p && *p != ']') p++;  // columnas de más (resoluciones agregadas)
+    if (*p++ != ']') return false;
+    if (isnan(ts)) continue;
+    out_.append(d.id, (int64_t)ts, (float)t, (float)h, ColumnWriter::HISTORY);
+    lastTs = std::max(lastTs, (int64_t)ts);
+    rows++;
+  }
+  d.stats.rows += rows;
+  if (Round *r = findRound(d.round)) r->st.rows += rows;
+
+  double cursor;
+  more = jsonField(body, "cursor", cursor) && !isnan(cursor) && (uint32_t)cursor > d.historyFrom;
+  if (more) d.historyFrom = (uint32_t)cursor;
+  else if (lastTs >= 0) d.historyFrom = (uint32_t)(lastTs / 1000) + 1;
+  return true;
+}
@@ -0,0 +1,147 @@
+// ======== Colector de la flota ========
+// Pide /api/latest (y cada tanto /api/history por rango, siguiendo el
+// cursor) a cientos de placas desde un solo hilo con epoll: sockets no
+// bloqueantes, una conexión keep-alive por placa que se reusa entre
+// peticiones y rondas (si la placa la deja abierta; el WebServer del core
+// la cierra en cada respuesta), y a lo sumo maxActive placas atendidas a la
+// vez. Cada petición tiene su propio plazo: una placa colgada sólo ocupa su
+// lugar hasta timeoutMs y no frena a las demás. Tras fallar, la placa se
+// saltea 1, 3, 7... rondas (tope 2^maxBackoff - 1) hasta que conteste.
+// Una conexión reusada que el servidor ya había cerrado se reintenta una
+// vez en una nueva, sin contar como error.
+#pragma once
+
+#include <netinet/in.h>
+#include <stdint.h>
+
+#include <deque>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "ColumnFile.h"
+#include "HttpParser.h"
+#include "Mdns.h"
+
+// Versión de la API de las placas que entiende el colector (TXT "api")
+#define COLLECTOR_API_VERSION 1
+
+struct CollectorConfig {
+  uint32_t intervalMs = 10000;   // entre rondas
+  uint32_t timeoutMs = 3000;     // por petición (conexión + respuesta completa)
+  uint16_t maxActive = 64;       // placas atendidas a la vez
+  uint32_t historyEvery = 6;     // /api/history cada tantas rondas (0: nunca)
+  uint32_t backfillSec = 3600;   // primer pedido de historial: desde ahora - backfill
+  uint16_t pageRows = 500;       // limit= de cada página del historial
+  uint8_t maxBackoff = 4;
+};
+
+class Collector {
+public:
+  struct DeviceStats {
+    uint32_t requests;
+    uint32_t ok;
+    uint32_t timeouts;
+    uint32_t errors;        // conexión rechazada/cortada, HTTP != 200, JSON ilegible
+    uint32_t connects;      // conexiones nuevas
+    uint32_t reused;        // peticiones sobre una conexión abierta
+    uint32_t staleRetries;  // reusadas que el servidor ya había cerrado
+    uint32_t skipped;       // rondas salteadas por backoff u ocupada
+    uint32_t rows;          // filas escritas
+    uint64_t bytes;         // recibidos
+    uint32_t maxMs;         // petición más lenta (exitosa)
+  };
+
+  struct RoundStats {
+    uint32_t round;
+    uint32_t devices;       // placas con trabajo en la ronda
+    uint32_t ok, failed;
+    uint32_t skipped;       // por backoff
+    uint32_t busy;          // todavía ocupadas con la ronda anterior
+    uint32_t okMs;          // desde el inicio hasta la última placa exitosa
+    uint32_t ms;            // hasta la última placa (exitosa o no)
+    uint32_t rows;
+  };
+
+  Collector(const CollectorConfig &cfg, ColumnWriter &out);
+  ~Collector();
+
+  // ip: dirección numérica IPv4. history: la placa entiende /api/history?from=
+  // false si la IP no es válida o esa ip:puerto ya está en la lista
+  bool add(const std::string &name, const std::string &host, const std::string &ip, uint16_t port, bool history);
+  // Un servicio descubierto: sólo si el TXT trae api=COLLECTOR_API_VERSION;
+  // el historial si caps incluye "range". 1 agregada, 0 no es una placa
+  // (otro servidor HTTP de la red) o ya estaba, -1 otra versión de la API
+  int add(const MdnsService &s);
+  // Corre `rounds` rondas (0: hasta stop()) y vuelve con todo escrito
+  void run(uint32_t rounds);
+  void stop() { stop_ = true; }   // se puede llamar desde un handler de señal
+
+  std::function<void(const RoundStats &)> onRound;
+
+  size_t size() const { return devices_.size(); }
+  const std::string &name(size_t i) const { return devices_[i]->name; }
+  const DeviceStats &stats(size_t i) const { return devices_[i]->stats; }
+  DeviceStats total() const;
+
+private:
+  enum Step : uint8_t { IDLE, LATEST, HISTORY };
+  enum State : uint8_t { CLOSED, CONNECTING, WRITING, READING, KEPT };
+
+  struct Device {
+    std::string name, host;
+    sockaddr_in addr;
+    uint16_t id;            // en el archivo
+    bool history;
+    int fd = -1;
+    State state = CLOSED;
+    Step step = IDLE;
+    bool wantHistory = false;
+    bool reused = false;    // la petición en curso va por una conexión vieja
+    bool retried = false;
+    std::string out;
+    size_t outOff = 0;
+    HttpParser resp;
+    uint64_t startMs = 0, deadlineMs = 0;
+    uint32_t round = 0;     // ronda del trabajo en curso
+    uint32_t fails = 0;     // seguidos
+    uint32_t skipUntil = 0; // ronda
+    uint32_t historyFrom = 0;  // epoch (s) desde donde pedir el historial
+    int64_t lastLatestMs = 0;
+    DeviceStats stats = {};
+  };
+
+  struct Round {
+    RoundStats st;
+    uint64_t startMs;
+    uint32_t pending;
+  };
+
+  void startRound(uint64_t now);
+  void admit(uint64_t now);
+  void begin(Device &d, uint64_t now);
+  void send(Device &d, uint64_t now, bool retry = false);
+  bool retryStale(Device &d, uint64_t now);
+  bool connect(Device &d);
+  void onEvent(Device &d, uint32_t events, uint64_t now);
+  void writeSome(Device &d, uint64_t now);
+  void readSome(Device &d, uint64_t now);
+  void complete(Device &d, uint64_t now);
+  void fail(Device &d, bool timeout, uint64_t now);
+  void finish(Device &d, bool ok, uint64_t now);
+  void closeConn(Device &d);
+  void watch(Device &d, uint32_t events);
+  bool handleLatest(Device &d);
+  bool handleHistory(Device &d, bool &more);
+  Round *findRound(uint32_t n);
+
+  CollectorConfig cfg_;
+  ColumnWriter &out_;
+  int ep_ = -1;
+  std::vector<Device *> devices_;
+  std::deque<Device *> waiting_;    // con trabajo, esperando lugar
+  std::vector<Device *> active_;    // con una petición en curso
+  std::vector<Round> rounds_;       // abiertas (con placas pendientes)
+  uint32_t round_ = 0;
+  volatile bool stop_ = false;
+};
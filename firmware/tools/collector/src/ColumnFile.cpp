@@ -0,0 +1,206 @@
+#include "ColumnFile.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// ======== Formato ========
+static uint32_t fnv1a(const uint8_t *p, size_t n) {
+  uint32_t h = 2166136261u;
+  for (size_t i = 0; i < n; ++i) {
+    h ^= p[i];
+    h *= 16777619u;
+  }
+  return h;
+}
+
+template <class T> static void put(std::vector<uint8_t> &b, const T &v) {
+  const uint8_t *p = (const uint8_t *)&v;
+  b.insert(b.end(), p, p + sizeof(T));
+}
+
+template <class T> static void putColumn(std::vector<uint8_t> &b, const std::vector<T> &v) {
+  const uint8_t *p = (const uint8_t *)v.data();
+  b.insert(b.end(), p, p + v.size() * sizeof(T));
+}
+
+static void putString(std::vector<uint8_t> &b, const std::string &s) {
+  size_t n = s.size() < 255 ? s.size() : 255;
+  b.push_back((uint8_t)n);
+  b.insert(b.end(), s.begin(), s.begin() + n);
+}
+
+void ColumnRows::clear() {
+  dev.clear();
+  ts.clear();
+  temperature.clear();
+  humidity.clear();
+  source.clear();
+}
+
+// ======== Lectura ========
+namespace {
+
+struct Cursor {
+  const uint8_t *p;
+  size_t n, pos;
+  bool ok;
+
+  template <class T> T get() {
+    T v{};
+    if (pos + sizeof(T) > n) { ok = false; return v; }
+    memcpy(&v, p + pos, sizeof(T));
+    pos += sizeof(T);
+    return v;
+  }
+  std::string str() {
+    uint8_t len = get<uint8_t>();
+    if (!ok || pos + len > n) { ok = false; return std::string(); }
+    std::string s((const char *)p + pos, len);
+    pos += len;
+    return s;
+  }
+  template <class T> void column(std::vector<T> &out, size_t rows) {
+    if (!ok || pos + rows * sizeof(T) > n) { ok = false; return; }
+    out.resize(rows);
+    memcpy(out.data(), p + pos, rows * sizeof(T));
+    pos += rows * sizeof(T);
+  }
+};
+
+} // namespace
+
+long readColumnFile(const char *path, const std::function<void(const ColumnDevice &)> &onDevice,
+                    const std::function<void(const ColumnRows &)> &onRows) {
+  int fd = ::open(path, O_RDONLY);
+  if (fd < 0) return -1;
+  std::vector<uint8_t> payload;
+  ColumnRows rows;
+  long good = 0;
+  for (;;) {
+    uint8_t head[8];
+    if (read(fd, head, sizeof(head)) != (ssize_t)sizeof(head)) break;
+    uint32_t len;
+    memcpy(&len, head + 4, 4);
+    if (len > (64u << 20)) break;
+    payload.resize(len + 4);
+    if (read(fd, payload.data(), payload.size()) != (ssize_t)payload.size()) break;
+    uint32_t sum;
+    memcpy(&sum, payload.data() + len, 4);
+    if (sum != fnv1a(payload.data(), len)) break;
+
+    Cursor c = {payload.data(), len, 0, true};
+    if (memcmp(head, "FLCD", 4) == 0) {
+      ColumnDevice d;
+      d.id = c.get<uint16_t>();
+      d.port = c.get<uint16_t>();
+      d.name = c.str();
+      d.host = c.str();
+      d.ip = c.str();
+      if (!c.ok) break;
+      if (onDevice) onDevice(d);
+    } else if (memcmp(head, "FLCR", 4) == 0) {
+      uint32_t n = c.get<uint32_t>();
+      c.column(rows.dev, n);
+      c.column(rows.ts, n);
+      c.column(rows.temperature, n);
+      c.column(rows.humidity, n);
+      c.column(rows.source, n);
+      if (!c.ok) break;
+      if (onRows) onRows(rows);
+    } else {
+      break;
+    }
+    good += 8 + (long)len + 4;
+  }
+  ::close(fd);
+  return good;
+}
+
+// ======== Escritura ========
+bool ColumnWriter::open(const char *path) {
+  close();
+  ids_.clear();
+  rows_.clear();
+  long good = readColumnFile(path, [this](const ColumnDevice &d) { ids_[d.name] = d.id; }, nullptr);
+  fd_ = ::open(path, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+  if (fd_ < 0) return false;
+  struct stat st;
+  if (good >= 0 && fstat(fd_, &st) == 0 && st.st_size > good) {
+    stats_.recovered += (uint64_t)(st.st_size - good);
+    if (ftruncate(fd_, good) != 0) stats_.writeErrors++;
+  }
+  return true;
+}
+
+void ColumnWriter::close() {
+  if (fd_ < 0) return;
+  flush();
+  ::close(fd_);
+  fd_ = -1;
+}
+
+bool ColumnWriter::writeBlock(const char *magic, const std::vector<uint8_t> &payload) {
+  std::vector<uint8_t> b;
+  b.reserve(payload.size() + 12);
+  b.insert(b.end(), magic, magic + 4);
+  put(b, (uint32_t)payload.size());
+  b.insert(b.end(), payload.begin(), payload.end());
+  put(b, fnv1a(payload.data(), payload.size()));
+  // Un solo write con O_APPEND: el bloque queda entero o cortado al final
+  size_t off = 0;
+  while (off < b.size()) {
+    ssize_t n = write(fd_, b.data() + off, b.size() - off);
+    if (n < 0 && errno == EINTR) continue;
+    if (n <= 0) {
+      stats_.writeErrors++;
+      return false;
+    }
+    off += (size_t)n;
+  }
+  stats_.blocks++;
+  stats_.bytes += b.size();
+  return true;
+}
+
+uint16_t ColumnWriter::device(const std::string &name, const std::string &host, const std::string &ip,
+                              uint16_t port) {
+  auto it = ids_.find(name);
+  if (it != ids_.end()) return it->second;
+  uint16_t id = (uint16_t)ids_.size();
+  ids_[name] = id;
+  std::vector<uint8_t> b;
+  put(b, id);
+  put(b, port);
+  putString(b, name);
+  putString(b, host);
+  putString(b, ip);
+  if (fd_ >= 0) writeBlock("FLCD", b);
+  return id;
+}
+
+void ColumnWriter::append(uint16_t dev, int64_t tsMs, float t, float h, Source src) {
+  rows_.dev.push_back(dev);
+  rows_.ts.push_back(tsMs);
+  rows_.temperature.push_back(t);
+  rows_.humidity.push_back(h);
+  rows_.source.push_back((uint8_t)src);
+  stats_.rows++;
+  if (rows_.size() >= blockRows_) flush();
+}
+
+bool ColumnWriter::flush() {
+  if (rows_.size() == 0 || fd_ < 0) return true;
+  std::vector<uint8_t> b;
+  b.reserve(4 + rows_.size() * 19);
+  put(b, (uint32_t)rows_.size());
+  putColumn(b, rows_.dev);
+  putColumn(b, rows_.ts);
+  putColumn(b, rows_.temperature);
+  putColumn(b, rows_.humidity);
+  putColumn(b, rows_.source);
+  rows_.clear();
+  return writeBlock("FLCR", b);
+}
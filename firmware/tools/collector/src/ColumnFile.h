@@ -0,0 +1,77 @@
+// ======== Archivo columnar de sólo agregado ========
+// Un archivo con bloques uno detrás de otro; nunca se reescribe lo escrito.
+//   "FLCD" u32 largo  placa: u16 id, u16 puerto, nombre, host, ip (u8 largo + bytes)
+//   "FLCR" u32 largo  grupo de filas: u32 n y las columnas enteras, una
+//                     detrás de otra: dev u16[n], ts i64[n] (ms epoch),
+//                     temperature f32[n], humidity f32[n], source u8[n]
+// y después del contenido, u32 FNV-1a del contenido. Leer una columna es
+// leer un tramo contiguo por bloque. Un bloque cortado (corte de luz a mitad
+// de write) o con checksum malo termina la lectura; al reabrir para agregar
+// se recorta y las placas ya registradas conservan su id. Orden de bytes del
+// host (little-endian en x86/ARM).
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+struct ColumnDevice {
+  uint16_t id;
+  uint16_t port;
+  std::string name, host, ip;
+};
+
+struct ColumnRows {
+  std::vector<uint16_t> dev;
+  std::vector<int64_t> ts;
+  std::vector<float> temperature;
+  std::vector<float> humidity;
+  std::vector<uint8_t> source;
+  size_t size() const { return ts.size(); }
+  void clear();
+};
+
+class ColumnWriter {
+public:
+  enum Source : uint8_t { LATEST = 0, HISTORY = 1 };
+
+  struct Stats {
+    uint64_t rows;
+    uint32_t blocks;
+    uint64_t bytes;         // escritos en esta sesión
+    uint32_t writeErrors;
+    uint64_t recovered;     // bytes de cola rota recortados al abrir
+  };
+
+  explicit ColumnWriter(size_t blockRows = 4096) : blockRows_(blockRows) {}
+  ~ColumnWriter() { close(); }
+
+  bool open(const char *path);
+  void close();
+
+  // Id de la placa (la registra en el archivo la primera vez)
+  uint16_t device(const std::string &name, const std::string &host, const std::string &ip, uint16_t port);
+  void append(uint16_t dev, int64_t tsMs, float t, float h, Source src);
+  bool flush();   // escribe el grupo en curso como un bloque
+
+  size_t pending() const { return rows_.size(); }
+  const Stats &stats() const { return stats_; }
+
+private:
+  bool writeBlock(const char *magic, const std::vector<uint8_t> &payload);
+
+  int fd_ = -1;
+  size_t blockRows_;
+  ColumnRows rows_;
+  std::map<std::string, uint16_t> ids_;   // nombre -> id
+  Stats stats_ = {0, 0, 0, 0, 0};
+};
+
+// Recorre el archivo bloque por bloque. Devuelve los bytes válidos leídos
+// (el resto, si hay, es una cola rota); -1 si no se pudo abrir.
+long readColumnFile(const char *path, const std::function<void(const ColumnDevice &)> &onDevice,
+                    const std::function<void(const ColumnRows &)> &onRows);
@@ -0,0 +1,131 @@
+#include "HttpParser.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+void HttpParser::reset() {
+  state_ = STATUS;
+  line_.clear();
+  body_.clear();
+  remaining_ = 0;
+  bytes_ = 0;
+  status_ = 0;
+  http11_ = true;
+  keepAlive_ = true;
+  chunked_ = false;
+  hasLength_ = false;
+}
+
+HttpParser::Result HttpParser::headerLine(const std::string &l) {
+  size_t colon = l.find(':');
+  if (colon == std::string::npos) return BAD;
+  std::string name = l.substr(0, colon);
+  size_t v = l.find_first_not_of(" \t", colon + 1);
+  std::string value = v == std::string::npos ? "" : l.substr(v);
+  if (strcasecmp(name.c_str(), "Content-Length") == 0) {
+    char *end;
+    remaining_ = strtoul(value.c_str(), &end, 10);
+    if (end == value.c_str()) return BAD;
+    hasLength_ = true;
+  } else if (strcasecmp(name.c_str(), "Transfer-Encoding") == 0) {
+    chunked_ = strcasestr(value.c_str(), "chunked") != nullptr;
+  } else if (strcasecmp(name.c_str(), "Connection") == 0) {
+    if (strcasestr(value.c_str(), "close")) keepAlive_ = false;
+    else if (strcasestr(value.c_str(), "keep-alive")) keepAlive_ = true;
+  }
+  return NEED_MORE;
+}
+
+// Una línea completa (sin CRLF) según el estado
+HttpParser::Result HttpParser::line(const std::string &l) {
+  switch (state_) {
+    case STATUS:
+      if (l.compare(0, 5, "HTTP/") != 0 || l.size() < 12) return BAD;
+      http11_ = l.compare(5, 3, "1.0") != 0;
+      keepAlive_ = http11_;
+      status_ = atoi(l.c_str() + 9);
+      state_ = HEADERS;
+      return NEED_MORE;
+    case HEADERS:
+      if (!l.empty()) return headerLine(l);
+      if (chunked_) state_ = CHUNK_SIZE;
+      else if (hasLength_) state_ = remaining_ ? BODY : COMPLETE;
+      else if (status_ == 204 || status_ == 304) state_ = COMPLETE;
+      else {
+        state_ = UNTIL_CLOSE;   // sin largo: el cuerpo termina con la conexión
+        keepAlive_ = false;
+      }
+      return state_ == COMPLETE ? DONE : NEED_MORE;
+    case CHUNK_SIZE: {
+      char *end;
+      remaining_ = strtoul(l.c_str(), &end, 16);
+      if (end == l.c_str()) return BAD;
+      state_ = remaining_ ? CHUNK_DATA : TRAILER;
+      return NEED_MORE;
+    }
+    case CHUNK_END:
+      if (!l.empty()) return BAD;
+      state_ = CHUNK_SIZE;
+      return NEED_MORE;
+    case TRAILER:
+      if (!l.empty()) return NEED_MORE;
+      state_ = COMPLETE;
+      return DONE;
+    default:
+      return BAD;
+  }
+}
+
+HttpParser::Result HttpParser::feed(const char *data, size_t n) {
+  bytes_ += n;
+  while (n) {
+    switch (state_) {
+      case BODY:
+      case CHUNK_DATA: {
+        size_t take = n < remaining_ ? n : remaining_;
+        body_.append(data, take);
+        data += take;
+        n -= take;
+        remaining_ -= take;
+        if (remaining_) break;
+        if (state_ == CHUNK_DATA) {
+          state_ = CHUNK_END;
+          break;
+        }
+        state_ = COMPLETE;
+        return DONE;
+      }
+      case UNTIL_CLOSE:
+        body_.append(data, n);
+        return NEED_MORE;
+      case COMPLETE:
+        return BAD;  // bytes de más después de una respuesta completa
+      default: {
+        const char *nl = (const char *)memchr(data, '\n', n);
+        size_t take = nl ? (size_t)(nl - data) + 1 : n;
+        line_.append(data, take);
+        data += take;
+        n -= take;
+        if (!nl) {
+          if (line_.size() > 8192) return BAD;
+          break;
+        }
+        line_.resize(line_.size() - 1);
+        if (!line_.empty() && line_.back() == '\r') line_.resize(line_.size() - 1);
+        Result r = line(line_);
+        line_.clear();
+        if (r != NEED_MORE) return r;
+      }
+    }
+  }
+  return NEED_MORE;
+}
+
+HttpParser::Result HttpParser::closed() {
+  if (state_ == UNTIL_CLOSE) {
+    state_ = COMPLETE;
+    return DONE;
+  }
+  return state_ == COMPLETE ? DONE : BAD;
+}
@@ -0,0 +1,41 @@
+// ======== Respuesta HTTP/1.1 leída de a pedazos ========
+// Para el loop de eventos del colector: feed() recibe lo que haya llegado al
+// socket y avisa cuando la respuesta está completa. Cuerpo con
+// Content-Length, chunked (lo que usa JsonResponse en las respuestas
+// grandes) o delimitado por el cierre de la conexión.
+#pragma once
+
+#include <stddef.h>
+#include <string>
+
+class HttpParser {
+public:
+  enum Result { NEED_MORE, DONE, BAD };
+
+  void reset();
+  Result feed(const char *data, size_t n);
+  // El servidor cerró: completa un cuerpo sin largo, o es un error
+  Result closed();
+
+  int status() const { return status_; }
+  bool keepAlive() const { return keepAlive_; }
+  const std::string &body() const { return body_; }
+  size_t bytes() const { return bytes_; }  // recibidos, cabeceras incluidas
+
+private:
+  enum State { STATUS, HEADERS, BODY, CHUNK_SIZE, CHUNK_DATA, CHUNK_END, TRAILER, UNTIL_CLOSE, COMPLETE };
+
+  Result headerLine(const std::string &line);
+  Result line(const std::string &line);
+
+  State state_ = STATUS;
+  std::string line_;      // línea en curso (estado, cabeceras, tamaño de chunk)
+  std::string body_;
+  size_t remaining_ = 0;  // bytes de cuerpo o de chunk que faltan
+  size_t bytes_ = 0;
+  int status_ = 0;
+  bool http11_ = true;
+  bool keepAlive_ = true;
+  bool chunked_ = false;
+  bool hasLength_ = false;
+};
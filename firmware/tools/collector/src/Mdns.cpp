@@ -0,0 +1,350 @@
+#include "Mdns.h"
+
+#include <arpa/inet.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <set>
+
+// ======== Escritura ========
+namespace dns {
+
+Writer::Writer(uint16_t flags) : buf_(12, 0) {
+  buf_[2] = (uint8_t)(flags >> 8);
+  buf_[3] = (uint8_t)flags;
+}
+
+void Writer::u16(uint16_t v) {
+  buf_.push_back((uint8_t)(v >> 8));
+  buf_.push_back((uint8_t)v);
+}
+
+void Writer::u32(uint32_t v) {
+  u16((uint16_t)(v >> 16));
+  u16((uint16_t)v);
+}
+
+// Sin compresión: los mensajes son chicos
+void Writer::name(const std::string &n) {
+  size_t start = 0;
+  while (start < n.size()) {
+    size_t dot = n.find('.', start);
+    if (dot == std::string::npos) dot = n.size();
+    size_t len = dot - start;
+    if (len > 63) len = 63;
+    buf_.push_back((uint8_t)len);
+    buf_.insert(buf_.end(), n.begin() + start, n.begin() + start + len);
+    start = dot + 1;
+  }
+  buf_.push_back(0);
+}
+
+static void bump(std::vector<uint8_t> &b, int at) {
+  uint16_t v = (uint16_t)((b[at] << 8 | b[at + 1]) + 1);
+  b[at] = (uint8_t)(v >> 8);
+  b[at + 1] = (uint8_t)v;
+}
+
+void Writer::question(const std::string &n, uint16_t type, uint16_t cls) {
+  name(n);
+  u16(type);
+  u16(cls);
+  bump(buf_, 4);
+}
+
+size_t Writer::record(int section, const std::string &n, uint16_t type, uint16_t cls, uint32_t ttl) {
+  name(n);
+  u16(type);
+  u16(cls);
+  u32(ttl);
+  size_t lenAt = buf_.size();
+  u16(0);
+  bump(buf_, 6 + 2 * section);
+  return lenAt;
+}
+
+void Writer::endRecord(size_t lenAt) {
+  size_t len = buf_.size() - lenAt - 2;
+  buf_[lenAt] = (uint8_t)(len >> 8);
+  buf_[lenAt + 1] = (uint8_t)len;
+}
+
+void Writer::ptr(int section, const std::string &n, const std::string &target, uint32_t ttl) {
+  size_t at = record(section, n, PTR, CLASS_IN, ttl);
+  name(target);
+  endRecord(at);
+}
+
+void Writer::srv(int section, const std::string &n, uint16_t port, const std::string &target, uint32_t ttl) {
+  size_t at = record(section, n, SRV, CLASS_IN | CACHE_FLUSH, ttl);
+  u16(0);  // prioridad
+  u16(0);  // peso
+  u16(port);
+  name(target);
+  endRecord(at);
+}
+
+void Writer::txt(int section, const std::string &n, const std::map<std::string, std::string> &kv, uint32_t ttl) {
+  size_t at = record(section, n, TXT, CLASS_IN | CACHE_FLUSH, ttl);
+  for (const auto &e : kv) {
+    std::string s = e.first + "=" + e.second;
+    if (s.size() > 255) s.resize(255);
+    buf_.push_back((uint8_t)s.size());
+    buf_.insert(buf_.end(), s.begin(), s.end());
+  }
+  if (kv.empty()) buf_.push_back(0);
+  endRecord(at);
+}
+
+void Writer::a(int section, const std::string &n, const in_addr &ip, uint32_t ttl) {
+  size_t at = record(section, n, A, CLASS_IN | CACHE_FLUSH, ttl);
+  const uint8_t *b = (const uint8_t *)&ip.s_addr;
+  buf_.insert(buf_.end(), b, b + 4);
+  endRecord(at);
+}
+
+// ======== Lectura ========
+namespace {
+
+struct Reader {
+  const uint8_t *p;
+  size_t n, pos;
+  bool ok;
+
+  uint16_t u16() {
+    if (pos + 2 > n) { ok = false; return 0; }
+    uint16_t v = (uint16_t)(p[pos] << 8 | p[pos + 1]);
+    pos += 2;
+    return v;
+  }
+  uint32_t u32() {
+    uint32_t hi = u16();
+    return hi << 16 | u16();
+  }
+  // Nombre con compresión (punteros a nombres anteriores del mensaje)
+  std::string name() {
+    std::string out;
+    size_t at = pos;
+    bool jumped = false;
+    for (int hops = 0; ok && hops < 64; ++hops) {
+      if (at >= n) break;
+      uint8_t len = p[at];
+      if ((len & 0xC0) == 0xC0) {
+        if (at + 1 >= n) break;
+        if (!jumped) pos = at + 2;
+        jumped = true;
+        at = (size_t)((len & 0x3F) << 8 | p[at + 1]);
+        continue;
+      }
+      if (len == 0) {
+        if (!jumped) pos = at + 1;
+        return out;
+      }
+      if (at + 1 + len > n) break;
+      if (!out.empty()) out += '.';
+      out.append((const char *)p + at + 1, len);
+      at += 1 + len;
+    }
+    ok = false;
+    return out;
+  }
+};
+
+} // namespace
+
+bool parse(const uint8_t *p, size_t n, Message &out) {
+  Reader r = {p, n, 0, true};
+  out.id = r.u16();
+  out.flags = r.u16();
+  uint16_t qd = r.u16(), an = r.u16(), ns = r.u16(), ar = r.u16();
+  out.questions.clear();
+  out.records.clear();
+  for (uint16_t i = 0; i < qd && r.ok; ++i) {
+    std::string name = r.name();
+    uint16_t type = r.u16();
+    r.u16();  // clase
+    out.questions.push_back(std::make_pair(name, type));
+  }
+  for (uint32_t i = 0; i < (uint32_t)an + ns + ar && r.ok; ++i) {
+    Record rec;
+    rec.name = r.name();
+    rec.type = r.u16();
+    rec.cls = r.u16();
+    r.u32();  // ttl
+    uint16_t len = r.u16();
+    if (!r.ok || r.pos + len > n) return false;
+    size_t end = r.pos + len;
+    rec.port = 0;
+    rec.ip.s_addr = 0;
+    switch (rec.type) {
+      case PTR:
+        rec.target = r.name();
+        break;
+      case SRV:
+        r.u16();
+        r.u16();
+        rec.port = r.u16();
+        rec.target = r.name();
+        break;
+      case TXT:
+        while (r.pos < end) {
+          uint8_t l = p[r.pos++];
+          if (r.pos + l > end) return false;
+          std::string s((const char *)p + r.pos, l);
+          r.pos += l;
+          if (s.empty()) continue;
+          size_t eq = s.find('=');
+          rec.txt[s.substr(0, eq)] = eq == std::string::npos ? "" : s.substr(eq + 1);
+        }
+        break;
+      case A:
+        if (len == 4) memcpy(&rec.ip.s_addr, p + r.pos, 4);
+        break;
+      default:
+        break;
+    }
+    r.pos = end;
+    if (r.ok) out.records.push_back(rec);
+  }
+  return r.ok;
+}
+
+} // namespace dns
+
+// ======== Browse ========
+static uint64_t nowMs() {
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static std::string lower(std::string s) {
+  for (char &c : s) c = (char)tolower((unsigned char)c);
+  return s;
+}
+
+bool parseEndpoint(const char *s, uint16_t defaultPort, sockaddr_in &out) {
+  std::string host(s);
+  uint16_t port = defaultPort;
+  size_t colon = host.rfind(':');
+  if (colon != std::string::npos) {
+    port = (uint16_t)atoi(host.c_str() + colon + 1);
+    host.resize(colon);
+  }
+  memset(&out, 0, sizeof(out));
+  out.sin_family = AF_INET;
+  out.sin_port = htons(port);
+  return port && inet_pton(AF_INET, host.c_str(), &out.sin_addr) == 1;
+}
+
+namespace {
+
+struct Found {
+  std::set<std::string> instances;                          // nombres completos (PTR)
+  std::map<std::string, std::pair<std::string, uint16_t>> srv;  // instancia -> host, puerto
+  std::map<std::string, std::map<std::string, std::string>> txt;
+  std::map<std::string, in_addr> a;                          // host -> IP
+  std::map<std::string, in_addr> from;                       // instancia -> origen del paquete
+  std::map<std::string, std::string> display;                // instancia -> nombre como vino
+};
+
+void collect(int fd, const std::string &service, int waitMs, Found &f, MdnsBrowseStats &st) {
+  uint64_t deadline = nowMs() + (uint64_t)waitMs;
+  uint8_t buf[9000];
+  for (;;) {
+    uint64_t now = nowMs();
+    if (now >= deadline) return;
+    pollfd p = {fd, POLLIN, 0};
+    if (poll(&p, 1, (int)(deadline - now)) <= 0) continue;
+    sockaddr_in src;
+    socklen_t sl = sizeof(src);
+    ssize_t n = recvfrom(fd, buf, sizeof(buf), 0, (sockaddr *)&src, &sl);
+    if (n <= 0) continue;
+    dns::Message m;
+    if (!dns::parse(buf, (size_t)n, m) || !(m.flags & 0x8000)) {
+      st.malformed++;
+      continue;
+    }
+    st.packets++;
+    std::vector<std::string> seen;
+    for (const dns::Record &r : m.records) {
+      std::string name = lower(r.name);
+      switch (r.type) {
+        case dns::PTR:
+          if (name == service) {
+            f.instances.insert(lower(r.target));
+            f.display[lower(r.target)] = r.target;
+            seen.push_back(lower(r.target));
+          }
+          break;
+        case dns::SRV: f.srv[name] = std::make_pair(lower(r.target), r.port); seen.push_back(name); break;
+        case dns::TXT: f.txt[name] = r.txt; break;
+        case dns::A: f.a[name] = r.ip; break;
+      }
+    }
+    for (const std::string &s : seen) f.from[s] = src.sin_addr;
+  }
+}
+
+} // namespace
+
+std::vector<MdnsService> mdnsBrowse(const char *service, const sockaddr_in &to, int waitMs, MdnsBrowseStats *stats) {
+  MdnsBrowseStats st = {0, 0, 0};
+  std::vector<MdnsService> out;
+  int fd = socket(AF_INET, SOCK_DGRAM, 0);
+  if (fd < 0) return out;
+  int ttl = 255;
+  setsockopt(fd, IPPROTO_IP, IP_MULTICAST_TTL, &ttl, sizeof(ttl));
+  int rcv = 1 << 20;  // cientos de placas contestan casi a la vez
+  setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcv, sizeof(rcv));
+
+  const std::string svc = lower(service);
+  Found f;
+  dns::Writer q;
+  q.question(svc, dns::PTR, dns::CLASS_IN | dns::QU);
+  sendto(fd, q.bytes().data(), q.bytes().size(), 0, (const sockaddr *)&to, sizeof(to));
+  st.queries++;
+  collect(fd, svc, waitMs, f, st);
+
+  // Segunda vuelta: lo que faltó de cada instancia
+  dns::Writer again;
+  bool ask = false;
+  for (const std::string &inst : f.instances) {
+    if (!f.srv.count(inst) || !f.txt.count(inst)) {
+      again.question(inst, dns::ANY, dns::CLASS_IN | dns::QU);
+      ask = true;
+    } else if (!f.a.count(f.srv[inst].first)) {
+      again.question(f.srv[inst].first, dns::A, dns::CLASS_IN | dns::QU);
+      ask = true;
+    }
+  }
+  if (ask && again.bytes().size() < 9000) {
+    sendto(fd, again.bytes().data(), again.bytes().size(), 0, (const sockaddr *)&to, sizeof(to));
+    st.queries++;
+    collect(fd, svc, waitMs / 2, f, st);
+  }
+  close(fd);
+
+  for (const std::string &inst : f.instances) {
+    auto s = f.srv.find(inst);
+    if (s == f.srv.end()) continue;
+    MdnsService m;
+    size_t dot = inst.size() > svc.size() + 1 ? inst.size() - svc.size() - 1 : inst.size();
+    m.instance = f.display[inst].substr(0, dot);
+    m.host = s->second.first;
+    m.port = s->second.second;
+    auto a = f.a.find(m.host);
+    in_addr ip = a != f.a.end() ? a->second : f.from[inst];
+    char buf[INET_ADDRSTRLEN];
+    m.ip = inet_ntop(AF_INET, &ip, buf, sizeof(buf));
+    auto t = f.txt.find(inst);
+    if (t != f.txt.end()) m.txt = t->second;
+    out.push_back(m);
+  }
+  if (stats) *stats = st;
+  return out;
+}
@@ -0,0 +1,84 @@
+// ======== Descubrimiento por mDNS / DNS-SD ========
+// Pregunta PTR por un servicio (_http._tcp.local) con una consulta
+// "one-shot" (RFC 6762 §5.1): sale de un puerto que no es el 5353, así que
+// cada placa contesta por unicast directo al colector y no hace falta unirse
+// al grupo multicast. Junta PTR/SRV/TXT/A de las respuestas durante waitMs;
+// a las instancias que llegaron sin SRV, TXT o A les pregunta de nuevo.
+// Sin A se usa la dirección de origen del paquete (la placa que contestó).
+#pragma once
+
+#include <netinet/in.h>
+#include <stdint.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+struct MdnsService {
+  std::string instance;   // "esp32-2B3C"
+  std::string host;       // "esp32-2B3C.local"
+  std::string ip;         // "192.168.0.17"
+  uint16_t port = 0;
+  std::map<std::string, std::string> txt;
+};
+
+struct MdnsBrowseStats {
+  uint32_t queries;
+  uint32_t packets;       // respuestas recibidas
+  uint32_t malformed;     // paquetes que no se pudieron leer
+};
+
+// service: "_http._tcp.local". to: 224.0.0.251:5353 en la red real, o un
+// responder en 127.0.0.1 para las pruebas
+std::vector<MdnsService> mdnsBrowse(const char *service, const sockaddr_in &to, int waitMs,
+                                    MdnsBrowseStats *stats = nullptr);
+
+// "224.0.0.251:5353", "127.0.0.1:15353", "127.0.0.1" (puerto 5353)
+bool parseEndpoint(const char *s, uint16_t defaultPort, sockaddr_in &out);
+
+// ======== Mensajes DNS (compartido con el responder de prueba) ========
+namespace dns {
+enum Type : uint16_t { A = 1, PTR = 12, TXT = 16, SRV = 33, ANY = 255 };
+const uint16_t CLASS_IN = 1;
+const uint16_t QU = 0x8000;          // en preguntas: respuesta unicast
+const uint16_t CACHE_FLUSH = 0x8000; // en respuestas
+
+class Writer {
+public:
+  explicit Writer(uint16_t flags = 0);
+  void question(const std::string &name, uint16_t type, uint16_t cls);
+  // section: 0 respuestas, 1 autoridad, 2 adicionales
+  void ptr(int section, const std::string &name, const std::string &target, uint32_t ttl);
+  void srv(int section, const std::string &name, uint16_t port, const std::string &target, uint32_t ttl);
+  void txt(int section, const std::string &name, const std::map<std::string, std::string> &kv, uint32_t ttl);
+  void a(int section, const std::string &name, const in_addr &ip, uint32_t ttl);
+  const std::vector<uint8_t> &bytes() const { return buf_; }
+
+private:
+  void u16(uint16_t v);
+  void u32(uint32_t v);
+  void name(const std::string &n);
+  size_t record(int section, const std::string &n, uint16_t type, uint16_t cls, uint32_t ttl);
+  void endRecord(size_t lenAt);
+
+  std::vector<uint8_t> buf_;
+};
+
+struct Record {
+  std::string name;
+  uint16_t type, cls;
+  // Según el tipo
+  std::string target;                     // PTR, SRV
+  uint16_t port;                          // SRV
+  std::map<std::string, std::string> txt; // TXT
+  in_addr ip;                             // A
+};
+
+struct Message {
+  uint16_t id, flags;
+  std::vector<std::pair<std::string, uint16_t>> questions;  // nombre, tipo
+  std::vector<Record> records;  // las tres secciones juntas
+};
+
+bool parse(const uint8_t *p, size_t n, Message &out);
+} // namespace dns
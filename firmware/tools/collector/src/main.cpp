@@ -0,0 +1,170 @@
+// ======== Colector de la flota (Linux) ========
+// Descubre las placas por mDNS (_http._tcp con TXT api=1) y/o toma una lista
+// fija, y cada intervalo pide /api/latest a todas (y /api/history cada
+// tantas rondas) guardando las lecturas en un archivo columnar.
+//
+//   collector [opciones] [host[:puerto] ...]
+//     -o archivo   salida (fleet.col); se agrega, nunca se pisa
+//     -i s         intervalo entre rondas (10)
+//     -t ms        plazo por petición (3000)
+//     -c n         placas atendidas a la vez (64)
+//     -r n         rondas y salir (0: hasta Ctrl+C)
+//     -H n         /api/history cada n rondas (6; 0: nunca)
+//     -b s         historial inicial: los últimos s segundos (3600)
+//     -m ip:puerto a quién preguntar por mDNS (224.0.0.251:5353)
+//     -w ms        espera de respuestas mDNS (1500)
+//     -M           sin mDNS: sólo la lista
+//   collector -d archivo     vuelca el archivo como CSV
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <map>
+#include <string>
+
+#include "Collector.h"
+#include "ColumnFile.h"
+#include "Mdns.h"
+
+static Collector *s_collector = nullptr;
+
+static void onSignal(int) {
+  if (s_collector) s_collector->stop();
+}
+
+static int dump(const char *path) {
+  std::map<uint16_t, std::string> names;
+  printf("device,timestamp,temperature,humidity,source\n");
+  long good = readColumnFile(path, [&](const ColumnDevice &d) { names[d.id] = d.name; },
+                             [&](const ColumnRows &r) {
+                               for (size_t i = 0; i < r.size(); ++i) {
+                                 printf("%s,%lld,%.1f,%.0f,%s\n", names[r.dev[i]].c_str(), (long long)r.ts[i],
+                                        r.temperature[i], r.humidity[i],
+                                        r.source[i] == ColumnWriter::HISTORY ? "history" : "latest");
+                               }
+                             });
+  if (good < 0) {
+    fprintf(stderr, "no se pudo abrir %s\n", path);
+    return 1;
+  }
+  return 0;
+}
+
+// "192.168.0.17", "esp32-2B3C.local:80" (nombres por el resolver del sistema)
+static bool resolve(const std::string &entry, std::string &host, std::string &ip, uint16_t &port) {
+  host = entry;
+  port = 80;
+  size_t colon = entry.rfind(':');
+  if (colon != std::string::npos) {
+    port = (uint16_t)atoi(entry.c_str() + colon + 1);
+    host = entry.substr(0, colon);
+  }
+  addrinfo hints = {}, *res = nullptr;
+  hints.ai_family = AF_INET;
+  hints.ai_socktype = SOCK_STREAM;
+  if (getaddrinfo(host.c_str(), nullptr, &hints, &res) != 0 || !res) return false;
+  char buf[INET_ADDRSTRLEN];
+  ip = inet_ntop(AF_INET, &((sockaddr_in *)res->ai_addr)->sin_addr, buf, sizeof(buf));
+  freeaddrinfo(res);
+  return port != 0;
+}
+
+int main(int argc, char **argv) {
+  CollectorConfig cfg;
+  const char *outPath = "fleet.col";
+  const char *mdnsTo = "224.0.0.251:5353";
+  int mdnsWaitMs = 1500;
+  bool useMdns = true;
+  uint32_t rounds = 0;
+  int opt;
+  while ((opt = getopt(argc, argv, "o:i:t:c:r:H:b:m:w:Md:")) != -1) {
+    switch (opt) {
+      case 'o': outPath = optarg; break;
+      case 'i': cfg.intervalMs = (uint32_t)(atof(optarg) * 1000); break;
+      case 't': cfg.timeoutMs = (uint32_t)atoi(optarg); break;
+      case 'c': cfg.maxActive = (uint16_t)atoi(optarg); break;
+      case 'r': rounds = (uint32_t)atoi(optarg); break;
+      case 'H': cfg.historyEvery = (uint32_t)atoi(optarg); break;
+      case 'b': cfg.backfillSec = (uint32_t)atoi(optarg); break;
+      case 'm': mdnsTo = optarg; break;
+      case 'w': mdnsWaitMs = atoi(optarg); break;
+      case 'M': useMdns = false; break;
+      case 'd': return dump(optarg);
+      default:
+        fprintf(stderr, "uso: %s [-o archivo] [-i s] [-t ms] [-c n] [-r n] [-H n] [-b s] [-m ip:puerto] [-w ms] [-M] "
+                        "[host[:puerto] ...]\n       %s -d archivo\n", argv[0], argv[0]);
+        return 2;
+    }
+  }
+
+  // Una conexión por placa: cientos de descriptores
+  rlimit rl;
+  if (getrlimit(RLIMIT_NOFILE, &rl) == 0 && rl.rlim_cur < rl.rlim_max) {
+    rl.rlim_cur = rl.rlim_max;
+    setrlimit(RLIMIT_NOFILE, &rl);
+  }
+
+  ColumnWriter out;
+  if (!out.open(outPath)) {
+    fprintf(stderr, "no se pudo abrir %s\n", outPath);
+    return 1;
+  }
+  if (out.stats().recovered) fprintf(stderr, "%s: se recortaron %llu bytes de un bloque incompleto\n", outPath,
+                                     (unsigned long long)out.stats().recovered);
+  Collector collector(cfg, out);
+
+  if (useMdns) {
+    sockaddr_in to;
+    if (!parseEndpoint(mdnsTo, 5353, to)) {
+      fprintf(stderr, "-m %s: se espera ip[:puerto]\n", mdnsTo);
+      return 2;
+    }
+    MdnsBrowseStats st;
+    std::vector<MdnsService> found = mdnsBrowse("_http._tcp.local", to, mdnsWaitMs, &st);
+    uint32_t added = 0;
+    for (const MdnsService &s : found) {
+      int r = collector.add(s);
+      if (r > 0) added++;
+      else if (r < 0) fprintf(stderr, "%s: api=%s, se esperaba %d; se saltea\n", s.instance.c_str(),
+                              s.txt.at("api").c_str(), COLLECTOR_API_VERSION);
+    }
+    fprintf(stderr, "mDNS: %zu servicios _http._tcp, %u placas con api=%d (%u respuestas)\n", found.size(), added,
+            COLLECTOR_API_VERSION, st.packets);
+  }
+  // Después de mDNS: si una placa está en los dos, queda con el nombre de su instancia
+  for (int i = optind; i < argc; ++i) {
+    std::string host, ip;
+    uint16_t port;
+    if (!resolve(argv[i], host, ip, port)) {
+      fprintf(stderr, "%s: no se pudo resolver\n", argv[i]);
+      continue;
+    }
+    if (!collector.add(host, host, ip, port, true)) fprintf(stderr, "%s: ya está en la lista\n", argv[i]);
+  }
+
+  if (collector.size() == 0) {
+    fprintf(stderr, "no hay placas para consultar\n");
+    return 1;
+  }
+
+  collector.onRound = [](const Collector::RoundStats &r) {
+    fprintf(stderr, "ronda %u: %u placas, ok=%u fallaron=%u salteadas=%u ocupadas=%u filas=%u en %u ms\n", r.round,
+            r.devices, r.ok, r.failed, r.skipped, r.busy, r.rows, r.ms);
+  };
+  s_collector = &collector;
+  signal(SIGINT, onSignal);
+  signal(SIGTERM, onSignal);
+  collector.run(rounds);
+  s_collector = nullptr;
+
+  Collector::DeviceStats t = collector.total();
+  fprintf(stderr, "peticiones=%u ok=%u timeouts=%u errores=%u conexiones=%u reusadas=%u filas=%u -> %s\n",
+          t.requests, t.ok, t.timeouts, t.errors, t.connects, t.reused, t.rows, outPath);
+  return 0;
+}
@@ -0,0 +1,81 @@
+# Script de PlatformIO (extra_scripts = pre:...): convierte data/* en arrays
+# PROGMEM dentro de include/web_assets.h (versión plana y .gz de cada
+# archivo, con largo, tipo MIME y ETag precalculados). El firmware los sirve
+# desde la flash mapeada en memoria sin pasar por SPIFFS.
+# El ETag usa el mismo cálculo que StaticAssets (tamaño + FNV-1a), así que
+# no cambia entre la versión embebida y la de SPIFFS.
+#
+# Sin PlatformIO:  python3 ../tools/embed_data.py [dataDir] [salida.h]
+import gzip
+import os
+
+try:
+    Import("env")  # noqa: F821 (lo define PlatformIO)
+    DATA_DIR = env.subst("$PROJECT_DATA_DIR")  # noqa: F821
+    OUT = os.path.join(env.subst("$PROJECT_INCLUDE_DIR"), "web_assets.h")  # noqa: F821
+except NameError:
+    import sys
+    DATA_DIR = sys.argv[1] if len(sys.argv) > 1 else "data"
+    OUT = sys.argv[2] if len(sys.argv) > 2 else os.path.join("include", "web_assets.h")
+
+MIME = {
+    ".html": "text/html; charset=utf-8",
+    ".css": "text/css; charset=utf-8",
+    ".js": "application/javascript; charset=utf-8",
+    ".svg": "image/svg+xml",
+    ".json": "application/json; charset=utf-8",
+}
+SKIP = (".gz", ".bin")
+
+
+def fnv1a(data):
+    h = 2166136261
+    for b in data:
+        h = ((h ^ b) * 16777619) & 0xFFFFFFFF
+    return h
+
+
+def etag(data):
+    return '"%x-%08x"' % (len(data), fnv1a(data))
+
+
+def c_array(name, data):
+    lines = []
+    for i in range(0, len(data), 16):
+        lines.append("  " + ", ".join("0x%02x" % b for b in data[i:i + 16]) + ",")
+    return "static const uint8_t %s[] PROGMEM = {\n%s\n};\n" % (name, "\n".join(lines))
+
+
+def embed(data_dir, out):
+    names = sorted(n for n in os.listdir(data_dir)
+                   if os.path.isfile(os.path.join(data_dir, n)) and not n.endswith(SKIP))
+    arrays, rows = [], []
+    for i, name in enumerate(names):
+        with open(os.path.join(data_dir, name), "rb") as f:
+            raw = f.read()
+        gz = gzip.compress(raw, compresslevel=9, mtime=0)
+        mime = MIME.get(os.path.splitext(name)[1], "text/plain; charset=utf-8")
+        for suffix, data, is_gz in (("", raw, "false"), ("_GZ", gz, "true")):
+            var = "WEB_ASSET_%d%s" % (i, suffix)
+            arrays.append(c_array(var, data))
+            rows.append('  {"/%s", "%s", %s, %d, "%s", %s},' % (
+                name, mime, var, len(data), etag(data).replace('"', '\\"'), is_gz))
+
+    text = ("// Generado por tools/embed_data.py a partir de data/ - no editar\n"
+            "#pragma once\n\n#include <StaticAssets.h>\n\n"
+            + "\n".join(arrays)
+            + "\nstatic const EmbeddedAsset WEB_ASSETS[] = {\n" + "\n".join(rows) + "\n};\n"
+            + "static const size_t WEB_ASSETS_COUNT = sizeof(WEB_ASSETS) / sizeof(WEB_ASSETS[0]);\n")
+
+    # Sólo se reescribe si cambió, para no forzar recompilaciones
+    if os.path.exists(out):
+        with open(out) as f:
+            if f.read() == text:
+                return
+    os.makedirs(os.path.dirname(out) or ".", exist_ok=True)
+    with open(out, "w") as f:
+        f.write(text)
+    print("embed_data: %d archivos -> %s" % (len(names), out))
+
+
+embed(DATA_DIR, OUT)
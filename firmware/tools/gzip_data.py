@@ -0,0 +1,37 @@
+# Script de PlatformIO (extra_scripts = pre:...): genera data/<archivo>.gz
+# para cada archivo de data/ antes de compilar o armar la imagen de SPIFFS.
+# El firmware sirve la versión .gz con Content-Encoding: gzip cuando el
+# navegador la acepta. Salida reproducible (mtime = 0): mismo contenido,
+# mismo .gz, mismo ETag.
+import gzip
+import os
+
+try:
+    Import("env")  # noqa: F821 (lo define PlatformIO)
+    DATA_DIR = env.subst("$PROJECT_DATA_DIR")  # noqa: F821
+except NameError:
+    import sys
+    DATA_DIR = sys.argv[1] if len(sys.argv) > 1 else "data"
+
+SKIP = (".gz", ".bin")
+
+
+def gzip_data(data_dir):
+    if not os.path.isdir(data_dir):
+        return
+    for name in sorted(os.listdir(data_dir)):
+        src = os.path.join(data_dir, name)
+        if not os.path.isfile(src) or name.endswith(SKIP):
+            continue
+        dst = src + ".gz"
+        if os.path.exists(dst) and os.path.getmtime(dst) >= os.path.getmtime(src):
+            continue
+        with open(src, "rb") as f:
+            raw = f.read()
+        with open(dst, "wb") as f:
+            with gzip.GzipFile(filename="", mode="wb", fileobj=f, compresslevel=9, mtime=0) as gz:
+                gz.write(raw)
+        print("gzip_data: %s %d -> %d bytes" % (name, len(raw), os.path.getsize(dst)))
+
+
+gzip_data(DATA_DIR)